@@ -0,0 +1,390 @@
+/**
+ * Text cache eviction benchmark for transbasket.
+ * Replays a request trace through the text backend as the server does
+ * (lookup; a hit counts, a miss adds the translation) and reports the hit
+ * ratio unbounded, with W-TinyLFU at several entry budgets, and for an
+ * exact LRU of the same size simulated here.
+ *
+ * The trace is a recorded workload file, one request per line as
+ * "from<TAB>to<TAB>text" or just the text (eng -> kor), or by default a
+ * synthetic one: Zipf(0.99) requests over 100k keys with a bulk job of
+ * one-off strings mixed into the middle third.
+ *
+ * Usage: bench_cache_eviction [workload-file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "trans_cache.h"
+#include "cache_backend_text.h"
+#include "utils.h"
+
+#define SYNTHETIC_KEYS 100000
+#define SYNTHETIC_REQUESTS 1500000
+#define ZIPF_EXPONENT 0.99
+#define FLUSH_INTERVAL 100000       /* Requests between hit flushes (periodic save) */
+
+/* Entry budgets as percent of the distinct keys in the trace */
+static const double BUDGETS[] = { 1.0, 5.0, 20.0 };
+
+/* One request of the trace */
+typedef struct {
+    const char *from;
+    const char *to;
+    const char *text;
+    uint64_t key;               /* Digest prefix, identifies the text for LRU */
+} TraceRequest;
+
+typedef struct {
+    TraceRequest *requests;
+    size_t count;
+    char **owned;               /* Strings to free */
+    size_t owned_count;
+} Trace;
+
+/* Monotonic clock in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Append a request; returns 0 on success */
+static int trace_add(Trace *trace, size_t *capacity, const char *from, const char *to,
+                     const char *text) {
+    if (trace->count == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+        TraceRequest *requests = realloc(trace->requests, new_capacity * sizeof(TraceRequest));
+        if (!requests) {
+            return -1;
+        }
+        trace->requests = requests;
+        *capacity = new_capacity;
+    }
+
+    unsigned char digest[TRANS_CACHE_DIGEST_SIZE];
+    trans_cache_calculate_digest(from, to, text, digest);
+
+    TraceRequest *request = &trace->requests[trace->count++];
+    request->from = from;
+    request->to = to;
+    request->text = text;
+    memcpy(&request->key, digest, sizeof(request->key));
+    return 0;
+}
+
+/* Keep str for freeing with the trace; returns str or NULL */
+static char *trace_own(Trace *trace, size_t *capacity, char *str) {
+    if (!str) {
+        return NULL;
+    }
+    if (trace->owned_count == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+        char **owned = realloc(trace->owned, new_capacity * sizeof(char *));
+        if (!owned) {
+            free(str);
+            return NULL;
+        }
+        trace->owned = owned;
+        *capacity = new_capacity;
+    }
+    trace->owned[trace->owned_count++] = str;
+    return str;
+}
+
+/* Load a recorded workload; returns 0 on success */
+static int trace_load(Trace *trace, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Failed to open workload %s\n", path);
+        return -1;
+    }
+
+    size_t capacity = 0, owned_capacity = 0;
+    char *line = NULL;
+    size_t line_len = 0;
+    ssize_t read;
+    int result = 0;
+
+    while ((read = getline(&line, &line_len, fp)) != -1) {
+        while (read > 0 && (line[read - 1] == '\n' || line[read - 1] == '\r')) {
+            line[--read] = '\0';
+        }
+        if (read == 0) {
+            continue;
+        }
+
+        char *copy = trace_own(trace, &owned_capacity, strdup(line));
+        if (!copy) {
+            result = -1;
+            break;
+        }
+
+        const char *from = "eng", *to = "kor", *text = copy;
+        char *tab1 = strchr(copy, '\t');
+        char *tab2 = tab1 ? strchr(tab1 + 1, '\t') : NULL;
+        if (tab2) {
+            *tab1 = '\0';
+            *tab2 = '\0';
+            from = copy;
+            to = tab1 + 1;
+            text = tab2 + 1;
+        }
+
+        if (trace_add(trace, &capacity, from, to, text) != 0) {
+            result = -1;
+            break;
+        }
+    }
+
+    free(line);
+    fclose(fp);
+    return result;
+}
+
+/* Zipf-distributed key in [0, n) from the cumulative distribution */
+static size_t zipf_key(const double *cdf, size_t n, double u) {
+    size_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cdf[mid] < u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Build the synthetic trace; returns 0 on success */
+static int trace_synthetic(Trace *trace) {
+    double *cdf = malloc(SYNTHETIC_KEYS * sizeof(double));
+    char **keys = calloc(SYNTHETIC_KEYS, sizeof(char *));
+    size_t capacity = 0, owned_capacity = 0;
+    char text[64];
+    int result = cdf && keys ? 0 : -1;
+
+    double sum = 0.0;
+    for (size_t i = 0; result == 0 && i < SYNTHETIC_KEYS; i++) {
+        sum += 1.0 / pow((double)(i + 1), ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+    for (size_t i = 0; result == 0 && i < SYNTHETIC_KEYS; i++) {
+        cdf[i] /= sum;
+        snprintf(text, sizeof(text), "frequent sentence %zu", i);
+        keys[i] = trace_own(trace, &owned_capacity, strdup(text));
+        result = keys[i] ? 0 : -1;
+    }
+
+    srand(42);
+    size_t one_offs = 0;
+    for (size_t r = 0; result == 0 && r < SYNTHETIC_REQUESTS; r++) {
+        bool bulk = r >= SYNTHETIC_REQUESTS / 3 && r < 2 * SYNTHETIC_REQUESTS / 3 && (rand() & 1);
+        const char *request_text;
+
+        if (bulk) {
+            snprintf(text, sizeof(text), "bulk job string %zu", one_offs++);
+            request_text = trace_own(trace, &owned_capacity, strdup(text));
+        } else {
+            double u = (double)rand() / ((double)RAND_MAX + 1.0);
+            request_text = keys[zipf_key(cdf, SYNTHETIC_KEYS, u)];
+        }
+
+        if (!request_text || trace_add(trace, &capacity, "eng", "kor", request_text) != 0) {
+            result = -1;
+        }
+    }
+
+    free(cdf);
+    free(keys);
+    return result;
+}
+
+static void trace_free(Trace *trace) {
+    for (size_t i = 0; i < trace->owned_count; i++) {
+        free(trace->owned[i]);
+    }
+    free(trace->owned);
+    free(trace->requests);
+}
+
+/* Replay trace through a text cache with max_entries (0: unbounded).
+ * Returns hits, or -1 on error; *entries_out gets the final entry count. */
+static long long replay_cache(const Trace *trace, size_t max_entries, size_t *entries_out) {
+    TextBackendOptions options = { .max_entries = max_entries, .max_bytes = 0 };
+    TransCache *cache = trans_cache_init_with_backend(CACHE_BACKEND_TEXT,
+                                                      "/nonexistent/bench_eviction.jsonl",
+                                                      &options);
+    if (!cache) {
+        fprintf(stderr, "Failed to create cache\n");
+        return -1;
+    }
+
+    long long hits = 0;
+    double start = now_seconds();
+
+    for (size_t i = 0; i < trace->count; i++) {
+        const TraceRequest *request = &trace->requests[i];
+
+        trans_cache_read_begin(cache);
+        CacheEntry *entry = trans_cache_lookup(cache, request->from, request->to,
+                                               request->text);
+        if (entry) {
+            trans_cache_update_count(cache, entry);
+            hits++;
+        }
+        trans_cache_read_end(cache);
+
+        if (!entry) {
+            trans_cache_add(cache, request->from, request->to, request->text, "translated");
+        }
+        if ((i + 1) % FLUSH_INTERVAL == 0) {
+            trans_cache_flush_hits(cache);
+        }
+    }
+
+    double elapsed = now_seconds() - start;
+
+    size_t entries = 0;
+    unsigned long long evicted = 0;
+    cJSON *metrics = trans_cache_metrics(cache);
+    cJSON *storage = metrics ? cJSON_GetObjectItem(metrics, "storage") : NULL;
+    if (storage) {
+        entries = (size_t)cJSON_GetObjectItem(storage, "entries")->valuedouble;
+        evicted = (unsigned long long)cJSON_GetObjectItem(storage, "evicted")->valuedouble;
+    }
+    cJSON_Delete(metrics);
+    trans_cache_free(cache);
+
+    printf("  %-10s %10zu %9.2f%% %10zu %10llu %12.0f\n",
+           max_entries ? "w-tinylfu" : "unbounded", max_entries,
+           100.0 * (double)hits / (double)trace->count, entries, evicted,
+           (double)trace->count / elapsed);
+
+    *entries_out = entries;
+    return hits;
+}
+
+/* Exact LRU over digest prefixes: hash chains plus a recency list */
+typedef struct {
+    uint64_t key;
+    size_t prev, next;          /* Recency list (SIZE_MAX: none) */
+    size_t chain;               /* Next node in the bucket */
+} LruNode;
+
+/* Replay trace through an LRU of capacity entries; returns hits or -1 */
+static long long replay_lru(const Trace *trace, size_t capacity) {
+    size_t bucket_count = 1;
+    while (bucket_count < capacity * 2) {
+        bucket_count *= 2;
+    }
+
+    LruNode *nodes = malloc(capacity * sizeof(LruNode));
+    size_t *buckets = malloc(bucket_count * sizeof(size_t));
+    if (!nodes || !buckets) {
+        free(nodes);
+        free(buckets);
+        return -1;
+    }
+    memset(buckets, 0xff, bucket_count * sizeof(size_t));
+
+    size_t used = 0, head = SIZE_MAX, tail = SIZE_MAX;
+    long long hits = 0;
+
+    for (size_t i = 0; i < trace->count; i++) {
+        uint64_t key = trace->requests[i].key;
+        size_t *link = &buckets[key & (bucket_count - 1)];
+        size_t node = *link;
+        while (node != SIZE_MAX && nodes[node].key != key) {
+            node = nodes[node].chain;
+        }
+
+        if (node != SIZE_MAX) {
+            hits++;
+            if (node == head) {
+                continue;
+            }
+            /* Unlink from the recency list */
+            nodes[nodes[node].prev].next = nodes[node].next;
+            if (nodes[node].next != SIZE_MAX) {
+                nodes[nodes[node].next].prev = nodes[node].prev;
+            } else {
+                tail = nodes[node].prev;
+            }
+        } else if (used < capacity) {
+            node = used++;
+            nodes[node].key = key;
+            nodes[node].chain = *link;
+            *link = node;
+        } else {
+            /* Reuse the least recently used node */
+            node = tail;
+            tail = nodes[node].prev;
+            nodes[tail].next = SIZE_MAX;
+
+            size_t *old = &buckets[nodes[node].key & (bucket_count - 1)];
+            while (*old != node) {
+                old = &nodes[*old].chain;
+            }
+            *old = nodes[node].chain;
+
+            nodes[node].key = key;
+            nodes[node].chain = *link;
+            *link = node;
+        }
+
+        /* Move to the front */
+        nodes[node].prev = SIZE_MAX;
+        nodes[node].next = head;
+        if (head != SIZE_MAX) {
+            nodes[head].prev = node;
+        }
+        head = node;
+        if (tail == SIZE_MAX) {
+            tail = node;
+        }
+    }
+
+    free(nodes);
+    free(buckets);
+
+    printf("  %-10s %10zu %9.2f%%\n", "lru", capacity,
+           100.0 * (double)hits / (double)trace->count);
+    return hits;
+}
+
+int main(int argc, char *argv[]) {
+    Trace trace = { 0 };
+
+    if (argc > 1 ? trace_load(&trace, argv[1]) != 0 : trace_synthetic(&trace) != 0) {
+        fprintf(stderr, "Failed to build trace\n");
+        trace_free(&trace);
+        return 1;
+    }
+
+    printf("Text cache eviction, %zu requests (%s)\n\n", trace.count,
+           argc > 1 ? argv[1] : "synthetic: Zipf 0.99 + one-off bulk job");
+    printf("  %-10s %10s %10s %10s %10s %12s\n",
+           "policy", "budget", "hit ratio", "entries", "evicted", "requests/s");
+
+    size_t distinct = 0;
+    if (replay_cache(&trace, 0, &distinct) < 0 || distinct == 0) {
+        trace_free(&trace);
+        return 1;
+    }
+
+    for (size_t b = 0; b < sizeof(BUDGETS) / sizeof(BUDGETS[0]); b++) {
+        size_t budget = (size_t)((double)distinct * BUDGETS[b] / 100.0);
+        size_t entries;
+        if (budget == 0 || replay_cache(&trace, budget, &entries) < 0 ||
+            replay_lru(&trace, budget) < 0) {
+            continue;
+        }
+    }
+
+    trace_free(&trace);
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * Text cache backend lookup microbenchmark for transbasket.
+ * Fills the JSONL backend with N entries, reports resident memory per entry
+ * and compares lookups through the hash index with the previous linear scan
+ * over the entries array.
+ *
+ * Usage: bench_cache_index [entries ...]   (default: 10000 1000000 10000000)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "trans_cache.h"
+#include "cache_backend_text.h"
+#include "utils.h"
+
+#define INDEX_LOOKUPS 200000
+#define SCAN_BUDGET 200000000ULL    /* Entry comparisons spent on the linear scan */
+
+/* Monotonic clock in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Resident set size in bytes (0 if unavailable) */
+static size_t resident_bytes(void) {
+    unsigned long size = 0, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp) {
+        return 0;
+    }
+    if (fscanf(fp, "%lu %lu", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(fp);
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/* Previous lookup: hash, then compare against every entry */
+static CacheEntry *linear_lookup(TextBackend *backend, const char *from_lang,
+                                 const char *to_lang, const char *text) {
+    unsigned char digest[TRANS_CACHE_DIGEST_SIZE];
+    trans_cache_calculate_digest(from_lang, to_lang, text, digest);
+
+    for (size_t s = 0; s < backend->slice_count; s++) {
+        TextBackendContext *ctx = &backend->slices[s];
+        for (size_t i = 0; i < ctx->size; i++) {
+            if (memcmp(ctx->entries[i]->key, digest, sizeof(digest)) == 0) {
+                return ctx->entries[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Benchmark one cache size; returns 0 on success */
+static int run(size_t entries) {
+    char path[64];
+    snprintf(path, sizeof(path), "/nonexistent/bench_cache_%zu.jsonl", entries);
+
+    TransCache *cache = trans_cache_init(path);
+    if (!cache) {
+        fprintf(stderr, "Failed to create cache\n");
+        return -1;
+    }
+    TextBackend *backend = (TextBackend *)cache->backend_ctx;
+
+    char text[64];
+    size_t rss_before = resident_bytes();
+    double start = now_seconds();
+    for (size_t i = 0; i < entries; i++) {
+        snprintf(text, sizeof(text), "source text %zu", i);
+        if (trans_cache_add(cache, "eng", "kor", text, "translated") != 0) {
+            fprintf(stderr, "Failed to add entry %zu\n", i);
+            trans_cache_free(cache);
+            return -1;
+        }
+    }
+    double fill_seconds = now_seconds() - start;
+    double entry_bytes = (double)(resident_bytes() - rss_before) / entries;
+
+    /* Index lookups: half hits, half misses */
+    unsigned int seed = 7;
+    size_t hits = 0;
+    start = now_seconds();
+    trans_cache_read_begin(cache);
+    for (size_t i = 0; i < INDEX_LOOKUPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        size_t key = ((size_t)seed << 16 ^ seed) % entries;
+        if (i & 1) {
+            snprintf(text, sizeof(text), "missing text %zu", key);
+        } else {
+            snprintf(text, sizeof(text), "source text %zu", key);
+        }
+        if (trans_cache_lookup(cache, "eng", "kor", text)) {
+            hits++;
+        }
+    }
+    trans_cache_read_end(cache);
+    double index_ns = (now_seconds() - start) * 1e9 / INDEX_LOOKUPS;
+
+    if (hits != INDEX_LOOKUPS / 2) {
+        fprintf(stderr, "Index lookup mismatch: %zu hits, expected %d\n",
+                hits, INDEX_LOOKUPS / 2);
+        trans_cache_free(cache);
+        return -1;
+    }
+
+    /* Linear scan: misses walk the whole array; keep total work bounded */
+    size_t scans = SCAN_BUDGET / entries;
+    if (scans < 3) {
+        scans = 3;
+    }
+    start = now_seconds();
+    for (size_t i = 0; i < scans; i++) {
+        snprintf(text, sizeof(text), "missing text %zu", i);
+        if (linear_lookup(backend, "eng", "kor", text)) {
+            fprintf(stderr, "Linear scan found a missing key\n");
+            trans_cache_free(cache);
+            return -1;
+        }
+    }
+    double scan_ns = (now_seconds() - start) * 1e9 / scans;
+
+    printf("%-10zu %10.2f %14.0f %14.0f %16.0f %10.0fx\n", entries, fill_seconds,
+           entry_bytes, index_ns, scan_ns, scan_ns / index_ns);
+
+    trans_cache_free(cache);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static const size_t default_sizes[] = { 10000, 1000000, 10000000 };
+
+    printf("%-10s %10s %14s %14s %16s %11s\n",
+           "entries", "fill (s)", "mem/entry (B)", "index (ns)", "scan miss (ns)", "speedup");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            size_t entries = (size_t)strtoull(argv[i], NULL, 10);
+            if (entries == 0 || run(entries) != 0) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof(default_sizes) / sizeof(default_sizes[0]); i++) {
+        if (run(default_sizes[i]) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
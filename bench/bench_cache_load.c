@@ -0,0 +1,120 @@
+/**
+ * Text cache load benchmark for transbasket.
+ * Writes a JSONL cache file and measures how long the text backend takes
+ * to load it (parse, store and index) with 1, 2, 4, ... threads up to the
+ * given maximum, as speedup over one thread.
+ *
+ * Usage: bench_cache_load [entries] [max-threads] [directory]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "trans_cache.h"
+#include "cache_backend_text.h"
+
+#define DEFAULT_ENTRIES 1000000
+#define DEFAULT_DIRECTORY "/tmp"
+#define RUNS 3                      /* Best of */
+
+/* Monotonic clock in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Write entries records in the base file format */
+static int write_cache_file(const char *path, size_t entries) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        return -1;
+    }
+
+    char source[128];
+    char hash[65];
+    unsigned int seed = 1;
+    for (size_t i = 0; i < entries; i++) {
+        snprintf(source, sizeof(source), "Benchmark sentence number %zu, loaded at startup", i);
+        trans_cache_calculate_hash("eng", "kor", source, hash);
+        fprintf(fp, "{\"id\":%zu,\"hash\":\"%s\",\"from\":\"eng\",\"to\":\"kor\","
+                    "\"source\":\"%s\",\"target\":\"벤치마크 문장 %zu 번, \\\"시작\\\" 시 읽음\","
+                    "\"count\":%d,\"last_used\":%zu,\"created_at\":%zu}\n",
+                i + 1, hash, source, i, rand_r(&seed) % 50 + 1,
+                (size_t)1760000000 + i, (size_t)1750000000 + i);
+    }
+
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* Best load time in seconds with threads threads; -1 on error */
+static double time_load(const char *path, size_t threads, size_t entries) {
+    TextBackendOptions options = { .load_threads = threads };
+    double best = -1;
+
+    for (int run = 0; run < RUNS; run++) {
+        double start = now_seconds();
+        TransCache *cache = trans_cache_init_with_backend(CACHE_BACKEND_TEXT, path, &options);
+        double seconds = now_seconds() - start;
+        if (!cache) {
+            return -1;
+        }
+
+        size_t total = 0;
+        trans_cache_stats(cache, &total, NULL, NULL, 1, 60);
+        trans_cache_free(cache);
+        if (total != entries) {
+            fprintf(stderr, "Error: Loaded %zu of %zu entries\n", total, entries);
+            return -1;
+        }
+
+        if (best < 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+
+    return best;
+}
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : DEFAULT_ENTRIES;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 2 ? (size_t)strtoul(argv[2], NULL, 10) :
+                         (cpus > 0 ? (size_t)cpus : 1);
+    const char *directory = argc > 3 ? argv[3] : DEFAULT_DIRECTORY;
+
+    if (entries == 0 || max_threads == 0) {
+        fprintf(stderr, "Usage: %s [entries] [max-threads] [directory]\n", argv[0]);
+        return 1;
+    }
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/bench_cache_load.txt", directory);
+
+    printf("Writing cache file of %zu entries to %s...\n", entries, path);
+    if (write_cache_file(path, entries) != 0) {
+        fprintf(stderr, "Error: Failed to write %s\n", path);
+        remove(path);
+        return 1;
+    }
+
+    int result = 0;
+    double single = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double seconds = time_load(path, threads, entries);
+        if (seconds < 0) {
+            result = 1;
+            break;
+        }
+        if (threads == 1) {
+            single = seconds;
+        }
+        printf("threads %-3zu load %8.1f ms   speedup %5.2fx   (%ld CPUs)\n",
+               threads, seconds * 1e3, single / seconds, cpus);
+    }
+
+    remove(path);
+    return result;
+}
@@ -0,0 +1,134 @@
+/**
+ * Text cache snapshot benchmark for transbasket.
+ * Fills a text cache, saves it and compiles its snapshot, then compares
+ * starting from the JSONL file with mapping the snapshot: time until the
+ * cache is ready, and lookups of every key right after start (a snapshot
+ * entry is made on first use) and once more afterwards.
+ *
+ * Usage: bench_cache_snapshot [entries] [directory]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trans_cache.h"
+#include "cache_backend_text.h"
+
+#define DEFAULT_ENTRIES 200000
+#define DEFAULT_DIRECTORY "/tmp"
+
+/* Monotonic clock in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Source text of entry i */
+static void entry_text(size_t i, char *buffer, size_t size) {
+    snprintf(buffer, size, "Benchmark sentence number %zu for the startup comparison", i);
+}
+
+/* Remove the cache file, its journal and its snapshot */
+static void remove_cache_files(const char *path) {
+    char buffer[1024];
+
+    remove(path);
+    snprintf(buffer, sizeof(buffer), "%s.journal", path);
+    remove(buffer);
+    snprintf(buffer, sizeof(buffer), "%s.snap", path);
+    remove(buffer);
+}
+
+/* Write a cache of entries entries as one base file and its snapshot */
+static int build_cache(const char *path, size_t entries) {
+    TextBackendOptions options = { .snapshot = true };
+    TransCache *cache = trans_cache_init_with_backend(CACHE_BACKEND_TEXT, path, &options);
+    if (!cache) {
+        return -1;
+    }
+
+    char text[128];
+    char translation[160];
+    for (size_t i = 0; i < entries; i++) {
+        entry_text(i, text, sizeof(text));
+        snprintf(translation, sizeof(translation), "벤치마크 문장 %zu 번, 시작 시간 비교용", i);
+        trans_cache_add(cache, "eng", "kor", text, translation);
+    }
+
+    /* Rewrite the base file (and compile the snapshot with it) */
+    atomic_store(&((TextBackend *)cache->backend_ctx)->rewrite_pending, true);
+    int result = trans_cache_save(cache);
+    trans_cache_free(cache);
+    return result;
+}
+
+/* Nanoseconds per lookup over all keys */
+static double lookup_all(TransCache *cache, size_t entries, size_t *found) {
+    char text[128];
+
+    *found = 0;
+    double start = now_seconds();
+    for (size_t i = 0; i < entries; i++) {
+        entry_text(i, text, sizeof(text));
+        trans_cache_read_begin(cache);
+        if (trans_cache_lookup(cache, "eng", "kor", text)) {
+            (*found)++;
+        }
+        trans_cache_read_end(cache);
+    }
+    return (now_seconds() - start) * 1e9 / entries;
+}
+
+/* Start the cache one way and report; returns 0 on success */
+static int run(const char *label, const char *path, size_t entries, bool snapshot) {
+    TextBackendOptions options = { .snapshot = snapshot };
+
+    double start = now_seconds();
+    TransCache *cache = trans_cache_init_with_backend(CACHE_BACKEND_TEXT, path, &options);
+    double init_ms = (now_seconds() - start) * 1e3;
+    if (!cache) {
+        fprintf(stderr, "Error: Failed to open %s\n", path);
+        return -1;
+    }
+
+    size_t first_found, again_found;
+    double first_ns = lookup_all(cache, entries, &first_found);
+    double again_ns = lookup_all(cache, entries, &again_found);
+
+    printf("%-10s start %9.1f ms   first lookups %7.0f ns   again %7.0f ns   (found %zu/%zu)\n",
+           label, init_ms, first_ns, again_ns, again_found, entries);
+
+    trans_cache_free(cache);
+    return (first_found == entries && again_found == entries) ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : DEFAULT_ENTRIES;
+    const char *directory = argc > 2 ? argv[2] : DEFAULT_DIRECTORY;
+
+    if (entries == 0) {
+        fprintf(stderr, "Usage: %s [entries] [directory]\n", argv[0]);
+        return 1;
+    }
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/bench_cache_snapshot.txt", directory);
+
+    remove_cache_files(path);
+    printf("Building cache of %zu entries in %s...\n", entries, path);
+    if (build_cache(path, entries) != 0) {
+        fprintf(stderr, "Error: Failed to build cache\n");
+        remove_cache_files(path);
+        return 1;
+    }
+
+    int result = run("jsonl", path, entries, false);
+    if (result == 0) {
+        result = run("snapshot", path, entries, true);
+    }
+
+    remove_cache_files(path);
+    return result == 0 ? 0 : 1;
+}
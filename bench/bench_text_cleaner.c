@@ -0,0 +1,172 @@
+/**
+ * Text cleaner microbenchmark for transbasket.
+ * Measures post-processing throughput of model output in bytes/sec:
+ * the two-pass unescape_string + strip_emoji_and_shortcodes path, the
+ * single-pass clean_text, and TextCleaner fed in small streamed deltas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utils.h"
+
+#define DEFAULT_MIN_SECONDS 0.5
+#define STREAM_DELTA_SIZE 16    /* Typical size of one streamed content delta */
+
+/* Building blocks of synthetic model output */
+static const char *const fragments[] = {
+    "The quick brown fox jumps over the lazy dog. ",
+    "\\\"Quoted\\\" text with\\ttabs and\\nnewlines. ",
+    "번역된 문장은 여기에 있습니다. ",
+    "日本語のテキストも含まれます。 ",
+    "Emoji \xF0\x9F\x98\x80 and \xE2\x9C\x85 marks ",
+    ":smile: shortcodes :+1: and times like 10:30 ",
+    "  extra   spaces\\r\\n",
+    "path\\\\to\\\\file, it\\'s fine. ",
+};
+
+/* Monotonic clock in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Build size bytes of deterministic pseudo model output */
+static char *make_input(size_t size) {
+    char *text = malloc(size + 1);
+    if (!text) {
+        return NULL;
+    }
+
+    size_t count = sizeof(fragments) / sizeof(fragments[0]);
+    size_t len = 0;
+    unsigned int seed = 42;
+
+    while (len < size) {
+        seed = seed * 1103515245 + 12345;
+        const char *fragment = fragments[(seed >> 16) % count];
+        size_t fragment_len = strlen(fragment);
+        if (len + fragment_len > size) {
+            break;
+        }
+        memcpy(text + len, fragment, fragment_len);
+        len += fragment_len;
+    }
+
+    /* Pad with ASCII so no UTF-8 sequence is cut */
+    memset(text + len, 'x', size - len);
+    text[size] = '\0';
+    return text;
+}
+
+/* Previous post-processing: two passes into buffers, then a copy */
+static char *two_pass(const char *input, size_t len) {
+    char *unescaped = malloc(len + 1);
+    char *cleaned = malloc(len + 1);
+    char *result = NULL;
+
+    if (unescaped && cleaned &&
+        unescape_string(input, unescaped, len + 1) == 0 &&
+        strip_emoji_and_shortcodes(unescaped, cleaned, len + 1) == 0) {
+        result = strdup(cleaned);
+    }
+
+    free(unescaped);
+    free(cleaned);
+    return result;
+}
+
+/* Single pass over the whole text */
+static char *single_pass(const char *input, size_t len) {
+    return clean_text(input, len, NULL);
+}
+
+/* Incremental cleaning of STREAM_DELTA_SIZE-byte deltas into one buffer */
+static char *streamed(const char *input, size_t len) {
+    char *output = malloc(len + TEXT_CLEANER_SLACK);
+    if (!output) {
+        return NULL;
+    }
+
+    TextCleaner cleaner;
+    text_cleaner_init(&cleaner);
+
+    size_t out = 0;
+    for (size_t pos = 0; pos < len; pos += STREAM_DELTA_SIZE) {
+        size_t chunk = len - pos < STREAM_DELTA_SIZE ? len - pos : STREAM_DELTA_SIZE;
+        out += text_cleaner_feed(&cleaner, input + pos, chunk, output + out);
+    }
+    text_cleaner_finish(&cleaner, output + out);
+
+    return output;
+}
+
+typedef char *(*CleanFunction)(const char *input, size_t len);
+
+/* Run fn repeatedly for at least min_seconds; returns bytes/sec */
+static double measure(CleanFunction fn, const char *input, size_t len, double min_seconds) {
+    unsigned long long iterations = 0;
+    double start = now_seconds();
+    double elapsed;
+
+    do {
+        for (int i = 0; i < 16; i++) {
+            free(fn(input, len));
+        }
+        iterations += 16;
+        elapsed = now_seconds() - start;
+    } while (elapsed < min_seconds);
+
+    return (double)len * iterations / elapsed;
+}
+
+int main(int argc, char **argv) {
+    double min_seconds = argc > 1 ? atof(argv[1]) : DEFAULT_MIN_SECONDS;
+    if (min_seconds <= 0) {
+        min_seconds = DEFAULT_MIN_SECONDS;
+    }
+
+    static const size_t sizes[] = { 256, 4096, 65536, 1048576 };
+    static const struct {
+        const char *name;
+        CleanFunction fn;
+    } modes[] = {
+        { "two-pass", two_pass },
+        { "single-pass", single_pass },
+        { "streamed", streamed },
+    };
+
+    printf("%-10s %-12s %16s %10s\n", "size", "mode", "bytes/sec", "MB/s");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        char *input = make_input(len);
+        if (!input) {
+            fprintf(stderr, "Memory allocation failed\n");
+            return 1;
+        }
+
+        /* All modes must agree before their speed means anything */
+        char *expected = two_pass(input, len);
+        for (size_t m = 1; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            char *got = modes[m].fn(input, len);
+            if (!expected || !got || strcmp(expected, got) != 0) {
+                fprintf(stderr, "Output mismatch: %s at %zu bytes\n", modes[m].name, len);
+                return 1;
+            }
+            free(got);
+        }
+        free(expected);
+
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            double rate = measure(modes[m].fn, input, len, min_seconds);
+            printf("%-10zu %-12s %16.0f %10.1f\n", len, modes[m].name, rate, rate / 1e6);
+        }
+
+        free(input);
+    }
+
+    return 0;
+}
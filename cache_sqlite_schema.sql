@@ -2,49 +2,41 @@
 -- This schema is designed to store translation cache entries with optimal indexing
 -- for fast lookup and efficient cleanup operations.
 
--- Main cache table
+-- Storage layout: only effective before the first table is created
+-- Incremental auto-vacuum lets cleanup return freed pages (PRAGMA incremental_vacuum)
+PRAGMA page_size = 4096;
+PRAGMA auto_vacuum = INCREMENTAL;
+
+-- Main cache table (schema version 2)
+-- The 32-byte SHA256 digest is the primary key of a WITHOUT ROWID table, so each
+-- row is stored in the key's B-tree: lookups, inserts and count updates touch a
+-- single B-tree. Version 1 (TEXT hash, rowid, five indexes) is migrated on open
+-- by the SQLite backend.
 CREATE TABLE IF NOT EXISTS trans_cache (
-    id INTEGER PRIMARY KEY AUTOINCREMENT,
-    hash TEXT NOT NULL UNIQUE,              -- SHA256 hash of from|to|source_text (64 chars)
+    hash BLOB NOT NULL PRIMARY KEY,         -- SHA256 digest of from|to|source_text (32 bytes)
+    id INTEGER NOT NULL,                    -- Entry id (assigned by the cache, export order)
     from_lang TEXT NOT NULL,                -- ISO 639-2 source language code (3 chars)
     to_lang TEXT NOT NULL,                  -- ISO 639-2 target language code (3 chars)
     source_text TEXT NOT NULL,              -- Original text to translate
     translated_text TEXT NOT NULL,          -- Translated result
-    count INTEGER DEFAULT 1,                -- Number of times this translation was requested
+    count INTEGER NOT NULL DEFAULT 1,       -- Number of times this translation was requested
     last_used INTEGER NOT NULL,             -- Last access timestamp (Unix epoch seconds)
     created_at INTEGER NOT NULL,            -- Creation timestamp (Unix epoch seconds)
 
     -- Constraints
-    CHECK(length(hash) = 64),               -- Ensure valid SHA256 hex string
+    CHECK(length(hash) = 32),               -- Ensure valid SHA256 digest
     CHECK(length(from_lang) = 3),           -- Ensure valid ISO 639-2 code
     CHECK(length(to_lang) = 3),             -- Ensure valid ISO 639-2 code
-    CHECK(count >= 1),                      -- Count must be at least 1
-    CHECK(last_used >= created_at)          -- Last used cannot be before creation
-);
-
--- Primary index on hash for O(1) lookup
--- This is the most critical index as all cache lookups use hash
-CREATE UNIQUE INDEX IF NOT EXISTS idx_hash ON trans_cache(hash);
-
--- Composite index for language pair queries
--- Useful for cache statistics and language-specific operations
-CREATE INDEX IF NOT EXISTS idx_lang_pair ON trans_cache(from_lang, to_lang);
-
--- Index on last_used for cleanup operations
--- Enables efficient deletion of old entries (e.g., older than N days)
-CREATE INDEX IF NOT EXISTS idx_last_used ON trans_cache(last_used);
-
--- Index on count for analytics and popular translation queries
--- Allows fast retrieval of most frequently used translations
-CREATE INDEX IF NOT EXISTS idx_count ON trans_cache(count DESC);
+    CHECK(count >= 1)                       -- Count must be at least 1
+) WITHOUT ROWID;
 
--- Composite index for language pair + hash lookup optimization
--- Optimizes queries that filter by language pair first
-CREATE INDEX IF NOT EXISTS idx_lang_hash ON trans_cache(from_lang, to_lang, hash);
+-- No secondary indexes: every hit flush changes count and last_used, so an
+-- index on either would be rewritten on the hot path. Cleanup (last_used) and
+-- statistics (count) run periodically and scan the table instead.
 
 -- Schema version metadata
 -- Used for database migration tracking
-PRAGMA user_version = 1;
+PRAGMA user_version = 2;
 
 -- Performance optimizations
 -- Enable Write-Ahead Logging for better concurrency
@@ -60,9 +52,9 @@ PRAGMA synchronous = NORMAL;
 PRAGMA foreign_keys = ON;
 
 -- Cache size: allocate more memory for better performance
--- -2000 means 2000 KB (2 MB) of cache
+-- -8192 means 8192 KB (8 MB) of cache per connection
 -- Negative values are in KB, positive values are in pages
-PRAGMA cache_size = -2000;
+PRAGMA cache_size = -8192;
 
 -- Temporary storage in memory for better performance
 PRAGMA temp_store = MEMORY;
@@ -79,6 +71,7 @@ ANALYZE;
 -- Optional: Full-Text Search index for source and translated text
 -- Uncomment if you need to search within translation text
 -- This significantly increases storage size but enables text search
+-- (external content tables need an integer key: id stands in for the rowid)
 /*
 CREATE VIRTUAL TABLE IF NOT EXISTS trans_cache_fts USING fts5(
     source_text,
@@ -0,0 +1,128 @@
+/**
+ * Redis backend for translation cache.
+ * One cache shared by several transbasket nodes, over a connection pool.
+ */
+
+#ifndef CACHE_BACKEND_REDIS_H
+#define CACHE_BACKEND_REDIS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "trans_cache.h"
+
+/**
+ * Redis backend options (options argument of trans_cache_init_with_backend,
+ * whose path is the server URL: redis://[[user]:password@]host[:port][/db]).
+ * NULL / 0 fields select the defaults.
+ */
+typedef struct {
+    int pool_size;                  /* Pooled connections for commands (default: 8, at least 2) */
+    int timeout_ms;                 /* Connect and command timeout (default: 2000) */
+    const char *key_prefix;         /* Prefix of every key (default: "transbasket:") */
+    long long ttl_seconds;          /* Entries expire this long after their last hit
+                                     * (default: 0, never) */
+} RedisBackendOptions;
+
+/* Socket with its read and write buffers (cache_backend_redis.c) */
+typedef struct RedisConnection RedisConnection;
+
+/**
+ * Hits recorded by update_count and not yet written to the server.
+ * A slot stays occupied until the next flush even if its hits are reset.
+ */
+typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    uint32_t hits;                  /* Hits to add to count */
+    uint32_t last_used;             /* Latest hit timestamp */
+    bool used;                      /* Slot occupied */
+} RedisPendingHit;
+
+/**
+ * Redis backend context structure.
+ * Each entry is a hash under <key_prefix><hex hash>. Commands run on a
+ * pool of connections; a write-behind batch keeps one of them for its
+ * MULTI until end_batch. With a hot tier, one more connection receives
+ * the server's invalidation pushes (RESP3 client tracking).
+ */
+typedef struct {
+    char *host;
+    int port;
+    char *user;                     /* NULL: default user */
+    char *password;                 /* NULL: no AUTH */
+    int db;
+    char *key_prefix;
+    size_t prefix_len;
+    int timeout_ms;
+    long long ttl_seconds;          /* 0: entries never expire */
+
+    /* Connection pool (idle list under pool_lock) */
+    RedisConnection *connections;
+    size_t connection_count;
+    RedisConnection *idle_connections;
+    pthread_mutex_t pool_lock;
+    pthread_cond_t pool_cond;       /* Signaled when a connection is returned */
+
+    /* Entry ids, reserved in blocks from <key_prefix>next_id (under id_lock) */
+    pthread_mutex_t id_lock;
+    long long next_id;
+    long long id_limit;             /* Last id of the reserved block */
+
+    /* Deferred hits (open addressing by key), written in one MULTI/EXEC.
+     * Under pending_lock, which a flush holds until the server replied. */
+    RedisPendingHit *pending;
+    size_t pending_count;           /* Occupied slots */
+    pthread_mutex_t pending_lock;
+    atomic_uint pending_flushes;    /* Bumped before each flush is sent */
+
+    /* Open write-behind batch (under the shard write lock) */
+    RedisConnection *batch;
+
+    /* Client tracking for the hot tier (tracking_stop under tracking_lock) */
+    CacheHotTier *hot_tier;
+    RedisConnection *tracking;      /* Read by the tracking thread only */
+    pthread_t tracking_thread;
+    bool tracking_running;
+    bool tracking_stop;             /* Asks the thread to exit */
+    pthread_mutex_t tracking_lock;
+    pthread_cond_t tracking_cond;   /* Wakes the thread between reconnects */
+    atomic_bool tracking_connected;
+
+    /* Counters (read by metrics) */
+    atomic_ullong commands;
+    atomic_ullong pipelines;        /* Round trips carrying more than one command */
+    atomic_ullong errors;           /* Error replies and failed round trips */
+    atomic_ullong reconnects;
+    atomic_ullong invalidations;    /* Keys invalidated by tracking pushes */
+    atomic_ullong tracking_resets;  /* Hot tier cleared (flush or lost tracking) */
+} RedisBackendContext;
+
+/**
+ * Initialize Redis backend.
+ * Connects the pool; entries are created on the server as they are added.
+ *
+ * @param url Server URL: redis://[[user]:password@]host[:port][/db] or host[:port]
+ * @param options Connection settings (NULL for defaults)
+ * @return TransCache instance or NULL on error
+ */
+TransCache *redis_backend_init(const char *url, const RedisBackendOptions *options);
+
+/**
+ * Call callback for every entry on the server under the key prefix (SCAN).
+ * The entry is only valid during the call.
+ *
+ * @return Number of entries visited, or -1 on error or if callback failed
+ */
+long redis_backend_foreach(TransCache *cache,
+                           int (*callback)(CacheEntry *entry, void *user_data),
+                           void *user_data);
+
+/**
+ * Get Redis backend operations table.
+ *
+ * @return Pointer to static CacheBackendOps structure
+ */
+CacheBackendOps *redis_backend_get_ops(void);
+
+#endif /* CACHE_BACKEND_REDIS_H */
@@ -6,24 +6,105 @@
 #ifndef CACHE_BACKEND_SQLITE_H
 #define CACHE_BACKEND_SQLITE_H
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include <sqlite3.h>
 #include "trans_cache.h"
 
+/**
+ * SQLite backend options (options argument of trans_cache_init_with_backend).
+ * NULL / 0 fields select the defaults.
+ */
+typedef struct {
+    const char *journal_mode;       /* Journal mode (default: WAL) */
+    const char *sync_mode;          /* Synchronous mode (default: NORMAL) */
+    int read_connections;           /* Read-only connections for lookups (default: 8) */
+    bool full_mutex;                /* Open with SQLITE_OPEN_FULLMUTEX instead of NOMUTEX */
+    int page_size;                  /* Page size of new databases in bytes (default: 4096) */
+    int cache_size_kb;              /* Page cache per connection in KiB (default: 8192) */
+    long long mmap_size;            /* Memory-mapped I/O per connection in bytes
+                                     * (default: 256 MiB; -1 disables it) */
+    const char *temp_store;         /* DEFAULT, FILE or MEMORY (default: MEMORY) */
+    int busy_timeout_ms;            /* Wait for other connections' locks (default: 5000; -1: no wait) */
+    const char *checkpoint_mode;    /* Checkpoint on save: PASSIVE, FULL, RESTART or
+                                     * TRUNCATE (default: PASSIVE; idle saves TRUNCATE) */
+} SqliteBackendOptions;
+
+/**
+ * Read-only connection with its own lookup statement. A lookup checks one
+ * out of the pool, so no two threads ever use a reader at the same time.
+ */
+typedef struct SqliteReader {
+    sqlite3 *db;
+    sqlite3_stmt *stmt_lookup;      /* SELECT by key */
+    struct SqliteReader *next;      /* Next idle reader */
+} SqliteReader;
+
+/**
+ * Hits recorded by update_count and not yet written to the database.
+ * A slot stays occupied until the next flush even if its hits are reset.
+ */
+typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    uint32_t hits;                  /* Hits to add to count */
+    uint32_t last_used;             /* Latest hit timestamp */
+    bool used;                      /* Slot occupied */
+} SqlitePendingHit;
+
 /**
  * SQLite backend context structure.
- * Stores database handle and prepared statements for efficient operations.
+ * One writer connection, used under the shard write lock and writer_lock,
+ * and a pool of read-only connections that lookups use in parallel (WAL
+ * mode). Hits go to the pending table without the shard lock; only when
+ * that table is full does update_count write, under writer_lock alone.
  */
 typedef struct {
-    sqlite3 *db;                    /* SQLite database handle */
+    sqlite3 *db;                    /* Writer connection */
+    pthread_mutex_t writer_lock;    /* Recursive; held across a write-behind batch */
     char *db_path;                  /* Database file path */
 
-    /* Prepared statements for common operations */
-    sqlite3_stmt *stmt_lookup;      /* SELECT by hash */
+    /* Prepared statements of the writer connection */
     sqlite3_stmt *stmt_insert;      /* INSERT new entry */
-    sqlite3_stmt *stmt_update_count;/* UPDATE count and last_used */
+    sqlite3_stmt *stmt_update_count;/* Add hits to count, advance last_used */
     sqlite3_stmt *stmt_update_trans;/* UPDATE translation */
     sqlite3_stmt *stmt_delete_old;  /* DELETE old entries */
     sqlite3_stmt *stmt_count_all;   /* COUNT(*) */
+    int next_id;                    /* Id of the next inserted entry */
+
+    /* Reader pool (idle list under readers_lock) */
+    SqliteReader *readers;
+    size_t reader_count;
+    SqliteReader *idle_readers;
+    pthread_mutex_t readers_lock;
+    pthread_cond_t readers_cond;    /* Signaled when a reader is returned */
+
+    /* Deferred hits (open addressing by key), written in one transaction.
+     * Under pending_lock, which a flush holds until it has committed. */
+    SqlitePendingHit *pending;
+    size_t pending_count;           /* Occupied slots */
+    pthread_mutex_t pending_lock;
+    atomic_uint pending_flushes;    /* Bumped before each flush commits */
+
+    /* WAL checkpoints, run by save on their own connection so that writes
+     * keep going (under checkpoint_lock) */
+    sqlite3 *checkpoint_db;         /* NULL unless the journal is in WAL mode */
+    char *wal_path;                 /* <db_path>-wal */
+    int checkpoint_mode;            /* SQLITE_CHECKPOINT_* used while writes come in */
+    pthread_mutex_t checkpoint_lock;
+    unsigned long long writes_at_checkpoint; /* writes seen by the last checkpoint */
+    bool incremental_vacuum;        /* auto_vacuum=INCREMENTAL: cleanup frees pages */
+
+    /* Maintenance counters (read by metrics) */
+    atomic_ullong writes;           /* Statements that changed rows */
+    atomic_ullong checkpoints;
+    atomic_ullong checkpoints_truncate; /* Idle checkpoints that truncated the WAL */
+    atomic_ullong checkpoints_busy; /* Checkpoints that could not copy the whole WAL */
+    atomic_ullong checkpoint_us_total;
+    atomic_ullong checkpoint_us_max;
+    atomic_ullong checkpoint_us_last;
+    atomic_ullong vacuumed_pages;   /* Pages returned by incremental vacuum */
 } SqliteBackendContext;
 
 /**
@@ -31,9 +112,10 @@ typedef struct {
  * Creates database and tables if they don't exist.
  *
  * @param db_path Path to SQLite database file
+ * @param options Connection settings (NULL for defaults)
  * @return TransCache instance or NULL on error
  */
-TransCache *sqlite_backend_init(const char *db_path);
+TransCache *sqlite_backend_init(const char *db_path, const SqliteBackendOptions *options);
 
 /**
  * Get SQLite backend operations table.
@@ -1,25 +1,182 @@
 #ifndef CACHE_BACKEND_TEXT_H
 #define CACHE_BACKEND_TEXT_H
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include "trans_cache.h"
+#include "cache_snapshot.h"
 
-/* Text backend specific context */
+/* Hash index slot (entry == NULL marks an empty slot). The tag is written
+ * before the entry is published and never changes afterwards. */
 typedef struct {
-    CacheEntry **entries;   /* Dynamic array of cache entries */
+    uint64_t tag;           /* First 8 bytes of the SHA256 digest */
+    _Atomic(CacheEntry *) entry;
+} TextIndexSlot;
+
+/* Open-addressing (linear probing) table over entries by digest. Lookups
+ * read it without locks; a table is only ever filled, never cleared, and is
+ * replaced as a whole (and retired) when it grows or loses entries. */
+typedef struct {
+    size_t capacity;        /* Slot count, power of two */
+    TextIndexSlot slots[];
+} TextIndex;
+
+/* Arena block holding entry strings as [uint32 length][bytes][NUL] records */
+typedef struct TextArenaBlock {
+    struct TextArenaBlock *next;
+    size_t used;
+    size_t size;
+    char data[];
+} TextArenaBlock;
+
+typedef struct TextBackend TextBackend;
+
+/* Text backend options. Size bound (0 fields: unbounded): once it is
+ * reached, entries are evicted by W-TinyLFU: new entries wait in a small
+ * window, then stay only if requested more often than a sampled victim.
+ * With snapshot set, a compiled snapshot of the base file
+ * (<file_path>.snap, cache_snapshot.h) is mapped instead of parsing the
+ * base file, and rewrites of the base file compile it again. Otherwise
+ * the base file is parsed by load_threads threads, each taking a range of
+ * whole lines. */
+typedef struct {
+    size_t max_entries;     /* Entries kept at most (in memory, not the snapshot) */
+    size_t max_bytes;       /* Entry, string and index memory kept at most */
+    bool snapshot;          /* Start from <file_path>.snap when it is current */
+    size_t load_threads;    /* Threads loading the base file (0: one per CPU) */
+} TextBackendOptions;
+
+/* Count-Min sketch of how often keys were requested: 4 rows of 4-bit
+ * counters, one 64-bit word per row, the 4 words of a key in one block.
+ * Updated lock-free; counters are halved every sample_limit increments so
+ * old popularity fades. */
+typedef struct {
+    atomic_ullong *table;   /* 4 words per block */
+    size_t block_mask;
+    atomic_size_t samples;  /* Increments since the last halving */
+    size_t sample_limit;
+} TextFrequencySketch;
+
+/* Admission window slot: a recently added entry, by key and id */
+typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    int id;
+} TextWindowSlot;
+
+/* Text backend slice: the entries of one cache shard. Entries and strings
+ * are immutable once indexed (apart from count / last_used / hit_pending);
+ * memory a lookup may still read is retired through epoch.h, not freed. */
+typedef struct {
+    CacheEntry **entries;   /* Live entries in insertion order (point into slabs) */
     size_t size;            /* Current number of entries */
     size_t capacity;        /* Allocated capacity */
-    char *file_path;        /* Path to JSONL cache file */
-    int next_id;            /* Next ID to assign */
+    TextBackend *backend;   /* Shared file and id state */
+
+    /* Index over entries by digest (read lock-free) */
+    _Atomic(TextIndex *) index;
+    size_t index_used;      /* Occupied slots (tombstones included) */
+    size_t index_tombstones; /* Slots of evicted entries */
+
+    /* Entry storage: fixed-size slabs instead of one allocation per entry */
+    CacheEntry **slabs;
+    size_t slab_count;
+    size_t slab_used;       /* Entries handed out from the last slab */
+    size_t dead_entries;    /* Removed entries still occupying slab slots */
+
+    /* String storage: newest block first */
+    TextArenaBlock *arena;
+    size_t arena_bytes;     /* Bytes of all records */
+    size_t arena_dead;      /* Bytes of records no longer referenced */
+
+    /* Entries changed since the last save */
+    CacheEntry **dirty;
+    size_t dirty_count;
+    size_t dirty_capacity;
+
+    /* Entries whose hit_pending flag was set since the last flush_hits
+     * (written by lock-free hits; 0 lets the flush skip the scan) */
+    atomic_size_t pending_hits;
+
+    /* Keys evicted since the last save (journaled as removals) */
+    unsigned char (*removed)[TRANS_CACHE_DIGEST_SIZE];
+    size_t removed_count;
+    size_t removed_capacity;
+
+    /* Size bound of this slice (0: unbounded) and its eviction state */
+    size_t max_entries;
+    size_t max_bytes;
+    TextFrequencySketch sketch;
+    TextWindowSlot *window;         /* Ring of the newest entries */
+    size_t window_size;             /* Entries the window holds */
+    size_t window_head;
+    size_t window_count;
+    int window_min_id;              /* Entries with a smaller id are outside the window */
+    uint64_t random_state;          /* Victim sampling */
+    unsigned long long admitted;    /* Window entries kept over a main entry */
+    unsigned long long rejected;    /* Window entries evicted instead */
+    unsigned long long evicted;     /* Entries evicted in total */
+
+    /* This shard's section of the compiled snapshot (none: count 0).
+     * Records are used in place through views made on first access;
+     * entries in memory shadow them, so a record whose key was added,
+     * replaced or removed since is dead. */
+    size_t snapshot_count;
+    CacheEntry *snapshot_views;     /* One per record, zeroed until made */
+    _Atomic uint8_t *snapshot_state;    /* Per record: unused, busy, view made or dead */
+    _Atomic uint32_t *snapshot_next;    /* Links of the hit list (record + 1) */
+    _Atomic uint32_t snapshot_hits; /* Records hit since flush_hits (head, record + 1) */
+    size_t snapshot_dead;           /* Dead records */
 } TextBackendContext;
 
+/* Text backend: one slice per shard, persisted together as a base JSONL
+ * file plus an append-only journal of changes */
+struct TextBackend {
+    TextBackendContext *slices;
+    size_t slice_count;
+    char *file_path;        /* Path to JSONL cache file */
+    char *journal_path;     /* <file_path>.journal */
+    atomic_int next_id;     /* Next ID to assign */
+    atomic_bool rewrite_pending;  /* Entries were removed: next save rewrites the base file */
+    CacheSnapshot *snapshot;      /* Mapped base snapshot (NULL: base file loaded) */
+    char *snapshot_path;          /* <file_path>.snap when enabled, else NULL */
+
+    /* Under save_lock */
+    pthread_mutex_t save_lock;
+    FILE *journal;          /* Opened for append on first write */
+    size_t base_bytes;      /* Size of the base file */
+    size_t journal_bytes;   /* Size of the journal */
+};
+
+/* Entry filter for text_backend_remove_entries */
+typedef bool (*TextEntryFilter)(const CacheEntry *entry, void *user_data);
+
 /* Initialize text (JSONL) backend
  * Parameters:
  *   - file_path: Path to JSONL cache file
+ *   - options: Size bound, snapshot and load threads (NULL: unbounded,
+ *              no snapshot, one load thread per CPU). Entries beyond the
+ *              bound after loading are evicted least recently used first.
  * Returns: Initialized cache backend or NULL on error
  */
-TransCache *text_backend_init(const char *file_path);
+TransCache *text_backend_init(const char *file_path, const TextBackendOptions *options);
+
+/* Compile the entries of cache into a snapshot at snapshot_path (NULL:
+ * <file_path>.snap) that text_backend_init can map instead of parsing the
+ * base file. The snapshot is used while the base file is unchanged, with
+ * the journal replayed on top; saves that rewrite the base file recompile
+ * it. Returns entries written or -1 on error. */
+long text_backend_compile_snapshot(TransCache *cache, const char *snapshot_path);
 
 /* Get text backend operations */
 CacheBackendOps *text_backend_get_ops(void);
 
+/* Remove all entries for which match returns true, one shard at a time under
+ * its write lock. Keeps the index in sync and compacts entry and string
+ * storage once more than half of it is dead. Returns number removed. */
+size_t text_backend_remove_entries(TransCache *cache, TextEntryFilter match,
+                                   void *user_data);
+
 #endif /* CACHE_BACKEND_TEXT_H */
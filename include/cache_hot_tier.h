@@ -0,0 +1,46 @@
+#ifndef CACHE_HOT_TIER_H
+#define CACHE_HOT_TIER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <cjson/cJSON.h>
+#include "trans_cache.h"
+
+/* In-process L1 tier in front of a backend whose lookup reads storage
+ * (lookup_copies). Holds copies of recently looked-up entries in a fixed
+ * byte budget, evicting with CLOCK. Hits are lock-free; the copies are
+ * what trans_cache_lookup hands out, so hits and threshold checks work on
+ * them as on backend entries. Writes always go to the backend; the tier
+ * drops its copy of a key once the backend has committed a change to it,
+ * and once a shared backend reports a change by another process
+ * (attach_hot_tier). */
+
+/* Put a hot tier of capacity_bytes in front of cache's backend. Returns 0
+ * on success (also if the backend looks up in memory and needs none), -1
+ * if a shared backend cannot report changes made elsewhere. */
+int trans_cache_enable_hot_tier(TransCache *cache, size_t capacity_bytes);
+
+/* Lock-free lookup (inside a read section). On a miss, *generation is set
+ * for the hot_tier_fill that follows the backend lookup. */
+CacheEntry *hot_tier_lookup(CacheHotTier *tier, const unsigned char *key,
+                            unsigned int *generation);
+
+/* Record the backend lookup of key that followed a miss and keep a copy of
+ * entry unless key changed since *generation was taken. Returns the entry
+ * to hand out: the tier's copy, or entry itself if none was kept. */
+CacheEntry *hot_tier_fill(CacheHotTier *tier, const unsigned char *key,
+                          CacheEntry *entry, unsigned int generation);
+
+/* Drop the copy of key (after the backend committed a change to it) */
+void hot_tier_invalidate(CacheHotTier *tier, const unsigned char *key);
+
+/* Drop all copies (after the backend removed entries) */
+void hot_tier_clear(CacheHotTier *tier);
+
+/* Free the tier (no readers left) */
+void hot_tier_free(CacheHotTier *tier);
+
+/* Tier metrics with L1 / L2 hit ratios as JSON object (caller owns) */
+cJSON *hot_tier_stats(CacheHotTier *tier);
+
+#endif /* CACHE_HOT_TIER_H */
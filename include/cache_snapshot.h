@@ -0,0 +1,115 @@
+#ifndef CACHE_SNAPSHOT_H
+#define CACHE_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "trans_cache.h"
+
+/* Compiled, read-only snapshot of the text cache (cache_tool compile). The
+ * file is mapped as is: opening it costs the same for any number of
+ * entries, and processes mapping the same file share its pages.
+ *
+ * Layout (native byte order, 8-byte aligned sections):
+ *   header | one section descriptor per shard |
+ *   per shard: string heap | records | hash table
+ * The heap holds each record's source and target text, NUL-terminated and
+ * back to back. The table is open-addressing (linear probing) over the
+ * digest: slot position from digest bytes 4..7, slot tag from bytes 0..3. */
+
+#define CACHE_SNAPSHOT_MAGIC "TBSNAP01"
+#define CACHE_SNAPSHOT_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;        /* 0x01020304 as written */
+    uint32_t shard_count;
+    int32_t next_id;            /* Next entry ID when compiled */
+    uint64_t file_size;
+    uint64_t entry_count;
+    uint64_t source_size;       /* Base JSONL file the snapshot was compiled from */
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t reserved;
+} CacheSnapshotHeader;
+
+typedef struct {
+    uint64_t heap_offset;
+    uint64_t heap_size;
+    uint64_t records_offset;
+    uint64_t record_count;
+    uint64_t table_offset;
+    uint64_t table_capacity;    /* Slots, power of two (0 without records) */
+} CacheSnapshotSection;
+
+typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    int32_t id;
+    int32_t count;
+    uint32_t last_used;
+    uint32_t created_at;
+    char from_lang[8];          /* NUL-padded language code */
+    char to_lang[8];
+    uint64_t text_offset;       /* Source text in the heap, target right after it */
+} CacheSnapshotRecord;
+
+typedef struct {
+    uint32_t tag;
+    uint32_t record;            /* Record index + 1 (0: empty slot) */
+} CacheSnapshotSlot;
+
+typedef struct CacheSnapshot CacheSnapshot;
+typedef struct CacheSnapshotWriter CacheSnapshotWriter;
+
+/* Map and validate the snapshot at path, compiled for shard_count shards.
+ * Returns NULL if it does not exist or is not usable (logged). */
+CacheSnapshot *cache_snapshot_open(const char *path, size_t shard_count);
+
+/* Unmap the snapshot (no readers left) */
+void cache_snapshot_close(CacheSnapshot *snapshot);
+
+/* Header of an open snapshot */
+const CacheSnapshotHeader *cache_snapshot_header(const CacheSnapshot *snapshot);
+
+/* Whether the snapshot was compiled from the file at source_path as it is
+ * now (same size and modification time) */
+bool cache_snapshot_matches(const CacheSnapshot *snapshot, const char *source_path);
+
+/* Number of records of a shard */
+size_t cache_snapshot_count(const CacheSnapshot *snapshot, size_t shard);
+
+/* Record index of key in its shard, or -1 if not there */
+long cache_snapshot_find(const CacheSnapshot *snapshot, size_t shard,
+                         const unsigned char *key);
+
+/* Record index of a shard (index < cache_snapshot_count) */
+const CacheSnapshotRecord *cache_snapshot_record(const CacheSnapshot *snapshot, size_t shard,
+                                                 size_t index);
+
+/* Source and target text of a record. Returns false if the record points
+ * outside its shard's heap. */
+bool cache_snapshot_texts(const CacheSnapshot *snapshot, size_t shard,
+                          const CacheSnapshotRecord *record,
+                          const char **source, const char **target);
+
+/* Start writing a snapshot for shard_count shards to a temporary file next
+ * to path. Returns NULL on error. */
+CacheSnapshotWriter *cache_snapshot_writer_open(const char *path, size_t shard_count);
+
+/* Add an entry to the current shard (shards are written in order) */
+int cache_snapshot_writer_add(CacheSnapshotWriter *writer, const CacheEntry *entry);
+
+/* Finish the current shard and move on to the next one */
+int cache_snapshot_writer_end_shard(CacheSnapshotWriter *writer);
+
+/* Write the header, sync and move the file into place. The snapshot
+ * records the current size and modification time of source_path (the base
+ * file it was compiled from). Frees writer; returns 0 on success. */
+int cache_snapshot_writer_finish(CacheSnapshotWriter *writer, const char *source_path,
+                                 int next_id);
+
+/* Drop an unfinished snapshot and free writer */
+void cache_snapshot_writer_abort(CacheSnapshotWriter *writer);
+
+#endif /* CACHE_SNAPSHOT_H */
@@ -0,0 +1,39 @@
+#ifndef CACHE_WRITE_BEHIND_H
+#define CACHE_WRITE_BEHIND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <cjson/cJSON.h>
+#include "config_loader.h"  /* For WriteBehindOverflow */
+#include "trans_cache.h"
+
+/* Write-behind settings (0 fields select the defaults) */
+typedef struct {
+    size_t capacity;                /* Max queued mutations (default: 10000) */
+    int interval_ms;                /* Apply queued mutations at least this often (default: 50) */
+    size_t batch_size;              /* ... or as soon as this many are queued (default: 1000) */
+    WriteBehindOverflow overflow;   /* What a mutation does when the queue is full */
+} WriteBehindOptions;
+
+/* Queue cache inserts and translation updates of cache instead of applying
+ * them on the calling thread. A background writer applies them shard by
+ * shard, each batch in one backend transaction. Returns 0 on success. */
+int trans_cache_enable_write_behind(TransCache *cache, const WriteBehindOptions *options);
+
+/* Queue "store translation for key": applied as an insert if the key is
+ * absent, a hit if the same translation is cached, a translation update
+ * otherwise. Returns 0 if queued or applied, -1 if dropped or failed. */
+int write_behind_enqueue(CacheWriteBehind *wb, const unsigned char *key,
+                         const char *from_lang, const char *to_lang,
+                         const char *source_text, const char *translated_text);
+
+/* Apply everything queued so far before returning */
+void write_behind_flush(CacheWriteBehind *wb);
+
+/* Stop the writer after applying what is queued, and free the queue */
+void write_behind_free(CacheWriteBehind *wb);
+
+/* Queue metrics as JSON object (caller owns) */
+cJSON *write_behind_stats(CacheWriteBehind *wb);
+
+#endif /* CACHE_WRITE_BEHIND_H */
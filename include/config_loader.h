@@ -9,9 +9,22 @@ typedef enum {
     CACHE_BACKEND_TEXT = 0,    /* JSONL file-based cache (default) */
     CACHE_BACKEND_SQLITE,      /* SQLite database cache */
     CACHE_BACKEND_MONGODB,     /* MongoDB cache (future) */
-    CACHE_BACKEND_REDIS        /* Redis cache (future) */
+    CACHE_BACKEND_REDIS        /* Redis cache shared by several nodes */
 } CacheBackendType;
 
+/* What a cache mutation does when the write-behind queue is full */
+typedef enum {
+    WRITE_BEHIND_OVERFLOW_SYNC = 0,  /* Apply it on the calling thread (default) */
+    WRITE_BEHIND_OVERFLOW_BLOCK,     /* Wait for room in the queue */
+    WRITE_BEHIND_OVERFLOW_DROP       /* Discard it */
+} WriteBehindOverflow;
+
+/* HTTP server threading mode */
+typedef enum {
+    SERVER_MODE_EPOLL = 0,     /* Internal epoll thread pool sized by max_workers (default) */
+    SERVER_MODE_THREAD         /* One OS thread per connection (legacy) */
+} ServerMode;
+
 /* Configuration structure */
 typedef struct {
     char *openai_base_url;
@@ -29,6 +42,25 @@ typedef struct {
     double frequency_penalty; /* Default: 0.0, range: -2.0 to 2.0 */
     double presence_penalty;  /* Default: 0.0, range: -2.0 to 2.0 */
     char *reasoning_effort;  /* Default: "none", options: "none", "low", "medium", "high" */
+    int upstream_concurrency; /* Max simultaneous upstream API calls (default: 1024) */
+    int upstream_threads;     /* curl_multi event loop threads for upstream I/O (default: 1) */
+
+    /* Batch endpoint settings */
+    int batch_max_items;        /* Max items per /translate/batch request (default: 500) */
+    int batch_max_concurrency;  /* Max concurrent upstream calls per batch (default: 16) */
+
+    /* Micro-batching of short texts into one upstream call */
+    bool micro_batch_enabled;   /* Enable micro-batching (default: false) */
+    int micro_batch_window_ms;  /* Collection window per language pair (default: 5) */
+    int micro_batch_max_items;  /* Max texts per upstream call (default: 16) */
+    int micro_batch_max_chars;  /* Only texts up to this many characters are batched (default: 200) */
+
+    /* HTTP server settings */
+    ServerMode server_mode;       /* Threading mode (default: SERVER_MODE_EPOLL) */
+    char *server_mode_str;        /* Server mode as string for logging */
+    unsigned int max_connections; /* Max concurrent connections (default: 1024) */
+    unsigned int per_ip_connection_limit; /* Max connections per client IP, 0 = unlimited (default: 0) */
+    unsigned int connection_timeout;      /* Idle connection timeout in seconds (default: 120) */
 
     /* Translation cache settings */
     CacheBackendType cache_type;  /* Cache backend type (default: CACHE_BACKEND_TEXT) */
@@ -41,11 +73,39 @@ typedef struct {
     char *cache_sqlite_path;        /* Path to SQLite database (default: ./trans_cache.db) */
     char *cache_sqlite_journal_mode; /* Journal mode: WAL, DELETE, etc. (default: WAL) */
     char *cache_sqlite_sync;        /* Synchronous mode: FULL, NORMAL, OFF (default: NORMAL) */
+    int cache_sqlite_readers;       /* Read-only connections for lookups (default: 8) */
+    bool cache_sqlite_full_mutex;   /* Open connections FULLMUTEX instead of NOMUTEX (default: false) */
+    int cache_sqlite_page_size;     /* Page size in bytes for new databases (default: 4096) */
+    int cache_sqlite_cache_size_kb; /* Page cache per connection in KiB (default: 8192) */
+    int cache_sqlite_mmap_size_mb;  /* Memory-mapped I/O per connection in MiB, 0 = off (default: 256) */
+    char *cache_sqlite_temp_store;  /* Temp store: DEFAULT, FILE, MEMORY (default: MEMORY) */
+    int cache_sqlite_busy_timeout_ms; /* Wait for locks of other connections (default: 5000) */
+    char *cache_sqlite_checkpoint;  /* Periodic WAL checkpoint: PASSIVE, FULL, RESTART, TRUNCATE (default: PASSIVE) */
+
+    /* Redis backend settings */
+    char *cache_redis_url;          /* Server URL (default: redis://127.0.0.1:6379/0) */
+    int cache_redis_pool;           /* Pooled connections (default: 8) */
+    int cache_redis_timeout_ms;     /* Connect and command timeout (default: 2000) */
+    char *cache_redis_prefix;       /* Prefix of every key, at most 64 bytes (default: transbasket:) */
 
     /* Common cache settings (applies to all backends) */
     int cache_threshold;     /* Minimum count to use cache (default: 5) */
     bool cache_cleanup_enabled;  /* Enable automatic cleanup (default: true) */
     int cache_cleanup_days;  /* Cleanup entries older than N days (default: 60) */
+    int cache_max_entries;   /* Text backend size bound in entries, 0 = none (default: 0) */
+    int cache_max_mb;        /* Text backend size bound in MiB, 0 = none (default: 0) */
+    bool cache_snapshot;     /* Text backend starts from <cache file>.snap (default: false) */
+    int cache_load_threads;  /* Threads loading the text cache file, 0 = one per CPU (default: 0) */
+
+    /* Write-behind queue for cache inserts and translation updates */
+    bool cache_write_behind;             /* Enable write-behind (default: true) */
+    int cache_write_behind_queue;        /* Max queued mutations (default: 10000) */
+    int cache_write_behind_interval_ms;  /* Max time before queued mutations are applied (default: 50) */
+    int cache_write_behind_batch;        /* Apply early once this many are queued (default: 1000) */
+    WriteBehindOverflow cache_write_behind_overflow; /* Full queue policy (default: sync) */
+
+    /* In-process hot tier in front of backends that read storage (sqlite, redis) */
+    int cache_l1_size_mb;                /* Byte budget in MiB, 0 = off (default: 64) */
 } Config;
 
 /* Load configuration from file */
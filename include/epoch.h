@@ -0,0 +1,35 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stddef.h>
+
+/* Epoch-based memory reclamation for lock-free readers.
+ * Readers bracket their accesses with epoch_enter / epoch_exit (sections
+ * nest). Writers unlink shared memory first and then hand it to
+ * epoch_retire, which frees it only once every thread that could still
+ * see it has left its section. One domain serves the whole process. */
+
+/* Destructor for retired memory */
+typedef void (*EpochFreeFn)(void *ptr);
+
+/* Enter / leave a read section on the calling thread */
+void epoch_enter(void);
+void epoch_exit(void);
+
+/* Free ptr with free_fn once no reader can hold it anymore. Takes no
+ * global lock: each thread frees its own retired memory in batches. */
+void epoch_retire(void *ptr, EpochFreeFn free_fn);
+
+/* Free whatever retired memory of any thread has become safe to free
+ * (call periodically, e.g. on cache save) */
+void epoch_reclaim(void);
+
+/* Wait until all retired memory is freed. Must not be called from inside a
+ * read section (it would wait for itself). */
+void epoch_barrier(void);
+
+/* Reclamation counters */
+void epoch_stats(unsigned long long *epoch, size_t *pending,
+                 unsigned long long *reclaimed);
+
+#endif /* EPOCH_H */
@@ -2,13 +2,30 @@
 #define HTTP_CLIENT_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <cjson/cJSON.h>
 #include "config_loader.h"
+#include "upstream_engine.h"
+#include "request_template.h"
 
 /* OpenAI translator structure */
 typedef struct {
     Config *config;
     int max_retries;
     int timeout;
+    char api_url[512];              /* chat/completions endpoint */
+    UpstreamEngine *engine;         /* curl_multi engine shared by all upstream calls */
+    RequestTemplates *templates;    /* Pre-serialized request bodies per language pair */
+
+    /* Streaming statistics (under stats_lock) */
+    pthread_mutex_t stats_lock;
+    unsigned long long streamed_responses;
+    unsigned long long stream_deltas;
+    unsigned long long streams_incomplete;  /* Ended without [DONE] */
+    unsigned long long ttft_samples;
+    unsigned long long ttft_ms_total;       /* Transfer start to first content delta */
+    unsigned long long ttft_ms_max;
 } OpenAITranslator;
 
 /* Translation error structure */
@@ -18,13 +35,41 @@ typedef struct {
     int status_code;
 } TranslationError;
 
+/* Completion callback for asynchronous translation.
+ * On success translated_text is non-NULL and owned by the callback (release it
+ * with free_translated_text). On failure translated_text is NULL and error is
+ * filled in; error->message is owned by the callback. */
+typedef void (*TranslationCallback)(char *translated_text, TranslationError *error,
+                                    void *user_data);
+
+/* Progress callback for streamed translation. fragment is cleaned text (emoji
+ * and shortcodes already stripped), not NUL-terminated and valid during the
+ * callback only. fragment == NULL means the upstream call is being retried
+ * and all fragments received so far must be discarded. */
+typedef void (*TranslationDeltaCallback)(const char *fragment, size_t len, void *user_data);
+
+/* Completion callback for multi-item translation.
+ * On success translated_texts is a caller-owned array of count entries (free
+ * each entry and the array); an entry is NULL when that item could not be
+ * split out of the model output. On upstream failure translated_texts is NULL
+ * and error is filled in as for TranslationCallback. */
+typedef void (*MultiTranslationCallback)(char **translated_texts, int count,
+                                         TranslationError *error, void *user_data);
+
 /* Initialize OpenAI translator */
 OpenAITranslator *openai_translator_init(Config *config, int max_retries, int timeout);
 
+/* Stop accepting requests, fail queued ones and wait for running ones to complete */
+void openai_translator_shutdown(OpenAITranslator *translator);
+
 /* Free OpenAI translator */
 void openai_translator_free(OpenAITranslator *translator);
 
-/* Translate text using OpenAI API */
+/* Upstream engine metrics as JSON object (caller owns) */
+cJSON *openai_translator_stats(OpenAITranslator *translator);
+
+/* Translate text using OpenAI API; blocks the calling thread until done.
+ * Must not be called from a completion callback. */
 char *openai_translate(
     OpenAITranslator *translator,
     const char *from_lang,
@@ -35,6 +80,52 @@ char *openai_translate(
     TranslationError *error
 );
 
+/* Start translation on the upstream engine; callback runs on an engine event-loop
+ * thread and should not block for long. Failed attempts are retried with
+ * exponential backoff before the callback reports an error.
+ * Returns 0 if started, -1 if the request was rejected (callback is not invoked). */
+int openai_translate_async(
+    OpenAITranslator *translator,
+    const char *from_lang,
+    const char *to_lang,
+    const char *text,
+    const char *request_uuid,
+    const char *timestamp,
+    TranslationCallback callback,
+    void *user_data
+);
+
+/* Same as openai_translate_async, but the upstream is always asked for a
+ * stream and delta_callback receives text fragments as they are generated
+ * (on the same thread as callback, always before it). The concatenated
+ * fragments equal the final text. */
+int openai_translate_stream_async(
+    OpenAITranslator *translator,
+    const char *from_lang,
+    const char *to_lang,
+    const char *text,
+    const char *request_uuid,
+    const char *timestamp,
+    TranslationDeltaCallback delta_callback,
+    TranslationCallback callback,
+    void *user_data
+);
+
+/* Translate several texts of the same language pair in one upstream call
+ * using numbered <source id="N"> / <target id="N"> delimiters. Same return
+ * and threading contract as openai_translate_async. */
+int openai_translate_multi_async(
+    OpenAITranslator *translator,
+    const char *from_lang,
+    const char *to_lang,
+    const char **texts,
+    int count,
+    const char *request_uuid,
+    const char *timestamp,
+    MultiTranslationCallback callback,
+    void *user_data
+);
+
 /* Free translated text */
 void free_translated_text(char *text);
 
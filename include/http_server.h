@@ -7,13 +7,17 @@
 #include "config_loader.h"
 #include "http_client.h"
 #include "trans_cache.h"
+#include "singleflight.h"
+#include "micro_batcher.h"
 
 /* Translation server structure */
 typedef struct {
     Config *config;
     OpenAITranslator *translator;
     struct MHD_Daemon *daemon;
-    int max_workers;
+    int max_workers;        /* HTTP worker threads (thread pool size in epoll mode) */
+    SingleFlight *flights;  /* In-flight upstream translations keyed by cache hash */
+    MicroBatcher *batcher;  /* Short-text micro-batcher (NULL when disabled) */
 
     /* Cache components */
     TransCache *cache;
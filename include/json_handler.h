@@ -15,6 +15,9 @@ typedef struct {
 /* Parse translation request from JSON string */
 TranslationRequest *parse_translation_request(const char *json_str);
 
+/* Parse translation request from an already parsed JSON object */
+TranslationRequest *parse_translation_request_object(const cJSON *root);
+
 /* Free translation request */
 void free_translation_request(TranslationRequest *req);
 
@@ -24,6 +27,10 @@ char *create_translation_response(const TranslationRequest *req, const char *tra
 /* Create error response JSON */
 char *create_error_response(const char *error_code, const char *error_message, const char *uuid);
 
+/* Object variants of the above, for embedding in larger responses (caller owns) */
+cJSON *create_translation_response_object(const TranslationRequest *req, const char *translated_text);
+cJSON *create_error_response_object(const char *error_code, const char *error_message, const char *uuid);
+
 /* Free JSON response string */
 void free_json_response(char *json_str);
 
@@ -0,0 +1,41 @@
+#ifndef MICRO_BATCHER_H
+#define MICRO_BATCHER_H
+
+#include <stdbool.h>
+#include <cjson/cJSON.h>
+#include "http_client.h"
+
+/* Micro-batcher (opaque) */
+typedef struct MicroBatcher MicroBatcher;
+
+/* Create micro-batcher. Short texts of the same (from, to) pair that arrive
+ * within window_ms are packed into one upstream call of up to max_items. */
+MicroBatcher *micro_batcher_create(OpenAITranslator *translator, int window_ms,
+                                   int max_items, int max_chars);
+
+/* True if text is short enough to be micro-batched */
+bool micro_batcher_accepts(MicroBatcher *batcher, const char *text);
+
+/* Queue text for the next batch of its language pair. Same return and
+ * callback contract as openai_translate_async. */
+int micro_batcher_submit(
+    MicroBatcher *batcher,
+    const char *from_lang,
+    const char *to_lang,
+    const char *text,
+    const char *request_uuid,
+    const char *timestamp,
+    TranslationCallback callback,
+    void *user_data
+);
+
+/* Flush pending batches and stop the window timer; later submits are rejected */
+void micro_batcher_shutdown(MicroBatcher *batcher);
+
+/* Free micro-batcher (shuts down first if still running) */
+void micro_batcher_free(MicroBatcher *batcher);
+
+/* Batching metrics as JSON object (caller owns) */
+cJSON *micro_batcher_stats(MicroBatcher *batcher);
+
+#endif /* MICRO_BATCHER_H */
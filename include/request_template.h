@@ -0,0 +1,43 @@
+#ifndef REQUEST_TEMPLATE_H
+#define REQUEST_TEMPLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <cjson/cJSON.h>
+#include "config_loader.h"
+
+/* Output format requested for numbered multi-item prompts */
+#define MULTI_ITEM_FORMAT_NOTE \
+    "The input contains several numbered <source id=\"N\"> blocks. " \
+    "Translate each block independently. Reply only with one " \
+    "<target id=\"N\">translation</target> block per source block, " \
+    "using the same numbers and order, and nothing else."
+
+/* Request kinds; each has its own prompt bytes */
+typedef enum {
+    REQUEST_TEMPLATE_SINGLE = 0,    /* One text, wrapped in <source></source> */
+    REQUEST_TEMPLATE_MULTI,         /* Pre-numbered <source id="N"> blocks */
+    REQUEST_TEMPLATE_KIND_COUNT
+} RequestTemplateKind;
+
+/* Pre-serialized chat completion request bodies (opaque) */
+typedef struct RequestTemplates RequestTemplates;
+
+/* Create template set for config. Pair-independent fragments are serialized
+ * here; each (from, to) prefix is serialized once on first use and reused
+ * byte for byte afterwards. */
+RequestTemplates *request_templates_create(const Config *config);
+
+/* Assemble request body: cached prefix + JSON-escaped source + suffix.
+ * Returns NULL on allocation failure (caller frees result). */
+char *request_templates_build(RequestTemplates *templates, RequestTemplateKind kind,
+                              const char *from_lang, const char *to_lang,
+                              const char *source, bool stream);
+
+/* Template metrics as JSON object (caller owns) */
+cJSON *request_templates_stats(RequestTemplates *templates);
+
+/* Free template set */
+void request_templates_free(RequestTemplates *templates);
+
+#endif /* REQUEST_TEMPLATE_H */
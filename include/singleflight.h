@@ -0,0 +1,40 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <cjson/cJSON.h>
+#include "http_client.h"  /* For TranslationCallback, TranslationError */
+
+/* In-flight request table (opaque) */
+typedef struct SingleFlight SingleFlight;
+
+/* Result of joining a flight */
+typedef enum {
+    SINGLEFLIGHT_LEADER = 0,    /* Caller must start the work and call singleflight_complete */
+    SINGLEFLIGHT_FOLLOWER,      /* Caller was attached to an existing flight */
+    SINGLEFLIGHT_ERROR          /* Allocation failure; callback will not be invoked */
+} SingleFlightRole;
+
+/* Create in-flight table */
+SingleFlight *singleflight_create(void);
+
+/* Free in-flight table (pending flights are dropped without callbacks) */
+void singleflight_free(SingleFlight *sf);
+
+/* Join the flight for key (cache hash). callback receives the shared result
+ * once the leader completes; each waiter gets its own copy of the text and
+ * error message. */
+SingleFlightRole singleflight_join(SingleFlight *sf, const char *key,
+                                   TranslationCallback callback, void *user_data);
+
+/* Complete the flight for key and fan the result out to every waiter.
+ * Takes ownership of translated_text and error->message. */
+void singleflight_complete(SingleFlight *sf, const char *key,
+                           char *translated_text, TranslationError *error);
+
+/* Coalescing metrics as JSON object (caller owns) */
+cJSON *singleflight_stats(SingleFlight *sf);
+
+#endif /* SINGLEFLIGHT_H */
@@ -0,0 +1,48 @@
+#ifndef SSE_PARSER_H
+#define SSE_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Incremental parser for OpenAI-style chat completion streams (opaque) */
+typedef struct SseParser SseParser;
+
+/* Per-delta progress callback. delta is the decoded content fragment (not
+ * NUL-terminated, valid during the callback only); index counts deltas from 1.
+ * Return 0 to continue, -1 to stop parsing (sse_parser_feed then fails). */
+typedef int (*SseDeltaCallback)(const char *delta, size_t len, size_t index, void *user_data);
+
+/* Create parser; callback may be NULL */
+SseParser *sse_parser_create(SseDeltaCallback callback, void *user_data);
+
+/* Forget all state so the parser can be reused for a new response */
+void sse_parser_reset(SseParser *parser);
+
+/* Consume bytes as they arrive from the network. Chunk boundaries may fall
+ * anywhere, including inside a line or a UTF-8 sequence.
+ * Returns 0 on success, -1 on allocation failure or callback abort. */
+int sse_parser_feed(SseParser *parser, const char *data, size_t len);
+
+/* End of stream: process a trailing line that had no line terminator */
+int sse_parser_finish(SseParser *parser);
+
+/* Accumulated delta content (NUL-terminated, owned by the parser) */
+const char *sse_parser_output(const SseParser *parser, size_t *len);
+
+/* Detach accumulated content (caller frees). Returns NULL if no content was
+ * received. The parser is left empty. */
+char *sse_parser_take_output(SseParser *parser);
+
+/* True once the "data: [DONE]" terminator has been seen */
+bool sse_parser_done(const SseParser *parser);
+
+/* Number of content deltas received so far */
+size_t sse_parser_delta_count(const SseParser *parser);
+
+/* Monotonic time (CLOCK_MONOTONIC, ms) of the first content delta, 0 if none yet */
+long long sse_parser_first_delta_at(const SseParser *parser);
+
+/* Free parser */
+void sse_parser_free(SseParser *parser);
+
+#endif /* SSE_PARSER_H */
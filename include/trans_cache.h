@@ -1,46 +1,80 @@
 #ifndef TRANS_CACHE_H
 #define TRANS_CACHE_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <pthread.h>
+#include <cjson/cJSON.h>
 #include "config_loader.h"  /* For CacheBackendType */
 
-/* Forward declaration */
+/* Forward declarations */
 typedef struct TransCache TransCache;
+typedef struct CacheWriteBehind CacheWriteBehind;   /* cache_write_behind.h */
+typedef struct CacheHotTier CacheHotTier;           /* cache_hot_tier.h */
 
-/* Cache entry structure */
+/* Size of binary SHA256 cache key */
+#define TRANS_CACHE_DIGEST_SIZE 32
+
+/* Shards for backends that can be partitioned by key (power of two, <= 256) */
+#define TRANS_CACHE_SHARDS 16
+
+/* Cache entry structure (72 bytes). Language codes are interned to 1-byte ids
+ * (trans_cache_lang_code); the hex hash is derived from key on demand.
+ * Once published, only count, last_used and hit_pending change; a new
+ * translation replaces the whole entry. count includes hits the backend
+ * has not folded into its storage yet, so it is the value to compare
+ * against the cache threshold. */
 typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];  /* SHA256 of "from|to|source" */
+    uint8_t from_id;        /* Interned ISO 639-2 source language code */
+    uint8_t to_id;          /* Interned ISO 639-2 target language code */
+    uint8_t journal_state;  /* Change not yet persisted (text backend journal) */
+    _Atomic uint8_t hit_pending;  /* Hit not yet folded by flush_hits (text backend) */
     int id;
-    char hash[65];          /* SHA256 hex string (64 chars + null) */
-    char from_lang[4];      /* ISO 639-2 language code */
-    char to_lang[4];        /* ISO 639-2 language code */
-    char *source_text;      /* Original text */
-    char *translated_text;  /* Translated text */
-    int count;              /* Number of times this translation was requested */
-    time_t last_used;       /* Last access timestamp (Unix time) */
-    time_t created_at;      /* Creation timestamp (Unix time) */
+    atomic_int count;       /* Number of times this translation was requested */
+    _Atomic uint32_t last_used;  /* Last access timestamp (Unix time) */
+    uint32_t created_at;    /* Creation timestamp (Unix time) */
+    uint32_t position;      /* Slot in the text backend's entries array */
+    char *source_text;      /* Original text (backend-owned storage) */
+    char *translated_text;  /* Translated text (backend-owned storage) */
 } CacheEntry;
 
-/* Cache backend operations interface */
+/* Cache backend operations interface. Except for save and free_backend,
+ * operations get the backend slice of one shard and run under its lock;
+ * lookup and update_count run without it when concurrent_lookup and
+ * concurrent_update_count are set. */
 typedef struct {
-    /* Lookup cache entry by language pair and text */
-    CacheEntry* (*lookup)(void *backend_ctx, const char *from_lang,
-                          const char *to_lang, const char *text);
+    /* Lookup cache entry by key (trans_cache_calculate_digest). The entry
+     * must stay readable until the caller's read section ends (epoch.h). */
+    CacheEntry* (*lookup)(void *backend_ctx, const unsigned char *key);
 
-    /* Add new cache entry */
-    int (*add)(void *backend_ctx, const char *from_lang, const char *to_lang,
+    /* Add new cache entry under key */
+    int (*add)(void *backend_ctx, const unsigned char *key,
+               const char *from_lang, const char *to_lang,
                const char *source_text, const char *translated_text);
 
-    /* Update cache entry count (increment) */
+    /* Record a hit on entry: increment count, refresh last_used. Backends
+     * may defer writing it to storage until flush_hits. */
     int (*update_count)(void *backend_ctx, CacheEntry *entry);
 
+    /* Fold hits deferred by update_count into storage in one batch
+     * (optional). Returns number of entries folded or -1 on error. */
+    int (*flush_hits)(void *backend_ctx);
+
     /* Update cache entry translation (reset count to 1) */
     int (*update_translation)(void *backend_ctx, CacheEntry *entry,
                               const char *new_translation);
 
-    /* Save cache (persist to storage) */
-    int (*save)(void *backend_ctx);
+    /* Group the writes that follow into one transaction until end_batch
+     * (optional). Returns 0 on success; end_batch -1 if the commit failed. */
+    int (*begin_batch)(void *backend_ctx);
+    int (*end_batch)(void *backend_ctx);
+
+    /* Save cache (persist to storage); takes the shard locks it needs */
+    int (*save)(TransCache *cache);
 
     /* Cleanup old cache entries (older than days_threshold) */
     int (*cleanup)(void *backend_ctx, int days_threshold);
@@ -50,16 +84,58 @@ typedef struct {
                   size_t *active_entries, size_t *expired_entries,
                   int cache_threshold, int days_threshold);
 
-    /* Free backend resources */
+    /* Backend-specific metrics as JSON object (optional, caller owns;
+     * whole backend, locks what it reads itself) */
+    cJSON *(*metrics)(TransCache *cache);
+
+    /* Keep the copies of a hot tier in line with changes made outside this
+     * process (optional; whole backend). Called before the tier serves
+     * lookups, and with NULL before it is freed. Returns 0 on success; the
+     * tier is not enabled otherwise. */
+    int (*attach_hot_tier)(void *backend_ctx, CacheHotTier *tier);
+
+    /* Free backend resources (whole backend, all slices) */
     void (*free_backend)(void *backend_ctx);
+
+    /* lookup is safe alongside writers of its shard (no shard lock taken) */
+    bool concurrent_lookup;
+
+    /* update_count is safe alongside writers of its shard (no shard lock
+     * taken; the caller is in the read section of its lookup) */
+    bool concurrent_update_count;
+
+    /* lookup reads storage and returns a fresh copy each time, so a hot
+     * tier (cache_hot_tier.h) can stand in for it */
+    bool lookup_copies;
 } CacheBackendOps;
 
+/* One partition of the cache: the keys mapping to it (trans_cache_shard_of),
+ * the backend slice holding them and the lock guarding that slice */
+typedef struct {
+    pthread_rwlock_t lock;
+    void *backend_ctx;              /* Backend slice */
+
+    /* Lock contention counters */
+    atomic_ullong read_locks;
+    atomic_ullong read_waits;       /* Read acquisitions that had to block */
+    atomic_ullong write_locks;
+    atomic_ullong write_waits;      /* Write acquisitions that had to block */
+} TransCacheShard;
+
 /* Translation cache structure (backend-agnostic) */
 struct TransCache {
     CacheBackendType type;        /* Backend type (text, sqlite, mongodb, redis) */
-    void *backend_ctx;            /* Backend-specific context */
+    void *backend_ctx;            /* Backend-specific context (owns all slices) */
     CacheBackendOps *ops;         /* Backend operations */
-    pthread_rwlock_t lock;        /* Read-write lock for thread safety */
+    TransCacheShard *shards;      /* Key-hash partitions, each with its own lock */
+    size_t shard_count;           /* Power of two */
+
+    /* Deferred hit counters (trans_cache_flush_hits) */
+    atomic_ullong hit_flushes;
+    atomic_ullong hits_folded;
+
+    CacheWriteBehind *write_behind;  /* Queue for add / update_translation (NULL: synchronous) */
+    CacheHotTier *hot_tier;          /* In-process copies of hot entries (NULL: none) */
 };
 
 /* ============================================================================
@@ -69,8 +145,11 @@ struct TransCache {
 /* Initialize translation cache with specified backend type
  * Parameters:
  *   - type: Backend type (CACHE_BACKEND_TEXT, CACHE_BACKEND_SQLITE, etc.)
- *   - config_path: Configuration path (file path for text, DB path for sqlite, etc.)
- *   - options: Backend-specific options (can be NULL for defaults)
+ *   - config_path: Configuration path (file path for text, DB path for sqlite,
+ *                  server URL for redis)
+ *   - options: Backend-specific options (can be NULL for defaults;
+ *              TextBackendOptions for text, SqliteBackendOptions for sqlite,
+ *              RedisBackendOptions for redis)
  * Returns: Initialized cache or NULL on error
  */
 TransCache *trans_cache_init_with_backend(CacheBackendType type,
@@ -80,28 +159,59 @@ TransCache *trans_cache_init_with_backend(CacheBackendType type,
 /* Initialize translation cache from file (legacy, defaults to text backend) */
 TransCache *trans_cache_init(const char *file_path);
 
-/* Lookup cache entry by language pair and text */
+/* Create the cache structure for a backend (used by backend init functions).
+ * slices holds shard_count backend slices (power of two, <= 256).
+ * Returns NULL on error; the backend is not freed then. */
+TransCache *trans_cache_create(CacheBackendType type, CacheBackendOps *ops,
+                               void *backend_ctx, void *const *slices,
+                               size_t shard_count);
+
+/* Shard holding key among shard_count shards */
+size_t trans_cache_shard_of(const unsigned char *key, size_t shard_count);
+
+/* Lock / unlock one shard (counted in the contention metrics) */
+void trans_cache_lock_shard(TransCache *cache, size_t shard, bool write);
+void trans_cache_unlock_shard(TransCache *cache, size_t shard);
+
+/* Begin / end a cache read section (nestable). Entries returned by
+ * trans_cache_lookup stay valid and unchanged until the section ends, even
+ * if they are replaced or removed meanwhile. Keep sections short: memory
+ * retired during a section is not freed before it ends. */
+void trans_cache_read_begin(TransCache *cache);
+void trans_cache_read_end(TransCache *cache);
+
+/* Lookup cache entry by language pair and text, in the hot tier first if
+ * there is one. Call inside a read section; the entry may be passed to
+ * trans_cache_update_* within the same section. */
 CacheEntry *trans_cache_lookup(TransCache *cache,
                                const char *from_lang,
                                const char *to_lang,
                                const char *text);
 
-/* Add new cache entry */
+/* Add new cache entry. With write-behind enabled the entry is queued and
+ * applied later (see write_behind_enqueue); 0 then means queued. */
 int trans_cache_add(TransCache *cache,
                    const char *from_lang,
                    const char *to_lang,
                    const char *source_text,
                    const char *translated_text);
 
-/* Update cache entry count (increment) */
+/* Record a hit on entry (count + 1, last_used = now). Call in the read
+ * section of the lookup that returned entry. The hit is visible in count
+ * right away; backends write it to storage in batches (flush_hits). */
 int trans_cache_update_count(TransCache *cache, CacheEntry *entry);
 
-/* Update cache entry translation (reset count to 1) */
+/* Fold deferred hits into backend storage, one shard at a time. Save,
+ * cleanup and stats do this first. Returns entries folded or -1 on error. */
+int trans_cache_flush_hits(TransCache *cache);
+
+/* Update cache entry translation (reset count to 1). Queued like
+ * trans_cache_add when write-behind is enabled. */
 int trans_cache_update_translation(TransCache *cache,
                                    CacheEntry *entry,
                                    const char *new_translation);
 
-/* Save cache to storage */
+/* Save cache to storage (applies queued writes first) */
 int trans_cache_save(TransCache *cache);
 
 /* Cleanup old cache entries (older than days_threshold) */
@@ -115,7 +225,10 @@ void trans_cache_stats(TransCache *cache,
                       int cache_threshold,
                       int days_threshold);
 
-/* Free translation cache */
+/* Cache metrics (shards and lock contention) as JSON object (caller owns) */
+cJSON *trans_cache_metrics(TransCache *cache);
+
+/* Free translation cache (not from inside a read section) */
 void trans_cache_free(TransCache *cache);
 
 /* Helper function to calculate SHA256 hash for cache key */
@@ -124,4 +237,28 @@ void trans_cache_calculate_hash(const char *from_lang,
                                 const char *text,
                                 char *hash_out);
 
+/* Binary SHA256 digest of the cache key (TRANS_CACHE_DIGEST_SIZE bytes) */
+void trans_cache_calculate_digest(const char *from_lang,
+                                  const char *to_lang,
+                                  const char *text,
+                                  unsigned char *digest_out);
+
+/* Hex-encode a digest into hash_out (65 bytes, NUL-terminated) */
+void trans_cache_digest_to_hex(const unsigned char *digest, char *hash_out);
+
+/* Decode a 64-character hex hash. Returns 0 on success, -1 if malformed. */
+int trans_cache_hex_to_digest(const char *hash, unsigned char *digest_out);
+
+/* Intern a language code as a process-wide 1-byte id (thread-safe).
+ * Returns 0 if the code is too long or the table is full. */
+uint8_t trans_cache_lang_id(const char *lang_code);
+
+/* Language code for an interned id ("" for 0 or unknown ids) */
+const char *trans_cache_lang_code(uint8_t lang_id);
+
+/* Entry accessors for the interned languages and the hex hash */
+const char *trans_cache_entry_from_lang(const CacheEntry *entry);
+const char *trans_cache_entry_to_lang(const CacheEntry *entry);
+void trans_cache_entry_hash(const CacheEntry *entry, char *hash_out);
+
 #endif /* TRANS_CACHE_H */
@@ -0,0 +1,75 @@
+#ifndef UPSTREAM_ENGINE_H
+#define UPSTREAM_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <curl/curl.h>
+#include <cjson/cJSON.h>
+
+/* Upstream I/O engine (opaque) */
+typedef struct UpstreamEngine UpstreamEngine;
+
+/* Result of a finished upstream transfer */
+typedef struct {
+    CURLcode curl_code;     /* Transfer result (CURLE_OK on success) */
+    long http_code;         /* HTTP status (0 if no response) */
+    const char *body;       /* Response body, NUL-terminated (valid during callback only) */
+    size_t body_size;
+    bool cancelled;         /* Request dropped by engine shutdown before completion */
+    bool streamed;          /* Body was delivered to the data callback instead */
+    long long started_ms;   /* Monotonic time (ms) the transfer started, 0 if never */
+} UpstreamResult;
+
+/* Completion callback; runs on an engine event-loop thread.
+ * Callbacks may submit follow-up requests (e.g. retries). */
+typedef void (*UpstreamCallback)(const UpstreamResult *result, void *user_data);
+
+/* Streaming body callback; runs on the event-loop thread for every chunk of a
+ * 2xx response as it arrives. Return 0 to continue, -1 to abort the transfer.
+ * Bodies of other statuses are buffered into UpstreamResult.body as usual. */
+typedef int (*UpstreamDataCallback)(const char *data, size_t size, void *user_data);
+
+/* Create engine with event_threads curl_multi loops sharing DNS and TLS
+ * session caches; each loop pools its own connections. max_inflight bounds
+ * concurrent transfers across all loops; excess requests wait in the loop
+ * queues. timeout is per transfer (s). */
+UpstreamEngine *upstream_engine_create(int event_threads, int max_inflight, int timeout);
+
+/* Submit a POST request. The engine takes ownership of headers and body, also
+ * when submission fails. delay_ms > 0 defers the start (used for retry backoff).
+ * Returns 0 if accepted, -1 if rejected (callback is not invoked). */
+int upstream_engine_submit(
+    UpstreamEngine *engine,
+    const char *url,
+    struct curl_slist *headers,
+    char *body,
+    long delay_ms,
+    UpstreamCallback callback,
+    void *user_data
+);
+
+/* Same as upstream_engine_submit, but successful response bodies are passed
+ * to data_callback as they arrive instead of being buffered. Both callbacks
+ * receive the same user_data. */
+int upstream_engine_submit_stream(
+    UpstreamEngine *engine,
+    const char *url,
+    struct curl_slist *headers,
+    char *body,
+    long delay_ms,
+    UpstreamDataCallback data_callback,
+    UpstreamCallback callback,
+    void *user_data
+);
+
+/* Stop accepting requests, cancel queued/delayed ones and wait for running
+ * transfers to complete. Safe to call more than once. */
+void upstream_engine_shutdown(UpstreamEngine *engine);
+
+/* Free engine (shuts down first if still running) */
+void upstream_engine_free(UpstreamEngine *engine);
+
+/* Engine metrics as JSON object (caller owns) */
+cJSON *upstream_engine_stats(UpstreamEngine *engine);
+
+#endif /* UPSTREAM_ENGINE_H */
@@ -40,6 +40,9 @@ int generate_uuid(char *uuid_buf, size_t buf_size);
 /* Get current timestamp in RFC 3339 format */
 int get_current_timestamp(char *timestamp_buf, size_t buf_size);
 
+/* Count characters in a UTF-8 string */
+size_t utf8_strlen(const char *text);
+
 /* Truncate text with suffix */
 int truncate_text(const char *text, char *output, size_t max_length, const char *suffix);
 
@@ -49,6 +52,45 @@ int strip_emoji_and_shortcodes(const char *input, char *output, size_t output_si
 /* Unescape string (convert \\n to \n, \\t to \t, etc.) */
 int unescape_string(const char *input, char *output, size_t output_size);
 
+/* Decode the escapes of a JSON string body of len bytes (without quotes)
+ * into out, which needs len bytes (decoding never makes it longer). Returns
+ * the decoded length, or -1 if malformed or it would hold a NUL byte. */
+long json_unescape(const char *s, size_t len, char *out);
+
+/* Incremental unescape_string + strip_emoji_and_shortcodes for streamed text.
+ * Bytes that may still change meaning (a trailing backslash, an incomplete
+ * UTF-8 sequence, a space that could end the text) are held back until the
+ * next feed or text_cleaner_finish, so the concatenated output equals the
+ * result of running both functions on the whole text. */
+typedef struct {
+    bool pending_backslash;
+    unsigned char utf8_buf[4];
+    int utf8_len;
+    int utf8_need;
+    bool in_shortcode;
+    bool last_was_space;
+    bool pending_space;
+    bool has_output;
+} TextCleaner;
+
+/* Extra output bytes (including NUL) beyond the input length a feed may produce */
+#define TEXT_CLEANER_SLACK 8
+
+/* Reset cleaner state */
+void text_cleaner_init(TextCleaner *cleaner);
+
+/* Clean len input bytes into output (capacity len + TEXT_CLEANER_SLACK).
+ * Returns number of bytes written; output is NUL-terminated. */
+size_t text_cleaner_feed(TextCleaner *cleaner, const char *input, size_t len, char *output);
+
+/* Flush held-back bytes at end of text (output capacity TEXT_CLEANER_SLACK) */
+size_t text_cleaner_finish(TextCleaner *cleaner, char *output);
+
+/* Unescape, strip emoji/shortcodes and normalize whitespace of a complete text
+ * in one pass. No length limit: the result is allocated from len (caller
+ * frees). out_len may be NULL. Returns NULL on allocation failure. */
+char *clean_text(const char *input, size_t len, size_t *out_len);
+
 /* Strip ANSI escape codes and control characters from text */
 int strip_ansi_codes(const char *input, char *output, size_t output_size);
 
@@ -0,0 +1,1925 @@
+/**
+ * Redis backend implementation for translation cache.
+ * Several transbasket nodes share one cache on a Redis server, spoken to
+ * with a small built-in RESP2 / RESP3 client. Each entry is a hash under
+ * <prefix><hex hash>; lookups read it with HMGET on a pool of connections.
+ * Cache hits are collected in memory and written by flush_hits as one
+ * MULTI/EXEC pipeline of HINCRBY, and write-behind batches go out the same
+ * way. Entries expire ttl_seconds after their last write instead of being
+ * removed by cleanup. A hot tier in front of the backend stays in line
+ * with the other nodes through client tracking: a RESP3 connection in
+ * broadcast mode on the key prefix gets an invalidation push for every
+ * key any client changes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "cache_backend_redis.h"
+#include "cache_hot_tier.h"
+#include "trans_cache.h"
+#include "epoch.h"
+#include "utils.h"
+
+#define DEFAULT_HOST "127.0.0.1"
+#define DEFAULT_PORT 6379
+#define DEFAULT_POOL_SIZE 8
+#define MIN_POOL_SIZE 2                         /* An open batch holds one while lookups run */
+#define MAX_POOL_SIZE 256
+#define DEFAULT_TIMEOUT_MS 2000
+#define DEFAULT_KEY_PREFIX "transbasket:"
+#define MAX_KEY_PREFIX 64
+#define KEY_SIZE (MAX_KEY_PREFIX + TRANS_CACHE_DIGEST_SIZE * 2 + 1)
+#define ID_BLOCK 1000                           /* Entry ids reserved per INCRBY */
+#define PENDING_HIT_SLOTS 8192                  /* Power of two */
+#define PENDING_HIT_MAX (PENDING_HIT_SLOTS / 2) /* Flush early beyond this */
+#define SCAN_COUNT 1000                         /* Keys per SCAN step */
+#define READ_CHUNK 16384                        /* Initial read buffer */
+#define MAX_REPLY_DEPTH 8
+#define MAX_BULK_LENGTH (512LL * 1024 * 1024)   /* Largest Redis string */
+#define MAX_AGGREGATE_LENGTH (1LL << 24)
+#define TRACKING_POLL_MS 200                    /* Tracking thread checks for stop this often */
+#define TRACKING_PING_MS 1000                   /* PING an idle tracking connection */
+#define TRACKING_RETRY_MS 1000                  /* Wait between tracking reconnects */
+
+/* Entry hash fields in HMGET order; stats reads only the first
+ * ENTRY_COUNT_FIELDS */
+static const char *const ENTRY_FIELDS[] = {
+    "id", "count", "last_used", "created_at", "from", "to", "source", "target"
+};
+#define ENTRY_FIELD_COUNT 8
+#define ENTRY_COUNT_FIELDS 3
+
+/* Reply types; RESP3 types map onto the nearest RESP2 one */
+typedef enum {
+    REPLY_STRING,       /* Bulk, verbatim, double and big number */
+    REPLY_STATUS,
+    REPLY_ERROR,        /* Simple and bulk errors */
+    REPLY_INTEGER,      /* Also booleans */
+    REPLY_NIL,
+    REPLY_ARRAY,        /* Also sets, and maps as key, value, ... */
+    REPLY_PUSH          /* Out-of-band RESP3 message */
+} RedisReplyType;
+
+typedef struct RedisReply {
+    RedisReplyType type;
+    long long integer;
+    char *str;                      /* NUL-terminated (STRING, STATUS, ERROR) */
+    size_t len;
+    struct RedisReply **elements;   /* ARRAY, PUSH */
+    size_t count;
+} RedisReply;
+
+struct RedisConnection {
+    int fd;                         /* -1: closed (reconnected on next use) */
+    char *in;                       /* Received, not parsed yet: in[in_start .. in_end) */
+    size_t in_start;
+    size_t in_end;
+    size_t in_size;
+    char *out;                      /* Commands not sent yet */
+    size_t out_len;
+    size_t out_size;
+    size_t out_commands;
+    bool out_failed;                /* A command did not fit (allocation failed) */
+    RedisConnection *next;          /* Next idle connection */
+};
+
+/* Forward declarations of backend operations */
+static CacheEntry* redis_backend_lookup(void *ctx, const unsigned char *key);
+static int redis_backend_add(void *ctx, const unsigned char *key,
+                             const char *from_lang, const char *to_lang,
+                             const char *source_text, const char *translated_text);
+static int redis_backend_update_count(void *ctx, CacheEntry *entry);
+static int redis_backend_flush_hits(void *ctx);
+static int redis_backend_update_translation(void *ctx, CacheEntry *entry,
+                                            const char *new_translation);
+static int redis_backend_save(TransCache *cache);
+static int redis_backend_cleanup(void *ctx, int days_threshold);
+static void redis_backend_stats(void *ctx, size_t *total_entries,
+                                size_t *active_entries, size_t *expired_entries,
+                                int cache_threshold, int days_threshold);
+static cJSON *redis_backend_metrics(TransCache *cache);
+static void redis_backend_free(void *ctx);
+
+/* Monotonic clock in milliseconds */
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ============================================================================
+ * Connections
+ * ============================================================================ */
+
+/* Connect fd to addr within timeout_ms */
+static int connect_with_timeout(int fd, const struct sockaddr *addr, socklen_t addr_len,
+                                int timeout_ms) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -1;
+    }
+
+    int result = connect(fd, addr, addr_len);
+    if (result < 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+
+        result = -1;
+        if (poll(&pfd, 1, timeout_ms) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_len) == 0 && error == 0) {
+            result = 0;
+        }
+    }
+
+    if (result == 0 && fcntl(fd, F_SETFL, flags) < 0) {
+        result = -1;
+    }
+    return result;
+}
+
+/* Receive and send timeout of fd (0: wait forever) */
+static void set_socket_timeout(int fd, int timeout_ms) {
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+/* Open a TCP connection to the server. Returns the socket or -1. */
+static int connect_socket(const RedisBackendContext *ctx) {
+    char port[16];
+    snprintf(port, sizeof(port), "%d", ctx->port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *addrs = NULL;
+    int rc = getaddrinfo(ctx->host, port, &hints, &addrs);
+    if (rc != 0) {
+        LOG_DEBUG("Error resolving Redis host %s: %s\n", ctx->host, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = addrs; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect_with_timeout(fd, ai->ai_addr, ai->ai_addrlen,
+                                            ctx->timeout_ms) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addrs);
+
+    if (fd < 0) {
+        LOG_DEBUG("Error connecting to Redis at %s:%d\n", ctx->host, ctx->port);
+        return -1;
+    }
+
+    /* Requests are small and wait for their reply */
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    set_socket_timeout(fd, ctx->timeout_ms);
+    return fd;
+}
+
+/* Close the socket and drop whatever was buffered */
+static void conn_close(RedisConnection *conn) {
+    if (conn->fd >= 0) {
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    conn->in_start = 0;
+    conn->in_end = 0;
+    conn->out_len = 0;
+    conn->out_commands = 0;
+    conn->out_failed = false;
+}
+
+/* Close and free the buffers (not conn itself) */
+static void conn_destroy(RedisConnection *conn) {
+    conn_close(conn);
+    free(conn->in);
+    free(conn->out);
+    conn->in = NULL;
+    conn->out = NULL;
+    conn->in_size = 0;
+    conn->out_size = 0;
+}
+
+/* Append len bytes to the commands to send */
+static void out_append(RedisConnection *conn, const void *data, size_t len) {
+    if (conn->out_failed) {
+        return;
+    }
+    if (conn->out_len + len > conn->out_size) {
+        size_t size = conn->out_size ? conn->out_size : 4096;
+        while (size < conn->out_len + len) {
+            size *= 2;
+        }
+        char *out = realloc(conn->out, size);
+        if (!out) {
+            conn->out_failed = true;
+            return;
+        }
+        conn->out = out;
+        conn->out_size = size;
+    }
+    memcpy(conn->out + conn->out_len, data, len);
+    conn->out_len += len;
+}
+
+/* Append a RESP type marker with a number: "*3\r\n", "$5\r\n" */
+static void out_header(RedisConnection *conn, char type, long long n) {
+    char header[32];
+    int len = snprintf(header, sizeof(header), "%c%lld\r\n", type, n);
+    out_append(conn, header, (size_t)len);
+}
+
+/* Queue a command of argc arguments, given by the command_* calls that follow */
+static void command_begin(RedisConnection *conn, int argc) {
+    out_header(conn, '*', argc);
+    conn->out_commands++;
+}
+
+static void command_arg(RedisConnection *conn, const void *data, size_t len) {
+    out_header(conn, '$', (long long)len);
+    out_append(conn, data, len);
+    out_append(conn, "\r\n", 2);
+}
+
+static void command_str(RedisConnection *conn, const char *str) {
+    command_arg(conn, str, strlen(str));
+}
+
+static void command_int(RedisConnection *conn, long long value) {
+    char number[24];
+    int len = snprintf(number, sizeof(number), "%lld", value);
+    command_arg(conn, number, (size_t)len);
+}
+
+/* Send the queued commands. Closes the connection on error. */
+static int conn_send(RedisBackendContext *ctx, RedisConnection *conn) {
+    if (conn->out_failed) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        conn_close(conn);
+        atomic_fetch_add_explicit(&ctx->errors, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    size_t sent = 0;
+    while (sent < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out + sent, conn->out_len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            LOG_DEBUG("Error sending to Redis: %s\n", strerror(errno));
+            conn_close(conn);
+            atomic_fetch_add_explicit(&ctx->errors, 1, memory_order_relaxed);
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+
+    atomic_fetch_add_explicit(&ctx->commands, conn->out_commands, memory_order_relaxed);
+    if (conn->out_commands > 1) {
+        atomic_fetch_add_explicit(&ctx->pipelines, 1, memory_order_relaxed);
+    }
+    conn->out_len = 0;
+    conn->out_commands = 0;
+    return 0;
+}
+
+/* Receive more bytes. Returns false on error, end of stream or timeout. */
+static bool conn_fill(RedisConnection *conn) {
+    if (conn->in_start > 0) {
+        memmove(conn->in, conn->in + conn->in_start, conn->in_end - conn->in_start);
+        conn->in_end -= conn->in_start;
+        conn->in_start = 0;
+    }
+    if (conn->in_end == conn->in_size) {
+        size_t size = conn->in_size ? conn->in_size * 2 : READ_CHUNK;
+        char *in = realloc(conn->in, size);
+        if (!in) {
+            return false;
+        }
+        conn->in = in;
+        conn->in_size = size;
+    }
+
+    for (;;) {
+        ssize_t n = recv(conn->fd, conn->in + conn->in_end, conn->in_size - conn->in_end, 0);
+        if (n > 0) {
+            conn->in_end += (size_t)n;
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+}
+
+/* Next CRLF-terminated line, without the CRLF. Valid until the next read
+ * (the CR stays behind it, so numbers in it parse without a copy). */
+static const char *conn_line(RedisConnection *conn, size_t *len) {
+    size_t scanned = 0;
+
+    for (;;) {
+        const char *start = conn->in + conn->in_start;
+        size_t available = conn->in_end - conn->in_start;
+        const char *lf = available > scanned ?
+                         memchr(start + scanned, '\n', available - scanned) : NULL;
+        if (lf) {
+            size_t n = (size_t)(lf - start);
+            if (n == 0 || start[n - 1] != '\r') {
+                return NULL;
+            }
+            *len = n - 1;
+            conn->in_start += n + 1;
+            return start;
+        }
+
+        scanned = available;
+        if (!conn_fill(conn)) {
+            return NULL;
+        }
+    }
+}
+
+/* Copy the next n bytes into dst (NUL-terminated) and skip their CRLF */
+static bool conn_bytes(RedisConnection *conn, char *dst, size_t n) {
+    size_t need = n + 2;
+    size_t copied = 0;
+
+    while (copied < need) {
+        size_t available = conn->in_end - conn->in_start;
+        if (available == 0) {
+            if (!conn_fill(conn)) {
+                return false;
+            }
+            continue;
+        }
+
+        size_t take = available < need - copied ? available : need - copied;
+        if (copied < n) {
+            size_t data = take < n - copied ? take : n - copied;
+            memcpy(dst + copied, conn->in + conn->in_start, data);
+        }
+        copied += take;
+        conn->in_start += take;
+    }
+
+    dst[n] = '\0';
+    return true;
+}
+
+/* Parse a decimal integer filling exactly len bytes */
+static bool parse_integer(const char *str, size_t len, long long *value) {
+    if (len == 0) {
+        return false;
+    }
+
+    char *end;
+    errno = 0;
+    long long v = strtoll(str, &end, 10);
+    if (errno != 0 || end != str + len) {
+        return false;
+    }
+
+    *value = v;
+    return true;
+}
+
+/* Free a reply and its elements */
+static void reply_free(RedisReply *reply) {
+    if (!reply) {
+        return;
+    }
+    for (size_t i = 0; i < reply->count; i++) {
+        reply_free(reply->elements[i]);
+    }
+    free(reply->elements);
+    free(reply->str);
+    free(reply);
+}
+
+/* Read one reply (RESP2 or RESP3). Returns NULL on a connection or
+ * protocol error. */
+static RedisReply *read_reply(RedisConnection *conn, int depth) {
+    if (depth > MAX_REPLY_DEPTH) {
+        return NULL;
+    }
+
+    size_t len;
+    const char *line = conn_line(conn, &len);
+    if (!line || len == 0) {
+        return NULL;
+    }
+
+    RedisReply *reply = calloc(1, sizeof(RedisReply));
+    if (!reply) {
+        return NULL;
+    }
+
+    char type = line[0];
+    long long n = 0;
+    bool ok = true;
+
+    switch (type) {
+        case '+':
+        case '-':
+        case ',':
+        case '(':
+            reply->type = type == '+' ? REPLY_STATUS : type == '-' ? REPLY_ERROR : REPLY_STRING;
+            reply->str = strndup(line + 1, len - 1);
+            reply->len = len - 1;
+            ok = reply->str != NULL;
+            break;
+
+        case ':':
+            reply->type = REPLY_INTEGER;
+            ok = parse_integer(line + 1, len - 1, &reply->integer);
+            break;
+
+        case '#':
+            reply->type = REPLY_INTEGER;
+            reply->integer = len > 1 && line[1] == 't';
+            break;
+
+        case '_':
+            reply->type = REPLY_NIL;
+            break;
+
+        case '$':
+        case '=':
+        case '!':
+            ok = parse_integer(line + 1, len - 1, &n) && n <= MAX_BULK_LENGTH;
+            if (ok && n < 0) {
+                reply->type = REPLY_NIL;
+            } else if (ok) {
+                reply->type = type == '!' ? REPLY_ERROR : REPLY_STRING;
+                reply->str = malloc((size_t)n + 1);
+                reply->len = (size_t)n;
+                ok = reply->str && conn_bytes(conn, reply->str, (size_t)n);
+
+                /* Verbatim strings start with their format ("txt:") */
+                if (ok && type == '=' && n >= 4) {
+                    memmove(reply->str, reply->str + 4, (size_t)n - 3);
+                    reply->len -= 4;
+                }
+            }
+            break;
+
+        case '*':
+        case '~':
+        case '%':
+        case '>':
+        case '|':
+            ok = parse_integer(line + 1, len - 1, &n) && n <= MAX_AGGREGATE_LENGTH;
+            if (ok && n < 0) {
+                reply->type = REPLY_NIL;
+            } else if (ok) {
+                reply->type = type == '>' ? REPLY_PUSH : REPLY_ARRAY;
+                reply->count = (size_t)n * (type == '%' || type == '|' ? 2 : 1);
+                reply->elements = calloc(reply->count ? reply->count : 1, sizeof(RedisReply *));
+                ok = reply->elements != NULL;
+                for (size_t i = 0; ok && i < reply->count; i++) {
+                    reply->elements[i] = read_reply(conn, depth + 1);
+                    ok = reply->elements[i] != NULL;
+                }
+            }
+            break;
+
+        default:
+            ok = false;
+            break;
+    }
+
+    if (!ok) {
+        reply_free(reply);
+        return NULL;
+    }
+
+    /* Attributes describe the reply that follows */
+    if (type == '|') {
+        reply_free(reply);
+        return read_reply(conn, depth);
+    }
+    return reply;
+}
+
+/* Read the reply to a sent command. Closes the connection on error. */
+static RedisReply *conn_read(RedisBackendContext *ctx, RedisConnection *conn) {
+    RedisReply *reply = read_reply(conn, 0);
+    if (!reply) {
+        LOG_DEBUG("Error reading from Redis: connection lost or invalid reply\n");
+        conn_close(conn);
+        atomic_fetch_add_explicit(&ctx->errors, 1, memory_order_relaxed);
+    }
+    return reply;
+}
+
+/* Whether reply (or, for a transaction, one of its results) is an error;
+ * logged with what */
+static bool reply_failed(RedisBackendContext *ctx, const RedisReply *reply, const char *what) {
+    const RedisReply *error = reply->type == REPLY_ERROR ? reply : NULL;
+
+    for (size_t i = 0; !error && reply->type == REPLY_ARRAY && i < reply->count; i++) {
+        if (reply->elements[i]->type == REPLY_ERROR) {
+            error = reply->elements[i];
+        }
+    }
+    if (!error) {
+        return false;
+    }
+
+    (void)what;     /* Unused when debug logging is compiled out */
+    LOG_DEBUG("Redis error %s: %s\n", what, error->str);
+    atomic_fetch_add_explicit(&ctx->errors, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Send the one command queued on conn and return its reply (NULL on error) */
+static RedisReply *conn_call(RedisBackendContext *ctx, RedisConnection *conn, const char *what) {
+    if (conn_send(ctx, conn) != 0) {
+        return NULL;
+    }
+
+    RedisReply *reply = conn_read(ctx, conn);
+    if (reply && reply_failed(ctx, reply, what)) {
+        reply_free(reply);
+        return NULL;
+    }
+    return reply;
+}
+
+/* Send the commands queued on conn and read their replies. Returns 0 if
+ * none failed. */
+static int conn_exchange(RedisBackendContext *ctx, RedisConnection *conn, const char *what) {
+    size_t expected = conn->out_commands;
+    if (conn_send(ctx, conn) != 0) {
+        return -1;
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < expected; i++) {
+        RedisReply *reply = conn_read(ctx, conn);
+        if (!reply) {
+            return -1;
+        }
+        if (reply_failed(ctx, reply, what)) {
+            result = -1;
+        }
+        reply_free(reply);
+    }
+    return result;
+}
+
+/* Connect conn, authenticate and select the database; resp3 switches the
+ * protocol with HELLO. Returns 0 on success. */
+static int conn_open(RedisBackendContext *ctx, RedisConnection *conn, bool resp3) {
+    conn_close(conn);
+
+    conn->fd = connect_socket(ctx);
+    if (conn->fd < 0) {
+        return -1;
+    }
+
+    if (resp3) {
+        command_begin(conn, ctx->password ? 5 : 2);
+        command_str(conn, "HELLO");
+        command_str(conn, "3");
+        if (ctx->password) {
+            command_str(conn, "AUTH");
+            command_str(conn, ctx->user ? ctx->user : "default");
+            command_str(conn, ctx->password);
+        }
+    } else if (ctx->password) {
+        command_begin(conn, ctx->user ? 3 : 2);
+        command_str(conn, "AUTH");
+        if (ctx->user) {
+            command_str(conn, ctx->user);
+        }
+        command_str(conn, ctx->password);
+    }
+    if (ctx->db > 0) {
+        command_begin(conn, 2);
+        command_str(conn, "SELECT");
+        command_int(conn, ctx->db);
+    }
+
+    if (conn->out_commands > 0 && conn_exchange(ctx, conn, "opening connection") != 0) {
+        conn_close(conn);
+        return -1;
+    }
+    return 0;
+}
+
+/* Check out an idle connection, waiting for one if all are busy, and
+ * reconnect it if it was closed. Returns NULL if that fails. */
+static RedisConnection *pool_acquire(RedisBackendContext *ctx) {
+    pthread_mutex_lock(&ctx->pool_lock);
+    while (!ctx->idle_connections) {
+        pthread_cond_wait(&ctx->pool_cond, &ctx->pool_lock);
+    }
+    RedisConnection *conn = ctx->idle_connections;
+    ctx->idle_connections = conn->next;
+    pthread_mutex_unlock(&ctx->pool_lock);
+
+    if (conn->fd < 0) {
+        atomic_fetch_add_explicit(&ctx->reconnects, 1, memory_order_relaxed);
+        if (conn_open(ctx, conn, false) != 0) {
+            LOG_DEBUG("Error: Cannot reconnect to Redis at %s:%d\n", ctx->host, ctx->port);
+            pthread_mutex_lock(&ctx->pool_lock);
+            conn->next = ctx->idle_connections;
+            ctx->idle_connections = conn;
+            pthread_cond_signal(&ctx->pool_cond);
+            pthread_mutex_unlock(&ctx->pool_lock);
+            return NULL;
+        }
+    }
+
+    return conn;
+}
+
+/* Return a connection to the pool */
+static void pool_release(RedisBackendContext *ctx, RedisConnection *conn) {
+    pthread_mutex_lock(&ctx->pool_lock);
+    conn->next = ctx->idle_connections;
+    ctx->idle_connections = conn;
+    pthread_cond_signal(&ctx->pool_cond);
+    pthread_mutex_unlock(&ctx->pool_lock);
+}
+
+/* ============================================================================
+ * Keys and entries
+ * ============================================================================ */
+
+/* Key of digest, <prefix><hex hash>, in a KEY_SIZE buffer. Returns its length. */
+static size_t entry_key(const RedisBackendContext *ctx, const unsigned char *digest, char *key) {
+    memcpy(key, ctx->key_prefix, ctx->prefix_len);
+    trans_cache_digest_to_hex(digest, key + ctx->prefix_len);
+    return ctx->prefix_len + TRANS_CACHE_DIGEST_SIZE * 2;
+}
+
+/* Digest of an entry key. Returns false for other keys. */
+static bool key_digest(const RedisBackendContext *ctx, const char *key, size_t len,
+                       unsigned char *digest) {
+    char hash[TRANS_CACHE_DIGEST_SIZE * 2 + 1];
+
+    if (len != ctx->prefix_len + TRANS_CACHE_DIGEST_SIZE * 2 ||
+        memcmp(key, ctx->key_prefix, ctx->prefix_len) != 0) {
+        return false;
+    }
+    memcpy(hash, key + ctx->prefix_len, TRANS_CACHE_DIGEST_SIZE * 2);
+    hash[TRANS_CACHE_DIGEST_SIZE * 2] = '\0';
+    return trans_cache_hex_to_digest(hash, digest) == 0;
+}
+
+/* Queue an HMGET of the first fields entry fields of key */
+static void queue_read(const RedisBackendContext *ctx, RedisConnection *conn,
+                       const unsigned char *digest, size_t fields) {
+    char key[KEY_SIZE];
+    size_t key_len = entry_key(ctx, digest, key);
+
+    command_begin(conn, 2 + (int)fields);
+    command_str(conn, "HMGET");
+    command_arg(conn, key, key_len);
+    for (size_t i = 0; i < fields; i++) {
+        command_str(conn, ENTRY_FIELDS[i]);
+    }
+}
+
+/* Queue the EXPIRE that follows every write of key */
+static void queue_expire(const RedisBackendContext *ctx, RedisConnection *conn,
+                         const char *key, size_t key_len) {
+    if (ctx->ttl_seconds > 0) {
+        command_begin(conn, 3);
+        command_str(conn, "EXPIRE");
+        command_arg(conn, key, key_len);
+        command_int(conn, ctx->ttl_seconds);
+    }
+}
+
+/* Queue the write of a whole entry: every field at once, so a hash that
+ * expired meanwhile is not left with half of them */
+static void queue_entry(const RedisBackendContext *ctx, RedisConnection *conn,
+                        const unsigned char *digest, int id,
+                        const char *from_lang, const char *to_lang,
+                        const char *source_text, const char *translated_text,
+                        int count, uint32_t last_used, uint32_t created_at) {
+    char key[KEY_SIZE];
+    size_t key_len = entry_key(ctx, digest, key);
+
+    command_begin(conn, 2 + 2 * ENTRY_FIELD_COUNT);
+    command_str(conn, "HSET");
+    command_arg(conn, key, key_len);
+    command_str(conn, "id");
+    command_int(conn, id);
+    command_str(conn, "count");
+    command_int(conn, count);
+    command_str(conn, "last_used");
+    command_int(conn, last_used);
+    command_str(conn, "created_at");
+    command_int(conn, created_at);
+    command_str(conn, "from");
+    command_str(conn, from_lang);
+    command_str(conn, "to");
+    command_str(conn, to_lang);
+    command_str(conn, "source");
+    command_str(conn, source_text);
+    command_str(conn, "target");
+    command_str(conn, translated_text);
+    queue_expire(ctx, conn, key, key_len);
+}
+
+/* Queue the commands adding hits to an entry's count */
+static void queue_hits(const RedisBackendContext *ctx, RedisConnection *conn,
+                       const unsigned char *digest, uint32_t hits, uint32_t last_used) {
+    char key[KEY_SIZE];
+    size_t key_len = entry_key(ctx, digest, key);
+
+    command_begin(conn, 4);
+    command_str(conn, "HINCRBY");
+    command_arg(conn, key, key_len);
+    command_str(conn, "count");
+    command_int(conn, hits);
+    command_begin(conn, 4);
+    command_str(conn, "HSET");
+    command_arg(conn, key, key_len);
+    command_str(conn, "last_used");
+    command_int(conn, last_used);
+    queue_expire(ctx, conn, key, key_len);
+}
+
+/* Fill entry from the HMGET reply of its first fields fields. Returns
+ * false unless the hash holds all of them (a missing key reads as nils,
+ * and hits on an entry that expired meanwhile leave a hash without id).
+ * The texts are taken over from reply. */
+static bool entry_from_reply(CacheEntry *entry, RedisReply *reply, size_t fields) {
+    if (reply->type != REPLY_ARRAY || reply->count != fields) {
+        return false;
+    }
+    for (size_t i = 0; i < fields; i++) {
+        if (reply->elements[i]->type != REPLY_STRING) {
+            return false;
+        }
+    }
+
+    long long id, count, last_used, created_at = 0;
+    RedisReply **values = reply->elements;
+    if (!parse_integer(values[0]->str, values[0]->len, &id) ||
+        !parse_integer(values[1]->str, values[1]->len, &count) ||
+        !parse_integer(values[2]->str, values[2]->len, &last_used) ||
+        (fields > ENTRY_COUNT_FIELDS &&
+         !parse_integer(values[3]->str, values[3]->len, &created_at))) {
+        return false;
+    }
+
+    entry->id = (int)id;
+    entry->count = (int)count;
+    entry->last_used = (uint32_t)last_used;
+    entry->created_at = (uint32_t)created_at;
+
+    if (fields > ENTRY_COUNT_FIELDS) {
+        entry->from_id = trans_cache_lang_id(values[4]->str);
+        entry->to_id = trans_cache_lang_id(values[5]->str);
+        entry->source_text = values[6]->str;
+        entry->translated_text = values[7]->str;
+        values[6]->str = NULL;
+        values[7]->str = NULL;
+    }
+    return true;
+}
+
+/* Free an entry returned by lookup */
+static void redis_entry_free(void *ptr) {
+    CacheEntry *entry = (CacheEntry*)ptr;
+    free(entry->source_text);
+    free(entry->translated_text);
+    free(entry);
+}
+
+/* Read the entry of key on a pooled connection (NULL if absent). A read
+ * is retried once on a new connection if the server dropped the old one
+ * (restart, idle timeout). */
+static CacheEntry *read_entry(RedisBackendContext *ctx, const unsigned char *key) {
+    RedisReply *reply = NULL;
+
+    for (int attempt = 0; attempt < 2 && !reply; attempt++) {
+        RedisConnection *conn = pool_acquire(ctx);
+        if (!conn) {
+            return NULL;
+        }
+
+        queue_read(ctx, conn, key, ENTRY_FIELD_COUNT);
+        reply = conn_call(ctx, conn, "looking up cache entry");
+        bool dropped = conn->fd < 0;
+        pool_release(ctx, conn);
+        if (!reply && !dropped) {
+            return NULL;
+        }
+    }
+    if (!reply) {
+        return NULL;
+    }
+
+    CacheEntry *entry = calloc(1, sizeof(CacheEntry));
+    if (entry && !entry_from_reply(entry, reply, ENTRY_FIELD_COUNT)) {
+        free(entry);
+        entry = NULL;
+    }
+    reply_free(reply);
+
+    if (entry) {
+        memcpy(entry->key, key, TRANS_CACHE_DIGEST_SIZE);
+    }
+    return entry;
+}
+
+/* Glob pattern matching every key under the prefix */
+static void prefix_pattern(const RedisBackendContext *ctx, char *pattern) {
+    size_t len = 0;
+    for (size_t i = 0; i < ctx->prefix_len; i++) {
+        char c = ctx->key_prefix[i];
+        if (c == '*' || c == '?' || c == '[' || c == ']' || c == '\\') {
+            pattern[len++] = '\\';
+        }
+        pattern[len++] = c;
+    }
+    pattern[len++] = '*';
+    pattern[len] = '\0';
+}
+
+/* Visit the entries under the prefix: SCAN for keys, then the HMGETs of
+ * each step's keys in one pipeline. Without texts only id, count and
+ * last_used are read. Returns entries visited or -1. */
+static long scan_entries(RedisBackendContext *ctx, bool texts,
+                         int (*callback)(CacheEntry *entry, void *user_data),
+                         void *user_data) {
+    RedisConnection *conn = pool_acquire(ctx);
+    if (!conn) {
+        return -1;
+    }
+
+    size_t fields = texts ? ENTRY_FIELD_COUNT : ENTRY_COUNT_FIELDS;
+    char pattern[MAX_KEY_PREFIX * 2 + 2];
+    prefix_pattern(ctx, pattern);
+
+    char cursor[32] = "0";
+    long visited = 0;
+    int result = 0;
+
+    do {
+        command_begin(conn, 6);
+        command_str(conn, "SCAN");
+        command_str(conn, cursor);
+        command_str(conn, "MATCH");
+        command_str(conn, pattern);
+        command_str(conn, "COUNT");
+        command_int(conn, SCAN_COUNT);
+
+        RedisReply *scan = conn_call(ctx, conn, "scanning keys");
+        if (!scan || scan->type != REPLY_ARRAY || scan->count != 2 ||
+            scan->elements[0]->type != REPLY_STRING ||
+            scan->elements[0]->len >= sizeof(cursor) ||
+            scan->elements[1]->type != REPLY_ARRAY) {
+            reply_free(scan);
+            result = -1;
+            break;
+        }
+        memcpy(cursor, scan->elements[0]->str, scan->elements[0]->len + 1);
+
+        /* Read the entries of this step in one round trip */
+        RedisReply *keys = scan->elements[1];
+        unsigned char (*digests)[TRANS_CACHE_DIGEST_SIZE] =
+            malloc((keys->count ? keys->count : 1) * TRANS_CACHE_DIGEST_SIZE);
+        if (!digests) {
+            LOG_DEBUG("Error: Memory allocation failed\n");
+            reply_free(scan);
+            result = -1;
+            break;
+        }
+
+        size_t queued = 0;
+        for (size_t i = 0; i < keys->count; i++) {
+            RedisReply *key = keys->elements[i];
+            if (key->type == REPLY_STRING &&
+                key_digest(ctx, key->str, key->len, digests[queued])) {
+                queue_read(ctx, conn, digests[queued], fields);
+                queued++;
+            }
+        }
+
+        if (queued > 0 && conn_send(ctx, conn) != 0) {
+            result = -1;
+        }
+        for (size_t i = 0; result == 0 && i < queued; i++) {
+            RedisReply *reply = conn_read(ctx, conn);
+            if (!reply) {
+                result = -1;
+                break;
+            }
+
+            CacheEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            memcpy(entry.key, digests[i], TRANS_CACHE_DIGEST_SIZE);
+            if (entry_from_reply(&entry, reply, fields)) {
+                visited++;
+                /* Keep reading the step's replies after a failed callback */
+                if (callback(&entry, user_data) != 0) {
+                    for (i++; i < queued; i++) {
+                        reply_free(conn_read(ctx, conn));
+                    }
+                    result = -1;
+                }
+            }
+            free(entry.source_text);
+            free(entry.translated_text);
+            reply_free(reply);
+        }
+
+        free(digests);
+        reply_free(scan);
+    } while (result == 0 && strcmp(cursor, "0") != 0);
+
+    pool_release(ctx, conn);
+    return result == 0 ? visited : -1;
+}
+
+/* Next entry id, reserving a new block of ids on the server (shared by
+ * all nodes) when the current one is used up. Returns -1 on error. */
+static int reserve_id(RedisBackendContext *ctx) {
+    pthread_mutex_lock(&ctx->id_lock);
+
+    if (ctx->next_id > ctx->id_limit) {
+        RedisConnection *conn = pool_acquire(ctx);
+        RedisReply *reply = NULL;
+        if (conn) {
+            char key[KEY_SIZE];
+            int key_len = snprintf(key, sizeof(key), "%snext_id", ctx->key_prefix);
+
+            command_begin(conn, 3);
+            command_str(conn, "INCRBY");
+            command_arg(conn, key, (size_t)key_len);
+            command_int(conn, ID_BLOCK);
+            reply = conn_call(ctx, conn, "reserving entry ids");
+            pool_release(ctx, conn);
+        }
+
+        if (!reply || reply->type != REPLY_INTEGER) {
+            reply_free(reply);
+            pthread_mutex_unlock(&ctx->id_lock);
+            return -1;
+        }
+        ctx->id_limit = reply->integer;
+        ctx->next_id = reply->integer - ID_BLOCK + 1;
+        reply_free(reply);
+    }
+
+    int id = (int)ctx->next_id++;
+    pthread_mutex_unlock(&ctx->id_lock);
+    return id;
+}
+
+/* Connection for a write: the open batch's, or a pooled one */
+static RedisConnection *write_connection(RedisBackendContext *ctx) {
+    return ctx->batch ? ctx->batch : pool_acquire(ctx);
+}
+
+/* Send a write queued on conn, unless it belongs to the open batch */
+static int write_finish(RedisBackendContext *ctx, RedisConnection *conn, const char *what) {
+    if (conn == ctx->batch) {
+        return 0;
+    }
+
+    int result = conn_exchange(ctx, conn, what);
+    pool_release(ctx, conn);
+    return result;
+}
+
+/* ============================================================================
+ * Deferred hits
+ * ============================================================================ */
+
+/* Pending hit slot of key; with create, claims a free slot if key has none.
+ * Returns NULL if key has no slot (or the table is full). Caller holds
+ * pending_lock. */
+static RedisPendingHit *pending_slot(RedisBackendContext *ctx, const unsigned char *key,
+                                     bool create) {
+    uint64_t tag;
+    memcpy(&tag, key, sizeof(tag));
+
+    for (size_t probe = 0; probe < PENDING_HIT_SLOTS; probe++) {
+        RedisPendingHit *slot = &ctx->pending[(tag + probe) & (PENDING_HIT_SLOTS - 1)];
+        if (!slot->used) {
+            if (!create) {
+                return NULL;
+            }
+            memcpy(slot->key, key, TRANS_CACHE_DIGEST_SIZE);
+            slot->hits = 0;
+            slot->last_used = 0;
+            slot->used = true;
+            ctx->pending_count++;
+            return slot;
+        }
+        if (memcmp(slot->key, key, TRANS_CACHE_DIGEST_SIZE) == 0) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+/* Write pending hits in one MULTI/EXEC (caller holds pending_lock), so a
+ * failed flush leaves none of them applied */
+static int write_pending_hits(RedisBackendContext *ctx) {
+    RedisConnection *conn = pool_acquire(ctx);
+    if (!conn) {
+        return -1;
+    }
+
+    int folded = 0;
+    command_begin(conn, 1);
+    command_str(conn, "MULTI");
+    for (size_t i = 0; i < PENDING_HIT_SLOTS; i++) {
+        RedisPendingHit *slot = &ctx->pending[i];
+        if (slot->used && slot->hits > 0) {
+            queue_hits(ctx, conn, slot->key, slot->hits, slot->last_used);
+            folded++;
+        }
+    }
+    command_begin(conn, 1);
+    command_str(conn, "EXEC");
+
+    int result = folded > 0 ? conn_exchange(ctx, conn, "writing hits") : 0;
+    if (folded == 0) {
+        conn->out_len = 0;
+        conn->out_commands = 0;
+    }
+    pool_release(ctx, conn);
+
+    return result == 0 ? folded : -1;
+}
+
+/* Write all pending hits and clear the table. On error the hits stay
+ * pending. Lookups wait meanwhile, and lookups that read the table before
+ * retry (pending_flushes), so no hit is counted twice or missed. */
+static int flush_pending_hits(RedisBackendContext *ctx) {
+    pthread_mutex_lock(&ctx->pending_lock);
+
+    int folded = 0;
+    if (ctx->pending_count > 0) {
+        atomic_fetch_add(&ctx->pending_flushes, 1);
+        folded = write_pending_hits(ctx);
+        if (folded >= 0) {
+            memset(ctx->pending, 0, PENDING_HIT_SLOTS * sizeof(RedisPendingHit));
+            ctx->pending_count = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&ctx->pending_lock);
+    return folded;
+}
+
+/* Add a hit to the pending table. Returns false if the table is full. */
+static bool record_pending_hit(RedisBackendContext *ctx, const unsigned char *key,
+                               uint32_t now) {
+    pthread_mutex_lock(&ctx->pending_lock);
+
+    RedisPendingHit *pending = pending_slot(ctx, key, false);
+    if (!pending && ctx->pending_count < PENDING_HIT_MAX) {
+        pending = pending_slot(ctx, key, true);
+    }
+    if (pending) {
+        pending->hits++;
+        pending->last_used = now;
+    }
+
+    pthread_mutex_unlock(&ctx->pending_lock);
+    return pending != NULL;
+}
+
+/* ============================================================================
+ * Client tracking (hot tier invalidation)
+ * ============================================================================ */
+
+/* Connect the tracking connection: RESP3, with the server pushing an
+ * invalidation for every key under the prefix that any client changes
+ * (broadcast mode, so nothing has to be registered per key). */
+static int tracking_open(RedisBackendContext *ctx, RedisConnection *conn) {
+    if (conn_open(ctx, conn, true) != 0) {
+        return -1;
+    }
+
+    command_begin(conn, ctx->prefix_len > 0 ? 6 : 4);
+    command_str(conn, "CLIENT");
+    command_str(conn, "TRACKING");
+    command_str(conn, "ON");
+    command_str(conn, "BCAST");
+    if (ctx->prefix_len > 0) {
+        command_str(conn, "PREFIX");
+        command_str(conn, ctx->key_prefix);
+    }
+
+    RedisReply *reply = conn_call(ctx, conn, "enabling client tracking");
+    if (!reply) {
+        conn_close(conn);
+        return -1;
+    }
+    reply_free(reply);
+    return 0;
+}
+
+/* Drop all copies of the hot tier */
+static void tracking_reset(RedisBackendContext *ctx) {
+    hot_tier_clear(ctx->hot_tier);
+    atomic_fetch_add_explicit(&ctx->tracking_resets, 1, memory_order_relaxed);
+}
+
+/* Apply an invalidation push: drop the copies of the keys it names, or
+ * all copies if it names none (FLUSHDB / FLUSHALL) */
+static void handle_push(RedisBackendContext *ctx, const RedisReply *push) {
+    if (push->count < 2 || push->elements[0]->type != REPLY_STRING ||
+        strcmp(push->elements[0]->str, "invalidate") != 0) {
+        return;
+    }
+
+    const RedisReply *keys = push->elements[1];
+    if (keys->type == REPLY_NIL) {
+        tracking_reset(ctx);
+        return;
+    }
+    if (keys->type != REPLY_ARRAY) {
+        return;
+    }
+
+    unsigned char digest[TRANS_CACHE_DIGEST_SIZE];
+    for (size_t i = 0; i < keys->count; i++) {
+        const RedisReply *key = keys->elements[i];
+        if (key->type == REPLY_STRING && key_digest(ctx, key->str, key->len, digest)) {
+            hot_tier_invalidate(ctx->hot_tier, digest);
+            atomic_fetch_add_explicit(&ctx->invalidations, 1, memory_order_relaxed);
+        }
+    }
+}
+
+/* Wait up to ms unless tracking is being stopped. Returns false to stop. */
+static bool tracking_wait(RedisBackendContext *ctx, int ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&ctx->tracking_lock);
+    if (!ctx->tracking_stop) {
+        pthread_cond_timedwait(&ctx->tracking_cond, &ctx->tracking_lock, &deadline);
+    }
+    bool running = !ctx->tracking_stop;
+    pthread_mutex_unlock(&ctx->tracking_lock);
+
+    return running;
+}
+
+/* Whether tracking is being stopped */
+static bool tracking_stopping(RedisBackendContext *ctx) {
+    pthread_mutex_lock(&ctx->tracking_lock);
+    bool stop = ctx->tracking_stop;
+    pthread_mutex_unlock(&ctx->tracking_lock);
+    return stop;
+}
+
+/* Tracking thread: applies invalidation pushes, PINGs the connection when
+ * it is idle and reconnects when it is lost. Without a tracking connection
+ * changes by other nodes go unnoticed, so the hot tier is cleared when it
+ * is lost and again once it is back. */
+static void *tracking_main(void *arg) {
+    RedisBackendContext *ctx = (RedisBackendContext*)arg;
+    RedisConnection *conn = ctx->tracking;
+    long long last_active = monotonic_ms();
+    long long ping_sent = 0;            /* 0: no PING waiting for its reply */
+
+    while (!tracking_stopping(ctx)) {
+        if (conn->fd < 0) {
+            if (tracking_open(ctx, conn) != 0) {
+                tracking_wait(ctx, TRACKING_RETRY_MS);
+                continue;
+            }
+            tracking_reset(ctx);
+            atomic_store(&ctx->tracking_connected, true);
+            LOG_INFO("Redis tracking connection restored\n");
+            last_active = monotonic_ms();
+            ping_sent = 0;
+        }
+
+        /* Nothing buffered: wait for data, a bit at a time */
+        if (conn->in_start == conn->in_end) {
+            struct pollfd pfd = { .fd = conn->fd, .events = POLLIN };
+            int ready = poll(&pfd, 1, TRACKING_POLL_MS);
+            if (ready < 0 && errno != EINTR) {
+                ready = 1;              /* Let the read report the error */
+            }
+            if (ready <= 0) {
+                long long now = monotonic_ms();
+                if (ping_sent > 0 && now - ping_sent > ctx->timeout_ms) {
+                    LOG_DEBUG("Error: Redis tracking connection did not answer PING\n");
+                    conn_close(conn);
+                } else if (ping_sent == 0 && now - last_active >= TRACKING_PING_MS) {
+                    command_begin(conn, 1);
+                    command_str(conn, "PING");
+                    if (conn_send(ctx, conn) == 0) {
+                        ping_sent = now;
+                    }
+                }
+                if (conn->fd < 0) {
+                    goto lost;
+                }
+                continue;
+            }
+        }
+
+        RedisReply *reply = read_reply(conn, 0);
+        if (!reply) {
+            conn_close(conn);
+            goto lost;
+        }
+        if (reply->type == REPLY_PUSH) {
+            handle_push(ctx, reply);
+        } else {
+            ping_sent = 0;
+        }
+        reply_free(reply);
+        last_active = monotonic_ms();
+        continue;
+
+    lost:
+        if (!tracking_stopping(ctx)) {
+            LOG_INFO("Warning: Redis tracking connection lost, hot tier cleared until it is back\n");
+            atomic_store(&ctx->tracking_connected, false);
+            tracking_reset(ctx);
+        }
+    }
+
+    return NULL;
+}
+
+/* Stop the tracking thread and close its connection */
+static void stop_tracking(RedisBackendContext *ctx) {
+    if (!ctx->tracking_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&ctx->tracking_lock);
+    ctx->tracking_stop = true;
+    pthread_cond_signal(&ctx->tracking_cond);
+    pthread_mutex_unlock(&ctx->tracking_lock);
+
+    pthread_join(ctx->tracking_thread, NULL);
+    ctx->tracking_running = false;
+
+    conn_destroy(ctx->tracking);
+    free(ctx->tracking);
+    ctx->tracking = NULL;
+    ctx->hot_tier = NULL;
+    atomic_store(&ctx->tracking_connected, false);
+}
+
+/* Invalidate a hot tier's copies on changes by any client (NULL: stop) */
+static int redis_backend_attach_hot_tier(void *backend_ctx, CacheHotTier *tier) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+    if (!tier) {
+        stop_tracking(ctx);
+        return 0;
+    }
+    if (ctx->tracking_running) {
+        return -1;
+    }
+
+    RedisConnection *conn = calloc(1, sizeof(RedisConnection));
+    if (!conn) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return -1;
+    }
+    conn->fd = -1;
+
+    /* Servers before 6.0 have neither RESP3 nor client tracking */
+    if (tracking_open(ctx, conn) != 0) {
+        LOG_INFO("Warning: Redis client tracking unavailable (needs Redis 6 or later)\n");
+        conn_destroy(conn);
+        free(conn);
+        return -1;
+    }
+
+    ctx->tracking = conn;
+    ctx->hot_tier = tier;
+    ctx->tracking_stop = false;
+    atomic_store(&ctx->tracking_connected, true);
+
+    if (pthread_create(&ctx->tracking_thread, NULL, tracking_main, ctx) != 0) {
+        LOG_DEBUG("Error: Failed to start Redis tracking thread\n");
+        conn_destroy(conn);
+        free(conn);
+        ctx->tracking = NULL;
+        ctx->hot_tier = NULL;
+        atomic_store(&ctx->tracking_connected, false);
+        return -1;
+    }
+    ctx->tracking_running = true;
+
+    LOG_INFO("Redis client tracking enabled for keys '%s*'\n", ctx->key_prefix);
+    return 0;
+}
+
+/* ============================================================================
+ * Backend operations
+ * ============================================================================ */
+
+/* Parse redis://[[user]:password@]host[:port][/db], or host[:port], into
+ * ctx (host, user, password, port, db) */
+static int parse_url(RedisBackendContext *ctx, const char *url) {
+    const char *p = url;
+
+    /* Errors show the URL after its credentials */
+    const char *shown = strrchr(url, '@') ? strrchr(url, '@') + 1 : url;
+    (void)shown;    /* Unused when debug logging is compiled out */
+
+    if (strncmp(p, "redis://", 8) == 0) {
+        p += 8;
+    } else if (strstr(p, "://")) {
+        LOG_DEBUG("Error: Unsupported Redis URL scheme (redis:// only)\n");
+        return -1;
+    }
+
+    /* Credentials */
+    const char *at = strrchr(p, '@');
+    if (at) {
+        const char *colon = memchr(p, ':', (size_t)(at - p));
+        if (colon) {
+            ctx->user = colon > p ? strndup(p, (size_t)(colon - p)) : NULL;
+            ctx->password = strndup(colon + 1, (size_t)(at - colon - 1));
+            if (!ctx->password || (colon > p && !ctx->user)) {
+                return -1;
+            }
+        }
+        p = at + 1;
+    }
+
+    /* Host, [v6 address] or name */
+    const char *host_end;
+    if (*p == '[') {
+        host_end = strchr(p, ']');
+        if (!host_end) {
+            LOG_DEBUG("Error: Invalid Redis URL '%s'\n", shown);
+            return -1;
+        }
+        ctx->host = strndup(p + 1, (size_t)(host_end - p - 1));
+        p = host_end + 1;
+    } else {
+        host_end = p + strcspn(p, ":/");
+        ctx->host = strndup(p, (size_t)(host_end - p));
+        p = host_end;
+    }
+    if (!ctx->host) {
+        return -1;
+    }
+    if (ctx->host[0] == '\0') {
+        free(ctx->host);
+        ctx->host = strdup(DEFAULT_HOST);
+        if (!ctx->host) {
+            return -1;
+        }
+    }
+
+    /* Port and database */
+    char *end = (char *)p;
+    if (*p == ':') {
+        long port = strtol(p + 1, &end, 10);
+        if (end == p + 1 || port < 1 || port > 65535) {
+            LOG_DEBUG("Error: Invalid port in Redis URL '%s'\n", shown);
+            return -1;
+        }
+        ctx->port = (int)port;
+    }
+    if (*end == '/' && end[1] != '\0') {
+        const char *db = end + 1;
+        long index = strtol(db, &end, 10);
+        if (end == db || index < 0 || index > 65535) {
+            LOG_DEBUG("Error: Invalid database in Redis URL '%s'\n", shown);
+            return -1;
+        }
+        ctx->db = (int)index;
+    } else if (*end == '/') {
+        end++;
+    }
+    if (*end != '\0') {
+        LOG_DEBUG("Error: Invalid Redis URL '%s'\n", shown);
+        return -1;
+    }
+
+    return 0;
+}
+
+TransCache *redis_backend_init(const char *url, const RedisBackendOptions *options) {
+    const char *key_prefix = options && options->key_prefix ?
+                             options->key_prefix : DEFAULT_KEY_PREFIX;
+    if (strlen(key_prefix) > MAX_KEY_PREFIX) {
+        LOG_DEBUG("Error: Redis key prefix longer than %d bytes\n", MAX_KEY_PREFIX);
+        return NULL;
+    }
+
+    /* Allocate RedisBackendContext */
+    RedisBackendContext *ctx = calloc(1, sizeof(RedisBackendContext));
+    if (!ctx) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return NULL;
+    }
+
+    pthread_mutex_init(&ctx->pool_lock, NULL);
+    pthread_cond_init(&ctx->pool_cond, NULL);
+    pthread_mutex_init(&ctx->id_lock, NULL);
+    pthread_mutex_init(&ctx->pending_lock, NULL);
+    pthread_mutex_init(&ctx->tracking_lock, NULL);
+    pthread_cond_init(&ctx->tracking_cond, NULL);
+    atomic_init(&ctx->pending_flushes, 0);
+    atomic_init(&ctx->tracking_connected, false);
+    atomic_init(&ctx->commands, 0);
+    atomic_init(&ctx->pipelines, 0);
+    atomic_init(&ctx->errors, 0);
+    atomic_init(&ctx->reconnects, 0);
+    atomic_init(&ctx->invalidations, 0);
+    atomic_init(&ctx->tracking_resets, 0);
+
+    /* Settings with defaults filled in */
+    ctx->port = DEFAULT_PORT;
+    if (parse_url(ctx, url ? url : "") != 0) {
+        redis_backend_free(ctx);
+        return NULL;
+    }
+    int pool_size = options && options->pool_size > 0 ? options->pool_size : DEFAULT_POOL_SIZE;
+    if (pool_size < MIN_POOL_SIZE) {
+        pool_size = MIN_POOL_SIZE;
+    } else if (pool_size > MAX_POOL_SIZE) {
+        pool_size = MAX_POOL_SIZE;
+    }
+    ctx->timeout_ms = options && options->timeout_ms > 0 ? options->timeout_ms : DEFAULT_TIMEOUT_MS;
+    ctx->ttl_seconds = options && options->ttl_seconds > 0 ? options->ttl_seconds : 0;
+    ctx->key_prefix = strdup(key_prefix);
+    ctx->prefix_len = strlen(key_prefix);
+    ctx->next_id = 1;
+    ctx->id_limit = 0;
+
+    ctx->pending = calloc(PENDING_HIT_SLOTS, sizeof(RedisPendingHit));
+    ctx->connections = calloc((size_t)pool_size, sizeof(RedisConnection));
+    if (!ctx->key_prefix || !ctx->pending || !ctx->connections) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        redis_backend_free(ctx);
+        return NULL;
+    }
+    ctx->connection_count = (size_t)pool_size;
+
+    /* Open the pool (a server that cannot be reached fails here) */
+    for (size_t i = 0; i < ctx->connection_count; i++) {
+        RedisConnection *conn = &ctx->connections[i];
+        conn->fd = -1;
+        conn->next = ctx->idle_connections;
+        ctx->idle_connections = conn;
+    }
+    for (size_t i = 0; i < ctx->connection_count; i++) {
+        if (conn_open(ctx, &ctx->connections[i], false) != 0) {
+            LOG_DEBUG("Error: Cannot connect to Redis at %s:%d\n", ctx->host, ctx->port);
+            redis_backend_free(ctx);
+            return NULL;
+        }
+    }
+
+    /* One shard: the pool is shared by all keys */
+    void *slices[1] = { ctx };
+    TransCache *cache = trans_cache_create(CACHE_BACKEND_REDIS, redis_backend_get_ops(),
+                                           ctx, slices, 1);
+    if (!cache) {
+        redis_backend_free(ctx);
+        return NULL;
+    }
+
+    char ttl[32];
+    if (ctx->ttl_seconds > 0) {
+        snprintf(ttl, sizeof(ttl), "%lld s", ctx->ttl_seconds);
+    } else {
+        snprintf(ttl, sizeof(ttl), "none");
+    }
+    LOG_INFO("Redis cache initialized: %s:%d/%d (%zu connections, prefix '%s', ttl %s)\n",
+             ctx->host, ctx->port, ctx->db, ctx->connection_count, ctx->key_prefix, ttl);
+
+    return cache;
+}
+
+/* Lookup cache entry without the shard lock. The returned copy is retired
+ * right away and freed after the caller's read section. */
+static CacheEntry* redis_backend_lookup(void *backend_ctx, const unsigned char *key) {
+    if (!backend_ctx || !key) {
+        return NULL;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+
+    for (;;) {
+        /* Hits not written yet, so the threshold sees every hit of this node */
+        pthread_mutex_lock(&ctx->pending_lock);
+        unsigned int flushes = atomic_load(&ctx->pending_flushes);
+        RedisPendingHit *pending = pending_slot(ctx, key, false);
+        uint32_t hits = pending ? pending->hits : 0;
+        uint32_t hit_time = pending ? pending->last_used : 0;
+        pthread_mutex_unlock(&ctx->pending_lock);
+
+        CacheEntry *entry = read_entry(ctx, key);
+        if (!entry) {
+            return NULL;
+        }
+
+        /* A flush wrote those hits meanwhile: the hash may hold them */
+        if (atomic_load(&ctx->pending_flushes) != flushes) {
+            redis_entry_free(entry);
+            continue;
+        }
+
+        entry->count += (int)hits;
+        if (hit_time > entry->last_used) {
+            entry->last_used = hit_time;
+        }
+
+        epoch_retire(entry, redis_entry_free);
+        return entry;
+    }
+}
+
+/* Add new cache entry (queued if a batch is open) */
+static int redis_backend_add(void *backend_ctx,
+                             const unsigned char *key,
+                             const char *from_lang,
+                             const char *to_lang,
+                             const char *source_text,
+                             const char *translated_text) {
+    if (!backend_ctx || !key || !from_lang || !to_lang || !source_text || !translated_text) {
+        return -1;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+
+    int id = reserve_id(ctx);
+    if (id < 0) {
+        return -1;
+    }
+
+    RedisConnection *conn = write_connection(ctx);
+    if (!conn) {
+        return -1;
+    }
+
+    uint32_t now = (uint32_t)time(NULL);
+    queue_entry(ctx, conn, key, id, from_lang, to_lang, source_text, translated_text,
+                1, now, now);
+    return write_finish(ctx, conn, "inserting cache entry");
+}
+
+/* Record a hit in the pending table; the count is bumped by the next
+ * flush (or right away if the table cannot take it) */
+static int redis_backend_update_count(void *backend_ctx, CacheEntry *entry) {
+    if (!backend_ctx || !entry) {
+        return -1;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+
+    /* Increment count and update last_used of the looked-up copy */
+    uint32_t now = (uint32_t)time(NULL);
+    entry->count++;
+    entry->last_used = now;
+
+    if (record_pending_hit(ctx, entry->key, now)) {
+        return 0;
+    }
+
+    /* Table full: write it out early */
+    if (flush_pending_hits(ctx) >= 0 && record_pending_hit(ctx, entry->key, now)) {
+        return 0;
+    }
+
+    RedisConnection *conn = pool_acquire(ctx);
+    if (!conn) {
+        return -1;
+    }
+    queue_hits(ctx, conn, entry->key, 1, now);
+    int result = conn_exchange(ctx, conn, "updating count");
+    pool_release(ctx, conn);
+    return result;
+}
+
+/* Write deferred hits in one MULTI/EXEC */
+static int redis_backend_flush_hits(void *backend_ctx) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    return flush_pending_hits((RedisBackendContext*)backend_ctx);
+}
+
+/* Update cache entry translation (queued if a batch is open) */
+static int redis_backend_update_translation(void *backend_ctx,
+                                            CacheEntry *entry,
+                                            const char *new_translation) {
+    if (!backend_ctx || !entry || !new_translation) {
+        return -1;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+
+    /* The looked-up copy keeps its text (readers may hold it); reset
+     * count to 1 and update last_used */
+    uint32_t now = (uint32_t)time(NULL);
+    entry->count = 1;
+    entry->last_used = now;
+
+    /* Hits on the old translation no longer count */
+    pthread_mutex_lock(&ctx->pending_lock);
+    RedisPendingHit *pending = pending_slot(ctx, entry->key, false);
+    if (pending) {
+        pending->hits = 0;
+        pending->last_used = 0;
+    }
+    pthread_mutex_unlock(&ctx->pending_lock);
+
+    RedisConnection *conn = write_connection(ctx);
+    if (!conn) {
+        return -1;
+    }
+
+    queue_entry(ctx, conn, entry->key, entry->id, trans_cache_entry_from_lang(entry),
+                trans_cache_entry_to_lang(entry), entry->source_text, new_translation,
+                1, now, entry->created_at);
+    return write_finish(ctx, conn, "updating translation");
+}
+
+/* Start a write-behind batch: the writes until end_batch are queued on one
+ * connection inside MULTI and sent together */
+static int redis_backend_begin_batch(void *backend_ctx) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+    if (ctx->batch) {
+        return -1;
+    }
+
+    RedisConnection *conn = pool_acquire(ctx);
+    if (!conn) {
+        return -1;
+    }
+
+    command_begin(conn, 1);
+    command_str(conn, "MULTI");
+    ctx->batch = conn;
+    return 0;
+}
+
+/* Send a write-behind batch in one round trip; EXEC applies all of its
+ * writes or none */
+static int redis_backend_end_batch(void *backend_ctx) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+    RedisConnection *conn = ctx->batch;
+    if (!conn) {
+        return -1;
+    }
+    ctx->batch = NULL;
+
+    int result = 0;
+    if (conn->out_commands > 1) {
+        command_begin(conn, 1);
+        command_str(conn, "EXEC");
+        result = conn_exchange(ctx, conn, "committing batch");
+    } else {
+        /* Nothing written: drop the MULTI */
+        conn->out_len = 0;
+        conn->out_commands = 0;
+    }
+
+    pool_release(ctx, conn);
+    return result;
+}
+
+/* Save cache: writes reach the server as they are made (deferred hits by
+ * flush_hits before every save); persisting them is up to the server's
+ * RDB / AOF settings */
+static int redis_backend_save(TransCache *cache) {
+    if (!cache || !cache->backend_ctx) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Cleanup old cache entries: every write sets the entry's TTL, so the
+ * server removes unused entries itself and there is nothing to do here */
+static int redis_backend_cleanup(void *backend_ctx, int days_threshold) {
+    (void)backend_ctx;
+    (void)days_threshold;
+    return 0;
+}
+
+/* Stats counters over the scanned entries */
+typedef struct {
+    size_t total;
+    size_t active;
+    size_t expired;
+    int threshold;
+    uint32_t expired_before;
+} EntryTally;
+
+static int tally_entry(CacheEntry *entry, void *user_data) {
+    EntryTally *tally = (EntryTally*)user_data;
+
+    tally->total++;
+    if (entry->count >= tally->threshold) {
+        tally->active++;
+    }
+    if (entry->last_used < tally->expired_before) {
+        tally->expired++;
+    }
+    return 0;
+}
+
+/* Get cache statistics: counts every entry under the prefix (SCAN, shared
+ * by all nodes), so it takes time proportional to the cache size */
+static void redis_backend_stats(void *backend_ctx,
+                                size_t *total_entries,
+                                size_t *active_entries,
+                                size_t *expired_entries,
+                                int cache_threshold,
+                                int days_threshold) {
+    if (!backend_ctx) {
+        return;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+    time_t now = time(NULL);
+    EntryTally tally = {
+        .threshold = cache_threshold,
+        .expired_before = (uint32_t)(now - (time_t)days_threshold * 24 * 60 * 60)
+    };
+
+    if (scan_entries(ctx, false, tally_entry, &tally) < 0) {
+        LOG_DEBUG("Error: Failed to scan Redis cache entries\n");
+    }
+
+    if (total_entries) *total_entries = tally.total;
+    if (active_entries) *active_entries = tally.active;
+    if (expired_entries) *expired_entries = tally.expired;
+}
+
+/* Connection, pipelining and tracking metrics */
+static cJSON *redis_backend_metrics(TransCache *cache) {
+    if (!cache || !cache->backend_ctx) {
+        return NULL;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)cache->backend_ctx;
+    cJSON *metrics = cJSON_CreateObject();
+    if (!metrics) {
+        return NULL;
+    }
+
+    size_t idle = 0;
+    pthread_mutex_lock(&ctx->pool_lock);
+    for (RedisConnection *conn = ctx->idle_connections; conn; conn = conn->next) {
+        idle++;
+    }
+    pthread_mutex_unlock(&ctx->pool_lock);
+
+    char server[300];
+    snprintf(server, sizeof(server), "%s:%d/%d", ctx->host, ctx->port, ctx->db);
+
+    cJSON_AddStringToObject(metrics, "server", server);
+    cJSON_AddStringToObject(metrics, "key_prefix", ctx->key_prefix);
+    cJSON_AddNumberToObject(metrics, "ttl_seconds", (double)ctx->ttl_seconds);
+    cJSON_AddNumberToObject(metrics, "connections", (double)ctx->connection_count);
+    cJSON_AddNumberToObject(metrics, "idle_connections", (double)idle);
+    cJSON_AddNumberToObject(metrics, "commands",
+                            (double)atomic_load_explicit(&ctx->commands, memory_order_relaxed));
+    cJSON_AddNumberToObject(metrics, "pipelines",
+                            (double)atomic_load_explicit(&ctx->pipelines, memory_order_relaxed));
+    cJSON_AddNumberToObject(metrics, "errors",
+                            (double)atomic_load_explicit(&ctx->errors, memory_order_relaxed));
+    cJSON_AddNumberToObject(metrics, "reconnects",
+                            (double)atomic_load_explicit(&ctx->reconnects, memory_order_relaxed));
+    cJSON_AddBoolToObject(metrics, "tracking", ctx->tracking_running);
+    cJSON_AddBoolToObject(metrics, "tracking_connected",
+                          atomic_load(&ctx->tracking_connected));
+    cJSON_AddNumberToObject(metrics, "invalidations",
+                            (double)atomic_load_explicit(&ctx->invalidations,
+                                                         memory_order_relaxed));
+    cJSON_AddNumberToObject(metrics, "tracking_resets",
+                            (double)atomic_load_explicit(&ctx->tracking_resets,
+                                                         memory_order_relaxed));
+
+    return metrics;
+}
+
+/* Free Redis backend */
+static void redis_backend_free(void *backend_ctx) {
+    if (!backend_ctx) {
+        return;
+    }
+
+    RedisBackendContext *ctx = (RedisBackendContext*)backend_ctx;
+
+    stop_tracking(ctx);
+
+    /* Write hits recorded since the last flush */
+    if (ctx->pending && ctx->connections) {
+        flush_pending_hits(ctx);
+    }
+
+    /* Close connections */
+    for (size_t i = 0; i < ctx->connection_count; i++) {
+        conn_destroy(&ctx->connections[i]);
+    }
+    free(ctx->connections);
+
+    /* Free context */
+    pthread_mutex_destroy(&ctx->pool_lock);
+    pthread_cond_destroy(&ctx->pool_cond);
+    pthread_mutex_destroy(&ctx->id_lock);
+    pthread_mutex_destroy(&ctx->pending_lock);
+    pthread_mutex_destroy(&ctx->tracking_lock);
+    pthread_cond_destroy(&ctx->tracking_cond);
+    free(ctx->pending);
+    free(ctx->key_prefix);
+    free(ctx->password);
+    free(ctx->user);
+    free(ctx->host);
+    free(ctx);
+}
+
+/* Visit every entry on the server */
+long redis_backend_foreach(TransCache *cache,
+                           int (*callback)(CacheEntry *entry, void *user_data),
+                           void *user_data) {
+    if (!cache || cache->type != CACHE_BACKEND_REDIS || !cache->backend_ctx || !callback) {
+        return -1;
+    }
+
+    return scan_entries((RedisBackendContext*)cache->backend_ctx, true, callback, user_data);
+}
+
+/* Get backend operations */
+CacheBackendOps *redis_backend_get_ops(void) {
+    static CacheBackendOps ops = {
+        .lookup = redis_backend_lookup,
+        .add = redis_backend_add,
+        .update_count = redis_backend_update_count,
+        .flush_hits = redis_backend_flush_hits,
+        .update_translation = redis_backend_update_translation,
+        .begin_batch = redis_backend_begin_batch,
+        .end_batch = redis_backend_end_batch,
+        .save = redis_backend_save,
+        .cleanup = redis_backend_cleanup,
+        .stats = redis_backend_stats,
+        .metrics = redis_backend_metrics,
+        .attach_hot_tier = redis_backend_attach_hot_tier,
+        .free_backend = redis_backend_free,
+        .concurrent_lookup = true,          /* Pooled connections */
+        .concurrent_update_count = true,    /* Pending table has its own lock */
+        .lookup_copies = true               /* Hash read into a new entry */
+    };
+    return &ops;
+}
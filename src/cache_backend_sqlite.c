@@ -1,170 +1,368 @@
 /**
  * SQLite backend implementation for translation cache.
  * Uses prepared statements for high performance and SQL injection protection.
+ * Writes go through one connection under the shard write lock; lookups run
+ * without that lock on a pool of read-only connections, in parallel under
+ * WAL. Cache hits are collected in memory and written in one transaction
+ * by flush_hits instead of one UPDATE per hit.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
+#include <sys/stat.h>
 #include <sqlite3.h>
 #include "cache_backend_sqlite.h"
 #include "trans_cache.h"
+#include "epoch.h"
 #include "utils.h"
 
+#define DEFAULT_JOURNAL_MODE "WAL"
+#define DEFAULT_SYNC_MODE "NORMAL"
+#define DEFAULT_READ_CONNECTIONS 8
+#define MAX_READ_CONNECTIONS 256
+#define DEFAULT_PAGE_SIZE 4096
+#define DEFAULT_CACHE_SIZE_KB 8192
+#define DEFAULT_MMAP_SIZE (256LL * 1024 * 1024)
+#define DEFAULT_TEMP_STORE "MEMORY"
+#define DEFAULT_BUSY_TIMEOUT_MS 5000            /* Wait for locks held by other connections */
+#define DEFAULT_CHECKPOINT_MODE "PASSIVE"
+#define WAL_AUTOCHECKPOINT_PAGES 16384          /* Writer checkpoints itself only past this */
+#define PENDING_HIT_SLOTS 8192                  /* Power of two */
+#define PENDING_HIT_MAX (PENDING_HIT_SLOTS / 2) /* Flush early beyond this */
+
 /* Forward declarations of backend operations */
-static CacheEntry* sqlite_backend_lookup(void *ctx, const char *from_lang,
-                                          const char *to_lang, const char *text);
-static int sqlite_backend_add(void *ctx, const char *from_lang, const char *to_lang,
+static CacheEntry* sqlite_backend_lookup(void *ctx, const unsigned char *key);
+static int sqlite_backend_add(void *ctx, const unsigned char *key,
+                               const char *from_lang, const char *to_lang,
                                const char *source_text, const char *translated_text);
 static int sqlite_backend_update_count(void *ctx, CacheEntry *entry);
+static int sqlite_backend_flush_hits(void *ctx);
 static int sqlite_backend_update_translation(void *ctx, CacheEntry *entry,
                                               const char *new_translation);
-static int sqlite_backend_save(void *ctx);
+static int sqlite_backend_save(TransCache *cache);
 static int sqlite_backend_cleanup(void *ctx, int days_threshold);
 static void sqlite_backend_stats(void *ctx, size_t *total_entries,
                                   size_t *active_entries, size_t *expired_entries,
                                   int cache_threshold, int days_threshold);
+static cJSON *sqlite_backend_metrics(TransCache *cache);
 static void sqlite_backend_free(void *ctx);
 
-/* SQL schema and statements */
+/* Schema version (PRAGMA user_version). 0 or 1: TEXT hash with rowid and
+ * five indexes; 2: BLOB key WITHOUT ROWID, no secondary index. */
+#define SCHEMA_VERSION 2
+#define SQL_SET_SCHEMA_VERSION "PRAGMA user_version = 2;"
+
+/* SQL schema and statements. The 32-byte digest is the primary key, so a
+ * row lives in the key's B-tree and lookups, inserts and hit updates touch
+ * only that one tree. Cleanup and statistics scan the table instead of
+ * keeping last_used / count indexes current on every hit. */
 static const char *SQL_CREATE_TABLE =
     "CREATE TABLE IF NOT EXISTS trans_cache ("
-    "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
-    "  hash TEXT NOT NULL UNIQUE,"
+    "  hash BLOB NOT NULL PRIMARY KEY,"
+    "  id INTEGER NOT NULL,"
     "  from_lang TEXT NOT NULL,"
     "  to_lang TEXT NOT NULL,"
     "  source_text TEXT NOT NULL,"
     "  translated_text TEXT NOT NULL,"
-    "  count INTEGER DEFAULT 1,"
+    "  count INTEGER NOT NULL DEFAULT 1,"
     "  last_used INTEGER NOT NULL,"
     "  created_at INTEGER NOT NULL,"
-    "  CHECK(length(hash) = 64),"
+    "  CHECK(length(hash) = 32),"
     "  CHECK(length(from_lang) = 3),"
     "  CHECK(length(to_lang) = 3),"
     "  CHECK(count >= 1)"
-    ");";
+    ") WITHOUT ROWID;";
 
-static const char *SQL_CREATE_INDEX_HASH =
-    "CREATE UNIQUE INDEX IF NOT EXISTS idx_hash ON trans_cache(hash);";
+/* Run sql on db, logging failures as "Error <what>" */
+static int exec_sql(sqlite3 *db, const char *sql, const char *what) {
+    (void)what;     /* Unused when debug logging is compiled out */
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_DEBUG("Error %s: %s\n", what, err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
 
-static const char *SQL_CREATE_INDEX_LANG_PAIR =
-    "CREATE INDEX IF NOT EXISTS idx_lang_pair ON trans_cache(from_lang, to_lang);";
+/* Integer result of a PRAGMA query (-1 on error) */
+static long long pragma_int(sqlite3 *db, const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    long long value = -1;
 
-static const char *SQL_CREATE_INDEX_LAST_USED =
-    "CREATE INDEX IF NOT EXISTS idx_last_used ON trans_cache(last_used);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        value = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
 
-static const char *SQL_CREATE_INDEX_COUNT =
-    "CREATE INDEX IF NOT EXISTS idx_count ON trans_cache(count DESC);";
+    return value;
+}
 
-static const char *SQL_CREATE_INDEX_LANG_HASH =
-    "CREATE INDEX IF NOT EXISTS idx_lang_hash ON trans_cache(from_lang, to_lang, hash);";
+/* Whether the trans_cache table exists (-1 on error) */
+static int table_exists(sqlite3 *db) {
+    sqlite3_stmt *stmt = NULL;
+    const char *sql =
+        "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'trans_cache';";
 
-/* Apply database schema */
-static int apply_schema(sqlite3 *db) {
-    char *err_msg = NULL;
-    int rc;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        LOG_DEBUG("Error reading schema: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
 
-    /* Create table */
-    rc = sqlite3_exec(db, SQL_CREATE_TABLE, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        LOG_DEBUG("Error creating table: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        LOG_DEBUG("Error reading schema: %s\n", sqlite3_errmsg(db));
         return -1;
     }
+    return rc == SQLITE_ROW;
+}
 
-    /* Create indexes */
-    const char *indexes[] = {
-        SQL_CREATE_INDEX_HASH,
-        SQL_CREATE_INDEX_LANG_PAIR,
-        SQL_CREATE_INDEX_LAST_USED,
-        SQL_CREATE_INDEX_COUNT,
-        SQL_CREATE_INDEX_LANG_HASH
-    };
+/* Copy v1 rows into the v2 table (hex hash -> 32-byte key). Rows whose
+ * hash is not valid hex are skipped. Returns rows copied or -1. */
+static int copy_v1_rows(sqlite3 *db) {
+    sqlite3_stmt *select = NULL;
+    sqlite3_stmt *insert = NULL;
+    int copied = 0;
+    int skipped = 0;
+    int result = -1;
 
-    for (size_t i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++) {
-        rc = sqlite3_exec(db, indexes[i], NULL, NULL, &err_msg);
-        if (rc != SQLITE_OK) {
-            LOG_DEBUG("Error creating index: %s\n", err_msg);
-            sqlite3_free(err_msg);
-            return -1;
+    const char *sql_select =
+        "SELECT id, hash, from_lang, to_lang, source_text, translated_text, "
+        "COALESCE(count, 1), last_used, created_at FROM trans_cache_v1;";
+    const char *sql_insert =
+        "INSERT OR IGNORE INTO trans_cache (hash, id, from_lang, to_lang, source_text, "
+        "translated_text, count, last_used, created_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
+
+    if (sqlite3_prepare_v2(db, sql_select, -1, &select, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, sql_insert, -1, &insert, NULL) != SQLITE_OK) {
+        LOG_DEBUG("Error preparing migration statements: %s\n", sqlite3_errmsg(db));
+        goto done;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(select)) == SQLITE_ROW) {
+        const char *hash = (const char*)sqlite3_column_text(select, 1);
+        unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+
+        if (trans_cache_hex_to_digest(hash, key) != 0) {
+            skipped++;
+            continue;
+        }
+
+        sqlite3_reset(insert);
+        sqlite3_bind_blob(insert, 1, key, TRANS_CACHE_DIGEST_SIZE, SQLITE_STATIC);
+        for (int col = 0; col < 9; col++) {
+            if (col != 1) {
+                sqlite3_bind_value(insert, col == 0 ? 2 : col + 1,
+                                   sqlite3_column_value(select, col));
+            }
         }
+
+        if (sqlite3_step(insert) != SQLITE_DONE) {
+            LOG_DEBUG("Error migrating cache entry: %s\n", sqlite3_errmsg(db));
+            goto done;
+        }
+        copied++;
     }
 
-    return 0;
+    if (rc != SQLITE_DONE) {
+        LOG_DEBUG("Error reading v1 cache entries: %s\n", sqlite3_errmsg(db));
+        goto done;
+    }
+
+    if (skipped > 0) {
+        LOG_INFO("Warning: Skipped %d cache entries with an invalid hash\n", skipped);
+    }
+    result = copied;
+
+done:
+    sqlite3_finalize(select);
+    sqlite3_finalize(insert);
+    return result;
 }
 
-/* Apply PRAGMA optimizations */
-static int apply_pragmas(sqlite3 *db, const char *journal_mode, const char *sync_mode) {
-    char *err_msg = NULL;
-    char pragma_sql[256];
-    int rc;
+/* Rebuild a v1 table (TEXT hash, rowid, five indexes) as v2, in one
+ * transaction, then VACUUM to give the freed pages back */
+static int migrate_v1(sqlite3 *db) {
+    LOG_INFO("Migrating SQLite cache schema to version %d...\n", SCHEMA_VERSION);
 
-    /* Set journal mode (WAL, DELETE, etc.) */
-    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA journal_mode=%s;", journal_mode);
-    rc = sqlite3_exec(db, pragma_sql, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        LOG_DEBUG("Error setting journal_mode: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    if (exec_sql(db, "BEGIN IMMEDIATE;", "starting migration") != 0) {
         return -1;
     }
 
-    /* Set synchronous mode (FULL, NORMAL, OFF) */
-    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA synchronous=%s;", sync_mode);
-    rc = sqlite3_exec(db, pragma_sql, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        LOG_DEBUG("Error setting synchronous: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    int copied = -1;
+    if (exec_sql(db, "ALTER TABLE trans_cache RENAME TO trans_cache_v1;",
+                 "renaming v1 table") == 0 &&
+        exec_sql(db, SQL_CREATE_TABLE, "creating table") == 0) {
+        copied = copy_v1_rows(db);
+    }
+
+    if (copied < 0 ||
+        exec_sql(db, "DROP TABLE trans_cache_v1;", "dropping v1 table") != 0 ||
+        exec_sql(db, SQL_SET_SCHEMA_VERSION, "setting schema version") != 0 ||
+        exec_sql(db, "COMMIT;", "committing migration") != 0) {
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
         return -1;
     }
 
-    /* Set cache size (2000 pages = ~2MB with 1KB page size) */
-    rc = sqlite3_exec(db, "PRAGMA cache_size=2000;", NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        LOG_DEBUG("Error setting cache_size: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    /* Not fatal: the file just keeps its old size */
+    if (exec_sql(db, "VACUUM;", "compacting database") != 0) {
+        LOG_INFO("Warning: VACUUM after schema migration failed\n");
+    }
+
+    LOG_INFO("SQLite cache schema migrated: %d entries\n", copied);
+    return 0;
+}
+
+/* Create the schema, or migrate an older one (PRAGMA user_version) */
+static int apply_schema(sqlite3 *db) {
+    int version = (int)pragma_int(db, "PRAGMA user_version;");
+    int exists = table_exists(db);
+    if (version < 0 || exists < 0) {
         return -1;
     }
 
-    /* Set memory-mapped I/O (256MB) */
-    rc = sqlite3_exec(db, "PRAGMA mmap_size=268435456;", NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        LOG_DEBUG("Error setting mmap_size: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    if (version > SCHEMA_VERSION) {
+        LOG_INFO("Error: SQLite cache schema version %d is newer than supported (%d)\n",
+                 version, SCHEMA_VERSION);
+        return -1;
+    }
+
+    if (exists && version < SCHEMA_VERSION) {
+        return migrate_v1(db);
+    }
+
+    if (exec_sql(db, SQL_CREATE_TABLE, "creating table") != 0) {
+        return -1;
+    }
+    if (version < SCHEMA_VERSION &&
+        exec_sql(db, SQL_SET_SCHEMA_VERSION, "setting schema version") != 0) {
         return -1;
     }
 
     return 0;
 }
 
-/* Prepare all SQL statements */
-static int prepare_statements(SqliteBackendContext *ctx) {
-    int rc;
+/* Apply per-connection cache settings (writer, readers and checkpointer) */
+static int apply_connection_pragmas(sqlite3 *db, const SqliteBackendOptions *opts) {
+    char pragma_sql[128];
 
-    /* Lookup by hash */
-    const char *sql_lookup =
-        "SELECT id, hash, from_lang, to_lang, source_text, translated_text, "
-        "count, last_used, created_at FROM trans_cache WHERE hash = ?;";
-    rc = sqlite3_prepare_v2(ctx->db, sql_lookup, -1, &ctx->stmt_lookup, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_DEBUG("Error preparing lookup statement: %s\n", sqlite3_errmsg(ctx->db));
+    sqlite3_busy_timeout(db, opts->busy_timeout_ms);
+
+    /* Negative cache_size is in KiB, independent of the page size */
+    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA cache_size=-%d;", opts->cache_size_kb);
+    if (exec_sql(db, pragma_sql, "setting cache_size") != 0) {
+        return -1;
+    }
+
+    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA mmap_size=%lld;", opts->mmap_size);
+    if (exec_sql(db, pragma_sql, "setting mmap_size") != 0) {
+        return -1;
+    }
+
+    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA temp_store=%s;", opts->temp_store);
+    return exec_sql(db, pragma_sql, "setting temp_store");
+}
+
+/* Apply PRAGMA optimizations (writer connection). Sets *wal if the journal
+ * ended up in WAL mode (it may not, e.g. on file systems without shared
+ * memory). */
+static int apply_pragmas(sqlite3 *db, const SqliteBackendOptions *opts, bool *wal) {
+    char pragma_sql[128];
+    sqlite3_stmt *stmt = NULL;
+
+    /* Set journal mode (WAL, DELETE, etc.); the result is the mode in effect */
+    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA journal_mode=%s;", opts->journal_mode);
+    if (sqlite3_prepare_v2(db, pragma_sql, -1, &stmt, NULL) != SQLITE_OK ||
+        sqlite3_step(stmt) != SQLITE_ROW) {
+        LOG_DEBUG("Error setting journal_mode: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+    const char *mode = (const char*)sqlite3_column_text(stmt, 0);
+    *wal = mode && strcasecmp(mode, "wal") == 0;
+    if (strcasecmp(opts->journal_mode, "WAL") == 0 && !*wal) {
+        LOG_INFO("Warning: SQLite cache could not enable WAL (journal mode %s)\n",
+                 mode ? mode : "unknown");
+    }
+    sqlite3_finalize(stmt);
+
+    /* Set synchronous mode (FULL, NORMAL, OFF) */
+    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA synchronous=%s;", opts->sync_mode);
+    if (exec_sql(db, pragma_sql, "setting synchronous") != 0) {
+        return -1;
+    }
+
+    /* Checkpoints run from save; commits only checkpoint if those fall far behind */
+    if (*wal) {
+        snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA wal_autocheckpoint=%d;",
+                 WAL_AUTOCHECKPOINT_PAGES);
+        if (exec_sql(db, pragma_sql, "setting wal_autocheckpoint") != 0) {
+            return -1;
+        }
+    }
+
+    return apply_connection_pragmas(db, opts);
+}
+
+/* Storage layout of new databases (writer connection, before the schema).
+ * page_size and auto_vacuum only take effect before the first table is
+ * created, or on the next VACUUM (page_size not in WAL mode). */
+static int apply_storage_layout(sqlite3 *db, const SqliteBackendOptions *opts) {
+    char pragma_sql[64];
+
+    snprintf(pragma_sql, sizeof(pragma_sql), "PRAGMA page_size=%d;", opts->page_size);
+    if (exec_sql(db, pragma_sql, "setting page_size") != 0) {
         return -1;
     }
 
+    /* Cleanup returns the pages it frees (incremental_vacuum) */
+    return exec_sql(db, "PRAGMA auto_vacuum=INCREMENTAL;", "setting auto_vacuum");
+}
+
+/* Convert a database created without incremental auto-vacuum (one VACUUM,
+ * the first time only). Sets ctx->incremental_vacuum. */
+static void enable_incremental_vacuum(SqliteBackendContext *ctx) {
+    if (pragma_int(ctx->db, "PRAGMA auto_vacuum;") != 2) {
+        LOG_INFO("Converting SQLite cache to incremental auto-vacuum (one-time VACUUM)...\n");
+        if (exec_sql(ctx->db, "VACUUM;", "converting auto_vacuum") != 0) {
+            LOG_INFO("Warning: SQLite cache keeps its auto_vacuum mode (VACUUM failed)\n");
+        }
+    }
+
+    ctx->incremental_vacuum = pragma_int(ctx->db, "PRAGMA auto_vacuum;") == 2;
+}
+
+/* SQL of the lookup statement (prepared on every reader) */
+static const char *SQL_LOOKUP =
+    "SELECT id, from_lang, to_lang, source_text, translated_text, "
+    "count, last_used, created_at FROM trans_cache WHERE hash = ?;";
+
+/* Prepare all SQL statements of the writer connection */
+static int prepare_statements(SqliteBackendContext *ctx) {
+    int rc;
+
     /* Insert new entry */
     const char *sql_insert =
-        "INSERT INTO trans_cache (hash, from_lang, to_lang, source_text, "
+        "INSERT INTO trans_cache (hash, id, from_lang, to_lang, source_text, "
         "translated_text, count, last_used, created_at) "
-        "VALUES (?, ?, ?, ?, ?, 1, ?, ?);";
+        "VALUES (?, ?, ?, ?, ?, ?, 1, ?, ?);";
     rc = sqlite3_prepare_v2(ctx->db, sql_insert, -1, &ctx->stmt_insert, NULL);
     if (rc != SQLITE_OK) {
         LOG_DEBUG("Error preparing insert statement: %s\n", sqlite3_errmsg(ctx->db));
         return -1;
     }
 
-    /* Update count and last_used */
+    /* Add deferred hits to count and advance last_used */
     const char *sql_update_count =
-        "UPDATE trans_cache SET count = ?, last_used = ? WHERE hash = ?;";
+        "UPDATE trans_cache SET count = count + ?, last_used = MAX(last_used, ?) "
+        "WHERE hash = ?;";
     rc = sqlite3_prepare_v2(ctx->db, sql_update_count, -1, &ctx->stmt_update_count, NULL);
     if (rc != SQLITE_OK) {
         LOG_DEBUG("Error preparing update_count statement: %s\n", sqlite3_errmsg(ctx->db));
@@ -198,192 +396,492 @@ static int prepare_statements(SqliteBackendContext *ctx) {
         return -1;
     }
 
+    /* Entry ids continue after the largest stored one (only this
+     * connection inserts) */
+    sqlite3_stmt *stmt = NULL;
+    rc = sqlite3_prepare_v2(ctx->db, "SELECT COALESCE(MAX(id), 0) FROM trans_cache;", -1,
+                            &stmt, NULL);
+    if (rc != SQLITE_OK || sqlite3_step(stmt) != SQLITE_ROW) {
+        LOG_DEBUG("Error reading max id: %s\n", sqlite3_errmsg(ctx->db));
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+    ctx->next_id = sqlite3_column_int(stmt, 0) + 1;
+    sqlite3_finalize(stmt);
+
+    return 0;
+}
+
+/* Open the read-only connections of the pool */
+static int open_readers(SqliteBackendContext *ctx, size_t count, int mutex_flag,
+                        const SqliteBackendOptions *opts) {
+    ctx->readers = calloc(count, sizeof(SqliteReader));
+    if (!ctx->readers) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return -1;
+    }
+    ctx->reader_count = count;
+
+    for (size_t i = 0; i < count; i++) {
+        SqliteReader *reader = &ctx->readers[i];
+
+        int rc = sqlite3_open_v2(ctx->db_path, &reader->db,
+                                 SQLITE_OPEN_READONLY | mutex_flag, NULL);
+        if (rc != SQLITE_OK) {
+            LOG_DEBUG("Error opening read connection %s: %s\n", ctx->db_path,
+                      sqlite3_errmsg(reader->db));
+            return -1;
+        }
+        if (apply_connection_pragmas(reader->db, opts) != 0) {
+            return -1;
+        }
+
+        rc = sqlite3_prepare_v2(reader->db, SQL_LOOKUP, -1, &reader->stmt_lookup, NULL);
+        if (rc != SQLITE_OK) {
+            LOG_DEBUG("Error preparing lookup statement: %s\n", sqlite3_errmsg(reader->db));
+            return -1;
+        }
+
+        reader->next = ctx->idle_readers;
+        ctx->idle_readers = reader;
+    }
+
     return 0;
 }
 
+/* SQLITE_CHECKPOINT_* of a mode name (-1 if unknown) */
+static int checkpoint_mode_of(const char *name) {
+    if (strcasecmp(name, "PASSIVE") == 0) return SQLITE_CHECKPOINT_PASSIVE;
+    if (strcasecmp(name, "FULL") == 0) return SQLITE_CHECKPOINT_FULL;
+    if (strcasecmp(name, "RESTART") == 0) return SQLITE_CHECKPOINT_RESTART;
+    if (strcasecmp(name, "TRUNCATE") == 0) return SQLITE_CHECKPOINT_TRUNCATE;
+    return -1;
+}
+
+/* Name of a SQLITE_CHECKPOINT_* mode */
+static const char *checkpoint_mode_name(int mode) {
+    switch (mode) {
+        case SQLITE_CHECKPOINT_FULL: return "full";
+        case SQLITE_CHECKPOINT_RESTART: return "restart";
+        case SQLITE_CHECKPOINT_TRUNCATE: return "truncate";
+        case SQLITE_CHECKPOINT_PASSIVE:
+        default: return "passive";
+    }
+}
+
 /* Initialize SQLite backend */
-TransCache *sqlite_backend_init(const char *db_path) {
+TransCache *sqlite_backend_init(const char *db_path, const SqliteBackendOptions *options) {
     if (!db_path) {
         LOG_DEBUG("Error: NULL database path\n");
         return NULL;
     }
 
-    /* Allocate TransCache */
-    TransCache *cache = calloc(1, sizeof(TransCache));
-    if (!cache) {
-        LOG_DEBUG("Error: Memory allocation failed\n");
+    /* Readers open the file on their own */
+    if (db_path[0] == '\0' || strcmp(db_path, ":memory:") == 0) {
+        LOG_DEBUG("Error: SQLite cache needs a database file, not '%s'\n", db_path);
         return NULL;
     }
 
+    /* Connections are never shared between threads at the same time, but
+     * the library must still be built thread-safe */
+    if (!sqlite3_threadsafe()) {
+        LOG_DEBUG("Error: SQLite library is not thread-safe\n");
+        return NULL;
+    }
+
+    /* Options with defaults filled in */
+    SqliteBackendOptions opts = {
+        .journal_mode = options && options->journal_mode ?
+                        options->journal_mode : DEFAULT_JOURNAL_MODE,
+        .sync_mode = options && options->sync_mode ? options->sync_mode : DEFAULT_SYNC_MODE,
+        .read_connections = options && options->read_connections > 0 ?
+                            options->read_connections : DEFAULT_READ_CONNECTIONS,
+        .full_mutex = options && options->full_mutex,
+        .page_size = options && options->page_size > 0 ? options->page_size : DEFAULT_PAGE_SIZE,
+        .cache_size_kb = options && options->cache_size_kb > 0 ?
+                         options->cache_size_kb : DEFAULT_CACHE_SIZE_KB,
+        .mmap_size = !options || options->mmap_size == 0 ? DEFAULT_MMAP_SIZE :
+                     options->mmap_size < 0 ? 0 : options->mmap_size,
+        .temp_store = options && options->temp_store ? options->temp_store : DEFAULT_TEMP_STORE,
+        .busy_timeout_ms = !options || options->busy_timeout_ms == 0 ? DEFAULT_BUSY_TIMEOUT_MS :
+                           options->busy_timeout_ms < 0 ? 0 : options->busy_timeout_ms,
+        .checkpoint_mode = options && options->checkpoint_mode ?
+                           options->checkpoint_mode : DEFAULT_CHECKPOINT_MODE
+    };
+    if (opts.read_connections > MAX_READ_CONNECTIONS) {
+        opts.read_connections = MAX_READ_CONNECTIONS;
+    }
+    int mutex_flag = opts.full_mutex ? SQLITE_OPEN_FULLMUTEX : SQLITE_OPEN_NOMUTEX;
+
+    int checkpoint_mode = checkpoint_mode_of(opts.checkpoint_mode);
+    if (checkpoint_mode < 0) {
+        LOG_INFO("Warning: Unknown SQLite checkpoint mode '%s', using PASSIVE\n",
+                 opts.checkpoint_mode);
+        checkpoint_mode = SQLITE_CHECKPOINT_PASSIVE;
+    }
+
     /* Allocate SqliteBackendContext */
     SqliteBackendContext *ctx = calloc(1, sizeof(SqliteBackendContext));
     if (!ctx) {
         LOG_DEBUG("Error: Memory allocation failed\n");
-        free(cache);
         return NULL;
     }
 
+    pthread_mutexattr_t writer_attr;
+    pthread_mutexattr_init(&writer_attr);
+    pthread_mutexattr_settype(&writer_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&ctx->writer_lock, &writer_attr);
+    pthread_mutexattr_destroy(&writer_attr);
+
+    pthread_mutex_init(&ctx->readers_lock, NULL);
+    pthread_cond_init(&ctx->readers_cond, NULL);
+    pthread_mutex_init(&ctx->pending_lock, NULL);
+    pthread_mutex_init(&ctx->checkpoint_lock, NULL);
+    atomic_init(&ctx->pending_flushes, 0);
+    ctx->checkpoint_mode = checkpoint_mode;
+
     ctx->db_path = strdup(db_path);
-    if (!ctx->db_path) {
+    ctx->wal_path = malloc(strlen(db_path) + sizeof("-wal"));
+    ctx->pending = calloc(PENDING_HIT_SLOTS, sizeof(SqlitePendingHit));
+    if (!ctx->db_path || !ctx->wal_path || !ctx->pending) {
         LOG_DEBUG("Error: Memory allocation failed\n");
-        free(ctx);
-        free(cache);
+        sqlite_backend_free(ctx);
         return NULL;
     }
+    sprintf(ctx->wal_path, "%s-wal", db_path);
 
-    /* Open database with FULLMUTEX for thread safety */
+    /* Open writer connection */
     int rc = sqlite3_open_v2(db_path, &ctx->db,
-                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | mutex_flag,
                              NULL);
     if (rc != SQLITE_OK) {
         LOG_DEBUG("Error opening database %s: %s\n", db_path, sqlite3_errmsg(ctx->db));
-        free(ctx->db_path);
-        free(ctx);
-        free(cache);
+        sqlite_backend_free(ctx);
         return NULL;
     }
+    sqlite3_busy_timeout(ctx->db, opts.busy_timeout_ms);
 
-    /* Apply schema */
-    if (apply_schema(ctx->db) != 0) {
+    /* Apply schema (page size and auto-vacuum first: new files take them) */
+    if (apply_storage_layout(ctx->db, &opts) != 0 || apply_schema(ctx->db) != 0) {
         LOG_DEBUG("Error: Failed to apply schema\n");
-        sqlite3_close(ctx->db);
-        free(ctx->db_path);
-        free(ctx);
-        free(cache);
+        sqlite_backend_free(ctx);
         return NULL;
     }
+    enable_incremental_vacuum(ctx);
 
-    /* Apply PRAGMA optimizations (defaults: WAL, NORMAL) */
-    if (apply_pragmas(ctx->db, "WAL", "NORMAL") != 0) {
+    /* Apply PRAGMA optimizations */
+    bool wal = false;
+    if (apply_pragmas(ctx->db, &opts, &wal) != 0) {
         LOG_DEBUG("Error: Failed to apply PRAGMA settings\n");
-        sqlite3_close(ctx->db);
-        free(ctx->db_path);
-        free(ctx);
-        free(cache);
+        sqlite_backend_free(ctx);
         return NULL;
     }
 
     /* Prepare statements */
     if (prepare_statements(ctx) != 0) {
         LOG_DEBUG("Error: Failed to prepare statements\n");
-        sqlite3_close(ctx->db);
-        free(ctx->db_path);
-        free(ctx);
-        free(cache);
+        sqlite_backend_free(ctx);
         return NULL;
     }
 
-    /* Initialize read-write lock */
-    if (pthread_rwlock_init(&cache->lock, NULL) != 0) {
-        LOG_DEBUG("Error: Failed to initialize rwlock\n");
-        sqlite3_finalize(ctx->stmt_lookup);
-        sqlite3_finalize(ctx->stmt_insert);
-        sqlite3_finalize(ctx->stmt_update_count);
-        sqlite3_finalize(ctx->stmt_update_trans);
-        sqlite3_finalize(ctx->stmt_delete_old);
-        sqlite3_finalize(ctx->stmt_count_all);
-        sqlite3_close(ctx->db);
-        free(ctx->db_path);
-        free(ctx);
-        free(cache);
+    /* Open read connections once the schema exists */
+    if (open_readers(ctx, (size_t)opts.read_connections, mutex_flag, &opts) != 0) {
+        LOG_DEBUG("Error: Failed to open read connections\n");
+        sqlite_backend_free(ctx);
         return NULL;
     }
 
-    /* Set up TransCache */
-    cache->type = CACHE_BACKEND_SQLITE;
-    cache->backend_ctx = ctx;
-    cache->ops = sqlite_backend_get_ops();
+    /* Checkpoints get their own connection (WAL only) */
+    if (wal) {
+        rc = sqlite3_open_v2(db_path, &ctx->checkpoint_db, SQLITE_OPEN_READWRITE | mutex_flag,
+                             NULL);
+        if (rc != SQLITE_OK || apply_connection_pragmas(ctx->checkpoint_db, &opts) != 0) {
+            LOG_DEBUG("Error opening checkpoint connection: %s\n",
+                      sqlite3_errmsg(ctx->checkpoint_db));
+            sqlite_backend_free(ctx);
+            return NULL;
+        }
+    }
+
+    /* One shard: the writer connection and its statements are shared */
+    void *slices[1] = { ctx };
+    TransCache *cache = trans_cache_create(CACHE_BACKEND_SQLITE, sqlite_backend_get_ops(),
+                                           ctx, slices, 1);
+    if (!cache) {
+        sqlite_backend_free(ctx);
+        return NULL;
+    }
 
-    LOG_INFO("SQLite cache initialized: %s\n", db_path);
+    LOG_INFO("SQLite cache initialized: %s (%d read connections, %s, journal %s, "
+             "checkpoint %s)\n",
+             db_path, opts.read_connections,
+             mutex_flag == SQLITE_OPEN_FULLMUTEX ? "FULLMUTEX" : "NOMUTEX",
+             opts.journal_mode, wal ? checkpoint_mode_name(checkpoint_mode) : "off");
 
     return cache;
 }
 
-/* Lookup cache entry */
-static CacheEntry* sqlite_backend_lookup(void *backend_ctx,
-                                          const char *from_lang,
-                                          const char *to_lang,
-                                          const char *text) {
-    if (!backend_ctx || !from_lang || !to_lang || !text) {
-        return NULL;
+/* Check out an idle reader, waiting for one if all are busy */
+static SqliteReader *reader_acquire(SqliteBackendContext *ctx) {
+    pthread_mutex_lock(&ctx->readers_lock);
+    while (!ctx->idle_readers) {
+        pthread_cond_wait(&ctx->readers_cond, &ctx->readers_lock);
     }
+    SqliteReader *reader = ctx->idle_readers;
+    ctx->idle_readers = reader->next;
+    pthread_mutex_unlock(&ctx->readers_lock);
 
-    SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
+    return reader;
+}
+
+/* Return a reader to the pool */
+static void reader_release(SqliteBackendContext *ctx, SqliteReader *reader) {
+    pthread_mutex_lock(&ctx->readers_lock);
+    reader->next = ctx->idle_readers;
+    ctx->idle_readers = reader;
+    pthread_cond_signal(&ctx->readers_cond);
+    pthread_mutex_unlock(&ctx->readers_lock);
+}
+
+/* Pending hit slot of key; with create, claims a free slot if key has none.
+ * Returns NULL if key has no slot (or the table is full). Caller holds
+ * pending_lock. */
+static SqlitePendingHit *pending_slot(SqliteBackendContext *ctx, const unsigned char *key,
+                                      bool create) {
+    uint64_t tag;
+    memcpy(&tag, key, sizeof(tag));
+
+    for (size_t probe = 0; probe < PENDING_HIT_SLOTS; probe++) {
+        SqlitePendingHit *slot = &ctx->pending[(tag + probe) & (PENDING_HIT_SLOTS - 1)];
+        if (!slot->used) {
+            if (!create) {
+                return NULL;
+            }
+            memcpy(slot->key, key, TRANS_CACHE_DIGEST_SIZE);
+            slot->hits = 0;
+            slot->last_used = 0;
+            slot->used = true;
+            ctx->pending_count++;
+            return slot;
+        }
+        if (memcmp(slot->key, key, TRANS_CACHE_DIGEST_SIZE) == 0) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+/* Add hits to an entry's row (caller holds writer_lock) */
+static int write_hits(SqliteBackendContext *ctx, const unsigned char *key,
+                      uint32_t hits, uint32_t last_used) {
+    sqlite3_reset(ctx->stmt_update_count);
+    sqlite3_bind_int(ctx->stmt_update_count, 1, (int)hits);
+    sqlite3_bind_int64(ctx->stmt_update_count, 2, (sqlite3_int64)last_used);
+    sqlite3_bind_blob(ctx->stmt_update_count, 3, key, TRANS_CACHE_DIGEST_SIZE, SQLITE_STATIC);
+
+    int rc = sqlite3_step(ctx->stmt_update_count);
+    sqlite3_reset(ctx->stmt_update_count);
+
+    if (rc != SQLITE_DONE) {
+        LOG_DEBUG("Error updating count: %s\n", sqlite3_errmsg(ctx->db));
+        return -1;
+    }
+
+    atomic_fetch_add_explicit(&ctx->writes, 1, memory_order_relaxed);
+    return 0;
+}
+
+/* Write pending hits in one transaction (caller holds pending_lock). A
+ * savepoint, so it also nests inside a write-behind batch. */
+static int write_pending_hits(SqliteBackendContext *ctx) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(ctx->db, "SAVEPOINT hits;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_DEBUG("Error starting hit transaction: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+
+    int folded = 0;
+    for (size_t i = 0; i < PENDING_HIT_SLOTS; i++) {
+        SqlitePendingHit *slot = &ctx->pending[i];
+        if (!slot->used || slot->hits == 0) {
+            continue;
+        }
+        if (write_hits(ctx, slot->key, slot->hits, slot->last_used) != 0) {
+            sqlite3_exec(ctx->db, "ROLLBACK TO hits; RELEASE hits;", NULL, NULL, NULL);
+            return -1;
+        }
+        folded++;
+    }
+
+    if (sqlite3_exec(ctx->db, "RELEASE hits;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_DEBUG("Error committing hit transaction: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(ctx->db, "ROLLBACK TO hits; RELEASE hits;", NULL, NULL, NULL);
+        return -1;
+    }
+
+    return folded;
+}
+
+/* Write all pending hits and clear the table on the writer connection.
+ * On error nothing is written and the hits stay pending. Lookups wait
+ * meanwhile, and lookups that read the table before retry
+ * (pending_flushes), so no hit is counted twice or missed. */
+static int flush_pending_hits(SqliteBackendContext *ctx) {
+    pthread_mutex_lock(&ctx->writer_lock);
+    pthread_mutex_lock(&ctx->pending_lock);
+
+    int folded = 0;
+    if (ctx->pending_count > 0) {
+        atomic_fetch_add(&ctx->pending_flushes, 1);
+        folded = write_pending_hits(ctx);
+        if (folded >= 0) {
+            memset(ctx->pending, 0, PENDING_HIT_SLOTS * sizeof(SqlitePendingHit));
+            ctx->pending_count = 0;
+        }
+    }
 
-    /* Calculate hash */
-    char hash[65];
-    trans_cache_calculate_hash(from_lang, to_lang, text, hash);
+    pthread_mutex_unlock(&ctx->pending_lock);
+    pthread_mutex_unlock(&ctx->writer_lock);
+    return folded;
+}
+
+/* Add a hit to the pending table. Returns false if the table is full. */
+static bool record_pending_hit(SqliteBackendContext *ctx, const unsigned char *key,
+                               uint32_t now) {
+    pthread_mutex_lock(&ctx->pending_lock);
+
+    SqlitePendingHit *pending = pending_slot(ctx, key, false);
+    if (!pending && ctx->pending_count < PENDING_HIT_MAX) {
+        pending = pending_slot(ctx, key, true);
+    }
+    if (pending) {
+        pending->hits++;
+        pending->last_used = now;
+    }
+
+    pthread_mutex_unlock(&ctx->pending_lock);
+    return pending != NULL;
+}
+
+/* Free an entry returned by lookup */
+static void sqlite_entry_free(void *ptr) {
+    CacheEntry *entry = (CacheEntry*)ptr;
+    free(entry->source_text);
+    free(entry->translated_text);
+    free(entry);
+}
 
-    /* Bind hash parameter */
-    sqlite3_reset(ctx->stmt_lookup);
-    sqlite3_bind_text(ctx->stmt_lookup, 1, hash, -1, SQLITE_STATIC);
+/* Read the row of key on a pooled reader (NULL if absent) */
+static CacheEntry *read_entry(SqliteBackendContext *ctx, const unsigned char *key) {
+    SqliteReader *reader = reader_acquire(ctx);
+    sqlite3_stmt *stmt = reader->stmt_lookup;
+
+    /* Bind key (primary key) */
+    sqlite3_reset(stmt);
+    sqlite3_bind_blob(stmt, 1, key, TRANS_CACHE_DIGEST_SIZE, SQLITE_STATIC);
 
     /* Execute query */
-    int rc = sqlite3_step(ctx->stmt_lookup);
-    if (rc != SQLITE_ROW) {
-        /* Not found or error */
-        sqlite3_reset(ctx->stmt_lookup);
-        return NULL;
+    CacheEntry *entry = NULL;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        entry = calloc(1, sizeof(CacheEntry));
+    } else if (rc != SQLITE_DONE) {
+        LOG_DEBUG("Error looking up cache entry: %s\n", sqlite3_errmsg(reader->db));
+    }
+
+    /* Extract data from result row */
+    if (entry) {
+        entry->id = sqlite3_column_int(stmt, 0);
+        memcpy(entry->key, key, TRANS_CACHE_DIGEST_SIZE);
+        entry->from_id = trans_cache_lang_id((const char*)sqlite3_column_text(stmt, 1));
+        entry->to_id = trans_cache_lang_id((const char*)sqlite3_column_text(stmt, 2));
+        entry->source_text = strdup((const char*)sqlite3_column_text(stmt, 3));
+        entry->translated_text = strdup((const char*)sqlite3_column_text(stmt, 4));
+        entry->count = sqlite3_column_int(stmt, 5);
+        entry->last_used = (uint32_t)sqlite3_column_int64(stmt, 6);
+        entry->created_at = (uint32_t)sqlite3_column_int64(stmt, 7);
     }
 
-    /* Allocate cache entry */
-    CacheEntry *entry = calloc(1, sizeof(CacheEntry));
-    if (!entry) {
-        sqlite3_reset(ctx->stmt_lookup);
+    sqlite3_reset(stmt);
+    reader_release(ctx, reader);
+
+    if (entry && (!entry->source_text || !entry->translated_text)) {
+        sqlite_entry_free(entry);
         return NULL;
     }
+    return entry;
+}
 
-    /* Extract data from result row */
-    entry->id = sqlite3_column_int(ctx->stmt_lookup, 0);
-    strncpy(entry->hash, (const char*)sqlite3_column_text(ctx->stmt_lookup, 1), sizeof(entry->hash) - 1);
-    strncpy(entry->from_lang, (const char*)sqlite3_column_text(ctx->stmt_lookup, 2), sizeof(entry->from_lang) - 1);
-    strncpy(entry->to_lang, (const char*)sqlite3_column_text(ctx->stmt_lookup, 3), sizeof(entry->to_lang) - 1);
-    entry->source_text = strdup((const char*)sqlite3_column_text(ctx->stmt_lookup, 4));
-    entry->translated_text = strdup((const char*)sqlite3_column_text(ctx->stmt_lookup, 5));
-    entry->count = sqlite3_column_int(ctx->stmt_lookup, 6);
-    entry->last_used = (time_t)sqlite3_column_int64(ctx->stmt_lookup, 7);
-    entry->created_at = (time_t)sqlite3_column_int64(ctx->stmt_lookup, 8);
-
-    sqlite3_reset(ctx->stmt_lookup);
-
-    if (!entry->source_text || !entry->translated_text) {
-        free(entry->source_text);
-        free(entry->translated_text);
-        free(entry);
+/* Lookup cache entry without the shard lock. The returned copy is retired
+ * right away and freed after the caller's read section. */
+static CacheEntry* sqlite_backend_lookup(void *backend_ctx, const unsigned char *key) {
+    if (!backend_ctx || !key) {
         return NULL;
     }
 
-    return entry;
+    SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
+
+    for (;;) {
+        /* Hits not written yet, so the threshold sees every hit */
+        pthread_mutex_lock(&ctx->pending_lock);
+        unsigned int flushes = atomic_load(&ctx->pending_flushes);
+        SqlitePendingHit *pending = pending_slot(ctx, key, false);
+        uint32_t hits = pending ? pending->hits : 0;
+        uint32_t hit_time = pending ? pending->last_used : 0;
+        pthread_mutex_unlock(&ctx->pending_lock);
+
+        CacheEntry *entry = read_entry(ctx, key);
+        if (!entry) {
+            return NULL;
+        }
+
+        /* A flush committed those hits meanwhile: the row may hold them */
+        if (atomic_load(&ctx->pending_flushes) != flushes) {
+            sqlite_entry_free(entry);
+            continue;
+        }
+
+        entry->count += (int)hits;
+        if (hit_time > entry->last_used) {
+            entry->last_used = hit_time;
+        }
+
+        epoch_retire(entry, sqlite_entry_free);
+        return entry;
+    }
 }
 
 /* Add new cache entry */
 static int sqlite_backend_add(void *backend_ctx,
+                              const unsigned char *key,
                               const char *from_lang,
                               const char *to_lang,
                               const char *source_text,
                               const char *translated_text) {
-    if (!backend_ctx || !from_lang || !to_lang || !source_text || !translated_text) {
+    if (!backend_ctx || !key || !from_lang || !to_lang || !source_text || !translated_text) {
         return -1;
     }
 
     SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
 
-    /* Calculate hash */
-    char hash[65];
-    trans_cache_calculate_hash(from_lang, to_lang, source_text, hash);
-
     /* Current timestamp */
     time_t now = time(NULL);
 
+    pthread_mutex_lock(&ctx->writer_lock);
+
     /* Bind parameters */
     sqlite3_reset(ctx->stmt_insert);
-    sqlite3_bind_text(ctx->stmt_insert, 1, hash, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(ctx->stmt_insert, 2, from_lang, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(ctx->stmt_insert, 3, to_lang, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(ctx->stmt_insert, 4, source_text, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(ctx->stmt_insert, 5, translated_text, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int64(ctx->stmt_insert, 6, (sqlite3_int64)now);
+    sqlite3_bind_blob(ctx->stmt_insert, 1, key, TRANS_CACHE_DIGEST_SIZE, SQLITE_STATIC);
+    sqlite3_bind_int(ctx->stmt_insert, 2, ctx->next_id);
+    sqlite3_bind_text(ctx->stmt_insert, 3, from_lang, -1, SQLITE_STATIC);
+    sqlite3_bind_text(ctx->stmt_insert, 4, to_lang, -1, SQLITE_STATIC);
+    sqlite3_bind_text(ctx->stmt_insert, 5, source_text, -1, SQLITE_STATIC);
+    sqlite3_bind_text(ctx->stmt_insert, 6, translated_text, -1, SQLITE_STATIC);
     sqlite3_bind_int64(ctx->stmt_insert, 7, (sqlite3_int64)now);
+    sqlite3_bind_int64(ctx->stmt_insert, 8, (sqlite3_int64)now);
 
     /* Execute insert */
     int rc = sqlite3_step(ctx->stmt_insert);
@@ -391,13 +889,19 @@ static int sqlite_backend_add(void *backend_ctx,
 
     if (rc != SQLITE_DONE) {
         LOG_DEBUG("Error inserting cache entry: %s\n", sqlite3_errmsg(ctx->db));
+        pthread_mutex_unlock(&ctx->writer_lock);
         return -1;
     }
 
+    ctx->next_id++;
+    pthread_mutex_unlock(&ctx->writer_lock);
+    atomic_fetch_add_explicit(&ctx->writes, 1, memory_order_relaxed);
     return 0;
 }
 
-/* Update cache entry count */
+/* Record a hit in the pending table; the row is updated by the next
+ * flush (or right away if the table cannot take it). Runs without the
+ * shard lock: only the table-full path uses the writer connection. */
 static int sqlite_backend_update_count(void *backend_ctx, CacheEntry *entry) {
     if (!backend_ctx || !entry) {
         return -1;
@@ -405,26 +909,33 @@ static int sqlite_backend_update_count(void *backend_ctx, CacheEntry *entry) {
 
     SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
 
-    /* Increment count and update last_used */
+    /* Increment count and update last_used of the looked-up copy */
+    uint32_t now = (uint32_t)time(NULL);
     entry->count++;
-    entry->last_used = time(NULL);
+    entry->last_used = now;
 
-    /* Bind parameters */
-    sqlite3_reset(ctx->stmt_update_count);
-    sqlite3_bind_int(ctx->stmt_update_count, 1, entry->count);
-    sqlite3_bind_int64(ctx->stmt_update_count, 2, (sqlite3_int64)entry->last_used);
-    sqlite3_bind_text(ctx->stmt_update_count, 3, entry->hash, -1, SQLITE_STATIC);
+    if (record_pending_hit(ctx, entry->key, now)) {
+        return 0;
+    }
 
-    /* Execute update */
-    int rc = sqlite3_step(ctx->stmt_update_count);
-    sqlite3_reset(ctx->stmt_update_count);
+    /* Table full: write it out early */
+    if (flush_pending_hits(ctx) >= 0 && record_pending_hit(ctx, entry->key, now)) {
+        return 0;
+    }
 
-    if (rc != SQLITE_DONE) {
-        LOG_DEBUG("Error updating count: %s\n", sqlite3_errmsg(ctx->db));
+    pthread_mutex_lock(&ctx->writer_lock);
+    int result = write_hits(ctx, entry->key, 1, now);
+    pthread_mutex_unlock(&ctx->writer_lock);
+    return result;
+}
+
+/* Write deferred hits in one transaction */
+static int sqlite_backend_flush_hits(void *backend_ctx) {
+    if (!backend_ctx) {
         return -1;
     }
 
-    return 0;
+    return flush_pending_hits((SqliteBackendContext*)backend_ctx);
 }
 
 /* Update cache entry translation */
@@ -437,22 +948,28 @@ static int sqlite_backend_update_translation(void *backend_ctx,
 
     SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
 
-    /* Update in-memory entry */
-    free(entry->translated_text);
-    entry->translated_text = strdup(new_translation);
-    if (!entry->translated_text) {
-        return -1;
-    }
-
-    /* Reset count to 1 and update last_used */
+    /* The looked-up copy keeps its text (readers may hold it); reset
+     * count to 1 and update last_used */
     entry->count = 1;
-    entry->last_used = time(NULL);
+    entry->last_used = (uint32_t)time(NULL);
+
+    pthread_mutex_lock(&ctx->writer_lock);
+
+    /* Hits on the old translation no longer count */
+    pthread_mutex_lock(&ctx->pending_lock);
+    SqlitePendingHit *pending = pending_slot(ctx, entry->key, false);
+    if (pending) {
+        pending->hits = 0;
+        pending->last_used = 0;
+    }
+    pthread_mutex_unlock(&ctx->pending_lock);
 
     /* Bind parameters */
     sqlite3_reset(ctx->stmt_update_trans);
     sqlite3_bind_text(ctx->stmt_update_trans, 1, new_translation, -1, SQLITE_TRANSIENT);
     sqlite3_bind_int64(ctx->stmt_update_trans, 2, (sqlite3_int64)entry->last_used);
-    sqlite3_bind_text(ctx->stmt_update_trans, 3, entry->hash, -1, SQLITE_STATIC);
+    sqlite3_bind_blob(ctx->stmt_update_trans, 3, entry->key, TRANS_CACHE_DIGEST_SIZE,
+                      SQLITE_STATIC);
 
     /* Execute update */
     int rc = sqlite3_step(ctx->stmt_update_trans);
@@ -460,19 +977,140 @@ static int sqlite_backend_update_translation(void *backend_ctx,
 
     if (rc != SQLITE_DONE) {
         LOG_DEBUG("Error updating translation: %s\n", sqlite3_errmsg(ctx->db));
+        pthread_mutex_unlock(&ctx->writer_lock);
         return -1;
     }
 
+    pthread_mutex_unlock(&ctx->writer_lock);
+    atomic_fetch_add_explicit(&ctx->writes, 1, memory_order_relaxed);
     return 0;
 }
 
-/* Save cache (no-op for SQLite - auto-commit) */
-static int sqlite_backend_save(void *backend_ctx) {
-    (void)backend_ctx;
-    /* SQLite auto-commits, no explicit save needed */
+/* Start a write-behind batch: the writes until end_batch share one
+ * transaction (lookups on the read connections see them after commit).
+ * writer_lock is held until end_batch, so a table-full hit cannot slip
+ * its write into the batch. */
+static int sqlite_backend_begin_batch(void *backend_ctx) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
+    char *err_msg = NULL;
+
+    pthread_mutex_lock(&ctx->writer_lock);
+    if (sqlite3_exec(ctx->db, "BEGIN IMMEDIATE;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_DEBUG("Error starting batch transaction: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        pthread_mutex_unlock(&ctx->writer_lock);
+        return -1;
+    }
+
     return 0;
 }
 
+/* Commit a write-behind batch (rolled back as a whole if that fails) */
+static int sqlite_backend_end_batch(void *backend_ctx) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
+    char *err_msg = NULL;
+
+    int result = 0;
+    if (sqlite3_exec(ctx->db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_DEBUG("Error committing batch transaction: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(ctx->db, "ROLLBACK;", NULL, NULL, NULL);
+        result = -1;
+    }
+
+    pthread_mutex_unlock(&ctx->writer_lock);
+    return result;
+}
+
+/* Monotonic clock in microseconds */
+static unsigned long long monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + (unsigned long long)ts.tv_nsec / 1000;
+}
+
+/* Size of the WAL file in bytes (0 if there is none) */
+static long long wal_size(const SqliteBackendContext *ctx) {
+    struct stat st;
+    return ctx->wal_path && stat(ctx->wal_path, &st) == 0 ? (long long)st.st_size : 0;
+}
+
+/* Save cache: rows are committed as they are written (deferred hits by
+ * flush_hits before every save), so saving means checkpointing the WAL
+ * into the database file, on the checkpoint connection. While writes come
+ * in, the configured mode copies the bulk of the WAL without blocking
+ * them, then a PASSIVE pass under the shard write lock copies what was
+ * committed meanwhile: the WAL is then fully checkpointed and the next
+ * write starts it over instead of growing it. Once no writes came in since
+ * the last checkpoint, TRUNCATE empties the WAL file. */
+static int sqlite_backend_save(TransCache *cache) {
+    if (!cache || !cache->backend_ctx) {
+        return -1;
+    }
+
+    SqliteBackendContext *ctx = (SqliteBackendContext*)cache->backend_ctx;
+    if (!ctx->checkpoint_db) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ctx->checkpoint_lock);
+
+    unsigned long long writes = atomic_load_explicit(&ctx->writes, memory_order_relaxed);
+    bool idle = writes == ctx->writes_at_checkpoint;
+    if (idle && wal_size(ctx) == 0) {
+        pthread_mutex_unlock(&ctx->checkpoint_lock);
+        return 0;
+    }
+
+    int mode = idle ? SQLITE_CHECKPOINT_TRUNCATE : ctx->checkpoint_mode;
+    int wal_frames = 0;
+    int copied_frames = 0;
+
+    unsigned long long start = monotonic_us();
+    int rc = sqlite3_wal_checkpoint_v2(ctx->checkpoint_db, NULL, mode,
+                                       &wal_frames, &copied_frames);
+    if (!idle && (rc == SQLITE_OK || rc == SQLITE_BUSY)) {
+        trans_cache_lock_shard(cache, 0, true);
+        writes = atomic_load_explicit(&ctx->writes, memory_order_relaxed);
+        rc = sqlite3_wal_checkpoint_v2(ctx->checkpoint_db, NULL, SQLITE_CHECKPOINT_PASSIVE,
+                                       &wal_frames, &copied_frames);
+        trans_cache_unlock_shard(cache, 0);
+    }
+    unsigned long long elapsed = monotonic_us() - start;
+
+    ctx->writes_at_checkpoint = writes;
+
+    atomic_fetch_add_explicit(&ctx->checkpoints, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&ctx->checkpoint_us_total, elapsed, memory_order_relaxed);
+    atomic_store_explicit(&ctx->checkpoint_us_last, elapsed, memory_order_relaxed);
+    if (elapsed > atomic_load_explicit(&ctx->checkpoint_us_max, memory_order_relaxed)) {
+        atomic_store_explicit(&ctx->checkpoint_us_max, elapsed, memory_order_relaxed);
+    }
+
+    /* BUSY: a TRUNCATE gave up waiting; fewer frames copied than logged:
+     * readers still use older pages. The next save continues. */
+    int result = 0;
+    if (rc == SQLITE_BUSY || (rc == SQLITE_OK && copied_frames < wal_frames)) {
+        atomic_fetch_add_explicit(&ctx->checkpoints_busy, 1, memory_order_relaxed);
+    } else if (rc != SQLITE_OK) {
+        LOG_DEBUG("Error checkpointing WAL: %s\n", sqlite3_errmsg(ctx->checkpoint_db));
+        result = -1;
+    } else if (idle) {
+        atomic_fetch_add_explicit(&ctx->checkpoints_truncate, 1, memory_order_relaxed);
+    }
+
+    pthread_mutex_unlock(&ctx->checkpoint_lock);
+    return result;
+}
+
 /* Cleanup old cache entries */
 static int sqlite_backend_cleanup(void *backend_ctx, int days_threshold) {
     if (!backend_ctx || days_threshold <= 0) {
@@ -485,6 +1123,8 @@ static int sqlite_backend_cleanup(void *backend_ctx, int days_threshold) {
     time_t now = time(NULL);
     time_t threshold_time = now - (days_threshold * 24 * 60 * 60);
 
+    pthread_mutex_lock(&ctx->writer_lock);
+
     /* Bind threshold parameter */
     sqlite3_reset(ctx->stmt_delete_old);
     sqlite3_bind_int64(ctx->stmt_delete_old, 1, (sqlite3_int64)threshold_time);
@@ -496,9 +1136,29 @@ static int sqlite_backend_cleanup(void *backend_ctx, int days_threshold) {
 
     if (rc != SQLITE_DONE) {
         LOG_DEBUG("Error cleaning up old entries: %s\n", sqlite3_errmsg(ctx->db));
+        pthread_mutex_unlock(&ctx->writer_lock);
         return 0;
     }
 
+    if (removed_count > 0) {
+        atomic_fetch_add_explicit(&ctx->writes, 1, memory_order_relaxed);
+
+        /* Give the pages of removed rows back to the file system */
+        if (ctx->incremental_vacuum) {
+            long long free_pages = pragma_int(ctx->db, "PRAGMA freelist_count;");
+            if (exec_sql(ctx->db, "PRAGMA incremental_vacuum;", "running incremental vacuum") == 0 &&
+                free_pages > 0) {
+                long long left = pragma_int(ctx->db, "PRAGMA freelist_count;");
+                if (left >= 0 && left < free_pages) {
+                    atomic_fetch_add_explicit(&ctx->vacuumed_pages,
+                                              (unsigned long long)(free_pages - left),
+                                              memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&ctx->writer_lock);
     return removed_count;
 }
 
@@ -515,6 +1175,8 @@ static void sqlite_backend_stats(void *backend_ctx,
 
     SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
 
+    pthread_mutex_lock(&ctx->writer_lock);
+
     /* Get total entries */
     sqlite3_reset(ctx->stmt_count_all);
     if (sqlite3_step(ctx->stmt_count_all) == SQLITE_ROW) {
@@ -552,6 +1214,62 @@ static void sqlite_backend_stats(void *backend_ctx,
             sqlite3_finalize(stmt);
         }
     }
+
+    pthread_mutex_unlock(&ctx->writer_lock);
+}
+
+/* Storage, checkpoint and vacuum metrics */
+static cJSON *sqlite_backend_metrics(TransCache *cache) {
+    if (!cache || !cache->backend_ctx) {
+        return NULL;
+    }
+
+    SqliteBackendContext *ctx = (SqliteBackendContext*)cache->backend_ctx;
+    cJSON *metrics = cJSON_CreateObject();
+    if (!metrics) {
+        return NULL;
+    }
+
+    /* File layout, read on a pooled connection */
+    SqliteReader *reader = reader_acquire(ctx);
+    long long page_size = pragma_int(reader->db, "PRAGMA page_size;");
+    long long page_count = pragma_int(reader->db, "PRAGMA page_count;");
+    long long freelist = pragma_int(reader->db, "PRAGMA freelist_count;");
+    reader_release(ctx, reader);
+
+    unsigned long long checkpoints =
+        atomic_load_explicit(&ctx->checkpoints, memory_order_relaxed);
+    unsigned long long total_us =
+        atomic_load_explicit(&ctx->checkpoint_us_total, memory_order_relaxed);
+
+    cJSON_AddNumberToObject(metrics, "page_size", (double)page_size);
+    cJSON_AddNumberToObject(metrics, "db_bytes", (double)(page_size * page_count));
+    cJSON_AddNumberToObject(metrics, "freelist_pages", (double)freelist);
+    cJSON_AddBoolToObject(metrics, "incremental_vacuum", ctx->incremental_vacuum);
+    cJSON_AddNumberToObject(metrics, "vacuumed_pages",
+                            (double)atomic_load_explicit(&ctx->vacuumed_pages,
+                                                         memory_order_relaxed));
+    cJSON_AddBoolToObject(metrics, "wal", ctx->checkpoint_db != NULL);
+    cJSON_AddNumberToObject(metrics, "wal_bytes", (double)wal_size(ctx));
+    cJSON_AddStringToObject(metrics, "checkpoint_mode",
+                            checkpoint_mode_name(ctx->checkpoint_mode));
+    cJSON_AddNumberToObject(metrics, "checkpoints", (double)checkpoints);
+    cJSON_AddNumberToObject(metrics, "checkpoints_truncate",
+                            (double)atomic_load_explicit(&ctx->checkpoints_truncate,
+                                                         memory_order_relaxed));
+    cJSON_AddNumberToObject(metrics, "checkpoints_busy",
+                            (double)atomic_load_explicit(&ctx->checkpoints_busy,
+                                                         memory_order_relaxed));
+    cJSON_AddNumberToObject(metrics, "avg_checkpoint_ms",
+                            checkpoints ? (double)total_us / (double)checkpoints / 1000.0 : 0.0);
+    cJSON_AddNumberToObject(metrics, "max_checkpoint_ms",
+                            (double)atomic_load_explicit(&ctx->checkpoint_us_max,
+                                                         memory_order_relaxed) / 1000.0);
+    cJSON_AddNumberToObject(metrics, "last_checkpoint_ms",
+                            (double)atomic_load_explicit(&ctx->checkpoint_us_last,
+                                                         memory_order_relaxed) / 1000.0);
+
+    return metrics;
 }
 
 /* Free SQLite backend */
@@ -562,8 +1280,24 @@ static void sqlite_backend_free(void *backend_ctx) {
 
     SqliteBackendContext *ctx = (SqliteBackendContext*)backend_ctx;
 
+    /* Write hits recorded since the last flush */
+    if (ctx->pending && ctx->db && ctx->stmt_update_count) {
+        flush_pending_hits(ctx);
+    }
+
+    /* Close checkpoint connection (the writer closing last removes the WAL) */
+    if (ctx->checkpoint_db) {
+        sqlite3_close(ctx->checkpoint_db);
+    }
+
+    /* Close read connections */
+    for (size_t i = 0; i < ctx->reader_count; i++) {
+        if (ctx->readers[i].stmt_lookup) sqlite3_finalize(ctx->readers[i].stmt_lookup);
+        if (ctx->readers[i].db) sqlite3_close(ctx->readers[i].db);
+    }
+    free(ctx->readers);
+
     /* Finalize all prepared statements */
-    if (ctx->stmt_lookup) sqlite3_finalize(ctx->stmt_lookup);
     if (ctx->stmt_insert) sqlite3_finalize(ctx->stmt_insert);
     if (ctx->stmt_update_count) sqlite3_finalize(ctx->stmt_update_count);
     if (ctx->stmt_update_trans) sqlite3_finalize(ctx->stmt_update_trans);
@@ -576,6 +1310,13 @@ static void sqlite_backend_free(void *backend_ctx) {
     }
 
     /* Free context */
+    pthread_mutex_destroy(&ctx->writer_lock);
+    pthread_mutex_destroy(&ctx->readers_lock);
+    pthread_cond_destroy(&ctx->readers_cond);
+    pthread_mutex_destroy(&ctx->pending_lock);
+    pthread_mutex_destroy(&ctx->checkpoint_lock);
+    free(ctx->pending);
+    free(ctx->wal_path);
     free(ctx->db_path);
     free(ctx);
 }
@@ -586,11 +1327,18 @@ CacheBackendOps *sqlite_backend_get_ops(void) {
         .lookup = sqlite_backend_lookup,
         .add = sqlite_backend_add,
         .update_count = sqlite_backend_update_count,
+        .flush_hits = sqlite_backend_flush_hits,
         .update_translation = sqlite_backend_update_translation,
+        .begin_batch = sqlite_backend_begin_batch,
+        .end_batch = sqlite_backend_end_batch,
         .save = sqlite_backend_save,
         .cleanup = sqlite_backend_cleanup,
         .stats = sqlite_backend_stats,
-        .free_backend = sqlite_backend_free
+        .metrics = sqlite_backend_metrics,
+        .free_backend = sqlite_backend_free,
+        .concurrent_lookup = true,    /* Pooled read connections */
+        .concurrent_update_count = true, /* Pending table has its own lock */
+        .lookup_copies = true         /* Row read into a new entry */
     };
     return &ops;
 }
@@ -1,41 +1,2295 @@
 /**
  * Text (JSONL) backend implementation for translation cache.
  * This backend stores cache entries in a JSONL file format.
+ * In memory, entries live in fixed-size slabs and their strings in large
+ * arena blocks, indexed by an open-addressing table over the binary key.
+ * On disk, a base file holds a full snapshot and <file>.journal collects
+ * changed entries since; the base is rewritten (temp file + rename) only
+ * when entries were removed or the journal has outgrown it.
+ * Each cache shard has its own slice (entries, index, slabs, arena, dirty
+ * list); the file, journal and id counter are shared by all slices.
+ * The base file is loaded in parallel: ranges of whole lines are parsed on
+ * several threads, then each slice stores and indexes its records.
+ * Lookups probe the index without locks: writers publish new entries and
+ * tables with release stores, replace entries instead of changing them, and
+ * retire (epoch.h) whatever a lookup may still be reading. Hits are
+ * recorded without locks too, in the entry's atomics; flush_hits later
+ * lists the touched entries for the journal.
+ * With a size bound, each slice evicts by W-TinyLFU: a Count-Min sketch
+ * estimates how often keys are requested, new entries wait in a window of
+ * the newest 1%, and an entry leaving the window stays only if it is
+ * requested more often than the victim sampled from the rest. Evicted
+ * entries leave a tombstone in the index and a removal record in the
+ * journal.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <time.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <cjson/cJSON.h>
 #include "cache_backend_text.h"
 #include "trans_cache.h"
+#include "epoch.h"
 #include "utils.h"
 
 #define INITIAL_CAPACITY 100
 #define GROWTH_FACTOR 2
+#define INITIAL_INDEX_CAPACITY 1024
+#define SLAB_ENTRIES 4096                   /* Entries per slab */
+#define ARENA_BLOCK_SIZE (1024 * 1024)      /* Minimum arena block size */
+#define ARENA_RECORD_HEADER sizeof(uint32_t)
+#define JOURNAL_SUFFIX ".journal"
+#define TEMP_SUFFIX ".tmp"
+#define SNAPSHOT_SUFFIX ".snap"
+#define INITIAL_DIRTY_CAPACITY 64
+#define JOURNAL_COMPACT_MIN_BYTES (4 * 1024 * 1024)
+#define INITIAL_REMOVED_CAPACITY 64
+
+/* Base file loader */
+#define LOAD_MAX_THREADS 64
+#define LOAD_MIN_RANGE_BYTES (1024 * 1024)  /* Smallest share of the file per thread */
+#define LOAD_LANG_CODE_SIZE 16
+
+/* Memory per entry besides its strings: slab slot, entries pointer and
+ * index slots (the index is kept between 3/8 and 3/4 full) */
+#define ENTRY_OVERHEAD (sizeof(CacheEntry) + sizeof(CacheEntry *) + 2 * sizeof(TextIndexSlot))
+
+/* Size-bounded slices (W-TinyLFU) */
+#define EVICTION_SAMPLES 8                  /* Entries compared to pick a victim */
+#define WINDOW_PERCENT 1                    /* Admission window share of the bound */
+#define SKETCH_ENTRY_ESTIMATE 256           /* Bytes per entry assumed for max_bytes */
+#define SKETCH_COUNTERS_PER_ENTRY 4         /* Per row: 4 bits each, 8 bytes per entry in all */
+#define SKETCH_MIN_BLOCKS 16
+#define SKETCH_RESET_FACTOR 10              /* Halve counters every 10 * entries increments */
+#define SKETCH_COUNTER_MAX 15
+
+/* CacheEntry.position of a snapshot view (not in the entries array) */
+#define SNAPSHOT_POSITION UINT32_MAX
+
+/* TextBackendContext.snapshot_state */
+#define SNAPSHOT_UNUSED 0       /* No view yet */
+#define SNAPSHOT_BUSY 1         /* View being made */
+#define SNAPSHOT_VIEW 2         /* View made */
+#define SNAPSHOT_DEAD 3         /* Replaced or removed */
+
+/* CacheEntry.journal_state: what the next journal record must carry */
+#define JOURNAL_STATE_TOUCH 1   /* count / last_used only */
+#define JOURNAL_STATE_FULL 2    /* whole entry (new or translation changed) */
+#define JOURNAL_STATE_RETIRED 3 /* replaced, moved, removed or evicted: no longer indexed */
+
+/* Index is grown once more than 3/4 of the slots are occupied */
+#define INDEX_FULL(used, capacity) ((used) * 4 >= (capacity) * 3)
+
+/* Storage is compacted once more than half of it is dead */
+#define MOSTLY_DEAD(dead, total) ((dead) * 2 > (total))
 
 /* Forward declarations of backend operations */
-static CacheEntry* text_backend_lookup(void *ctx, const char *from_lang,
-                                       const char *to_lang, const char *text);
-static int text_backend_add(void *ctx, const char *from_lang, const char *to_lang,
+static CacheEntry* text_backend_lookup(void *ctx, const unsigned char *key);
+static int text_backend_add(void *ctx, const unsigned char *key,
+                            const char *from_lang, const char *to_lang,
                             const char *source_text, const char *translated_text);
 static int text_backend_update_count(void *ctx, CacheEntry *entry);
+static int text_backend_flush_hits(void *ctx);
 static int text_backend_update_translation(void *ctx, CacheEntry *entry,
                                            const char *new_translation);
-static int text_backend_save(void *ctx);
+static int text_backend_save(TransCache *cache);
 static int text_backend_cleanup(void *ctx, int days_threshold);
 static void text_backend_stats(void *ctx, size_t *total_entries,
                                size_t *active_entries, size_t *expired_entries,
                                int cache_threshold, int days_threshold);
+static cJSON *text_backend_metrics(TransCache *cache);
 static void text_backend_free(void *ctx);
 
-/* Load cache entries from JSONL file */
-static int load_cache_from_file(TextBackendContext *ctx, const char *file_path) {
-    FILE *fp = fopen(file_path, "r");
+/* ============================================================================
+ * String arena
+ * ============================================================================ */
+
+/* Record size for a string of len bytes (header, bytes, NUL; 4-byte aligned) */
+static size_t arena_record_size(size_t len) {
+    return (ARENA_RECORD_HEADER + len + 1 + 3) & ~(size_t)3;
+}
+
+/* Length stored in front of an arena string */
+static size_t arena_string_length(const char *text) {
+    uint32_t len;
+    memcpy(&len, text - ARENA_RECORD_HEADER, sizeof(len));
+    return len;
+}
+
+/* Allocate an arena block with room for at least min_size bytes */
+static TextArenaBlock *arena_new_block(size_t min_size) {
+    size_t size = min_size > ARENA_BLOCK_SIZE ? min_size : ARENA_BLOCK_SIZE;
+    TextArenaBlock *block = malloc(sizeof(TextArenaBlock) + size);
+    if (!block) {
+        LOG_DEBUG("Error: Memory allocation failed for cache arena\n");
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->used = 0;
+    block->size = size;
+    return block;
+}
+
+/* Copy string into the arena. Returns the stored NUL-terminated copy. */
+static char *arena_store(TextBackendContext *ctx, const char *text, size_t len) {
+    if (len > UINT32_MAX) {
+        return NULL;
+    }
+
+    size_t record = arena_record_size(len);
+    TextArenaBlock *block = ctx->arena;
+
+    if (!block || block->size - block->used < record) {
+        block = arena_new_block(record);
+        if (!block) {
+            return NULL;
+        }
+        block->next = ctx->arena;
+        ctx->arena = block;
+    }
+
+    char *data = block->data + block->used;
+    uint32_t len32 = (uint32_t)len;
+    memcpy(data, &len32, sizeof(len32));
+    memcpy(data + ARENA_RECORD_HEADER, text, len);
+    data[ARENA_RECORD_HEADER + len] = '\0';
+
+    block->used += record;
+    ctx->arena_bytes += record;
+
+    return data + ARENA_RECORD_HEADER;
+}
+
+/* Mark an arena string as no longer referenced */
+static void arena_release(TextBackendContext *ctx, const char *text) {
+    if (text) {
+        ctx->arena_dead += arena_record_size(arena_string_length(text));
+    }
+}
+
+/* Free arena blocks */
+static void arena_free(TextArenaBlock *block) {
+    while (block) {
+        TextArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+/* Free arena blocks once lookups can no longer read their strings */
+static void arena_retire(TextArenaBlock *block) {
+    while (block) {
+        TextArenaBlock *next = block->next;
+        epoch_retire(block, free);
+        block = next;
+    }
+}
+
+/* ============================================================================
+ * Entry slabs
+ * ============================================================================ */
+
+/* Hand out the next entry slot */
+static CacheEntry *slab_alloc(TextBackendContext *ctx) {
+    if (ctx->slab_count == 0 || ctx->slab_used == SLAB_ENTRIES) {
+        CacheEntry **slabs = realloc(ctx->slabs, (ctx->slab_count + 1) * sizeof(CacheEntry *));
+        if (!slabs) {
+            LOG_DEBUG("Error: Memory allocation failed for cache slabs\n");
+            return NULL;
+        }
+        ctx->slabs = slabs;
+
+        CacheEntry *slab = malloc(SLAB_ENTRIES * sizeof(CacheEntry));
+        if (!slab) {
+            LOG_DEBUG("Error: Memory allocation failed for cache slab\n");
+            return NULL;
+        }
+
+        ctx->slabs[ctx->slab_count++] = slab;
+        ctx->slab_used = 0;
+    }
+
+    CacheEntry *entry = &ctx->slabs[ctx->slab_count - 1][ctx->slab_used++];
+    memset(entry, 0, sizeof(CacheEntry));
+    return entry;
+}
+
+/* Total entry slots handed out */
+static size_t slab_slots(const TextBackendContext *ctx) {
+    return ctx->slab_count ? (ctx->slab_count - 1) * SLAB_ENTRIES + ctx->slab_used : 0;
+}
+
+/* Free slabs */
+static void slabs_free(CacheEntry **slabs, size_t slab_count) {
+    for (size_t i = 0; i < slab_count; i++) {
+        free(slabs[i]);
+    }
+    free(slabs);
+}
+
+/* Free slabs once lookups can no longer read their entries (the slab list
+ * itself is only used by writers) */
+static void slabs_retire(CacheEntry **slabs, size_t slab_count) {
+    for (size_t i = 0; i < slab_count; i++) {
+        epoch_retire(slabs[i], free);
+    }
+    free(slabs);
+}
+
+/* Copy entry fields (count, last_used and hit_pending may be changing
+ * under lock-free hits) */
+static void copy_entry(CacheEntry *dst, const CacheEntry *src) {
+    memcpy(dst->key, src->key, TRANS_CACHE_DIGEST_SIZE);
+    dst->from_id = src->from_id;
+    dst->to_id = src->to_id;
+    dst->journal_state = src->journal_state;
+    dst->id = src->id;
+    atomic_store_explicit(&dst->count,
+                          atomic_load_explicit(&src->count, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&dst->last_used,
+                          atomic_load_explicit(&src->last_used, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&dst->hit_pending,
+                          atomic_load_explicit(&src->hit_pending, memory_order_relaxed),
+                          memory_order_relaxed);
+    dst->created_at = src->created_at;
+    dst->position = src->position;
+    dst->source_text = src->source_text;
+    dst->translated_text = src->translated_text;
+}
+
+/* ============================================================================
+ * Hash index
+ * ============================================================================ */
+
+/* Marks the slot of an evicted entry: lookups probe past it, inserts do
+ * not reuse it (its tag may be read concurrently) */
+static CacheEntry index_tombstone;
+
+/* Index tag: first 8 digest bytes, big-endian */
+static uint64_t digest_tag(const unsigned char *digest) {
+    uint64_t tag = 0;
+    for (int i = 0; i < 8; i++) {
+        tag = (tag << 8) | digest[i];
+    }
+    return tag;
+}
+
+/* Allocate an empty index table */
+static TextIndex *index_alloc(size_t capacity) {
+    TextIndex *index = calloc(1, sizeof(TextIndex) + capacity * sizeof(TextIndexSlot));
+    if (!index) {
+        LOG_DEBUG("Error: Memory allocation failed for cache index\n");
+        return NULL;
+    }
+
+    index->capacity = capacity;
+    return index;
+}
+
+/* Table capacity for entries plus one more */
+static size_t index_capacity_for(size_t entries) {
+    size_t capacity = INITIAL_INDEX_CAPACITY;
+    while (INDEX_FULL(entries + 1, capacity)) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/* Current table (NULL before the first entry) */
+static TextIndex *index_current(TextBackendContext *ctx) {
+    return atomic_load_explicit(&ctx->index, memory_order_acquire);
+}
+
+/* Replace the current table; the old one is retired */
+static void index_publish(TextBackendContext *ctx, TextIndex *index) {
+    TextIndex *old = atomic_exchange_explicit(&ctx->index, index, memory_order_acq_rel);
+    epoch_retire(old, free);
+}
+
+/* Insert entry into a table. An entry with the same key that is already
+ * indexed wins, so lookups return the earliest one like the array order.
+ * The slot is published after its tag. Returns true if inserted. */
+static bool index_insert(TextIndex *index, CacheEntry *entry) {
+    uint64_t tag = digest_tag(entry->key);
+    size_t mask = index->capacity - 1;
+    size_t pos = (size_t)tag & mask;
+    CacheEntry *current;
+
+    while ((current = atomic_load_explicit(&index->slots[pos].entry, memory_order_relaxed))) {
+        if (current != &index_tombstone && index->slots[pos].tag == tag &&
+            memcmp(current->key, entry->key, TRANS_CACHE_DIGEST_SIZE) == 0) {
+            return false;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    index->slots[pos].tag = tag;
+    atomic_store_explicit(&index->slots[pos].entry, entry, memory_order_release);
+    return true;
+}
+
+/* Find the slot holding key (safe without locks) */
+static TextIndexSlot *index_slot(TextIndex *index, const unsigned char *digest) {
+    if (!index) {
+        return NULL;
+    }
+
+    uint64_t tag = digest_tag(digest);
+    size_t mask = index->capacity - 1;
+    size_t pos = (size_t)tag & mask;
+    CacheEntry *entry;
+
+    while ((entry = atomic_load_explicit(&index->slots[pos].entry, memory_order_acquire))) {
+        if (entry != &index_tombstone && index->slots[pos].tag == tag &&
+            memcmp(entry->key, digest, TRANS_CACHE_DIGEST_SIZE) == 0) {
+            return &index->slots[pos];
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/* Find indexed entry by key */
+static CacheEntry *index_find(TextBackendContext *ctx, const unsigned char *digest) {
+    TextIndexSlot *slot = index_slot(index_current(ctx), digest);
+    return slot ? atomic_load_explicit(&slot->entry, memory_order_acquire) : NULL;
+}
+
+/* Make room for one more index entry: grow the table, or only drop its
+ * tombstones if they take up enough of it */
+static int index_reserve(TextBackendContext *ctx) {
+    TextIndex *index = index_current(ctx);
+    if (index && !INDEX_FULL(ctx->index_used + 1, index->capacity)) {
+        return 0;
+    }
+
+    size_t live = ctx->index_used - ctx->index_tombstones;
+    size_t capacity = index ? index->capacity : INITIAL_INDEX_CAPACITY;
+    if (index && live * 2 >= capacity) {
+        capacity *= 2;
+    }
+
+    TextIndex *grown = index_alloc(capacity);
+    if (!grown) {
+        return -1;
+    }
+
+    for (size_t i = 0; index && i < index->capacity; i++) {
+        CacheEntry *entry = atomic_load_explicit(&index->slots[i].entry, memory_order_relaxed);
+        if (entry && entry != &index_tombstone) {
+            index_insert(grown, entry);
+        }
+    }
+
+    index_publish(ctx, grown);
+    ctx->index_used = live;
+    ctx->index_tombstones = 0;
+    return 0;
+}
+
+/* Index entries array into a new table */
+static int index_rebuild(TextBackendContext *ctx) {
+    TextIndex *index = index_alloc(index_capacity_for(ctx->size));
+    if (!index) {
+        return -1;
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < ctx->size; i++) {
+        if (index_insert(index, ctx->entries[i])) {
+            used++;
+        }
+    }
+
+    index_publish(ctx, index);
+    ctx->index_used = used;
+    ctx->index_tombstones = 0;
+    return 0;
+}
+
+/* ============================================================================
+ * Entry storage
+ * ============================================================================ */
+
+/* Make room for one more entry pointer */
+static int entries_reserve(TextBackendContext *ctx) {
+    if (ctx->size < ctx->capacity) {
+        return 0;
+    }
+
+    size_t new_capacity = ctx->capacity * GROWTH_FACTOR;
+    CacheEntry **new_entries = realloc(ctx->entries, new_capacity * sizeof(CacheEntry *));
+    if (!new_entries) {
+        LOG_DEBUG("Error: Memory reallocation failed\n");
+        return -1;
+    }
+
+    ctx->entries = new_entries;
+    ctx->capacity = new_capacity;
+    return 0;
+}
+
+/* Store a new entry under key (not yet indexed) from interned language
+ * ids and texts of the given lengths */
+static CacheEntry *store_entry_ids(TextBackendContext *ctx, const unsigned char *key,
+                                   uint8_t from_id, uint8_t to_id,
+                                   const char *source_text, size_t source_len,
+                                   const char *translated_text, size_t translated_len) {
+    if (entries_reserve(ctx) != 0) {
+        return NULL;
+    }
+
+    char *source = arena_store(ctx, source_text, source_len);
+    char *target = source ? arena_store(ctx, translated_text, translated_len) : NULL;
+    CacheEntry *entry = target ? slab_alloc(ctx) : NULL;
+
+    if (!entry) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        arena_release(ctx, source);
+        arena_release(ctx, target);
+        return NULL;
+    }
+
+    memcpy(entry->key, key, TRANS_CACHE_DIGEST_SIZE);
+    entry->from_id = from_id;
+    entry->to_id = to_id;
+    entry->source_text = source;
+    entry->translated_text = target;
+    entry->position = (uint32_t)ctx->size;
+
+    ctx->entries[ctx->size++] = entry;
+    return entry;
+}
+
+/* Store a new entry under key (not yet indexed) */
+static CacheEntry *store_entry(TextBackendContext *ctx, const unsigned char *key,
+                               const char *from_lang, const char *to_lang,
+                               const char *source_text, const char *translated_text) {
+    return store_entry_ids(ctx, key, trans_cache_lang_id(from_lang), trans_cache_lang_id(to_lang),
+                           source_text, strlen(source_text),
+                           translated_text, strlen(translated_text));
+}
+
+/* Entry is a view of a snapshot record of ctx (tells by address, so hits
+ * need not read position, which writers change) */
+static bool is_snapshot_entry(const TextBackendContext *ctx, const CacheEntry *entry) {
+    return ctx->snapshot_count > 0 && entry >= ctx->snapshot_views &&
+           entry < ctx->snapshot_views + ctx->snapshot_count;
+}
+
+/* Relist flagged entries after they moved. While a rewrite is pending the
+ * list is not needed; if it cannot hold them all, fall back to a rewrite. */
+static void dirty_rebuild(TextBackendContext *ctx) {
+    size_t count = 0;
+
+    if (!atomic_load(&ctx->backend->rewrite_pending)) {
+        /* Snapshot views do not move */
+        for (size_t i = 0; i < ctx->dirty_count; i++) {
+            CacheEntry *entry = ctx->dirty[i];
+            if (is_snapshot_entry(ctx, entry) && entry->journal_state != JOURNAL_STATE_RETIRED) {
+                ctx->dirty[count++] = entry;
+            }
+        }
+        for (size_t i = 0; i < ctx->size; i++) {
+            if (!ctx->entries[i]->journal_state) {
+                continue;
+            }
+            if (count == ctx->dirty_capacity) {
+                atomic_store(&ctx->backend->rewrite_pending, true);
+                count = 0;
+                break;
+            }
+            ctx->dirty[count++] = ctx->entries[i];
+        }
+    }
+
+    ctx->dirty_count = count;
+}
+
+/* Move live entries and strings into fresh, densely packed storage and
+ * index them in a new table. Everything is allocated up front; on failure
+ * the old storage is kept. The old storage is retired, not freed. */
+static int compact_storage(TextBackendContext *ctx) {
+    size_t slab_count = (ctx->size + SLAB_ENTRIES - 1) / SLAB_ENTRIES;
+    size_t live_bytes = ctx->arena_bytes - ctx->arena_dead;
+
+    CacheEntry **slabs = slab_count ? calloc(slab_count, sizeof(CacheEntry *)) : NULL;
+    TextArenaBlock *block = arena_new_block(live_bytes);
+    TextIndex *index = index_alloc(index_capacity_for(ctx->size));
+    bool ok = block && index && (slab_count == 0 || slabs);
+
+    for (size_t i = 0; ok && i < slab_count; i++) {
+        slabs[i] = malloc(SLAB_ENTRIES * sizeof(CacheEntry));
+        ok = slabs[i] != NULL;
+    }
+
+    if (!ok) {
+        LOG_DEBUG("Warning: Not enough memory to compact cache storage\n");
+        if (slabs) {
+            slabs_free(slabs, slab_count);
+        }
+        free(block);
+        free(index);
+        return -1;
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < ctx->size; i++) {
+        CacheEntry *old_entry = ctx->entries[i];
+        CacheEntry *entry = &slabs[i / SLAB_ENTRIES][i % SLAB_ENTRIES];
+        copy_entry(entry, old_entry);
+
+        const char *texts[2] = { old_entry->source_text, old_entry->translated_text };
+        char *copies[2];
+        for (int t = 0; t < 2; t++) {
+            size_t record = arena_record_size(arena_string_length(texts[t]));
+            memcpy(block->data + block->used, texts[t] - ARENA_RECORD_HEADER, record);
+            copies[t] = block->data + block->used + ARENA_RECORD_HEADER;
+            block->used += record;
+        }
+        entry->source_text = copies[0];
+        entry->translated_text = copies[1];
+
+        /* Updates through a pointer to the old copy are redirected by key */
+        old_entry->journal_state = JOURNAL_STATE_RETIRED;
+        ctx->entries[i] = entry;
+
+        if (index_insert(index, entry)) {
+            used++;
+        }
+    }
+
+    /* Entries moved: the dirty list must point at the new copies (relisting
+     * reads the old list, so before the old storage is retired) */
+    dirty_rebuild(ctx);
+
+    /* Unlink the old storage before retiring it */
+    index_publish(ctx, index);
+    ctx->index_used = used;
+    ctx->index_tombstones = 0;
+    slabs_retire(ctx->slabs, ctx->slab_count);
+    arena_retire(ctx->arena);
+
+    ctx->slabs = slabs;
+    ctx->slab_count = slab_count;
+    ctx->slab_used = ctx->size - (slab_count ? (slab_count - 1) * SLAB_ENTRIES : 0);
+    ctx->dead_entries = 0;
+    ctx->arena = block;
+    ctx->arena_bytes = block->used;
+    ctx->arena_dead = 0;
+
+    LOG_DEBUG("Compacted cache storage: %zu entries, %zu string bytes\n",
+              ctx->size, ctx->arena_bytes);
+    return 0;
+}
+
+/* Compact once more than half of the entry or string storage is dead
+ * (removed entries, replaced translations) */
+static void compact_if_mostly_dead(TextBackendContext *ctx) {
+    if (MOSTLY_DEAD(ctx->dead_entries, slab_slots(ctx)) ||
+        MOSTLY_DEAD(ctx->arena_dead, ctx->arena_bytes)) {
+        compact_storage(ctx);
+    }
+}
+
+/* Remove matching entries from one slice. Survivors are indexed in a new
+ * table before anything changes, so running out of memory removes nothing.
+ * Removed entries stay readable in their slab until the next compaction. */
+static size_t remove_entries(TextBackendContext *ctx, TextEntryFilter match,
+                             void *user_data) {
+    bool any = false;
+    for (size_t i = 0; !any && i < ctx->size; i++) {
+        any = match(ctx->entries[i], user_data);
+    }
+
+    size_t removed = 0;
+
+    if (any) {
+        TextIndex *index = index_alloc(index_capacity_for(ctx->size));
+        if (!index) {
+            LOG_INFO("Warning: Not enough memory to remove cache entries\n");
+            return 0;
+        }
+
+        size_t used = 0;
+        size_t write_idx = 0;
+
+        for (size_t i = 0; i < ctx->size; i++) {
+            CacheEntry *entry = ctx->entries[i];
+
+            if (match(entry, user_data)) {
+                arena_release(ctx, entry->source_text);
+                arena_release(ctx, entry->translated_text);
+                entry->journal_state = JOURNAL_STATE_RETIRED;
+                removed++;
+            } else {
+                entry->position = (uint32_t)write_idx;
+                ctx->entries[write_idx++] = entry;
+                if (index_insert(index, entry)) {
+                    used++;
+                }
+            }
+        }
+
+        ctx->size = write_idx;
+        ctx->dead_entries += removed;
+        index_publish(ctx, index);
+        ctx->index_used = used;
+        ctx->index_tombstones = 0;
+
+        /* A bulk removal rewrites (compacts) the base file rather than
+         * appending one removal record per entry to the journal */
+        atomic_store(&ctx->backend->rewrite_pending, true);
+        ctx->dirty_count = 0;
+    }
+
+    /* Also reclaims strings replaced by update_translation */
+    compact_if_mostly_dead(ctx);
+
+    return removed;
+}
+
+/* ============================================================================
+ * Size bound (W-TinyLFU)
+ * ============================================================================ */
+
+/* Allocate a sketch wide enough for entries (fewer collisions between the
+ * keys it tracks than one counter per entry would give) */
+static int sketch_init(TextFrequencySketch *sketch, size_t entries) {
+    size_t blocks = SKETCH_MIN_BLOCKS;
+    while (blocks * 16 < entries * SKETCH_COUNTERS_PER_ENTRY) {
+        blocks *= 2;
+    }
+
+    sketch->table = calloc(blocks * 4, sizeof(atomic_ullong));
+    if (!sketch->table) {
+        LOG_DEBUG("Error: Memory allocation failed for cache frequency sketch\n");
+        return -1;
+    }
+
+    sketch->block_mask = blocks - 1;
+    atomic_init(&sketch->samples, 0);
+    sketch->sample_limit = entries * SKETCH_RESET_FACTOR;
+    return 0;
+}
+
+/* Word of row in the block of key, and the counter's bit offset in it
+ * (digest bytes 8..15 pick the block, 16..19 the counters) */
+static atomic_ullong *sketch_word(const TextFrequencySketch *sketch, const unsigned char *key,
+                                  int row, unsigned int *shift) {
+    uint64_t block;
+    memcpy(&block, key + 8, sizeof(block));
+    *shift = (key[16 + row] & 15) * 4;
+    return &sketch->table[((size_t)block & sketch->block_mask) * 4 + (size_t)row];
+}
+
+/* Count a request for key (lock-free; saturated counters are only read) */
+static void sketch_increment(TextFrequencySketch *sketch, const unsigned char *key) {
+    if (!sketch->table) {
+        return;
+    }
+
+    bool added = false;
+    for (int row = 0; row < 4; row++) {
+        unsigned int shift;
+        atomic_ullong *word = sketch_word(sketch, key, row, &shift);
+        unsigned long long old = atomic_load_explicit(word, memory_order_relaxed);
+
+        while (((old >> shift) & 15) < SKETCH_COUNTER_MAX) {
+            if (atomic_compare_exchange_weak_explicit(word, &old, old + (1ULL << shift),
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                added = true;
+                break;
+            }
+        }
+    }
+
+    if (added) {
+        atomic_fetch_add_explicit(&sketch->samples, 1, memory_order_relaxed);
+    }
+}
+
+/* Estimated requests for key: the smallest of its counters */
+static unsigned int sketch_frequency(const TextFrequencySketch *sketch, const unsigned char *key) {
+    unsigned int frequency = SKETCH_COUNTER_MAX;
+
+    for (int row = 0; row < 4; row++) {
+        unsigned int shift;
+        atomic_ullong *word = sketch_word(sketch, key, row, &shift);
+        unsigned int count =
+            (unsigned int)(atomic_load_explicit(word, memory_order_relaxed) >> shift) & 15;
+        if (count < frequency) {
+            frequency = count;
+        }
+    }
+    return frequency;
+}
+
+/* Halve all counters once enough requests were counted, so popularity
+ * fades (caller holds the shard write lock) */
+static void sketch_age(TextFrequencySketch *sketch) {
+    if (!sketch->table ||
+        atomic_load_explicit(&sketch->samples, memory_order_relaxed) < sketch->sample_limit) {
+        return;
+    }
+
+    size_t words = (sketch->block_mask + 1) * 4;
+    for (size_t i = 0; i < words; i++) {
+        unsigned long long old = atomic_load_explicit(&sketch->table[i], memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&sketch->table[i], &old,
+                                                      (old >> 1) & 0x7777777777777777ULL,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+        }
+    }
+    atomic_store_explicit(&sketch->samples, sketch->sample_limit / 2, memory_order_relaxed);
+}
+
+/* Bytes held by the live entries of a slice */
+static size_t slice_bytes(const TextBackendContext *ctx) {
+    return ctx->arena_bytes - ctx->arena_dead + ctx->size * ENTRY_OVERHEAD;
+}
+
+/* Slice is over its size bound */
+static bool over_bound(const TextBackendContext *ctx) {
+    return (ctx->max_entries && ctx->size > ctx->max_entries) ||
+           (ctx->max_bytes && slice_bytes(ctx) > ctx->max_bytes);
+}
+
+/* xorshift64 for victim sampling */
+static uint64_t next_random(TextBackendContext *ctx) {
+    uint64_t x = ctx->random_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    ctx->random_state = x;
+    return x;
+}
+
+/* Least requested of a few entries sampled outside the window (ties: least
+ * recently used), skipping exclude. NULL if none could be sampled. */
+static CacheEntry *sample_victim(TextBackendContext *ctx, const CacheEntry *exclude) {
+    CacheEntry *victim = NULL;
+    unsigned int victim_frequency = 0;
+    int sampled = 0;
+
+    for (int tries = 0; ctx->size > 0 && sampled < EVICTION_SAMPLES &&
+                        tries < EVICTION_SAMPLES * 4; tries++) {
+        CacheEntry *entry = ctx->entries[next_random(ctx) % ctx->size];
+        if (entry == exclude || entry->id >= ctx->window_min_id) {
+            continue;
+        }
+        sampled++;
+
+        unsigned int frequency = ctx->sketch.table ? sketch_frequency(&ctx->sketch, entry->key) : 0;
+        if (!victim || frequency < victim_frequency ||
+            (frequency == victim_frequency && entry->last_used < victim->last_used)) {
+            victim = entry;
+            victim_frequency = frequency;
+        }
+    }
+    return victim;
+}
+
+/* Take entry out of the slice: tombstone its index slot and move the last
+ * entry into its place. Lookups in progress keep reading it; its slab slot
+ * and strings are dead space until compaction. */
+static void unlink_entry(TextBackendContext *ctx, CacheEntry *entry) {
+    TextIndexSlot *slot = index_slot(index_current(ctx), entry->key);
+    if (slot && atomic_load_explicit(&slot->entry, memory_order_relaxed) == entry) {
+        atomic_store_explicit(&slot->entry, &index_tombstone, memory_order_release);
+        ctx->index_tombstones++;
+    }
+
+    CacheEntry *last = ctx->entries[--ctx->size];
+    if (last != entry) {
+        last->position = entry->position;
+        ctx->entries[entry->position] = last;
+    }
+
+    arena_release(ctx, entry->source_text);
+    arena_release(ctx, entry->translated_text);
+    entry->journal_state = JOURNAL_STATE_RETIRED;
+    ctx->dead_entries++;
+}
+
+/* Remember an evicted key for the journal. While a rewrite is pending the
+ * list is not needed; if it cannot grow, fall back to a rewrite. */
+static void note_removed(TextBackendContext *ctx, const unsigned char *key) {
+    if (atomic_load(&ctx->backend->rewrite_pending)) {
+        return;
+    }
+
+    if (ctx->removed_count == ctx->removed_capacity) {
+        size_t new_capacity = ctx->removed_capacity ?
+                              ctx->removed_capacity * GROWTH_FACTOR : INITIAL_REMOVED_CAPACITY;
+        void *new_removed = realloc(ctx->removed, new_capacity * sizeof(*ctx->removed));
+        if (!new_removed) {
+            LOG_DEBUG("Warning: Cannot track cache eviction, next save rewrites the file\n");
+            atomic_store(&ctx->backend->rewrite_pending, true);
+            ctx->removed_count = 0;
+            return;
+        }
+        ctx->removed = new_removed;
+        ctx->removed_capacity = new_capacity;
+    }
+
+    memcpy(ctx->removed[ctx->removed_count++], key, TRANS_CACHE_DIGEST_SIZE);
+}
+
+/* Evict entry, journaling its removal */
+static void evict_entry(TextBackendContext *ctx, CacheEntry *entry) {
+    note_removed(ctx, entry->key);
+    unlink_entry(ctx, entry);
+    ctx->evicted++;
+}
+
+/* Put a new entry into the admission window */
+static void window_push(TextBackendContext *ctx, const CacheEntry *entry) {
+    size_t slots = ctx->window_size + 1;
+    TextWindowSlot *slot = &ctx->window[(ctx->window_head + ctx->window_count) % slots];
+
+    memcpy(slot->key, entry->key, TRANS_CACHE_DIGEST_SIZE);
+    slot->id = entry->id;
+    if (ctx->window_count++ == 0) {
+        ctx->window_min_id = entry->id;
+    }
+}
+
+/* Take the oldest entry out of the window. Returns it, or NULL if it was
+ * removed meanwhile (a new translation keeps the id, and its place). */
+static CacheEntry *window_pop(TextBackendContext *ctx) {
+    size_t slots = ctx->window_size + 1;
+    TextWindowSlot *slot = &ctx->window[ctx->window_head];
+
+    ctx->window_head = (ctx->window_head + 1) % slots;
+    ctx->window_count--;
+    ctx->window_min_id = ctx->window_count ? ctx->window[ctx->window_head].id : INT_MAX;
+
+    CacheEntry *entry = index_find(ctx, slot->key);
+    return entry && entry->id == slot->id ? entry : NULL;
+}
+
+/* Bring the slice back under its bound after added (may be NULL) grew it.
+ * Entries pushed out of the window compete with a sampled victim from the
+ * rest and the less requested one goes; if that is not enough (the window
+ * alone is over the bound), its oldest entries go too. */
+static void enforce_bound(TextBackendContext *ctx, const CacheEntry *added) {
+    if (!ctx->window) {
+        return;
+    }
+
+    unsigned long long evicted = ctx->evicted;
+
+    if (added) {
+        window_push(ctx, added);
+    }
+
+    while (ctx->window_count > ctx->window_size) {
+        CacheEntry *candidate = window_pop(ctx);
+        bool contested = false;
+
+        while (candidate && over_bound(ctx)) {
+            CacheEntry *victim = sample_victim(ctx, candidate);
+            contested = true;
+
+            if (!victim || sketch_frequency(&ctx->sketch, candidate->key) <=
+                           sketch_frequency(&ctx->sketch, victim->key)) {
+                evict_entry(ctx, candidate);
+                ctx->rejected++;
+                candidate = NULL;
+            } else {
+                evict_entry(ctx, victim);
+            }
+        }
+
+        if (candidate && contested) {
+            ctx->admitted++;
+        }
+    }
+
+    while (over_bound(ctx) && ctx->size > 0) {
+        CacheEntry *victim = sample_victim(ctx, NULL);
+        if (!victim) {
+            if (ctx->window_count == 0) {
+                break;
+            }
+            victim = window_pop(ctx);
+            if (!victim) {
+                continue;
+            }
+        }
+        evict_entry(ctx, victim);
+    }
+
+    if (ctx->evicted != evicted) {
+        compact_if_mostly_dead(ctx);
+    }
+}
+
+/* Set up the size bound of a slice (per-slice share of options) */
+static int bound_init(TextBackendContext *ctx, const TextBackendOptions *options,
+                      size_t slice_count, uint64_t seed) {
+    ctx->window_min_id = INT_MAX;
+    if (!options || (options->max_entries == 0 && options->max_bytes == 0)) {
+        return 0;
+    }
+
+    ctx->max_entries = options->max_entries ?
+                       (options->max_entries + slice_count - 1) / slice_count : 0;
+    ctx->max_bytes = options->max_bytes ?
+                     (options->max_bytes + slice_count - 1) / slice_count : 0;
+
+    /* Expected entries at the bound sizes the sketch and the window */
+    size_t entries = ctx->max_bytes ? ctx->max_bytes / SKETCH_ENTRY_ESTIMATE : SIZE_MAX;
+    if (ctx->max_entries && ctx->max_entries < entries) {
+        entries = ctx->max_entries;
+    }
+    if (entries == 0) {
+        entries = 1;
+    }
+
+    ctx->window_size = entries * WINDOW_PERCENT / 100;
+    if (ctx->window_size == 0) {
+        ctx->window_size = 1;
+    }
+    ctx->window = malloc((ctx->window_size + 1) * sizeof(TextWindowSlot));
+    if (!ctx->window || sketch_init(&ctx->sketch, entries) != 0) {
+        LOG_DEBUG("Error: Memory allocation failed for cache eviction state\n");
+        return -1;
+    }
+
+    ctx->random_state = seed | 1;
+    return 0;
+}
+
+/* Evict entries loaded beyond the bound, least recently used first (the
+ * sketch is still empty). Returns the number evicted. */
+static size_t trim_to_bound(TextBackendContext *ctx) {
+    size_t trimmed = 0;
+
+    while (ctx->window && over_bound(ctx)) {
+        CacheEntry *victim = sample_victim(ctx, NULL);
+        if (!victim) {
+            break;
+        }
+        unlink_entry(ctx, victim);
+        trimmed++;
+    }
+
+    if (trimmed > 0) {
+        compact_if_mostly_dead(ctx);
+    }
+    return trimmed;
+}
+
+/* ============================================================================
+ * Compiled snapshot
+ * ============================================================================ */
+
+/* Visitor for visit_entries; returns false to stop */
+typedef bool (*TextEntryVisitor)(CacheEntry *entry, void *user_data);
+
+/* Shard index of a slice */
+static size_t slice_index(const TextBackendContext *ctx) {
+    return (size_t)(ctx - ctx->backend->slices);
+}
+
+/* Give a slice its section of the snapshot. The arrays are zeroed on first
+ * touch by the kernel, so this costs the same for any number of records. */
+static int snapshot_attach(TextBackendContext *ctx, const CacheSnapshot *snapshot) {
+    size_t count = cache_snapshot_count(snapshot, slice_index(ctx));
+    if (count == 0) {
+        return 0;
+    }
+
+    ctx->snapshot_views = calloc(count, sizeof(CacheEntry));
+    ctx->snapshot_state = calloc(count, sizeof(*ctx->snapshot_state));
+    ctx->snapshot_next = calloc(count, sizeof(*ctx->snapshot_next));
+    if (!ctx->snapshot_views || !ctx->snapshot_state || !ctx->snapshot_next) {
+        LOG_DEBUG("Error: Memory allocation failed for cache snapshot views\n");
+        return -1;
+    }
+
+    ctx->snapshot_count = count;
+    return 0;
+}
+
+/* Fill entry from record index. Returns false if the record is corrupt. */
+static bool snapshot_fill(const TextBackendContext *ctx, size_t index, CacheEntry *entry) {
+    const CacheSnapshot *snapshot = ctx->backend->snapshot;
+    size_t shard = slice_index(ctx);
+    const CacheSnapshotRecord *record = cache_snapshot_record(snapshot, shard, index);
+
+    const char *source, *target;
+    if (!cache_snapshot_texts(snapshot, shard, record, &source, &target) ||
+        memchr(record->from_lang, '\0', sizeof(record->from_lang)) == NULL ||
+        memchr(record->to_lang, '\0', sizeof(record->to_lang)) == NULL) {
+        return false;
+    }
+
+    memcpy(entry->key, record->key, TRANS_CACHE_DIGEST_SIZE);
+    entry->from_id = trans_cache_lang_id(record->from_lang);
+    entry->to_id = trans_cache_lang_id(record->to_lang);
+    entry->journal_state = 0;
+    atomic_store_explicit(&entry->hit_pending, 0, memory_order_relaxed);
+    entry->id = record->id;
+    atomic_store_explicit(&entry->count, record->count, memory_order_relaxed);
+    atomic_store_explicit(&entry->last_used, record->last_used, memory_order_relaxed);
+    entry->created_at = record->created_at;
+    entry->position = SNAPSHOT_POSITION;
+    entry->source_text = (char *)source;
+    entry->translated_text = (char *)target;
+    return true;
+}
+
+/* View of record index, made on first use (safe without locks).
+ * NULL if the record is dead. */
+static CacheEntry *snapshot_view(TextBackendContext *ctx, size_t index) {
+    _Atomic uint8_t *state = &ctx->snapshot_state[index];
+
+    for (;;) {
+        uint8_t current = atomic_load_explicit(state, memory_order_acquire);
+        if (current == SNAPSHOT_VIEW) {
+            return &ctx->snapshot_views[index];
+        }
+        if (current == SNAPSHOT_DEAD) {
+            return NULL;
+        }
+        if (current == SNAPSHOT_BUSY) {
+            sched_yield();
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(state, &current, SNAPSHOT_BUSY,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            bool ok = snapshot_fill(ctx, index, &ctx->snapshot_views[index]);
+            if (!ok) {
+                LOG_DEBUG("Warning: Corrupt cache snapshot record, skipping\n");
+            }
+            atomic_store_explicit(state, ok ? SNAPSHOT_VIEW : SNAPSHOT_DEAD, memory_order_release);
+            return ok ? &ctx->snapshot_views[index] : NULL;
+        }
+    }
+}
+
+/* Index of the live record for key, or -1 */
+static long snapshot_record_of(TextBackendContext *ctx, const unsigned char *key) {
+    if (ctx->snapshot_count == 0) {
+        return -1;
+    }
+
+    long index = cache_snapshot_find(ctx->backend->snapshot, slice_index(ctx), key);
+    if (index < 0 || atomic_load_explicit(&ctx->snapshot_state[index], memory_order_acquire) ==
+                     SNAPSHOT_DEAD) {
+        return -1;
+    }
+    return index;
+}
+
+/* View of the live record for key, or NULL */
+static CacheEntry *snapshot_find(TextBackendContext *ctx, const unsigned char *key) {
+    long index = snapshot_record_of(ctx, key);
+    return index < 0 ? NULL : snapshot_view(ctx, (size_t)index);
+}
+
+/* Mark record index dead: its key was replaced or removed in memory
+ * (caller holds the shard write lock). A view lookups still hold is retired
+ * like a replaced entry. */
+static void snapshot_kill(TextBackendContext *ctx, size_t index) {
+    _Atomic uint8_t *state = &ctx->snapshot_state[index];
+
+    for (;;) {
+        uint8_t current = atomic_load_explicit(state, memory_order_acquire);
+        if (current == SNAPSHOT_DEAD) {
+            return;
+        }
+        if (current == SNAPSHOT_BUSY) {
+            sched_yield();
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(state, &current, SNAPSHOT_DEAD,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            if (current == SNAPSHOT_VIEW) {
+                ctx->snapshot_views[index].journal_state = JOURNAL_STATE_RETIRED;
+            }
+            ctx->snapshot_dead++;
+            return;
+        }
+    }
+}
+
+/* List a view hit for the first time since the last flush (lock-free push;
+ * flush_hits takes the whole list) */
+static void snapshot_note_hit(TextBackendContext *ctx, const CacheEntry *entry) {
+    uint32_t record = (uint32_t)(entry - ctx->snapshot_views) + 1;
+    uint32_t head = atomic_load_explicit(&ctx->snapshot_hits, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&ctx->snapshot_next[record - 1], head, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&ctx->snapshot_hits, &head, record,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/* Live entry of record index for reading under the shard lock: its view if
+ * made, else filled into scratch. NULL if the record is dead. */
+static CacheEntry *snapshot_entry(TextBackendContext *ctx, size_t index, CacheEntry *scratch) {
+    uint8_t state = atomic_load_explicit(&ctx->snapshot_state[index], memory_order_acquire);
+    if (state == SNAPSHOT_DEAD) {
+        return NULL;
+    }
+    if (state != SNAPSHOT_UNUSED) {
+        return snapshot_view(ctx, index);
+    }
+    return snapshot_fill(ctx, index, scratch) ? scratch : NULL;
+}
+
+/* Call visit on every live entry of a slice, in memory first, then in the
+ * snapshot. Stops and returns false when visit does. */
+static bool visit_entries(TextBackendContext *ctx, TextEntryVisitor visit, void *user_data) {
+    for (size_t i = 0; i < ctx->size; i++) {
+        if (!visit(ctx->entries[i], user_data)) {
+            return false;
+        }
+    }
+
+    CacheEntry scratch;
+    for (size_t i = 0; i < ctx->snapshot_count; i++) {
+        CacheEntry *entry = snapshot_entry(ctx, i, &scratch);
+        if (entry && !visit(entry, user_data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Remove the snapshot entries that match (caller holds the shard write
+ * lock). Their removal reaches disk through a rewrite. */
+static size_t remove_snapshot_entries(TextBackendContext *ctx, TextEntryFilter match,
+                                      void *user_data) {
+    size_t removed = 0;
+    CacheEntry scratch;
+
+    for (size_t i = 0; i < ctx->snapshot_count; i++) {
+        CacheEntry *entry = snapshot_entry(ctx, i, &scratch);
+        if (entry && match(entry, user_data)) {
+            snapshot_kill(ctx, i);
+            removed++;
+        }
+    }
+
+    if (removed > 0) {
+        atomic_store(&ctx->backend->rewrite_pending, true);
+    }
+    return removed;
+}
+
+/* Remove matching entries from all slices */
+size_t text_backend_remove_entries(TransCache *cache, TextEntryFilter match,
+                                   void *user_data) {
+    if (!cache || !match) {
+        return 0;
+    }
+
+    size_t removed = 0;
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        trans_cache_lock_shard(cache, i, true);
+        TextBackendContext *ctx = cache->shards[i].backend_ctx;
+        removed += remove_entries(ctx, match, user_data);
+        removed += remove_snapshot_entries(ctx, match, user_data);
+        trans_cache_unlock_shard(cache, i);
+    }
+
+    return removed;
+}
+
+/* ============================================================================
+ * Journal
+ * ============================================================================ */
+
+/* Record that entry has unsaved changes */
+static void mark_dirty(TextBackendContext *ctx, CacheEntry *entry, uint8_t state) {
+    if (entry->journal_state >= state) {
+        return;
+    }
+
+    bool listed = entry->journal_state != 0;
+    entry->journal_state = state;
+
+    /* A pending rewrite persists every entry anyway */
+    if (listed || atomic_load(&ctx->backend->rewrite_pending)) {
+        return;
+    }
+
+    if (ctx->dirty_count == ctx->dirty_capacity) {
+        size_t new_capacity = ctx->dirty_capacity ?
+                              ctx->dirty_capacity * GROWTH_FACTOR : INITIAL_DIRTY_CAPACITY;
+        CacheEntry **new_dirty = realloc(ctx->dirty, new_capacity * sizeof(CacheEntry *));
+        if (!new_dirty) {
+            LOG_DEBUG("Warning: Cannot track cache change, next save rewrites the file\n");
+            atomic_store(&ctx->backend->rewrite_pending, true);
+            ctx->dirty_count = 0;
+            return;
+        }
+        ctx->dirty = new_dirty;
+        ctx->dirty_capacity = new_capacity;
+    }
+
+    ctx->dirty[ctx->dirty_count++] = entry;
+}
+
+/* Serialize entry as one JSONL record (caller frees). A full record has the
+ * base file format; otherwise only hash, count and last_used are written. */
+static char *entry_record(const CacheEntry *entry, bool full) {
+    char hash[65];
+    trans_cache_entry_hash(entry, hash);
+
+    cJSON *json = cJSON_CreateObject();
+    if (!json) {
+        LOG_DEBUG("Error: Failed to create JSON object\n");
+        return NULL;
+    }
+
+    if (full) {
+        cJSON_AddNumberToObject(json, "id", entry->id);
+    }
+    cJSON_AddStringToObject(json, "hash", hash);
+    if (full) {
+        cJSON_AddStringToObject(json, "from", trans_cache_entry_from_lang(entry));
+        cJSON_AddStringToObject(json, "to", trans_cache_entry_to_lang(entry));
+        cJSON_AddStringToObject(json, "source", entry->source_text);
+        cJSON_AddStringToObject(json, "target", entry->translated_text);
+    }
+    cJSON_AddNumberToObject(json, "count", entry->count);
+    cJSON_AddNumberToObject(json, "last_used", (double)entry->last_used);
+    if (full) {
+        cJSON_AddNumberToObject(json, "created_at", (double)entry->created_at);
+    }
+
+    char *record = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    return record;
+}
+
+/* Write one record line; returns bytes written or -1 */
+static long write_record(FILE *fp, const CacheEntry *entry, bool full) {
+    char *record = entry_record(entry, full);
+    if (!record) {
+        return -1;
+    }
+
+    size_t len = strlen(record);
+    bool ok = fwrite(record, 1, len, fp) == len && fputc('\n', fp) != EOF;
+    free(record);
+
+    return ok ? (long)(len + 1) : -1;
+}
+
+/* Flush and fsync a stream */
+static bool sync_file(FILE *fp) {
+    return fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+}
+
+/* Write a removal record for key; returns bytes written or -1 */
+static long write_removal(FILE *fp, const unsigned char *key) {
+    char hash[65];
+    trans_cache_digest_to_hex(key, hash);
+
+    int len = fprintf(fp, "{\"hash\":\"%s\",\"removed\":true}\n", hash);
+    return len > 0 ? (long)len : -1;
+}
+
+/* Append records for all evicted keys and dirty entries to the journal, one
+ * shard at a time under its read lock (removals first: a key evicted and
+ * added again is dirty under its new entry). Writes nothing if nothing
+ * changed. Caller holds save_lock. */
+static int append_journal(TransCache *cache) {
+    TextBackend *backend = (TextBackend*)cache->backend_ctx;
+
+    size_t bytes = 0;
+    bool written_any = false;
+    bool ok = true;
+
+    for (size_t s = 0; ok && s < cache->shard_count; s++) {
+        TextBackendContext *ctx = cache->shards[s].backend_ctx;
+
+        /* Writers are excluded; journal_state is not touched by readers */
+        trans_cache_lock_shard(cache, s, false);
+        bool changed = ctx->dirty_count > 0 || ctx->removed_count > 0;
+        if (changed && !backend->journal) {
+            backend->journal = fopen(backend->journal_path, "a");
+            if (!backend->journal) {
+                LOG_DEBUG("Error: Failed to open cache journal: %s\n", backend->journal_path);
+                trans_cache_unlock_shard(cache, s);
+                return -1;
+            }
+        }
+        written_any = written_any || changed;
+        for (size_t i = 0; ok && i < ctx->removed_count; i++) {
+            long written = write_removal(backend->journal, ctx->removed[i]);
+            ok = written >= 0;
+            bytes += ok ? (size_t)written : 0;
+        }
+        for (size_t i = 0; ok && i < ctx->dirty_count; i++) {
+            CacheEntry *entry = ctx->dirty[i];
+            if (entry->journal_state == JOURNAL_STATE_RETIRED) {
+                continue;   /* Its replacement is listed after it */
+            }
+            long written = write_record(backend->journal, entry,
+                                        entry->journal_state == JOURNAL_STATE_FULL);
+            ok = written >= 0;
+            if (ok) {
+                bytes += (size_t)written;
+                entry->journal_state = 0;
+            }
+        }
+        ctx->dirty_count = 0;
+        ctx->removed_count = 0;
+        trans_cache_unlock_shard(cache, s);
+    }
+
+    if (!written_any) {
+        return 0;
+    }
+
+    if (!ok || !sync_file(backend->journal)) {
+        /* The journal may end in a torn record now; start over from a rewrite */
+        LOG_INFO("Warning: Failed to write cache journal, rewriting %s on next save\n",
+                 backend->file_path);
+        fclose(backend->journal);
+        backend->journal = NULL;
+        atomic_store(&backend->rewrite_pending, true);
+        return -1;
+    }
+
+    backend->journal_bytes += bytes;
+    return 0;
+}
+
+/* Output of rewrite_base_file */
+typedef struct {
+    FILE *fp;
+    CacheSnapshotWriter *snapshot;  /* NULL: none enabled, or writing it failed */
+    size_t bytes;
+    size_t entries;
+    bool ok;
+} RewriteOutput;
+
+/* Write one entry to the new base file and snapshot */
+static bool rewrite_entry(CacheEntry *entry, void *user_data) {
+    RewriteOutput *out = user_data;
+
+    long written = write_record(out->fp, entry, true);
+    out->ok = written >= 0;
+    out->bytes += out->ok ? (size_t)written : 0;
+    out->entries++;
+    entry->journal_state = 0;
+
+    if (out->snapshot && cache_snapshot_writer_add(out->snapshot, entry) != 0) {
+        cache_snapshot_writer_abort(out->snapshot);
+        out->snapshot = NULL;
+    }
+    return out->ok;
+}
+
+/* Write all entries to a new base file, atomically replace the old one and
+ * drop the journal. Shards are written one at a time under their read lock;
+ * changes to a shard after it was written are journaled by the next save.
+ * The old base and journal stay valid if anything fails. With snapshots
+ * enabled, one is compiled from the same pass and moved into place before
+ * the journal goes (a crash in between leaves a stale snapshot, which is
+ * not used). Caller holds save_lock. */
+static int rewrite_base_file(TransCache *cache) {
+    TextBackend *backend = (TextBackend*)cache->backend_ctx;
+
+    size_t path_len = strlen(backend->file_path);
+    char *temp_path = malloc(path_len + sizeof(TEMP_SUFFIX));
+    if (!temp_path) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return -1;
+    }
+    memcpy(temp_path, backend->file_path, path_len);
+    memcpy(temp_path + path_len, TEMP_SUFFIX, sizeof(TEMP_SUFFIX));
+
+    FILE *fp = fopen(temp_path, "w");
     if (!fp) {
+        LOG_DEBUG("Error: Failed to open cache file for writing: %s\n", temp_path);
+        free(temp_path);
+        return -1;
+    }
+
+    /* Removals from here on need another rewrite */
+    atomic_store(&backend->rewrite_pending, false);
+
+    RewriteOutput out = { .fp = fp, .ok = true };
+    if (backend->snapshot_path) {
+        out.snapshot = cache_snapshot_writer_open(backend->snapshot_path, cache->shard_count);
+    }
+
+    for (size_t s = 0; out.ok && s < cache->shard_count; s++) {
+        TextBackendContext *ctx = cache->shards[s].backend_ctx;
+
+        trans_cache_lock_shard(cache, s, false);
+        visit_entries(ctx, rewrite_entry, &out);
+        ctx->dirty_count = 0;
+        ctx->removed_count = 0;
+        trans_cache_unlock_shard(cache, s);
+
+        if (out.snapshot && cache_snapshot_writer_end_shard(out.snapshot) != 0) {
+            cache_snapshot_writer_abort(out.snapshot);
+            out.snapshot = NULL;
+        }
+    }
+
+    bool ok = out.ok && sync_file(fp);
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+
+    if (!ok || rename(temp_path, backend->file_path) != 0) {
+        LOG_INFO("Error: Failed to write cache file: %s\n", backend->file_path);
+        remove(temp_path);
+        free(temp_path);
+        cache_snapshot_writer_abort(out.snapshot);
+        atomic_store(&backend->rewrite_pending, true);
+        return -1;
+    }
+    free(temp_path);
+
+    if (backend->snapshot_path &&
+        (!out.snapshot ||
+         cache_snapshot_writer_finish(out.snapshot, backend->file_path,
+                                      atomic_load(&backend->next_id)) != 0)) {
+        LOG_INFO("Warning: Failed to compile cache snapshot %s, the next start parses %s\n",
+                 backend->snapshot_path, backend->file_path);
+    }
+
+    /* Everything in the journal is in the new base now. A crash before the
+     * journal is gone only replays records that are already applied. */
+    if (backend->journal) {
+        fclose(backend->journal);
+        backend->journal = NULL;
+    }
+    remove(backend->journal_path);
+
+    backend->base_bytes = out.bytes;
+    backend->journal_bytes = 0;
+
+    LOG_DEBUG("Rewrote cache file %s (%zu entries, %zu bytes)\n",
+              backend->file_path, out.entries, out.bytes);
+    return 0;
+}
+
+/* Fields of a JSONL record */
+typedef struct {
+    cJSON *id;
+    cJSON *hash;
+    cJSON *from;
+    cJSON *to;
+    cJSON *source;
+    cJSON *target;
+    cJSON *count;
+    cJSON *last_used;
+    cJSON *created_at;
+} EntryRecordFields;
+
+/* Extract record fields; returns true for a complete (full) entry record */
+static bool get_record_fields(cJSON *json, EntryRecordFields *fields) {
+    fields->id = cJSON_GetObjectItem(json, "id");
+    fields->hash = cJSON_GetObjectItem(json, "hash");
+    fields->from = cJSON_GetObjectItem(json, "from");
+    fields->to = cJSON_GetObjectItem(json, "to");
+    fields->source = cJSON_GetObjectItem(json, "source");
+    fields->target = cJSON_GetObjectItem(json, "target");
+    fields->count = cJSON_GetObjectItem(json, "count");
+    fields->last_used = cJSON_GetObjectItem(json, "last_used");
+    fields->created_at = cJSON_GetObjectItem(json, "created_at");
+
+    return cJSON_IsNumber(fields->id) && cJSON_IsString(fields->hash) &&
+           cJSON_IsString(fields->from) && cJSON_IsString(fields->to) &&
+           cJSON_IsString(fields->source) && cJSON_IsString(fields->target) &&
+           cJSON_IsNumber(fields->count) && cJSON_IsNumber(fields->last_used) &&
+           cJSON_IsNumber(fields->created_at);
+}
+
+/* Raise next_id past id (single-threaded load; INT_MAX has nothing past it) */
+static void note_loaded_id(TextBackend *backend, int id) {
+    if (id >= atomic_load(&backend->next_id) && id < INT_MAX) {
+        atomic_store(&backend->next_id, id + 1);
+    }
+}
+
+/* Apply one journal record on top of the loaded entries (which are indexed).
+ * Records carry absolute values, so replaying one twice is harmless.
+ * Returns 0 if applied or skipped, -1 on allocation failure. */
+static int replay_record(TextBackend *backend, cJSON *json) {
+    EntryRecordFields fields;
+    bool full = get_record_fields(json, &fields);
+    bool removal = cJSON_IsTrue(cJSON_GetObjectItem(json, "removed"));
+
+    unsigned char digest[TRANS_CACHE_DIGEST_SIZE];
+    if (!cJSON_IsString(fields.hash) ||
+        trans_cache_hex_to_digest(fields.hash->valuestring, digest) != 0 ||
+        (!removal && (!cJSON_IsNumber(fields.count) || !cJSON_IsNumber(fields.last_used)))) {
+        LOG_DEBUG("Warning: Invalid cache journal record, skipping\n");
+        return 0;
+    }
+
+    TextBackendContext *ctx =
+        &backend->slices[trans_cache_shard_of(digest, backend->slice_count)];
+    CacheEntry *entry = index_find(ctx, digest);
+
+    /* A live snapshot record is what the journal continues from (records
+     * written before the snapshot was compiled are already in it) */
+    long record = entry ? -1 : snapshot_record_of(ctx, digest);
+
+    if (removal) {
+        /* Eviction of an entry that may since have been removed */
+        if (entry) {
+            unlink_entry(ctx, entry);
+        } else if (record >= 0) {
+            snapshot_kill(ctx, (size_t)record);
+        }
+        return 0;
+    }
+
+    if (record >= 0) {
+        CacheEntry *view = snapshot_view(ctx, (size_t)record);
+        if (view && (!full || strcmp(view->translated_text, fields.target->valuestring) == 0)) {
+            atomic_store(&view->count, fields.count->valueint);
+            atomic_store(&view->last_used, (uint32_t)fields.last_used->valuedouble);
+            return 0;
+        }
+    }
+
+    if (!full) {
+        /* Count update for an entry that may since have been removed */
+        if (entry) {
+            entry->count = fields.count->valueint;
+            entry->last_used = (uint32_t)fields.last_used->valuedouble;
+        }
+        return 0;
+    }
+
+    if (entry) {
+        if (strcmp(entry->translated_text, fields.target->valuestring) != 0) {
+            const char *target = fields.target->valuestring;
+            char *translated = arena_store(ctx, target, strlen(target));
+            if (!translated) {
+                return -1;
+            }
+            arena_release(ctx, entry->translated_text);
+            entry->translated_text = translated;
+        }
+    } else {
+        if (index_reserve(ctx) != 0) {
+            return -1;
+        }
+        entry = store_entry(ctx, digest, fields.from->valuestring, fields.to->valuestring,
+                            fields.source->valuestring, fields.target->valuestring);
+        if (!entry) {
+            return -1;
+        }
+        if (index_insert(index_current(ctx), entry)) {
+            ctx->index_used++;
+        }
+        if (record >= 0) {
+            snapshot_kill(ctx, (size_t)record);     /* New translation */
+        }
+    }
+
+    entry->id = fields.id->valueint;
+    entry->count = fields.count->valueint;
+    entry->last_used = (uint32_t)fields.last_used->valuedouble;
+    entry->created_at = (uint32_t)fields.created_at->valuedouble;
+
+    note_loaded_id(backend, entry->id);
+    return 0;
+}
+
+/* ============================================================================
+ * Base file loader
+ * ============================================================================ */
+
+/* Fields of a base file record */
+enum {
+    RECORD_ID,
+    RECORD_HASH,
+    RECORD_FROM,
+    RECORD_TO,
+    RECORD_SOURCE,
+    RECORD_TARGET,
+    RECORD_COUNT,
+    RECORD_LAST_USED,
+    RECORD_CREATED_AT,
+    RECORD_FIELD_COUNT
+};
+
+static const char *const RECORD_FIELD_NAMES[RECORD_FIELD_COUNT] = {
+    "id", "hash", "from", "to", "source", "target", "count", "last_used", "created_at"
+};
+
+/* Value of a record field */
+typedef struct {
+    enum { VALUE_NONE, VALUE_STRING, VALUE_NUMBER, VALUE_OTHER } type;
+    const char *text;       /* String contents, still escaped if escaped is set */
+    size_t len;
+    bool escaped;
+    double number;
+} RecordValue;
+
+/* A record parsed by a load worker. Strings point into the mapped file, or
+ * into the worker's string blocks if they were unescaped or copied. */
+typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    uint8_t from_id;
+    uint8_t to_id;
+    int id;
+    int count;
+    uint32_t last_used;
+    uint32_t created_at;
+    uint32_t source_len;
+    uint32_t target_len;
+    const char *source;
+    const char *target;
+} LoadedRecord;
+
+/* Records of one slice found by one worker, in file order */
+typedef struct {
+    LoadedRecord *records;
+    size_t count;
+    size_t capacity;
+} LoadedBucket;
+
+/* A range of whole lines of the base file and the records found there */
+typedef struct {
+    TextBackend *backend;
+    const char *start;
+    const char *end;
+    LoadedBucket buckets[TRANS_CACHE_SHARDS];
+    TextArenaBlock *strings;        /* Unescaped and copied strings */
+    char lang_codes[2][LOAD_LANG_CODE_SIZE];   /* Last from / to code seen */
+    uint8_t lang_ids[2];
+    int max_id;
+    size_t loaded;
+    bool failed;                    /* Allocation failed: the range ends early */
+} LoadRange;
+
+/* Loading of one slice from all ranges */
+typedef struct {
+    TextBackendContext *ctx;
+    LoadRange *ranges;
+    size_t range_count;
+    bool failed;                    /* Index could not be built */
+} SliceLoad;
+
+/* Items handed out to run_parallel threads */
+typedef struct {
+    void (*work)(void *item);
+    char *items;
+    size_t item_size;
+    size_t count;
+    atomic_size_t next;
+} ParallelWork;
+
+static void *parallel_worker(void *arg) {
+    ParallelWork *pw = arg;
+    size_t i;
+    while ((i = atomic_fetch_add(&pw->next, 1)) < pw->count) {
+        pw->work(pw->items + i * pw->item_size);
+    }
+    return NULL;
+}
+
+/* Run work on each of count items on up to threads threads, the caller's
+ * included (it does them all if no thread can be started) */
+static void run_parallel(void (*work)(void *), void *items, size_t item_size,
+                         size_t count, size_t threads) {
+    ParallelWork pw = { .work = work, .items = items, .item_size = item_size, .count = count };
+    atomic_init(&pw.next, 0);
+
+    pthread_t tids[LOAD_MAX_THREADS];
+    size_t started = 0;
+    for (size_t i = 1; i < threads && i < count && started < LOAD_MAX_THREADS; i++) {
+        if (pthread_create(&tids[started], NULL, parallel_worker, &pw) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    parallel_worker(&pw);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+}
+
+/* Threads for loading: load_threads, or one per CPU */
+static size_t load_thread_count(const TextBackendOptions *options) {
+    long threads = options && options->load_threads ? (long)options->load_threads :
+                   sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) {
+        threads = 1;
+    }
+    return threads > LOAD_MAX_THREADS ? LOAD_MAX_THREADS : (size_t)threads;
+}
+
+/* Skip JSON whitespace */
+static const char *skip_space(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+    return p;
+}
+
+/* Scan a JSON string from after its opening quote. Returns the position
+ * after the closing quote, or NULL if unterminated or holding a NUL byte. */
+static const char *scan_string(const char *p, const char *end, bool *escaped) {
+    *escaped = false;
+    while (p < end) {
+        if (*p == '"') {
+            return p + 1;
+        }
+        if (*p == '\\') {
+            *escaped = true;
+            p += 2;
+        } else if (*p == '\0') {
+            return NULL;
+        } else {
+            p++;
+        }
+    }
+    return NULL;
+}
+
+/* Scan a JSON number into *value. Returns the position after it or NULL. */
+static const char *scan_number(const char *p, const char *end, double *value) {
+    char buffer[64];
+    size_t len = 0;
+
+    while (p + len < end && len < sizeof(buffer) - 1 &&
+           ((p[len] >= '0' && p[len] <= '9') || p[len] == '-' || p[len] == '+' ||
+            p[len] == '.' || p[len] == 'e' || p[len] == 'E')) {
+        buffer[len] = p[len];
+        len++;
+    }
+    buffer[len] = '\0';
+
+    char *number_end;
+    *value = strtod(buffer, &number_end);
+    return len > 0 && number_end == buffer + len ? p + len : NULL;
+}
+
+/* Position after literal if it starts at p, else NULL */
+static const char *scan_literal(const char *p, const char *end, const char *literal) {
+    size_t len = strlen(literal);
+    return (size_t)(end - p) >= len && memcmp(p, literal, len) == 0 ? p + len : NULL;
+}
+
+/* Find the record fields of the flat JSON object on [p, end). Returns
+ * false for anything else (nested values too); cJSON handles those. */
+static bool scan_record(const char *p, const char *end, RecordValue *fields) {
+    for (int i = 0; i < RECORD_FIELD_COUNT; i++) {
+        fields[i].type = VALUE_NONE;
+    }
+
+    p = skip_space(p, end);
+    if (p == end || *p != '{') {
+        return false;
+    }
+    p = skip_space(p + 1, end);
+    if (p < end && *p == '}') {
+        return skip_space(p + 1, end) == end;
+    }
+
+    while (p < end && *p == '"') {
+        bool escaped;
+        const char *key = p + 1;
+        p = scan_string(key, end, &escaped);
+        if (!p || escaped) {
+            return false;
+        }
+        size_t key_len = (size_t)(p - 1 - key);
+
+        p = skip_space(p, end);
+        if (p == end || *p != ':') {
+            return false;
+        }
+        p = skip_space(p + 1, end);
+        if (p == end) {
+            return false;
+        }
+
+        RecordValue value = { .type = VALUE_OTHER };
+        if (*p == '"') {
+            value.type = VALUE_STRING;
+            value.text = p + 1;
+            p = scan_string(p + 1, end, &value.escaped);
+            if (p) {
+                value.len = (size_t)(p - 1 - value.text);
+            }
+        } else if (*p == '-' || (*p >= '0' && *p <= '9')) {
+            value.type = VALUE_NUMBER;
+            p = scan_number(p, end, &value.number);
+        } else if (*p == 't') {
+            p = scan_literal(p, end, "true");
+        } else if (*p == 'f') {
+            p = scan_literal(p, end, "false");
+        } else if (*p == 'n') {
+            p = scan_literal(p, end, "null");
+        } else {
+            return false;       /* Object or array */
+        }
+        if (!p) {
+            return false;
+        }
+
+        /* The first of duplicate keys counts, as with cJSON */
+        for (int i = 0; i < RECORD_FIELD_COUNT; i++) {
+            const char *name = RECORD_FIELD_NAMES[i];
+            if (fields[i].type == VALUE_NONE && strncmp(name, key, key_len) == 0 &&
+                name[key_len] == '\0') {
+                fields[i] = value;
+                break;
+            }
+        }
+
+        p = skip_space(p, end);
+        if (p < end && *p == '}') {
+            return skip_space(p + 1, end) == end;
+        }
+        if (p == end || *p != ',') {
+            return false;
+        }
+        p = skip_space(p + 1, end);
+    }
+
+    return false;
+}
+
+/* Room for len bytes and a NUL in the range's string blocks */
+static char *load_string_alloc(LoadRange *range, size_t len) {
+    TextArenaBlock *block = range->strings;
+    if (!block || block->size - block->used < len + 1) {
+        block = arena_new_block(len + 1);
+        if (!block) {
+            return NULL;
+        }
+        block->next = range->strings;
+        range->strings = block;
+    }
+
+    char *data = block->data + block->used;
+    block->used += len + 1;
+    return data;
+}
+
+/* Make a string value plain text (unescaped, NUL-terminated if copy is
+ * set). Returns 0, 1 if malformed, -1 on allocation failure. */
+static int load_string(LoadRange *range, RecordValue *value, bool copy) {
+    if (!value->escaped && !copy) {
+        return 0;
+    }
+
+    char *out = load_string_alloc(range, value->len);
+    if (!out) {
+        return -1;
+    }
+
+    long len = (long)value->len;
+    if (value->escaped) {
+        len = json_unescape(value->text, value->len, out);
+        if (len < 0) {
+            return 1;
+        }
+    } else {
+        memcpy(out, value->text, value->len);
+    }
+    out[len] = '\0';
+
+    value->text = out;
+    value->len = (size_t)len;
+    value->escaped = false;
+    return 0;
+}
+
+/* Interned id of a language code (plain text), remembering the last code
+ * of each role as the global table takes a lock */
+static uint8_t load_lang_id(LoadRange *range, int role, const RecordValue *value) {
+    if (value->len >= LOAD_LANG_CODE_SIZE) {
+        return 0;   /* Too long to intern */
+    }
+
+    char *cached = range->lang_codes[role];
+    if (strlen(cached) != value->len || memcmp(cached, value->text, value->len) != 0) {
+        memcpy(cached, value->text, value->len);
+        cached[value->len] = '\0';
+        range->lang_ids[role] = trans_cache_lang_id(cached);
+    }
+    return range->lang_ids[role];
+}
+
+/* Saturating conversion of a JSON number, as cJSON's valueint */
+static int number_to_int(double number) {
+    if (number >= INT_MAX) {
+        return INT_MAX;
+    }
+    if (number <= (double)INT_MIN) {
+        return INT_MIN;
+    }
+    return (int)number;
+}
+
+/* Whether fields hold a complete entry record */
+static bool record_complete(const RecordValue *fields) {
+    for (int i = 0; i < RECORD_FIELD_COUNT; i++) {
+        bool number = i == RECORD_ID || i == RECORD_COUNT ||
+                      i == RECORD_LAST_USED || i == RECORD_CREATED_AT;
+        if (fields[i].type != (number ? VALUE_NUMBER : VALUE_STRING)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Add a complete record to its slice's bucket; copy makes the strings
+ * independent of where the fields point. Returns 0 if added or skipped,
+ * -1 on allocation failure. */
+static int load_record(LoadRange *range, RecordValue *fields, bool copy) {
+    for (int i = RECORD_HASH; i <= RECORD_TARGET; i++) {
+        int result = load_string(range, &fields[i], copy);
+        if (result != 0) {
+            if (result > 0) {
+                LOG_DEBUG("Warning: Failed to parse cache line, skipping\n");
+            }
+            return result < 0 ? -1 : 0;
+        }
+    }
+
+    LoadedRecord record = {
+        .from_id = load_lang_id(range, 0, &fields[RECORD_FROM]),
+        .to_id = load_lang_id(range, 1, &fields[RECORD_TO]),
+        .id = number_to_int(fields[RECORD_ID].number),
+        .count = number_to_int(fields[RECORD_COUNT].number),
+        .last_used = (uint32_t)fields[RECORD_LAST_USED].number,
+        .created_at = (uint32_t)fields[RECORD_CREATED_AT].number,
+        .source = fields[RECORD_SOURCE].text,
+        .target = fields[RECORD_TARGET].text
+    };
+    if (fields[RECORD_SOURCE].len > UINT32_MAX || fields[RECORD_TARGET].len > UINT32_MAX) {
+        LOG_DEBUG("Warning: Invalid cache entry format, skipping\n");
+        return 0;
+    }
+    record.source_len = (uint32_t)fields[RECORD_SOURCE].len;
+    record.target_len = (uint32_t)fields[RECORD_TARGET].len;
+
+    /* Stored hash saves rehashing; recompute it if malformed */
+    char hash[65];
+    const RecordValue *hash_value = &fields[RECORD_HASH];
+    bool hash_ok = hash_value->len == sizeof(hash) - 1;
+    if (hash_ok) {
+        memcpy(hash, hash_value->text, sizeof(hash) - 1);
+        hash[sizeof(hash) - 1] = '\0';
+        hash_ok = trans_cache_hex_to_digest(hash, record.key) == 0;
+    }
+    if (!hash_ok) {
+        for (int i = RECORD_FROM; i <= RECORD_SOURCE; i++) {
+            if (load_string(range, &fields[i], true) != 0) {
+                return -1;
+            }
+        }
+        trans_cache_calculate_digest(fields[RECORD_FROM].text, fields[RECORD_TO].text,
+                                     fields[RECORD_SOURCE].text, record.key);
+        record.source = fields[RECORD_SOURCE].text;
+    }
+
+    LoadedBucket *bucket =
+        &range->buckets[trans_cache_shard_of(record.key, range->backend->slice_count)];
+    if (bucket->count == bucket->capacity) {
+        size_t new_capacity = bucket->capacity ? bucket->capacity * GROWTH_FACTOR :
+                              INITIAL_CAPACITY;
+        LoadedRecord *records = realloc(bucket->records, new_capacity * sizeof(LoadedRecord));
+        if (!records) {
+            LOG_DEBUG("Error: Memory allocation failed\n");
+            return -1;
+        }
+        bucket->records = records;
+        bucket->capacity = new_capacity;
+    }
+    bucket->records[bucket->count++] = record;
+
+    if (record.id > range->max_id && record.id < INT_MAX) {
+        range->max_id = record.id;
+    }
+    range->loaded++;
+    return 0;
+}
+
+/* Parse one line with cJSON (for what scan_record does not handle) */
+static int load_line_cjson(LoadRange *range, const char *line, const char *end) {
+    size_t len = (size_t)(end - line);
+    char *text = malloc(len + 1);
+    if (!text) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return -1;
+    }
+    memcpy(text, line, len);
+    text[len] = '\0';
+
+    cJSON *json = cJSON_Parse(text);
+    free(text);
+    if (!json) {
+        LOG_DEBUG("Warning: Failed to parse cache line, skipping\n");
+        return 0;
+    }
+
+    EntryRecordFields fields;
+    if (!get_record_fields(json, &fields)) {
+        LOG_DEBUG("Warning: Invalid cache entry format, skipping\n");
+        cJSON_Delete(json);
+        return 0;
+    }
+
+    cJSON *items[RECORD_FIELD_COUNT] = {
+        fields.id, fields.hash, fields.from, fields.to, fields.source, fields.target,
+        fields.count, fields.last_used, fields.created_at
+    };
+    RecordValue values[RECORD_FIELD_COUNT];
+    for (int i = 0; i < RECORD_FIELD_COUNT; i++) {
+        if (cJSON_IsString(items[i])) {
+            values[i] = (RecordValue){ .type = VALUE_STRING, .text = items[i]->valuestring,
+                                       .len = strlen(items[i]->valuestring) };
+        } else {
+            values[i] = (RecordValue){ .type = VALUE_NUMBER, .number = items[i]->valuedouble };
+        }
+    }
+
+    int result = load_record(range, values, true);
+    cJSON_Delete(json);
+    return result;
+}
+
+/* Parse the lines of a range (run_parallel work) */
+static void load_range(void *item) {
+    LoadRange *range = item;
+    const char *p = range->start;
+
+    while (p < range->end) {
+        const char *newline = memchr(p, '\n', (size_t)(range->end - p));
+        const char *line_end = newline ? newline : range->end;
+
+        RecordValue fields[RECORD_FIELD_COUNT];
+        int result;
+        if (scan_record(p, line_end, fields)) {
+            if (record_complete(fields)) {
+                result = load_record(range, fields, false);
+            } else {
+                LOG_DEBUG("Warning: Invalid cache entry format, skipping\n");
+                result = 0;
+            }
+        } else {
+            result = load_line_cjson(range, p, line_end);
+        }
+        if (result != 0) {
+            range->failed = true;
+            return;
+        }
+
+        p = newline ? newline + 1 : range->end;
+    }
+}
+
+/* Entry shadowed by an earlier one with the same key (TextBackendContext *) */
+static bool entry_shadowed(const CacheEntry *entry, void *user_data) {
+    return index_find(user_data, entry->key) != entry;
+}
+
+/* Store a slice's records from all ranges in file order, then index the
+ * slice (run_parallel work). Only the first entry of a key is indexed;
+ * later duplicates are dropped (their slots are needed for eviction to
+ * find every entry through the index). */
+static void load_slice(void *item) {
+    SliceLoad *load = item;
+    TextBackendContext *ctx = load->ctx;
+    size_t slice = slice_index(ctx);
+
+    size_t total = 0;
+    for (size_t r = 0; r < load->range_count; r++) {
+        total += load->ranges[r].buckets[slice].count;
+    }
+    if (ctx->size + total > ctx->capacity) {
+        CacheEntry **entries = realloc(ctx->entries, (ctx->size + total) * sizeof(CacheEntry *));
+        if (entries) {
+            ctx->entries = entries;
+            ctx->capacity = ctx->size + total;
+        }
+    }
+
+    bool stored = true;
+    for (size_t r = 0; stored && r < load->range_count; r++) {
+        const LoadedBucket *bucket = &load->ranges[r].buckets[slice];
+        for (size_t i = 0; i < bucket->count; i++) {
+            const LoadedRecord *record = &bucket->records[i];
+            CacheEntry *entry = store_entry_ids(ctx, record->key, record->from_id, record->to_id,
+                                                record->source, record->source_len,
+                                                record->target, record->target_len);
+            if (!entry) {
+                stored = false;
+                break;
+            }
+            entry->id = record->id;
+            entry->count = record->count;
+            entry->last_used = record->last_used;
+            entry->created_at = record->created_at;
+        }
+
+        /* What follows a failed range in the file was not parsed */
+        stored = stored && !load->ranges[r].failed;
+    }
+
+    if (index_rebuild(ctx) != 0) {
+        load->failed = true;
+        return;
+    }
+    if (ctx->index_used < ctx->size) {
+        remove_entries(ctx, entry_shadowed, ctx);
+    }
+}
+
+/* Store the records of ranges in their slices and index all slices, on up
+ * to threads threads. Returns 0, or -1 if an index could not be built. */
+static int load_slices(TextBackend *backend, LoadRange *ranges, size_t range_count,
+                       size_t threads) {
+    SliceLoad loads[TRANS_CACHE_SHARDS];
+    for (size_t i = 0; i < backend->slice_count; i++) {
+        loads[i] = (SliceLoad){ .ctx = &backend->slices[i], .ranges = ranges,
+                                .range_count = range_count };
+    }
+
+    run_parallel(load_slice, loads, sizeof(SliceLoad), backend->slice_count, threads);
+
+    for (size_t i = 0; i < backend->slice_count; i++) {
+        if (loads[i].failed) {
+            LOG_INFO("Error: Failed to build cache index\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Load the base JSONL file into the slices and index them. The file is
+ * mapped and split at line boundaries into up to threads ranges, parsed in
+ * parallel; then each slice takes its records from all ranges in file
+ * order, so the first entry of a key wins as before. Sets *bytes_out to
+ * the file size. Returns 0, or -1 if an index could not be built. */
+static int load_base_file(TextBackend *backend, const char *file_path, size_t threads,
+                          size_t *bytes_out) {
+    *bytes_out = 0;
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
         /* File doesn't exist yet - this is OK */
         LOG_DEBUG("Cache file not found, will create new: %s\n", file_path);
+        return load_slices(backend, NULL, 0, 1);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return load_slices(backend, NULL, 0, 1);
+    }
+
+    size_t size = (size_t)st.st_size;
+    char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOG_INFO("Error: Failed to map cache file %s\n", file_path);
+        return load_slices(backend, NULL, 0, 1);
+    }
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+
+    /* Small files are not worth the threads */
+    size_t range_count = size / LOAD_MIN_RANGE_BYTES + 1;
+    if (range_count > threads) {
+        range_count = threads;
+    }
+
+    LoadRange *ranges = calloc(range_count, sizeof(LoadRange));
+    if (!ranges) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        munmap(data, size);
+        return load_slices(backend, NULL, 0, 1);
+    }
+
+    const char *end = data + size;
+    const char *p = data;
+    for (size_t i = 0; i < range_count; i++) {
+        const char *split = i == range_count - 1 ? end : data + size / range_count * (i + 1);
+        if (split < p) {
+            split = p;
+        }
+        const char *newline = split < end ? memchr(split, '\n', (size_t)(end - split)) : NULL;
+
+        ranges[i].backend = backend;
+        ranges[i].start = p;
+        ranges[i].end = newline ? newline + 1 : end;
+        p = ranges[i].end;
+    }
+
+    run_parallel(load_range, ranges, sizeof(LoadRange), range_count, range_count);
+
+    /* Ranges after a failed one are not stored (load_slice) */
+    size_t loaded = 0;
+    for (size_t i = 0; i < range_count; i++) {
+        loaded += ranges[i].loaded;
+        note_loaded_id(backend, ranges[i].max_id);
+        if (ranges[i].failed) {
+            break;
+        }
+    }
+
+    int result = load_slices(backend, ranges, range_count, threads);
+
+    for (size_t i = 0; i < range_count; i++) {
+        for (size_t s = 0; s < TRANS_CACHE_SHARDS; s++) {
+            free(ranges[i].buckets[s].records);
+        }
+        arena_free(ranges[i].strings);
+    }
+    free(ranges);
+    munmap(data, size);
+
+    *bytes_out = size;
+    LOG_INFO("Loaded %zu cache entries from %s (threads: %zu)\n", loaded, file_path, range_count);
+    return result;
+}
+
+/* ============================================================================
+ * Backend operations
+ * ============================================================================ */
+
+/* Replay the journal on top of the loaded entries (which are indexed).
+ * Sets *bytes_out to the bytes read. */
+static int replay_journal(TextBackend *backend, const char *file_path, size_t *bytes_out) {
+    *bytes_out = 0;
+
+    FILE *fp = fopen(file_path, "r");
+    if (!fp) {
+        /* No changes since the base file was written */
         return 0;
     }
 
@@ -43,8 +2297,12 @@ static int load_cache_from_file(TextBackendContext *ctx, const char *file_path)
     size_t line_len = 0;
     ssize_t read;
     int loaded_count = 0;
+    bool complete_line = true;
 
     while ((read = getline(&line, &line_len, fp)) != -1) {
+        *bytes_out += (size_t)read;
+        complete_line = line[read - 1] == '\n';
+
         /* Parse JSON line */
         cJSON *json = cJSON_Parse(line);
         if (!json) {
@@ -52,264 +2310,354 @@ static int load_cache_from_file(TextBackendContext *ctx, const char *file_path)
             continue;
         }
 
-        /* Extract fields */
-        cJSON *id_json = cJSON_GetObjectItem(json, "id");
-        cJSON *hash_json = cJSON_GetObjectItem(json, "hash");
-        cJSON *from_json = cJSON_GetObjectItem(json, "from");
-        cJSON *to_json = cJSON_GetObjectItem(json, "to");
-        cJSON *source_json = cJSON_GetObjectItem(json, "source");
-        cJSON *target_json = cJSON_GetObjectItem(json, "target");
-        cJSON *count_json = cJSON_GetObjectItem(json, "count");
-        cJSON *last_used_json = cJSON_GetObjectItem(json, "last_used");
-        cJSON *created_at_json = cJSON_GetObjectItem(json, "created_at");
-
-        /* Validate required fields */
-        if (!cJSON_IsNumber(id_json) || !cJSON_IsString(hash_json) ||
-            !cJSON_IsString(from_json) || !cJSON_IsString(to_json) ||
-            !cJSON_IsString(source_json) || !cJSON_IsString(target_json) ||
-            !cJSON_IsNumber(count_json) || !cJSON_IsNumber(last_used_json) ||
-            !cJSON_IsNumber(created_at_json)) {
-            LOG_DEBUG("Warning: Invalid cache entry format, skipping\n");
-            cJSON_Delete(json);
-            continue;
-        }
-
-        /* Allocate cache entry */
-        CacheEntry *entry = calloc(1, sizeof(CacheEntry));
-        if (!entry) {
-            LOG_DEBUG("Error: Memory allocation failed\n");
+        if (replay_record(backend, json) != 0) {
             cJSON_Delete(json);
             break;
         }
+        loaded_count++;
+        cJSON_Delete(json);
+    }
 
-        /* Copy data */
-        entry->id = id_json->valueint;
-        strncpy(entry->hash, hash_json->valuestring, sizeof(entry->hash) - 1);
-        strncpy(entry->from_lang, from_json->valuestring, sizeof(entry->from_lang) - 1);
-        strncpy(entry->to_lang, to_json->valuestring, sizeof(entry->to_lang) - 1);
-        entry->source_text = strdup(source_json->valuestring);
-        entry->translated_text = strdup(target_json->valuestring);
-        entry->count = count_json->valueint;
-        entry->last_used = (time_t)last_used_json->valuedouble;
-        entry->created_at = (time_t)created_at_json->valuedouble;
+    free(line);
+    fclose(fp);
 
-        if (!entry->source_text || !entry->translated_text) {
-            LOG_DEBUG("Error: Memory allocation failed\n");
-            free(entry->source_text);
-            free(entry->translated_text);
-            free(entry);
-            cJSON_Delete(json);
-            break;
-        }
+    /* A torn last record would swallow the next append: start from a rewrite */
+    if (!complete_line) {
+        LOG_INFO("Warning: Cache journal %s ends in a partial record\n", file_path);
+        atomic_store(&backend->rewrite_pending, true);
+    }
 
-        /* Expand capacity if needed */
-        if (ctx->size >= ctx->capacity) {
-            size_t new_capacity = ctx->capacity * GROWTH_FACTOR;
-            CacheEntry **new_entries = realloc(ctx->entries,
-                                              new_capacity * sizeof(CacheEntry *));
-            if (!new_entries) {
-                LOG_DEBUG("Error: Memory reallocation failed\n");
-                free(entry->source_text);
-                free(entry->translated_text);
-                free(entry);
-                cJSON_Delete(json);
-                break;
-            }
-            ctx->entries = new_entries;
-            ctx->capacity = new_capacity;
-        }
+    LOG_INFO("Replayed %d cache journal records from %s\n", loaded_count, file_path);
+    return loaded_count;
+}
 
-        /* Add to cache */
-        ctx->entries[ctx->size++] = entry;
-        loaded_count++;
+/* Map the snapshot instead of parsing the base file, if it was compiled
+ * from the base file as it is now (or the base file is gone). Returns 1 if
+ * mapped, 0 if not usable, -1 on allocation failure. */
+static int open_snapshot(TextBackend *backend) {
+    CacheSnapshot *snapshot = cache_snapshot_open(backend->snapshot_path, backend->slice_count);
+    if (!snapshot) {
+        return 0;
+    }
 
-        /* Update next_id */
-        if (entry->id >= ctx->next_id) {
-            ctx->next_id = entry->id + 1;
-        }
+    struct stat st;
+    bool base_exists = stat(backend->file_path, &st) == 0;
+    if (base_exists && !cache_snapshot_matches(snapshot, backend->file_path)) {
+        LOG_INFO("Warning: Cache snapshot %s was not compiled from the current %s, loading it instead\n",
+                 backend->snapshot_path, backend->file_path);
+        cache_snapshot_close(snapshot);
+        return 0;
+    }
 
-        cJSON_Delete(json);
+    backend->snapshot = snapshot;
+    for (size_t i = 0; i < backend->slice_count; i++) {
+        if (snapshot_attach(&backend->slices[i], snapshot) != 0) {
+            return -1;
+        }
     }
 
-    free(line);
-    fclose(fp);
+    const CacheSnapshotHeader *header = cache_snapshot_header(snapshot);
+    note_loaded_id(backend, header->next_id - 1);
+    backend->base_bytes = base_exists ? (size_t)st.st_size : 0;
 
-    LOG_INFO("Loaded %d cache entries from %s\n", loaded_count, file_path);
-    return loaded_count;
+    /* Without the base file only the snapshot holds the entries */
+    if (!base_exists) {
+        atomic_store(&backend->rewrite_pending, true);
+    }
+
+    LOG_INFO("Mapped cache snapshot %s (%llu entries)\n", backend->snapshot_path,
+             (unsigned long long)header->entry_count);
+    return 1;
 }
 
 /* Initialize text backend */
-TransCache *text_backend_init(const char *file_path) {
+TransCache *text_backend_init(const char *file_path, const TextBackendOptions *options) {
     if (!file_path) {
         LOG_DEBUG("Error: NULL file path\n");
         return NULL;
     }
 
-    /* Allocate TransCache */
-    TransCache *cache = calloc(1, sizeof(TransCache));
-    if (!cache) {
+    /* Allocate TextBackend and its slices */
+    TextBackend *backend = calloc(1, sizeof(TextBackend));
+    if (!backend) {
         LOG_DEBUG("Error: Memory allocation failed\n");
         return NULL;
     }
 
-    /* Allocate TextBackendContext */
-    TextBackendContext *ctx = calloc(1, sizeof(TextBackendContext));
-    if (!ctx) {
+    backend->slice_count = TRANS_CACHE_SHARDS;
+    backend->slices = calloc(backend->slice_count, sizeof(TextBackendContext));
+    backend->file_path = strdup(file_path);
+    backend->journal_path = malloc(strlen(file_path) + sizeof(JOURNAL_SUFFIX));
+    atomic_init(&backend->next_id, 1);
+    atomic_init(&backend->rewrite_pending, false);
+    pthread_mutex_init(&backend->save_lock, NULL);
+
+    if (!backend->slices || !backend->file_path || !backend->journal_path) {
         LOG_DEBUG("Error: Memory allocation failed\n");
-        free(cache);
+        text_backend_free(backend);
         return NULL;
     }
+    strcpy(backend->journal_path, file_path);
+    strcat(backend->journal_path, JOURNAL_SUFFIX);
+
+    if (options && options->snapshot) {
+        backend->snapshot_path = malloc(strlen(file_path) + sizeof(SNAPSHOT_SUFFIX));
+        if (!backend->snapshot_path) {
+            LOG_DEBUG("Error: Memory allocation failed\n");
+            text_backend_free(backend);
+            return NULL;
+        }
+        strcpy(backend->snapshot_path, file_path);
+        strcat(backend->snapshot_path, SNAPSHOT_SUFFIX);
+    }
 
     /* Allocate initial capacity */
-    ctx->entries = malloc(INITIAL_CAPACITY * sizeof(CacheEntry *));
-    if (!ctx->entries) {
-        LOG_DEBUG("Error: Memory allocation failed\n");
-        free(ctx);
-        free(cache);
+    void *slices[TRANS_CACHE_SHARDS];
+    for (size_t i = 0; i < backend->slice_count; i++) {
+        TextBackendContext *ctx = &backend->slices[i];
+        ctx->backend = backend;
+        ctx->entries = malloc(INITIAL_CAPACITY * sizeof(CacheEntry *));
+        if (!ctx->entries) {
+            LOG_DEBUG("Error: Memory allocation failed\n");
+            text_backend_free(backend);
+            return NULL;
+        }
+        ctx->capacity = INITIAL_CAPACITY;
+        atomic_init(&ctx->pending_hits, 0);
+        if (bound_init(ctx, options, backend->slice_count, (uint64_t)time(NULL) + i) != 0) {
+            text_backend_free(backend);
+            return NULL;
+        }
+        slices[i] = ctx;
+    }
+
+    /* Map the compiled snapshot, or load existing cache from file (and
+     * compile a snapshot from it on the next save) */
+    int mapped = backend->snapshot_path ? open_snapshot(backend) : 0;
+    int loaded = mapped < 0 ? -1 :
+                 mapped ? load_slices(backend, NULL, 0, 1) :
+                 load_base_file(backend, file_path, load_thread_count(options),
+                                &backend->base_bytes);
+    if (loaded != 0) {
+        text_backend_free(backend);
         return NULL;
     }
+    if (!mapped && backend->snapshot_path) {
+        atomic_store(&backend->rewrite_pending, true);
+    }
 
-    ctx->size = 0;
-    ctx->capacity = INITIAL_CAPACITY;
-    ctx->file_path = strdup(file_path);
-    ctx->next_id = 1;
+    /* Apply changes saved after the base file was written */
+    replay_journal(backend, backend->journal_path, &backend->journal_bytes);
 
-    if (!ctx->file_path) {
-        LOG_DEBUG("Error: Memory allocation failed\n");
-        free(ctx->entries);
-        free(ctx);
-        free(cache);
-        return NULL;
+    /* Keep only what fits in the size bound */
+    size_t trimmed = 0;
+    for (size_t i = 0; i < backend->slice_count; i++) {
+        trimmed += trim_to_bound(&backend->slices[i]);
+    }
+    if (trimmed > 0) {
+        LOG_INFO("Evicted %zu cache entries beyond the size bound\n", trimmed);
+        atomic_store(&backend->rewrite_pending, true);
     }
 
-    /* Initialize read-write lock */
-    if (pthread_rwlock_init(&cache->lock, NULL) != 0) {
-        LOG_DEBUG("Error: Failed to initialize rwlock\n");
-        free(ctx->file_path);
-        free(ctx->entries);
-        free(ctx);
-        free(cache);
+    TransCache *cache = trans_cache_create(CACHE_BACKEND_TEXT, text_backend_get_ops(),
+                                           backend, slices, backend->slice_count);
+    if (!cache) {
+        text_backend_free(backend);
         return NULL;
     }
 
-    /* Set up TransCache */
-    cache->type = CACHE_BACKEND_TEXT;
-    cache->backend_ctx = ctx;
-    cache->ops = text_backend_get_ops();
-
-    /* Load existing cache from file */
-    load_cache_from_file(ctx, file_path);
-
     return cache;
 }
 
-/* Lookup cache entry */
-static CacheEntry* text_backend_lookup(void *backend_ctx,
-                                       const char *from_lang,
-                                       const char *to_lang,
-                                       const char *text) {
-    if (!backend_ctx || !from_lang || !to_lang || !text) {
+/* Lookup cache entry in one slice without locks (caller is in a read section) */
+static CacheEntry* text_backend_lookup(void *backend_ctx, const unsigned char *key) {
+    if (!backend_ctx || !key) {
         return NULL;
     }
 
     TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
 
-    /* Calculate hash */
-    char hash[65];
-    trans_cache_calculate_hash(from_lang, to_lang, text, hash);
-
-    /* Search for entry (no lock needed - caller handles locking) */
-    CacheEntry *found = NULL;
-    for (size_t i = 0; i < ctx->size; i++) {
-        if (strcmp(ctx->entries[i]->hash, hash) == 0) {
-            found = ctx->entries[i];
-            break;
-        }
+    /* Entries in memory shadow the snapshot */
+    CacheEntry *found = index_find(ctx, key);
+    if (!found) {
+        found = snapshot_find(ctx, key);
     }
 
-    /* Update last_used timestamp if found */
+    /* Update last_used timestamp if found (skip the store within a second) */
     if (found) {
-        found->last_used = time(NULL);
+        uint32_t now = (uint32_t)time(NULL);
+        if (atomic_load_explicit(&found->last_used, memory_order_relaxed) != now) {
+            atomic_store_explicit(&found->last_used, now, memory_order_relaxed);
+        }
     }
 
     return found;
 }
 
-/* Add new cache entry */
+/* Add new cache entry to one slice (caller holds its shard write lock) */
 static int text_backend_add(void *backend_ctx,
+                           const unsigned char *key,
                            const char *from_lang,
                            const char *to_lang,
                            const char *source_text,
                            const char *translated_text) {
-    if (!backend_ctx || !from_lang || !to_lang || !source_text || !translated_text) {
+    if (!backend_ctx || !key || !from_lang || !to_lang || !source_text || !translated_text) {
         return -1;
     }
 
     TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
 
-    /* Allocate new entry */
-    CacheEntry *entry = calloc(1, sizeof(CacheEntry));
-    if (!entry) {
-        LOG_DEBUG("Error: Memory allocation failed\n");
+    if (index_find(ctx, key) || snapshot_record_of(ctx, key) >= 0) {
+        LOG_DEBUG("Warning: Cache entry already exists, not adding\n");
+        return -1;
+    }
+
+    /* Reserve index space first so storing cannot leave an unindexed entry */
+    if (index_reserve(ctx) != 0) {
         return -1;
     }
 
-    /* Calculate hash */
-    trans_cache_calculate_hash(from_lang, to_lang, source_text, entry->hash);
+    CacheEntry *entry = store_entry(ctx, key, from_lang, to_lang, source_text,
+                                    translated_text);
+    if (!entry) {
+        return -1;
+    }
 
     /* Fill entry data */
-    entry->id = ctx->next_id++;
-    strncpy(entry->from_lang, from_lang, sizeof(entry->from_lang) - 1);
-    strncpy(entry->to_lang, to_lang, sizeof(entry->to_lang) - 1);
-    entry->source_text = strdup(source_text);
-    entry->translated_text = strdup(translated_text);
+    entry->id = atomic_fetch_add(&ctx->backend->next_id, 1);
     entry->count = 1;
-    entry->created_at = time(NULL);
-    entry->last_used = time(NULL);
+    entry->created_at = (uint32_t)time(NULL);
+    entry->last_used = entry->created_at;
 
-    if (!entry->source_text || !entry->translated_text) {
-        LOG_DEBUG("Error: Memory allocation failed\n");
-        free(entry->source_text);
-        free(entry->translated_text);
-        free(entry);
+    if (index_insert(index_current(ctx), entry)) {
+        ctx->index_used++;
+    }
+
+    mark_dirty(ctx, entry, JOURNAL_STATE_FULL);
+
+    /* The new entry enters the admission window; older ones may leave */
+    sketch_increment(&ctx->sketch, key);
+    sketch_age(&ctx->sketch);
+    enforce_bound(ctx, entry);
+    return 0;
+}
+
+/* The indexed version of entry: entry itself, or what replaced or moved it
+ * since the caller's lookup (NULL once removed) */
+static CacheEntry *live_entry(TextBackendContext *ctx, CacheEntry *entry) {
+    if (entry->journal_state != JOURNAL_STATE_RETIRED) {
+        return entry;
+    }
+    return index_find(ctx, entry->key);
+}
+
+/* Record a hit without the shard lock (caller is in the read section of
+ * its lookup). The count is live at once; the entry is only flagged, and
+ * text_backend_flush_hits lists it for the journal under the lock. A hit
+ * racing with the entry being replaced or moved by compaction is lost. */
+static int text_backend_update_count(void *backend_ctx, CacheEntry *entry) {
+    if (!backend_ctx || !entry) {
         return -1;
     }
 
-    /* Expand capacity if needed */
-    if (ctx->size >= ctx->capacity) {
-        size_t new_capacity = ctx->capacity * GROWTH_FACTOR;
-        CacheEntry **new_entries = realloc(ctx->entries,
-                                          new_capacity * sizeof(CacheEntry *));
-        if (!new_entries) {
-            LOG_DEBUG("Error: Memory reallocation failed\n");
-            free(entry->source_text);
-            free(entry->translated_text);
-            free(entry);
-            return -1;
-        }
-        ctx->entries = new_entries;
-        ctx->capacity = new_capacity;
+    TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
+
+    atomic_fetch_add_explicit(&entry->count, 1, memory_order_relaxed);
+
+    uint32_t now = (uint32_t)time(NULL);
+    if (atomic_load_explicit(&entry->last_used, memory_order_relaxed) != now) {
+        atomic_store_explicit(&entry->last_used, now, memory_order_relaxed);
     }
 
-    /* Add to cache */
-    ctx->entries[ctx->size++] = entry;
+    /* Only the first hit since the last flush writes the shared counter;
+     * release makes the flag visible to the flush that sees the count */
+    if (!atomic_load_explicit(&entry->hit_pending, memory_order_relaxed) &&
+        !atomic_exchange_explicit(&entry->hit_pending, 1, memory_order_relaxed)) {
+        if (is_snapshot_entry(ctx, entry)) {
+            snapshot_note_hit(ctx, entry);
+        }
+        atomic_fetch_add_explicit(&ctx->pending_hits, 1, memory_order_release);
+    }
 
+    sketch_increment(&ctx->sketch, entry->key);
     return 0;
 }
 
-/* Update cache entry count */
-static int text_backend_update_count(void *backend_ctx, CacheEntry *entry) {
-    if (!backend_ctx || !entry) {
+/* List entries hit since the last flush as dirty (caller holds the shard
+ * write lock). Scans the slice only if some hit was recorded. */
+static int text_backend_flush_hits(void *backend_ctx) {
+    if (!backend_ctx) {
+        return -1;
+    }
+
+    TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
+
+    /* Hits count in the sketch lock-free; halving it needs the lock */
+    sketch_age(&ctx->sketch);
+
+    if (atomic_exchange_explicit(&ctx->pending_hits, 0, memory_order_acquire) == 0) {
+        return 0;
+    }
+
+    int folded = 0;
+
+    /* Snapshot views are not in the entries array: they were listed when
+     * first hit (read the link before the flag lets the view be listed again) */
+    uint32_t record = atomic_exchange_explicit(&ctx->snapshot_hits, 0, memory_order_acquire);
+    while (record != 0) {
+        CacheEntry *entry = &ctx->snapshot_views[record - 1];
+        record = atomic_load_explicit(&ctx->snapshot_next[record - 1], memory_order_relaxed);
+        if (atomic_exchange_explicit(&entry->hit_pending, 0, memory_order_relaxed)) {
+            mark_dirty(ctx, entry, JOURNAL_STATE_TOUCH);
+            folded++;
+        }
+    }
+
+    for (size_t i = 0; i < ctx->size; i++) {
+        CacheEntry *entry = ctx->entries[i];
+        if (atomic_load_explicit(&entry->hit_pending, memory_order_relaxed) &&
+            atomic_exchange_explicit(&entry->hit_pending, 0, memory_order_relaxed)) {
+            mark_dirty(ctx, entry, JOURNAL_STATE_TOUCH);
+            folded++;
+        }
+    }
+
+    return folded;
+}
+
+/* Replace the translation of a snapshot entry: its key moves into memory
+ * with the new translation, and the record dies */
+static int snapshot_replace(TextBackendContext *ctx, CacheEntry *view,
+                            const char *new_translation) {
+    if (index_reserve(ctx) != 0) {
+        return -1;
+    }
+
+    CacheEntry *replacement = store_entry(ctx, view->key, trans_cache_entry_from_lang(view),
+                                          trans_cache_entry_to_lang(view), view->source_text,
+                                          new_translation);
+    if (!replacement) {
         return -1;
     }
 
-    entry->count++;
-    entry->last_used = time(NULL);
+    replacement->id = view->id;
+    replacement->created_at = view->created_at;
+    atomic_store_explicit(&replacement->count, 1, memory_order_relaxed);
+    atomic_store_explicit(&replacement->last_used, (uint32_t)time(NULL), memory_order_relaxed);
+
+    if (index_insert(index_current(ctx), replacement)) {
+        ctx->index_used++;
+    }
+    snapshot_kill(ctx, (size_t)(view - ctx->snapshot_views));
 
+    mark_dirty(ctx, replacement, JOURNAL_STATE_FULL);
+    sketch_increment(&ctx->sketch, replacement->key);
+    enforce_bound(ctx, replacement);
     return 0;
 }
 
-/* Update cache entry translation */
+/* Update cache entry translation: publish a new entry in place of the old
+ * one, which lookups in progress keep reading unchanged */
 static int text_backend_update_translation(void *backend_ctx,
                                            CacheEntry *entry,
                                            const char *new_translation) {
@@ -317,78 +2665,139 @@ static int text_backend_update_translation(void *backend_ctx,
         return -1;
     }
 
-    /* Free old translation */
-    free(entry->translated_text);
+    TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
+
+    CacheEntry *old_entry = live_entry(ctx, entry);
+    if (old_entry && is_snapshot_entry(ctx, old_entry)) {
+        return snapshot_replace(ctx, old_entry, new_translation);
+    }
+    TextIndexSlot *slot = old_entry ? index_slot(index_current(ctx), old_entry->key) : NULL;
+    if (!slot) {
+        return -1;
+    }
 
-    /* Set new translation */
-    entry->translated_text = strdup(new_translation);
-    if (!entry->translated_text) {
+    char *translated = arena_store(ctx, new_translation, strlen(new_translation));
+    CacheEntry *replacement = translated ? slab_alloc(ctx) : NULL;
+    if (!replacement) {
         LOG_DEBUG("Error: Memory allocation failed\n");
+        arena_release(ctx, translated);
         return -1;
     }
 
+    copy_entry(replacement, old_entry);
+    replacement->translated_text = translated;
+    replacement->journal_state = 0;
+    atomic_store_explicit(&replacement->hit_pending, 0, memory_order_relaxed);
+
     /* Reset count to 1 */
-    entry->count = 1;
-    entry->last_used = time(NULL);
+    atomic_store_explicit(&replacement->count, 1, memory_order_relaxed);
+    atomic_store_explicit(&replacement->last_used, (uint32_t)time(NULL), memory_order_relaxed);
+
+    ctx->entries[old_entry->position] = replacement;
+    atomic_store_explicit(&slot->entry, replacement, memory_order_release);
+
+    /* The old entry and its translation become dead space until compaction */
+    old_entry->journal_state = JOURNAL_STATE_RETIRED;
+    arena_release(ctx, old_entry->translated_text);
+    ctx->dead_entries++;
 
+    mark_dirty(ctx, replacement, JOURNAL_STATE_FULL);
+
+    /* A longer translation may push the slice over its bound */
+    sketch_increment(&ctx->sketch, replacement->key);
+    enforce_bound(ctx, NULL);
+    compact_if_mostly_dead(ctx);
     return 0;
 }
 
-/* Save cache to file */
-static int text_backend_save(void *backend_ctx) {
-    if (!backend_ctx) {
+/* Save cache: append changed entries to the journal, or rewrite the base
+ * file after removals or once the journal has outgrown it. Writes nothing
+ * when nothing changed. Takes shard read locks itself. */
+static int text_backend_save(TransCache *cache) {
+    if (!cache || !cache->backend_ctx) {
         return -1;
     }
 
-    TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
+    TextBackend *backend = (TextBackend*)cache->backend_ctx;
 
-    if (!ctx->file_path) {
-        return -1;
+    pthread_mutex_lock(&backend->save_lock);
+
+    int result;
+    if (atomic_load(&backend->rewrite_pending) ||
+        (backend->journal_bytes >= JOURNAL_COMPACT_MIN_BYTES &&
+         backend->journal_bytes > backend->base_bytes)) {
+        result = rewrite_base_file(cache);
+    } else {
+        result = append_journal(cache);
     }
 
-    FILE *fp = fopen(ctx->file_path, "w");
-    if (!fp) {
-        LOG_DEBUG("Error: Failed to open cache file for writing: %s\n",
-                ctx->file_path);
+    pthread_mutex_unlock(&backend->save_lock);
+
+    return result;
+}
+
+/* Add one entry to a snapshot being compiled */
+static bool compile_entry(CacheEntry *entry, void *user_data) {
+    return cache_snapshot_writer_add(user_data, entry) == 0;
+}
+
+/* Compile all entries into a snapshot, one shard at a time under its read
+ * lock. It records the base file as it is now; entries in the journal are
+ * in the snapshot too, which is harmless as replaying is idempotent. */
+long text_backend_compile_snapshot(TransCache *cache, const char *snapshot_path) {
+    if (!cache || !cache->backend_ctx || cache->type != CACHE_BACKEND_TEXT) {
         return -1;
     }
 
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
+    TextBackend *backend = (TextBackend*)cache->backend_ctx;
 
-        /* Create JSON object */
-        cJSON *json = cJSON_CreateObject();
-        if (!json) {
-            LOG_DEBUG("Error: Failed to create JSON object\n");
-            continue;
+    char *default_path = NULL;
+    if (!snapshot_path) {
+        default_path = malloc(strlen(backend->file_path) + sizeof(SNAPSHOT_SUFFIX));
+        if (!default_path) {
+            LOG_DEBUG("Error: Memory allocation failed\n");
+            return -1;
         }
+        strcpy(default_path, backend->file_path);
+        strcat(default_path, SNAPSHOT_SUFFIX);
+        snapshot_path = default_path;
+    }
 
-        cJSON_AddNumberToObject(json, "id", entry->id);
-        cJSON_AddStringToObject(json, "hash", entry->hash);
-        cJSON_AddStringToObject(json, "from", entry->from_lang);
-        cJSON_AddStringToObject(json, "to", entry->to_lang);
-        cJSON_AddStringToObject(json, "source", entry->source_text);
-        cJSON_AddStringToObject(json, "target", entry->translated_text);
-        cJSON_AddNumberToObject(json, "count", entry->count);
-        cJSON_AddNumberToObject(json, "last_used", (double)entry->last_used);
-        cJSON_AddNumberToObject(json, "created_at", (double)entry->created_at);
+    CacheSnapshotWriter *writer = cache_snapshot_writer_open(snapshot_path, cache->shard_count);
+    free(default_path);
+    if (!writer) {
+        return -1;
+    }
 
-        /* Write to file */
-        char *json_str = cJSON_PrintUnformatted(json);
-        if (json_str) {
-            fprintf(fp, "%s\n", json_str);
-            free(json_str);
-        }
+    long entries = 0;
+    for (size_t s = 0; s < cache->shard_count; s++) {
+        TextBackendContext *ctx = cache->shards[s].backend_ctx;
 
-        cJSON_Delete(json);
+        trans_cache_lock_shard(cache, s, false);
+        bool ok = visit_entries(ctx, compile_entry, writer);
+        entries += (long)(ctx->size + ctx->snapshot_count - ctx->snapshot_dead);
+        trans_cache_unlock_shard(cache, s);
+
+        if (!ok || cache_snapshot_writer_end_shard(writer) != 0) {
+            cache_snapshot_writer_abort(writer);
+            return -1;
+        }
     }
 
-    fclose(fp);
+    pthread_mutex_lock(&backend->save_lock);
+    int result = cache_snapshot_writer_finish(writer, backend->file_path,
+                                              atomic_load(&backend->next_id));
+    pthread_mutex_unlock(&backend->save_lock);
 
-    return 0;
+    return result == 0 ? entries : -1;
+}
+
+/* Entry not used since threshold (time_t *) */
+static bool entry_expired(const CacheEntry *entry, void *user_data) {
+    return entry->last_used < *(time_t *)user_data;
 }
 
-/* Cleanup old cache entries */
+/* Cleanup old cache entries in one slice (caller holds its shard write lock) */
 static int text_backend_cleanup(void *backend_ctx, int days_threshold) {
     if (!backend_ctx || days_threshold <= 0) {
         return 0;
@@ -399,31 +2808,33 @@ static int text_backend_cleanup(void *backend_ctx, int days_threshold) {
     time_t now = time(NULL);
     time_t threshold_time = now - (days_threshold * 24 * 60 * 60);
 
-    int removed_count = 0;
-    size_t write_idx = 0;
-
-    /* Iterate and keep only valid entries */
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
+    return (int)(remove_entries(ctx, entry_expired, &threshold_time) +
+                 remove_snapshot_entries(ctx, entry_expired, &threshold_time));
+}
 
-        if (entry->last_used < threshold_time) {
-            /* Expired entry - free memory */
-            free(entry->source_text);
-            free(entry->translated_text);
-            free(entry);
-            removed_count++;
-        } else {
-            /* Valid entry - keep it */
-            ctx->entries[write_idx++] = entry;
-        }
+/* Running totals of text_backend_stats */
+typedef struct {
+    int cache_threshold;
+    time_t threshold_time;
+    size_t total;
+    size_t active;
+    size_t expired;
+} EntryTally;
+
+static bool tally_entry(CacheEntry *entry, void *user_data) {
+    EntryTally *tally = user_data;
+
+    tally->total++;
+    if (entry->count >= tally->cache_threshold) {
+        tally->active++;
     }
-
-    ctx->size = write_idx;
-
-    return removed_count;
+    if (entry->last_used < tally->threshold_time) {
+        tally->expired++;
+    }
+    return true;
 }
 
-/* Get cache statistics */
+/* Get cache statistics for one slice */
 static void text_backend_stats(void *backend_ctx,
                                size_t *total_entries,
                                size_t *active_entries,
@@ -437,48 +2848,112 @@ static void text_backend_stats(void *backend_ctx,
     TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
 
     time_t now = time(NULL);
-    time_t threshold_time = now - (days_threshold * 24 * 60 * 60);
+    EntryTally tally = {
+        .cache_threshold = cache_threshold,
+        .threshold_time = now - (days_threshold * 24 * 60 * 60)
+    };
 
-    size_t total = ctx->size;
-    size_t active = 0;
-    size_t expired = 0;
+    /* Entries in memory and in the snapshot */
+    visit_entries(ctx, tally_entry, &tally);
 
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
+    if (total_entries) *total_entries = tally.total;
+    if (active_entries) *active_entries = tally.active;
+    if (expired_entries) *expired_entries = tally.expired;
+}
 
-        if (entry->count >= cache_threshold) {
-            active++;
-        }
+/* Storage size and eviction metrics over all slices, each under its read lock */
+static cJSON *text_backend_metrics(TransCache *cache) {
+    if (!cache || !cache->backend_ctx) {
+        return NULL;
+    }
 
-        if (entry->last_used < threshold_time) {
-            expired++;
-        }
+    cJSON *metrics = cJSON_CreateObject();
+    if (!metrics) {
+        return NULL;
     }
 
-    if (total_entries) *total_entries = total;
-    if (active_entries) *active_entries = active;
-    if (expired_entries) *expired_entries = expired;
+    size_t entries = 0, bytes = 0, dead_bytes = 0, window = 0;
+    size_t max_entries = 0, max_bytes = 0, snapshot_entries = 0;
+    unsigned long long admitted = 0, rejected = 0, evicted = 0;
+
+    for (size_t s = 0; s < cache->shard_count; s++) {
+        TextBackendContext *ctx = cache->shards[s].backend_ctx;
+
+        trans_cache_lock_shard(cache, s, false);
+        entries += ctx->size;
+        bytes += slice_bytes(ctx);
+        dead_bytes += ctx->arena_dead + ctx->dead_entries * sizeof(CacheEntry);
+        window += ctx->window_count;
+        max_entries += ctx->max_entries;
+        max_bytes += ctx->max_bytes;
+        admitted += ctx->admitted;
+        rejected += ctx->rejected;
+        evicted += ctx->evicted;
+        snapshot_entries += ctx->snapshot_count - ctx->snapshot_dead;
+        trans_cache_unlock_shard(cache, s);
+    }
+
+    cJSON_AddNumberToObject(metrics, "entries", (double)entries);
+    cJSON_AddNumberToObject(metrics, "bytes", (double)bytes);
+    cJSON_AddNumberToObject(metrics, "dead_bytes", (double)dead_bytes);
+    cJSON_AddNumberToObject(metrics, "max_entries", (double)max_entries);
+    cJSON_AddNumberToObject(metrics, "max_bytes", (double)max_bytes);
+    cJSON_AddStringToObject(metrics, "eviction",
+                            max_entries || max_bytes ? "w-tinylfu" : "none");
+    cJSON_AddNumberToObject(metrics, "window_entries", (double)window);
+    cJSON_AddNumberToObject(metrics, "admitted", (double)admitted);
+    cJSON_AddNumberToObject(metrics, "rejected", (double)rejected);
+    cJSON_AddNumberToObject(metrics, "evicted", (double)evicted);
+
+    TextBackend *backend = (TextBackend *)cache->backend_ctx;
+    cJSON_AddBoolToObject(metrics, "snapshot", backend->snapshot != NULL);
+    if (backend->snapshot) {
+        cJSON_AddNumberToObject(metrics, "snapshot_entries", (double)snapshot_entries);
+        cJSON_AddNumberToObject(metrics, "snapshot_bytes",
+                                (double)cache_snapshot_header(backend->snapshot)->file_size);
+    }
+    return metrics;
 }
 
-/* Free text backend */
+/* Free text backend and all of its slices */
 static void text_backend_free(void *backend_ctx) {
     if (!backend_ctx) {
         return;
     }
 
-    TextBackendContext *ctx = (TextBackendContext*)backend_ctx;
+    TextBackend *backend = (TextBackend*)backend_ctx;
+
+    if (backend->slices) {
+        for (size_t i = 0; i < backend->slice_count; i++) {
+            TextBackendContext *ctx = &backend->slices[i];
+
+            /* Entries and their strings live in slabs and arena blocks */
+            slabs_free(ctx->slabs, ctx->slab_count);
+            arena_free(ctx->arena);
+
+            free(index_current(ctx));
+            free(ctx->entries);
+            free(ctx->dirty);
+            free(ctx->removed);
+            free(ctx->sketch.table);
+            free(ctx->window);
+            free(ctx->snapshot_views);
+            free((void *)ctx->snapshot_state);
+            free((void *)ctx->snapshot_next);
+        }
+        free(backend->slices);
+    }
 
-    /* Free all entries */
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
-        free(entry->source_text);
-        free(entry->translated_text);
-        free(entry);
+    if (backend->journal) {
+        fclose(backend->journal);
     }
+    pthread_mutex_destroy(&backend->save_lock);
 
-    free(ctx->entries);
-    free(ctx->file_path);
-    free(ctx);
+    cache_snapshot_close(backend->snapshot);
+    free(backend->snapshot_path);
+    free(backend->journal_path);
+    free(backend->file_path);
+    free(backend);
 }
 
 /* Get backend operations */
@@ -487,11 +2962,16 @@ CacheBackendOps *text_backend_get_ops(void) {
         .lookup = text_backend_lookup,
         .add = text_backend_add,
         .update_count = text_backend_update_count,
+        .flush_hits = text_backend_flush_hits,
         .update_translation = text_backend_update_translation,
         .save = text_backend_save,
         .cleanup = text_backend_cleanup,
         .stats = text_backend_stats,
-        .free_backend = text_backend_free
+        .metrics = text_backend_metrics,
+        .free_backend = text_backend_free,
+        .concurrent_lookup = true,
+        .concurrent_update_count = true,
+        .lookup_copies = false        /* Entries are read in place */
     };
     return &ops;
 }
@@ -0,0 +1,447 @@
+/**
+ * Hot tier module for the translation cache.
+ * A bounded in-process copy of the most used entries of a backend that
+ * reads storage on every lookup (SQLite, Redis). Split into shards by key; each
+ * shard has a hash table whose bucket chains readers walk without a lock
+ * (entries are unlinked under the shard lock and freed through epoch.h)
+ * and a CLOCK ring that evicts entries not hit since the hand last passed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "cache_hot_tier.h"
+#include "epoch.h"
+#include "utils.h"
+
+#define HOT_TIER_SHARDS 16          /* Power of two */
+#define HOT_TIER_GENERATIONS 64     /* Change counters per shard (power of two) */
+#define HOT_TIER_ENTRY_ESTIMATE 256 /* Bytes per entry assumed for sizing buckets */
+#define HOT_TIER_MIN_BUCKETS 64
+
+/* Copy of a backend entry; the texts follow the struct in one allocation */
+typedef struct HotEntry {
+    CacheEntry entry;                   /* Handed out by hot_tier_lookup */
+    _Atomic(struct HotEntry *) next;    /* Bucket chain (read without the lock) */
+    struct HotEntry *clock_prev;        /* CLOCK ring (under the shard lock) */
+    struct HotEntry *clock_next;
+    atomic_bool referenced;             /* Hit since the hand last passed */
+    size_t bytes;
+} HotEntry;
+
+typedef struct {
+    pthread_mutex_t lock;               /* Writers: fill, evict, invalidate */
+    _Atomic(HotEntry *) *buckets;
+    size_t bucket_mask;
+    HotEntry *hand;                     /* Next CLOCK candidate (NULL if empty) */
+    size_t capacity;                    /* Byte budget of the shard */
+
+    /* Changes to keys of a stripe since start; a fill whose backend read
+     * may predate one is not kept */
+    atomic_uint generation[HOT_TIER_GENERATIONS];
+
+    /* Under lock */
+    size_t bytes;
+    size_t entries;
+    unsigned long long fills;
+    unsigned long long stale_fills;     /* Not kept: key changed during the read */
+    unsigned long long evictions;
+    unsigned long long invalidations;
+
+    atomic_ullong hits;                 /* L1 */
+    atomic_ullong misses;
+    atomic_ullong backend_hits;         /* L2, after an L1 miss */
+    atomic_ullong backend_misses;
+} HotTierShard;
+
+struct CacheHotTier {
+    size_t capacity;
+    HotTierShard shards[HOT_TIER_SHARDS];
+};
+
+/* Shard, bucket and generation stripe of key use different digest bytes
+ * (trans_cache_shard_of uses the last one) */
+static HotTierShard *shard_of(CacheHotTier *tier, const unsigned char *key) {
+    return &tier->shards[key[TRANS_CACHE_DIGEST_SIZE - 2] & (HOT_TIER_SHARDS - 1)];
+}
+
+static size_t bucket_of(const HotTierShard *s, const unsigned char *key) {
+    uint64_t h;
+    memcpy(&h, key, sizeof(h));
+    return (size_t)h & s->bucket_mask;
+}
+
+static atomic_uint *generation_of(HotTierShard *s, const unsigned char *key) {
+    return &s->generation[key[TRANS_CACHE_DIGEST_SIZE - 3] & (HOT_TIER_GENERATIONS - 1)];
+}
+
+/* Find key in its bucket chain (lock-free) */
+static HotEntry *find(HotTierShard *s, const unsigned char *key) {
+    HotEntry *e = atomic_load_explicit(&s->buckets[bucket_of(s, key)], memory_order_acquire);
+
+    while (e && memcmp(e->entry.key, key, TRANS_CACHE_DIGEST_SIZE) != 0) {
+        e = atomic_load_explicit(&e->next, memory_order_acquire);
+    }
+    return e;
+}
+
+/* Copy entry and its texts into one allocation */
+static HotEntry *entry_copy(const CacheEntry *entry) {
+    size_t source_len = strlen(entry->source_text);
+    size_t translated_len = strlen(entry->translated_text);
+    size_t bytes = sizeof(HotEntry) + source_len + translated_len + 2;
+
+    HotEntry *e = malloc(bytes);
+    if (!e) {
+        return NULL;
+    }
+
+    memset(e, 0, sizeof(HotEntry));
+    memcpy(e->entry.key, entry->key, TRANS_CACHE_DIGEST_SIZE);
+    e->entry.from_id = entry->from_id;
+    e->entry.to_id = entry->to_id;
+    e->entry.id = entry->id;
+    atomic_init(&e->entry.count, atomic_load(&entry->count));
+    atomic_init(&e->entry.last_used, atomic_load(&entry->last_used));
+    e->entry.created_at = entry->created_at;
+    e->entry.source_text = (char *)(e + 1);
+    memcpy(e->entry.source_text, entry->source_text, source_len + 1);
+    e->entry.translated_text = e->entry.source_text + source_len + 1;
+    memcpy(e->entry.translated_text, entry->translated_text, translated_len + 1);
+    atomic_init(&e->next, NULL);
+    atomic_init(&e->referenced, false);
+    e->bytes = bytes;
+    return e;
+}
+
+/* ============================================================================
+ * Shard changes (caller holds the shard lock)
+ * ============================================================================ */
+
+/* Publish e at the head of its bucket and behind the CLOCK hand */
+static void link_entry(HotTierShard *s, HotEntry *e) {
+    _Atomic(HotEntry *) *bucket = &s->buckets[bucket_of(s, e->entry.key)];
+
+    atomic_store_explicit(&e->next, atomic_load_explicit(bucket, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(bucket, e, memory_order_release);
+
+    if (!s->hand) {
+        e->clock_prev = e;
+        e->clock_next = e;
+        s->hand = e;
+    } else {
+        e->clock_next = s->hand;
+        e->clock_prev = s->hand->clock_prev;
+        s->hand->clock_prev->clock_next = e;
+        s->hand->clock_prev = e;
+    }
+
+    s->bytes += e->bytes;
+    s->entries++;
+}
+
+/* Unlink e and free it once no reader can hold it */
+static void remove_entry(HotTierShard *s, HotEntry *e) {
+    _Atomic(HotEntry *) *link = &s->buckets[bucket_of(s, e->entry.key)];
+    HotEntry *cur;
+
+    while ((cur = atomic_load_explicit(link, memory_order_relaxed)) != e) {
+        link = &cur->next;
+    }
+    atomic_store_explicit(link, atomic_load_explicit(&e->next, memory_order_relaxed),
+                          memory_order_release);
+
+    if (e->clock_next == e) {
+        s->hand = NULL;
+    } else {
+        e->clock_prev->clock_next = e->clock_next;
+        e->clock_next->clock_prev = e->clock_prev;
+        if (s->hand == e) {
+            s->hand = e->clock_next;
+        }
+    }
+
+    s->bytes -= e->bytes;
+    s->entries--;
+    epoch_retire(e, free);
+}
+
+/* Advance the CLOCK hand until bytes more fit: entries hit since the last
+ * pass get another round, the others are evicted */
+static void make_room(HotTierShard *s, size_t bytes) {
+    while (s->hand && s->bytes + bytes > s->capacity) {
+        HotEntry *e = s->hand;
+
+        if (atomic_exchange_explicit(&e->referenced, false, memory_order_relaxed)) {
+            s->hand = e->clock_next;
+            continue;
+        }
+        remove_entry(s, e);
+        s->evictions++;
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/* Enable the hot tier */
+int trans_cache_enable_hot_tier(TransCache *cache, size_t capacity_bytes) {
+    if (!cache || !cache->ops || cache->hot_tier || capacity_bytes == 0) {
+        return -1;
+    }
+    if (!cache->ops->lookup_copies) {
+        LOG_INFO("Cache hot tier not needed: backend looks up entries in memory\n");
+        return 0;
+    }
+
+    CacheHotTier *tier = calloc(1, sizeof(CacheHotTier));
+    if (!tier) {
+        LOG_INFO("Error: Memory allocation failed for cache hot tier\n");
+        return -1;
+    }
+    tier->capacity = capacity_bytes;
+
+    size_t shard_capacity = capacity_bytes / HOT_TIER_SHARDS;
+    size_t buckets = HOT_TIER_MIN_BUCKETS;
+    while (buckets < shard_capacity / HOT_TIER_ENTRY_ESTIMATE) {
+        buckets <<= 1;
+    }
+
+    for (size_t i = 0; i < HOT_TIER_SHARDS; i++) {
+        HotTierShard *s = &tier->shards[i];
+
+        s->buckets = calloc(buckets, sizeof(*s->buckets));
+        if (!s->buckets) {
+            LOG_INFO("Error: Memory allocation failed for cache hot tier\n");
+            hot_tier_free(tier);
+            return -1;
+        }
+        s->bucket_mask = buckets - 1;
+        s->capacity = shard_capacity;
+        pthread_mutex_init(&s->lock, NULL);
+        for (size_t g = 0; g < HOT_TIER_GENERATIONS; g++) {
+            atomic_init(&s->generation[g], 0);
+        }
+        atomic_init(&s->hits, 0);
+        atomic_init(&s->misses, 0);
+        atomic_init(&s->backend_hits, 0);
+        atomic_init(&s->backend_misses, 0);
+    }
+
+    /* Backends shared with other processes must drop copies they change */
+    if (cache->ops->attach_hot_tier &&
+        cache->ops->attach_hot_tier(cache->backend_ctx, tier) != 0) {
+        hot_tier_free(tier);
+        return -1;
+    }
+
+    cache->hot_tier = tier;
+
+    LOG_INFO("Cache hot tier enabled: %zu MiB in %d shards\n",
+             capacity_bytes / (1024 * 1024), HOT_TIER_SHARDS);
+    return 0;
+}
+
+/* Lock-free lookup */
+CacheEntry *hot_tier_lookup(CacheHotTier *tier, const unsigned char *key,
+                            unsigned int *generation) {
+    if (!tier || !key) {
+        return NULL;
+    }
+
+    HotTierShard *s = shard_of(tier, key);
+
+    /* Taken before the backend read that follows a miss */
+    *generation = atomic_load_explicit(generation_of(s, key), memory_order_acquire);
+
+    HotEntry *e = find(s, key);
+    if (!e) {
+        atomic_fetch_add_explicit(&s->misses, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    /* Write the bit only when it changes: hot entries stay shared in caches */
+    if (!atomic_load_explicit(&e->referenced, memory_order_relaxed)) {
+        atomic_store_explicit(&e->referenced, true, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&s->hits, 1, memory_order_relaxed);
+    return &e->entry;
+}
+
+/* Keep a copy of a backend entry */
+CacheEntry *hot_tier_fill(CacheHotTier *tier, const unsigned char *key,
+                          CacheEntry *entry, unsigned int generation) {
+    if (!tier || !key) {
+        return entry;
+    }
+
+    HotTierShard *s = shard_of(tier, key);
+
+    if (!entry) {
+        atomic_fetch_add_explicit(&s->backend_misses, 1, memory_order_relaxed);
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&s->backend_hits, 1, memory_order_relaxed);
+
+    HotEntry *copy = entry_copy(entry);
+    if (!copy) {
+        return entry;
+    }
+    if (copy->bytes > s->capacity) {
+        free(copy);
+        return entry;
+    }
+
+    pthread_mutex_lock(&s->lock);
+
+    /* A change committed after the backend read began: entry may be stale */
+    if (atomic_load_explicit(generation_of(s, key), memory_order_relaxed) != generation) {
+        s->stale_fills++;
+        pthread_mutex_unlock(&s->lock);
+        free(copy);
+        return entry;
+    }
+
+    /* Another miss on key filled it first: share its copy (and its hits) */
+    HotEntry *existing = find(s, key);
+    if (existing) {
+        pthread_mutex_unlock(&s->lock);
+        free(copy);
+        return &existing->entry;
+    }
+
+    make_room(s, copy->bytes);
+    link_entry(s, copy);
+    s->fills++;
+
+    pthread_mutex_unlock(&s->lock);
+    return &copy->entry;
+}
+
+/* Drop the copy of key */
+void hot_tier_invalidate(CacheHotTier *tier, const unsigned char *key) {
+    if (!tier || !key) {
+        return;
+    }
+
+    HotTierShard *s = shard_of(tier, key);
+
+    pthread_mutex_lock(&s->lock);
+    atomic_fetch_add_explicit(generation_of(s, key), 1, memory_order_release);
+    HotEntry *e = find(s, key);
+    if (e) {
+        remove_entry(s, e);
+        s->invalidations++;
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+/* Drop all copies */
+void hot_tier_clear(CacheHotTier *tier) {
+    if (!tier) {
+        return;
+    }
+
+    for (size_t i = 0; i < HOT_TIER_SHARDS; i++) {
+        HotTierShard *s = &tier->shards[i];
+
+        pthread_mutex_lock(&s->lock);
+        for (size_t g = 0; g < HOT_TIER_GENERATIONS; g++) {
+            atomic_fetch_add_explicit(&s->generation[g], 1, memory_order_release);
+        }
+        while (s->hand) {
+            remove_entry(s, s->hand);
+            s->invalidations++;
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+/* Free the tier */
+void hot_tier_free(CacheHotTier *tier) {
+    if (!tier) {
+        return;
+    }
+
+    for (size_t i = 0; i < HOT_TIER_SHARDS; i++) {
+        HotTierShard *s = &tier->shards[i];
+        if (!s->buckets) {
+            continue;
+        }
+
+        for (size_t b = 0; b <= s->bucket_mask; b++) {
+            HotEntry *e = atomic_load_explicit(&s->buckets[b], memory_order_relaxed);
+            while (e) {
+                HotEntry *next = atomic_load_explicit(&e->next, memory_order_relaxed);
+                free(e);
+                e = next;
+            }
+        }
+        free(s->buckets);
+        pthread_mutex_destroy(&s->lock);
+    }
+    free(tier);
+}
+
+/* Tier metrics */
+cJSON *hot_tier_stats(CacheHotTier *tier) {
+    if (!tier) {
+        return NULL;
+    }
+
+    size_t bytes = 0, entries = 0;
+    unsigned long long fills = 0, stale_fills = 0, evictions = 0, invalidations = 0;
+    unsigned long long hits = 0, misses = 0, backend_hits = 0, backend_misses = 0;
+
+    for (size_t i = 0; i < HOT_TIER_SHARDS; i++) {
+        HotTierShard *s = &tier->shards[i];
+
+        pthread_mutex_lock(&s->lock);
+        bytes += s->bytes;
+        entries += s->entries;
+        fills += s->fills;
+        stale_fills += s->stale_fills;
+        evictions += s->evictions;
+        invalidations += s->invalidations;
+        pthread_mutex_unlock(&s->lock);
+
+        hits += atomic_load_explicit(&s->hits, memory_order_relaxed);
+        misses += atomic_load_explicit(&s->misses, memory_order_relaxed);
+        backend_hits += atomic_load_explicit(&s->backend_hits, memory_order_relaxed);
+        backend_misses += atomic_load_explicit(&s->backend_misses, memory_order_relaxed);
+    }
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) {
+        return NULL;
+    }
+
+    unsigned long long lookups = hits + misses;
+    unsigned long long backend_lookups = backend_hits + backend_misses;
+
+    cJSON_AddNumberToObject(stats, "capacity_bytes", (double)tier->capacity);
+    cJSON_AddNumberToObject(stats, "bytes", (double)bytes);
+    cJSON_AddNumberToObject(stats, "entries", (double)entries);
+    cJSON_AddNumberToObject(stats, "l1_hits", (double)hits);
+    cJSON_AddNumberToObject(stats, "l1_misses", (double)misses);
+    cJSON_AddNumberToObject(stats, "l1_hit_ratio",
+                            lookups ? (double)hits / (double)lookups : 0.0);
+    cJSON_AddNumberToObject(stats, "l2_hits", (double)backend_hits);
+    cJSON_AddNumberToObject(stats, "l2_misses", (double)backend_misses);
+    cJSON_AddNumberToObject(stats, "l2_hit_ratio",
+                            backend_lookups ?
+                            (double)backend_hits / (double)backend_lookups : 0.0);
+    cJSON_AddNumberToObject(stats, "hit_ratio",
+                            lookups ? (double)(hits + backend_hits) / (double)lookups : 0.0);
+    cJSON_AddNumberToObject(stats, "fills", (double)fills);
+    cJSON_AddNumberToObject(stats, "stale_fills", (double)stale_fills);
+    cJSON_AddNumberToObject(stats, "evictions", (double)evictions);
+    cJSON_AddNumberToObject(stats, "invalidations", (double)invalidations);
+
+    return stats;
+}
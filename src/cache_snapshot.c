@@ -0,0 +1,453 @@
+/**
+ * Compiled snapshot module for the text cache.
+ * Writes the entries of all shards into one file laid out for lookups in
+ * place (string heap, fixed-size records and a hash table per shard) and
+ * maps such a file read-only. Opening validates only the header and the
+ * section bounds; records are checked when they are read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache_snapshot.h"
+#include "utils.h"
+
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_TEMP_SUFFIX ".tmp"
+#define SNAPSHOT_ALIGN 8
+
+struct CacheSnapshot {
+    const unsigned char *data;      /* Mapped file */
+    size_t size;
+    const CacheSnapshotHeader *header;
+    const CacheSnapshotSection *sections;
+};
+
+struct CacheSnapshotWriter {
+    FILE *fp;
+    char *path;
+    char *temp_path;
+    size_t shard_count;
+    CacheSnapshotSection *sections;
+    size_t shard;                   /* Shard being written */
+    uint64_t offset;                /* Bytes written so far */
+    uint64_t entry_count;
+
+    /* Current shard: its heap is streamed, records wait for end_shard */
+    CacheSnapshotRecord *records;
+    size_t record_count;
+    size_t record_capacity;
+    uint64_t heap_size;
+};
+
+/* Key bits used by the table: position from bytes 4..7, tag from 0..3 */
+static uint64_t key_bits(const unsigned char *key) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits = (bits << 8) | key[i];
+    }
+    return bits;
+}
+
+/* Section bounds lie within the file and are aligned */
+static bool section_valid(const CacheSnapshot *snapshot, const CacheSnapshotSection *section) {
+    uint64_t size = snapshot->size;
+    uint64_t capacity = section->table_capacity;
+
+    if (section->heap_offset > size || section->heap_size > size - section->heap_offset ||
+        section->records_offset % SNAPSHOT_ALIGN != 0 || section->records_offset > size ||
+        section->record_count > (size - section->records_offset) / sizeof(CacheSnapshotRecord) ||
+        section->record_count > UINT32_MAX - 1 ||
+        section->table_offset % SNAPSHOT_ALIGN != 0 || section->table_offset > size ||
+        capacity > (size - section->table_offset) / sizeof(CacheSnapshotSlot) ||
+        (capacity & (capacity - 1)) != 0 || capacity < section->record_count ||
+        (capacity == 0) != (section->record_count == 0)) {
+        return false;
+    }
+
+    /* The last string ends the heap, so every string in it is terminated */
+    return section->heap_size == 0 ||
+           snapshot->data[section->heap_offset + section->heap_size - 1] == '\0';
+}
+
+/* Map and validate a snapshot */
+CacheSnapshot *cache_snapshot_open(const char *path, size_t shard_count) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOG_DEBUG("Cache snapshot not found: %s\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    size_t table_start = sizeof(CacheSnapshotHeader) + shard_count * sizeof(CacheSnapshotSection);
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < table_start) {
+        LOG_INFO("Warning: Cache snapshot %s is truncated, ignoring it\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOG_INFO("Warning: Failed to map cache snapshot %s\n", path);
+        return NULL;
+    }
+
+    CacheSnapshot *snapshot = malloc(sizeof(CacheSnapshot));
+    if (!snapshot) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    snapshot->data = data;
+    snapshot->size = (size_t)st.st_size;
+    snapshot->header = data;
+    snapshot->sections = (const CacheSnapshotSection *)(snapshot->data + sizeof(CacheSnapshotHeader));
+
+    const CacheSnapshotHeader *header = snapshot->header;
+    bool valid = memcmp(header->magic, CACHE_SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == CACHE_SNAPSHOT_VERSION &&
+                 header->byte_order == SNAPSHOT_BYTE_ORDER &&
+                 header->shard_count == shard_count &&
+                 header->file_size == snapshot->size;
+
+    uint64_t entries = 0;
+    for (size_t s = 0; valid && s < shard_count; s++) {
+        valid = section_valid(snapshot, &snapshot->sections[s]);
+        entries += snapshot->sections[s].record_count;
+    }
+
+    if (!valid || entries != header->entry_count) {
+        LOG_INFO("Warning: Cache snapshot %s is invalid or from another version, ignoring it\n",
+                 path);
+        cache_snapshot_close(snapshot);
+        return NULL;
+    }
+
+    /* Lookups touch the table and records at random */
+    posix_madvise(data, snapshot->size, POSIX_MADV_RANDOM);
+
+    LOG_DEBUG("Mapped cache snapshot %s (%llu entries, %zu bytes)\n",
+              path, (unsigned long long)header->entry_count, snapshot->size);
+    return snapshot;
+}
+
+void cache_snapshot_close(CacheSnapshot *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+    munmap((void *)snapshot->data, snapshot->size);
+    free(snapshot);
+}
+
+const CacheSnapshotHeader *cache_snapshot_header(const CacheSnapshot *snapshot) {
+    return snapshot->header;
+}
+
+/* Compare the recorded source identity with the file as it is now */
+bool cache_snapshot_matches(const CacheSnapshot *snapshot, const char *source_path) {
+    struct stat st;
+    if (stat(source_path, &st) != 0) {
+        return false;
+    }
+
+    const CacheSnapshotHeader *header = snapshot->header;
+    return header->source_size == (uint64_t)st.st_size &&
+           header->source_mtime_sec == (int64_t)st.st_mtim.tv_sec &&
+           header->source_mtime_nsec == (int64_t)st.st_mtim.tv_nsec;
+}
+
+size_t cache_snapshot_count(const CacheSnapshot *snapshot, size_t shard) {
+    return (size_t)snapshot->sections[shard].record_count;
+}
+
+const CacheSnapshotRecord *cache_snapshot_record(const CacheSnapshot *snapshot, size_t shard,
+                                                 size_t index) {
+    const CacheSnapshotSection *section = &snapshot->sections[shard];
+    return (const CacheSnapshotRecord *)(snapshot->data + section->records_offset) + index;
+}
+
+/* Probe the shard's table (at most capacity slots, whatever the file says) */
+long cache_snapshot_find(const CacheSnapshot *snapshot, size_t shard,
+                         const unsigned char *key) {
+    const CacheSnapshotSection *section = &snapshot->sections[shard];
+    if (section->table_capacity == 0) {
+        return -1;
+    }
+
+    const CacheSnapshotSlot *table =
+        (const CacheSnapshotSlot *)(snapshot->data + section->table_offset);
+    uint64_t bits = key_bits(key);
+    uint32_t tag = (uint32_t)(bits >> 32);
+    size_t mask = (size_t)section->table_capacity - 1;
+    size_t pos = (size_t)bits & mask;
+
+    for (size_t probes = 0; probes <= mask; probes++) {
+        const CacheSnapshotSlot *slot = &table[pos];
+        if (slot->record == 0) {
+            return -1;
+        }
+        if (slot->tag == tag && slot->record <= section->record_count &&
+            memcmp(cache_snapshot_record(snapshot, shard, slot->record - 1)->key, key,
+                   TRANS_CACHE_DIGEST_SIZE) == 0) {
+            return (long)slot->record - 1;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return -1;
+}
+
+bool cache_snapshot_texts(const CacheSnapshot *snapshot, size_t shard,
+                          const CacheSnapshotRecord *record,
+                          const char **source, const char **target) {
+    const CacheSnapshotSection *section = &snapshot->sections[shard];
+    const char *heap = (const char *)snapshot->data + section->heap_offset;
+
+    if (record->text_offset >= section->heap_size) {
+        return false;
+    }
+
+    uint64_t target_offset = record->text_offset + strlen(heap + record->text_offset) + 1;
+    if (target_offset >= section->heap_size) {
+        return false;
+    }
+
+    *source = heap + record->text_offset;
+    *target = heap + target_offset;
+    return true;
+}
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+/* Write len bytes, counting them */
+static bool write_bytes(CacheSnapshotWriter *writer, const void *data, size_t len) {
+    if (len > 0 && fwrite(data, 1, len, writer->fp) != len) {
+        return false;
+    }
+    writer->offset += len;
+    return true;
+}
+
+/* Pad with zeros up to the section alignment */
+static bool write_padding(CacheSnapshotWriter *writer) {
+    static const unsigned char zeros[SNAPSHOT_ALIGN];
+    size_t pad = (SNAPSHOT_ALIGN - writer->offset % SNAPSHOT_ALIGN) % SNAPSHOT_ALIGN;
+    return write_bytes(writer, zeros, pad);
+}
+
+static void writer_free(CacheSnapshotWriter *writer) {
+    if (writer->fp) {
+        fclose(writer->fp);
+    }
+    free(writer->records);
+    free(writer->sections);
+    free(writer->temp_path);
+    free(writer->path);
+    free(writer);
+}
+
+CacheSnapshotWriter *cache_snapshot_writer_open(const char *path, size_t shard_count) {
+    CacheSnapshotWriter *writer = calloc(1, sizeof(CacheSnapshotWriter));
+    if (!writer) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return NULL;
+    }
+
+    size_t path_len = strlen(path);
+    writer->path = strdup(path);
+    writer->temp_path = malloc(path_len + sizeof(SNAPSHOT_TEMP_SUFFIX));
+    writer->sections = calloc(shard_count, sizeof(CacheSnapshotSection));
+    writer->shard_count = shard_count;
+    if (!writer->path || !writer->temp_path || !writer->sections) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        writer_free(writer);
+        return NULL;
+    }
+    memcpy(writer->temp_path, path, path_len);
+    memcpy(writer->temp_path + path_len, SNAPSHOT_TEMP_SUFFIX, sizeof(SNAPSHOT_TEMP_SUFFIX));
+
+    writer->fp = fopen(writer->temp_path, "wb");
+    if (!writer->fp) {
+        LOG_DEBUG("Error: Failed to open cache snapshot for writing: %s\n", writer->temp_path);
+        writer_free(writer);
+        return NULL;
+    }
+
+    /* Header and section descriptors are written last, in place of these */
+    CacheSnapshotHeader header = { 0 };
+    bool ok = write_bytes(writer, &header, sizeof(header));
+    for (size_t s = 0; ok && s < shard_count; s++) {
+        ok = write_bytes(writer, &writer->sections[s], sizeof(CacheSnapshotSection));
+    }
+    writer->sections[0].heap_offset = writer->offset;
+
+    if (!ok) {
+        LOG_DEBUG("Error: Failed to write cache snapshot: %s\n", writer->temp_path);
+        cache_snapshot_writer_abort(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+int cache_snapshot_writer_add(CacheSnapshotWriter *writer, const CacheEntry *entry) {
+    if (writer->shard >= writer->shard_count) {
+        return -1;
+    }
+
+    if (writer->record_count == writer->record_capacity) {
+        size_t new_capacity = writer->record_capacity ? writer->record_capacity * 2 : 1024;
+        CacheSnapshotRecord *records = realloc(writer->records,
+                                               new_capacity * sizeof(CacheSnapshotRecord));
+        if (!records) {
+            LOG_DEBUG("Error: Memory allocation failed\n");
+            return -1;
+        }
+        writer->records = records;
+        writer->record_capacity = new_capacity;
+    }
+
+    CacheSnapshotRecord *record = &writer->records[writer->record_count];
+    memset(record, 0, sizeof(*record));
+    memcpy(record->key, entry->key, TRANS_CACHE_DIGEST_SIZE);
+    record->id = entry->id;
+    record->count = atomic_load_explicit(&entry->count, memory_order_relaxed);
+    record->last_used = atomic_load_explicit(&entry->last_used, memory_order_relaxed);
+    record->created_at = entry->created_at;
+    strncpy(record->from_lang, trans_cache_entry_from_lang(entry), sizeof(record->from_lang) - 1);
+    strncpy(record->to_lang, trans_cache_entry_to_lang(entry), sizeof(record->to_lang) - 1);
+    record->text_offset = writer->heap_size;
+
+    size_t source_len = strlen(entry->source_text) + 1;
+    size_t target_len = strlen(entry->translated_text) + 1;
+    if (!write_bytes(writer, entry->source_text, source_len) ||
+        !write_bytes(writer, entry->translated_text, target_len)) {
+        return -1;
+    }
+
+    writer->heap_size += source_len + target_len;
+    writer->record_count++;
+    return 0;
+}
+
+/* Records, then the table over them */
+int cache_snapshot_writer_end_shard(CacheSnapshotWriter *writer) {
+    if (writer->shard >= writer->shard_count) {
+        return -1;
+    }
+
+    CacheSnapshotSection *section = &writer->sections[writer->shard];
+    section->heap_size = writer->heap_size;
+
+    size_t capacity = 0;
+    if (writer->record_count > 0) {
+        /* At most half full */
+        capacity = 16;
+        while (capacity < writer->record_count * 2) {
+            capacity *= 2;
+        }
+    }
+
+    CacheSnapshotSlot *table = capacity ? calloc(capacity, sizeof(CacheSnapshotSlot)) : NULL;
+    if (capacity && !table) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        return -1;
+    }
+
+    /* Keys are unique, so a slot is taken by the first empty probe */
+    for (size_t i = 0; i < writer->record_count; i++) {
+        uint64_t bits = key_bits(writer->records[i].key);
+        size_t pos = (size_t)bits & (capacity - 1);
+        while (table[pos].record != 0) {
+            pos = (pos + 1) & (capacity - 1);
+        }
+        table[pos].tag = (uint32_t)(bits >> 32);
+        table[pos].record = (uint32_t)(i + 1);
+    }
+
+    bool ok = write_padding(writer);
+    section->records_offset = writer->offset;
+    section->record_count = writer->record_count;
+    ok = ok && write_bytes(writer, writer->records,
+                           writer->record_count * sizeof(CacheSnapshotRecord));
+    section->table_offset = writer->offset;
+    section->table_capacity = capacity;
+    ok = ok && write_bytes(writer, table, capacity * sizeof(CacheSnapshotSlot));
+    free(table);
+
+    writer->entry_count += writer->record_count;
+    writer->record_count = 0;
+    writer->heap_size = 0;
+    writer->shard++;
+    if (writer->shard < writer->shard_count) {
+        writer->sections[writer->shard].heap_offset = writer->offset;
+    }
+
+    if (!ok) {
+        LOG_DEBUG("Error: Failed to write cache snapshot: %s\n", writer->temp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int cache_snapshot_writer_finish(CacheSnapshotWriter *writer, const char *source_path,
+                                 int next_id) {
+    if (writer->shard != writer->shard_count) {
+        cache_snapshot_writer_abort(writer);
+        return -1;
+    }
+
+    CacheSnapshotHeader header = { 0 };
+    memcpy(header.magic, CACHE_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = CACHE_SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.shard_count = (uint32_t)writer->shard_count;
+    header.next_id = next_id;
+    header.file_size = writer->offset;
+    header.entry_count = writer->entry_count;
+
+    struct stat st;
+    if (source_path && stat(source_path, &st) == 0) {
+        header.source_size = (uint64_t)st.st_size;
+        header.source_mtime_sec = (int64_t)st.st_mtim.tv_sec;
+        header.source_mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    }
+
+    bool ok = fseek(writer->fp, 0, SEEK_SET) == 0 &&
+              fwrite(&header, sizeof(header), 1, writer->fp) == 1 &&
+              fwrite(writer->sections, sizeof(CacheSnapshotSection), writer->shard_count,
+                     writer->fp) == writer->shard_count &&
+              fflush(writer->fp) == 0 && fsync(fileno(writer->fp)) == 0;
+    ok = fclose(writer->fp) == 0 && ok;
+    writer->fp = NULL;
+
+    if (!ok || rename(writer->temp_path, writer->path) != 0) {
+        LOG_INFO("Error: Failed to write cache snapshot: %s\n", writer->path);
+        remove(writer->temp_path);
+        writer_free(writer);
+        return -1;
+    }
+
+    LOG_DEBUG("Wrote cache snapshot %s (%llu entries, %llu bytes)\n", writer->path,
+              (unsigned long long)header.entry_count, (unsigned long long)header.file_size);
+    writer_free(writer);
+    return 0;
+}
+
+void cache_snapshot_writer_abort(CacheSnapshotWriter *writer) {
+    if (!writer) {
+        return;
+    }
+    if (writer->fp) {
+        fclose(writer->fp);
+        writer->fp = NULL;
+    }
+    remove(writer->temp_path);
+    writer_free(writer);
+}
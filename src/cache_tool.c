@@ -12,13 +12,14 @@
 #include "trans_cache.h"
 #include "cache_backend_text.h"
 #include "cache_backend_sqlite.h"
+#include "cache_backend_redis.h"
 #include "utils.h"
 
 #define VERSION "1.0.0"
 #define DEFAULT_CACHE_FILE "trans_dictionary.txt"
 
 /* Helper macro to get text backend context */
-#define GET_TEXT_CTX(cache) ((TextBackendContext*)(cache)->backend_ctx)
+#define GET_TEXT_CTX(cache) ((TextBackend*)(cache)->backend_ctx)
 
 /* Print usage information */
 static void print_usage(const char *prog_name) {
@@ -36,6 +37,8 @@ static void print_usage(const char *prog_name) {
     printf("  delete <id>                      Delete entry by ID\n");
     printf("  export [from_lang] [to_lang]     Export cache entries to stdout\n");
     printf("                                    Optional: filter by language pair\n");
+    printf("  compile [output]                 Compile cache into a snapshot\n");
+    printf("                                    (default: <cache file>.snap)\n");
     printf("  migrate --from <backend> --from-config <path>\n");
     printf("          --to <backend> --to-config <path>\n");
     printf("                                   Migrate cache between backends\n");
@@ -52,6 +55,7 @@ static void print_usage(const char *prog_name) {
     printf("  %s clear kor eng                 Clear Korean to English cache\n", prog_name);
     printf("  %s cleanup 30                    Remove entries older than 30 days\n", prog_name);
     printf("  %s stats                         Show cache statistics\n", prog_name);
+    printf("  %s compile                       Compile snapshot next to cache file\n", prog_name);
     printf("  %s -f custom.txt list            Use custom cache file\n", prog_name);
     printf("\n");
     printf("Migration Examples:\n");
@@ -59,6 +63,8 @@ static void print_usage(const char *prog_name) {
     printf("                     --to sqlite --to-config ./cache.db\n");
     printf("  %s migrate --from sqlite --from-config ./cache.db \\\n", prog_name);
     printf("                     --to text --to-config ./dict_new.txt\n");
+    printf("  %s migrate --from sqlite --from-config ./cache.db \\\n", prog_name);
+    printf("                     --to redis --to-config redis://127.0.0.1:6379/0\n");
     printf("\n");
 }
 
@@ -83,13 +89,53 @@ static void truncate_for_display(const char *text, char *buffer, size_t max_len)
     }
 }
 
+/* Order entries by ID */
+static int compare_entry_id(const void *a, const void *b) {
+    const CacheEntry *ea = *(const CacheEntry *const *)a;
+    const CacheEntry *eb = *(const CacheEntry *const *)b;
+    return (ea->id > eb->id) - (ea->id < eb->id);
+}
+
+/* Collect the entries of all text backend slices, ordered by ID.
+ * Returns a malloc'd array (caller frees) or NULL on allocation failure. */
+static CacheEntry **collect_text_entries(TransCache *cache, size_t *count_out) {
+    TextBackend *backend = GET_TEXT_CTX(cache);
+
+    size_t total = 0;
+    for (size_t s = 0; s < backend->slice_count; s++) {
+        total += backend->slices[s].size;
+    }
+
+    CacheEntry **entries = malloc((total > 0 ? total : 1) * sizeof(CacheEntry *));
+    if (!entries) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return NULL;
+    }
+
+    size_t count = 0;
+    for (size_t s = 0; s < backend->slice_count; s++) {
+        TextBackendContext *ctx = &backend->slices[s];
+        memcpy(entries + count, ctx->entries, ctx->size * sizeof(CacheEntry *));
+        count += ctx->size;
+    }
+
+    qsort(entries, count, sizeof(CacheEntry *), compare_entry_id);
+
+    *count_out = count;
+    return entries;
+}
+
 /* List cache entries */
 static int cmd_list(TransCache *cache, const char *from_lang, const char *to_lang) {
     if (!cache) {
         return -1;
     }
 
-    TextBackendContext *ctx = GET_TEXT_CTX(cache);
+    size_t entry_count;
+    CacheEntry **entries = collect_text_entries(cache, &entry_count);
+    if (!entries) {
+        return -1;
+    }
 
     printf("\n");
     printf("%-5s %-4s %-4s %-8s %-30s %-30s %-19s\n",
@@ -98,14 +144,14 @@ static int cmd_list(TransCache *cache, const char *from_lang, const char *to_lan
 
     int displayed_count = 0;
 
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
+    for (size_t i = 0; i < entry_count; i++) {
+        CacheEntry *entry = entries[i];
 
         /* Filter by language pair if specified */
-        if (from_lang && strcmp(entry->from_lang, from_lang) != 0) {
+        if (from_lang && strcmp(trans_cache_entry_from_lang(entry), from_lang) != 0) {
             continue;
         }
-        if (to_lang && strcmp(entry->to_lang, to_lang) != 0) {
+        if (to_lang && strcmp(trans_cache_entry_to_lang(entry), to_lang) != 0) {
             continue;
         }
 
@@ -118,16 +164,39 @@ static int cmd_list(TransCache *cache, const char *from_lang, const char *to_lan
         format_timestamp(entry->last_used, last_used_str, sizeof(last_used_str));
 
         printf("%-5d %-4s %-4s %-8d %-30s %-30s %s\n",
-               entry->id, entry->from_lang, entry->to_lang, entry->count,
-               source_display, trans_display, last_used_str);
+               entry->id, trans_cache_entry_from_lang(entry),
+               trans_cache_entry_to_lang(entry), entry->count, source_display, trans_display, last_used_str);
 
         displayed_count++;
     }
 
+    free(entries);
+
     printf("\nTotal: %d entries\n\n", displayed_count);
     return 0;
 }
 
+/* Language pair filter for cmd_clear */
+typedef struct {
+    uint8_t from_id;
+    uint8_t to_id;
+} LangPairFilter;
+
+static bool match_lang_pair(const CacheEntry *entry, void *user_data) {
+    const LangPairFilter *pair = (const LangPairFilter*)user_data;
+    return entry->from_id == pair->from_id && entry->to_id == pair->to_id;
+}
+
+static bool match_all(const CacheEntry *entry, void *user_data) {
+    (void)entry;
+    (void)user_data;
+    return true;
+}
+
+static bool match_id(const CacheEntry *entry, void *user_data) {
+    return entry->id == *(const int*)user_data;
+}
+
 /* Clear cache entries by language pair */
 static int cmd_clear(TransCache *cache, const char *from_lang, const char *to_lang) {
     if (!cache || !from_lang || !to_lang) {
@@ -141,28 +210,11 @@ static int cmd_clear(TransCache *cache, const char *from_lang, const char *to_la
         return -1;
     }
 
-    TextBackendContext *ctx = GET_TEXT_CTX(cache);
-
-    int removed_count = 0;
-    size_t write_idx = 0;
-
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
-
-        if (strcmp(entry->from_lang, from_lang) == 0 &&
-            strcmp(entry->to_lang, to_lang) == 0) {
-            /* Remove this entry */
-            free(entry->source_text);
-            free(entry->translated_text);
-            free(entry);
-            removed_count++;
-        } else {
-            /* Keep this entry */
-            ctx->entries[write_idx++] = entry;
-        }
-    }
-
-    ctx->size = write_idx;
+    LangPairFilter pair = {
+        .from_id = trans_cache_lang_id(from_lang),
+        .to_id = trans_cache_lang_id(to_lang)
+    };
+    int removed_count = (int)text_backend_remove_entries(cache, match_lang_pair, &pair);
 
     printf("Removed %d entries (%s -> %s)\n", removed_count, from_lang, to_lang);
 
@@ -182,8 +234,6 @@ static int cmd_clear_all(TransCache *cache) {
         return -1;
     }
 
-    TextBackendContext *ctx = GET_TEXT_CTX(cache);
-
     printf("WARNING: This will delete ALL cache entries!\n");
     printf("Are you sure? (yes/no): ");
 
@@ -201,17 +251,7 @@ static int cmd_clear_all(TransCache *cache) {
         return 0;
     }
 
-    int total_count = ctx->size;
-
-    /* Free all entries */
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
-        free(entry->source_text);
-        free(entry->translated_text);
-        free(entry);
-    }
-
-    ctx->size = 0;
+    int total_count = (int)text_backend_remove_entries(cache, match_all, NULL);
 
     printf("Removed %d entries\n", total_count);
 
@@ -231,12 +271,16 @@ static int cmd_stats(TransCache *cache) {
         return -1;
     }
 
-    TextBackendContext *ctx = GET_TEXT_CTX(cache);
+    size_t entry_count;
+    CacheEntry **entries = collect_text_entries(cache, &entry_count);
+    if (!entries) {
+        return -1;
+    }
 
     /* Count entries by language pair */
     typedef struct {
-        char from_lang[4];
-        char to_lang[4];
+        uint8_t from_id;
+        uint8_t to_id;
         int count;
         time_t last_used;
     } LangPairStats;
@@ -247,6 +291,7 @@ static int cmd_stats(TransCache *cache) {
 
     pairs = malloc(pairs_capacity * sizeof(LangPairStats));
     if (!pairs) {
+        free(entries);
         fprintf(stderr, "Error: Memory allocation failed\n");
         return -1;
     }
@@ -255,11 +300,11 @@ static int cmd_stats(TransCache *cache) {
     time_t now = time(NULL);
     time_t oldest_time = now;
     time_t newest_time = 0;
-    int total_count = ctx->size;
+    int total_count = (int)entry_count;
     long total_usage_count = 0;
 
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
+    for (size_t i = 0; i < entry_count; i++) {
+        CacheEntry *entry = entries[i];
 
         total_usage_count += entry->count;
 
@@ -273,8 +318,7 @@ static int cmd_stats(TransCache *cache) {
         /* Update language pair stats */
         int found = 0;
         for (int j = 0; j < pairs_count; j++) {
-            if (strcmp(pairs[j].from_lang, entry->from_lang) == 0 &&
-                strcmp(pairs[j].to_lang, entry->to_lang) == 0) {
+            if (pairs[j].from_id == entry->from_id && pairs[j].to_id == entry->to_id) {
                 pairs[j].count++;
                 if (entry->last_used > pairs[j].last_used) {
                     pairs[j].last_used = entry->last_used;
@@ -291,14 +335,15 @@ static int cmd_stats(TransCache *cache) {
                 LangPairStats *new_pairs = realloc(pairs, pairs_capacity * sizeof(LangPairStats));
                 if (!new_pairs) {
                     free(pairs);
+                    free(entries);
                     fprintf(stderr, "Error: Memory reallocation failed\n");
                     return -1;
                 }
                 pairs = new_pairs;
             }
 
-            strncpy(pairs[pairs_count].from_lang, entry->from_lang, 4);
-            strncpy(pairs[pairs_count].to_lang, entry->to_lang, 4);
+            pairs[pairs_count].from_id = entry->from_id;
+            pairs[pairs_count].to_id = entry->to_id;
             pairs[pairs_count].count = 1;
             pairs[pairs_count].last_used = entry->last_used;
             pairs_count++;
@@ -334,13 +379,15 @@ static int cmd_stats(TransCache *cache) {
         char last_used_str[20];
         format_timestamp(pairs[i].last_used, last_used_str, sizeof(last_used_str));
         printf("  %-4s → %-4s : %-8d  %s\n",
-               pairs[i].from_lang, pairs[i].to_lang,
+               trans_cache_lang_code(pairs[i].from_id),
+               trans_cache_lang_code(pairs[i].to_id),
                pairs[i].count, last_used_str);
     }
 
     printf("\n");
 
     free(pairs);
+    free(entries);
     return 0;
 }
 
@@ -372,13 +419,18 @@ static int cmd_search(TransCache *cache, const char *from_lang, const char *to_l
         return -1;
     }
 
+    trans_cache_read_begin(cache);
     CacheEntry *entry = trans_cache_lookup(cache, from_lang, to_lang, text);
 
     if (!entry) {
+        trans_cache_read_end(cache);
         printf("No matching entry found\n");
         return 0;
     }
 
+    char hash[65];
+    trans_cache_entry_hash(entry, hash);
+
     char created_str[20], last_used_str[20];
     format_timestamp(entry->created_at, created_str, sizeof(created_str));
     format_timestamp(entry->last_used, last_used_str, sizeof(last_used_str));
@@ -387,9 +439,9 @@ static int cmd_search(TransCache *cache, const char *from_lang, const char *to_l
     printf("=== Cache Entry Found ===\n");
     printf("\n");
     printf("ID:           %d\n", entry->id);
-    printf("Hash:         %s\n", entry->hash);
-    printf("From:         %s\n", entry->from_lang);
-    printf("To:           %s\n", entry->to_lang);
+    printf("Hash:         %s\n", hash);
+    printf("From:         %s\n", trans_cache_entry_from_lang(entry));
+    printf("To:           %s\n", trans_cache_entry_to_lang(entry));
     printf("Source:       %s\n", entry->source_text);
     printf("Translation:  %s\n", entry->translated_text);
     printf("Count:        %d\n", entry->count);
@@ -397,6 +449,7 @@ static int cmd_search(TransCache *cache, const char *from_lang, const char *to_l
     printf("Last used:    %s\n", last_used_str);
     printf("\n");
 
+    trans_cache_read_end(cache);
     return 0;
 }
 
@@ -407,33 +460,11 @@ static int cmd_delete(TransCache *cache, int id) {
         return -1;
     }
 
-    TextBackendContext *ctx = GET_TEXT_CTX(cache);
-
-    int found = 0;
-    size_t write_idx = 0;
-
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
-
-        if (entry->id == id) {
-            /* Delete this entry */
-            free(entry->source_text);
-            free(entry->translated_text);
-            free(entry);
-            found = 1;
-        } else {
-            /* Keep this entry */
-            ctx->entries[write_idx++] = entry;
-        }
-    }
-
-    if (!found) {
+    if (text_backend_remove_entries(cache, match_id, &id) == 0) {
         fprintf(stderr, "Error: Entry with ID %d not found\n", id);
         return -1;
     }
 
-    ctx->size = write_idx;
-
     printf("Deleted entry ID %d\n", id);
 
     /* Save changes */
@@ -452,23 +483,27 @@ static int cmd_export(TransCache *cache, const char *from_lang, const char *to_l
         return -1;
     }
 
-    TextBackendContext *ctx = GET_TEXT_CTX(cache);
+    size_t entry_count;
+    CacheEntry **entries = collect_text_entries(cache, &entry_count);
+    if (!entries) {
+        return -1;
+    }
 
-    for (size_t i = 0; i < ctx->size; i++) {
-        CacheEntry *entry = ctx->entries[i];
+    for (size_t i = 0; i < entry_count; i++) {
+        CacheEntry *entry = entries[i];
 
         /* Filter by language pair if specified */
-        if (from_lang && strcmp(entry->from_lang, from_lang) != 0) {
+        if (from_lang && strcmp(trans_cache_entry_from_lang(entry), from_lang) != 0) {
             continue;
         }
-        if (to_lang && strcmp(entry->to_lang, to_lang) != 0) {
+        if (to_lang && strcmp(trans_cache_entry_to_lang(entry), to_lang) != 0) {
             continue;
         }
 
         printf("%d\t%s\t%s\t%s\t%s\t%d\t%ld\t%ld\n",
                entry->id,
-               entry->from_lang,
-               entry->to_lang,
+               trans_cache_entry_from_lang(entry),
+               trans_cache_entry_to_lang(entry),
                entry->source_text,
                entry->translated_text,
                entry->count,
@@ -476,6 +511,27 @@ static int cmd_export(TransCache *cache, const char *from_lang, const char *to_l
                (long)entry->last_used);
     }
 
+    free(entries);
+    return 0;
+}
+
+/* Compile cache into a snapshot the server can map at startup */
+static int cmd_compile(TransCache *cache, const char *output) {
+    if (!cache) {
+        return -1;
+    }
+
+    long compiled = text_backend_compile_snapshot(cache, output);
+    if (compiled < 0) {
+        fprintf(stderr, "Error: Failed to compile snapshot\n");
+        return -1;
+    }
+
+    if (output) {
+        printf("Compiled %ld entries into %s\n", compiled, output);
+    } else {
+        printf("Compiled %ld entries into %s.snap\n", compiled, GET_TEXT_CTX(cache)->file_path);
+    }
     return 0;
 }
 
@@ -513,13 +569,23 @@ static const char *get_backend_name(CacheBackendType type) {
 /* Helper function to iterate all entries from a cache backend */
 typedef int (*entry_iterator_fn)(void *ctx, CacheEntry *entry, void *user_data);
 
-static int iterate_text_backend(TextBackendContext *ctx, entry_iterator_fn callback, void *user_data) {
-    for (size_t i = 0; i < ctx->size; i++) {
-        if (callback(ctx, ctx->entries[i], user_data) != 0) {
-            return -1;
+static int iterate_text_backend(TransCache *cache, entry_iterator_fn callback, void *user_data) {
+    size_t entry_count;
+    CacheEntry **entries = collect_text_entries(cache, &entry_count);
+    if (!entries) {
+        return -1;
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < entry_count; i++) {
+        if (callback(cache->backend_ctx, entries[i], user_data) != 0) {
+            result = -1;
+            break;
         }
     }
-    return 0;
+
+    free(entries);
+    return result;
 }
 
 /* For SQLite backend, we need to query all entries */
@@ -541,14 +607,17 @@ static int iterate_sqlite_backend(SqliteBackendContext *ctx, entry_iterator_fn c
         memset(&entry, 0, sizeof(entry));
 
         entry.id = sqlite3_column_int(stmt, 0);
-        strncpy(entry.hash, (const char*)sqlite3_column_text(stmt, 1), sizeof(entry.hash) - 1);
-        strncpy(entry.from_lang, (const char*)sqlite3_column_text(stmt, 2), sizeof(entry.from_lang) - 1);
-        strncpy(entry.to_lang, (const char*)sqlite3_column_text(stmt, 3), sizeof(entry.to_lang) - 1);
+        const void *key = sqlite3_column_blob(stmt, 1);
+        if (key && sqlite3_column_bytes(stmt, 1) == TRANS_CACHE_DIGEST_SIZE) {
+            memcpy(entry.key, key, TRANS_CACHE_DIGEST_SIZE);
+        }
+        entry.from_id = trans_cache_lang_id((const char*)sqlite3_column_text(stmt, 2));
+        entry.to_id = trans_cache_lang_id((const char*)sqlite3_column_text(stmt, 3));
         entry.source_text = strdup((const char*)sqlite3_column_text(stmt, 4));
         entry.translated_text = strdup((const char*)sqlite3_column_text(stmt, 5));
         entry.count = sqlite3_column_int(stmt, 6);
-        entry.last_used = (time_t)sqlite3_column_int64(stmt, 7);
-        entry.created_at = (time_t)sqlite3_column_int64(stmt, 8);
+        entry.last_used = (uint32_t)sqlite3_column_int64(stmt, 7);
+        entry.created_at = (uint32_t)sqlite3_column_int64(stmt, 8);
 
         if (!entry.source_text || !entry.translated_text) {
             free(entry.source_text);
@@ -579,6 +648,29 @@ static int iterate_sqlite_backend(SqliteBackendContext *ctx, entry_iterator_fn c
     return entry_count;
 }
 
+/* Adapts entry_iterator_fn to redis_backend_foreach */
+typedef struct {
+    TransCache *cache;
+    entry_iterator_fn callback;
+    void *user_data;
+} RedisIteration;
+
+static int redis_entry_callback(CacheEntry *entry, void *user_data) {
+    RedisIteration *iteration = (RedisIteration*)user_data;
+    return iteration->callback(iteration->cache->backend_ctx, entry, iteration->user_data);
+}
+
+/* For Redis backend, SCAN the keys under the prefix */
+static int iterate_redis_backend(TransCache *cache, entry_iterator_fn callback, void *user_data) {
+    RedisIteration iteration = { cache, callback, user_data };
+    long visited = redis_backend_foreach(cache, redis_entry_callback, &iteration);
+    if (visited < 0) {
+        fprintf(stderr, "Error reading entries from Redis\n");
+        return -1;
+    }
+    return (int)visited;
+}
+
 /* Migration callback context */
 typedef struct {
     TransCache *dest_cache;
@@ -594,8 +686,8 @@ static int migrate_entry_callback(void *ctx, CacheEntry *entry, void *user_data)
 
     /* Add to destination cache */
     if (trans_cache_add(mctx->dest_cache,
-                        entry->from_lang,
-                        entry->to_lang,
+                        trans_cache_entry_from_lang(entry),
+                        trans_cache_entry_to_lang(entry),
                         entry->source_text,
                         entry->translated_text) != 0) {
         mctx->failed_count++;
@@ -659,7 +751,8 @@ static int cmd_migrate(int argc, char *argv[]) {
             case 'h':
                 printf("Usage: cache_tool migrate --from <backend> --from-config <path> \\\n");
                 printf("                           --to <backend> --to-config <path>\n\n");
-                printf("Backends: text, sqlite, mongodb (not yet), redis (not yet)\n\n");
+                printf("Backends: text, sqlite, mongodb (not yet), redis\n");
+                printf("          (redis config: redis://[[user]:password@]host[:port][/db])\n\n");
                 printf("Example:\n");
                 printf("  cache_tool migrate --from text --from-config ./dict.txt \\\n");
                 printf("                     --to sqlite --to-config ./cache.db\n");
@@ -683,11 +776,11 @@ static int cmd_migrate(int argc, char *argv[]) {
     CacheBackendType to_type = parse_backend_type(to_backend);
 
     /* Check for unsupported backends */
-    if (from_type == CACHE_BACKEND_MONGODB || from_type == CACHE_BACKEND_REDIS) {
+    if (from_type == CACHE_BACKEND_MONGODB) {
         fprintf(stderr, "Error: %s backend not yet implemented\n", from_backend);
         return -1;
     }
-    if (to_type == CACHE_BACKEND_MONGODB || to_type == CACHE_BACKEND_REDIS) {
+    if (to_type == CACHE_BACKEND_MONGODB) {
         fprintf(stderr, "Error: %s backend not yet implemented\n", to_backend);
         return -1;
     }
@@ -727,11 +820,12 @@ static int cmd_migrate(int argc, char *argv[]) {
     /* Iterate source entries and migrate */
     int result = 0;
     if (from_type == CACHE_BACKEND_TEXT) {
-        TextBackendContext *ctx = (TextBackendContext*)source_cache->backend_ctx;
-        result = iterate_text_backend(ctx, migrate_entry_callback, &mctx);
+        result = iterate_text_backend(source_cache, migrate_entry_callback, &mctx);
     } else if (from_type == CACHE_BACKEND_SQLITE) {
         SqliteBackendContext *ctx = (SqliteBackendContext*)source_cache->backend_ctx;
         result = iterate_sqlite_backend(ctx, migrate_entry_callback, &mctx);
+    } else if (from_type == CACHE_BACKEND_REDIS) {
+        result = iterate_redis_backend(source_cache, migrate_entry_callback, &mctx);
     }
 
     if (result < 0) {
@@ -741,8 +835,12 @@ static int cmd_migrate(int argc, char *argv[]) {
         return -1;
     }
 
-    /* Save destination cache */
+    /* Save destination cache; a text cache is written as one complete file
+     * instead of a journal */
     printf("Saving destination cache...\n");
+    if (to_type == CACHE_BACKEND_TEXT) {
+        atomic_store(&GET_TEXT_CTX(dest_cache)->rewrite_pending, true);
+    }
     if (trans_cache_save(dest_cache) != 0) {
         fprintf(stderr, "Warning: Failed to save destination cache\n");
     }
@@ -863,6 +961,10 @@ int main(int argc, char *argv[]) {
         const char *to_lang = (optind + 2 < argc) ? argv[optind + 2] : NULL;
         result = cmd_export(cache, from_lang, to_lang);
 
+    } else if (strcmp(command, "compile") == 0) {
+        const char *output = (optind + 1 < argc) ? argv[optind + 1] : NULL;
+        result = cmd_compile(cache, output);
+
     } else {
         fprintf(stderr, "Error: Unknown command '%s'\n\n", command);
         print_usage(argv[0]);
@@ -0,0 +1,596 @@
+/**
+ * Write-behind module for the translation cache.
+ * Takes cache inserts and translation updates off the request thread: they
+ * are queued in a bounded ring and a background writer applies them every
+ * interval_ms (or once batch_size are queued), shard by shard, each batch
+ * in one backend transaction (begin_batch / end_batch).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "cache_write_behind.h"
+#include "cache_hot_tier.h"
+#include "utils.h"
+
+#define DEFAULT_CAPACITY 10000
+#define DEFAULT_INTERVAL_MS 50
+#define DEFAULT_BATCH_SIZE 1000
+
+/* Queued mutation: store translated_text for key */
+typedef struct {
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    uint8_t from_id;
+    uint8_t to_id;
+    char *source_text;              /* One allocation holding both texts */
+    char *translated_text;
+    long long queued_ms;            /* Monotonic enqueue time */
+} WriteBehindOp;
+
+/* Key written in the open transaction (valid if gen matches) */
+typedef struct {
+    uint64_t tag;
+    unsigned int gen;
+} TouchedKey;
+
+struct CacheWriteBehind {
+    TransCache *cache;
+    size_t capacity;
+    size_t batch_size;
+    int interval_ms;
+    WriteBehindOverflow overflow;
+
+    pthread_mutex_t lock;           /* Protects the ring, flags and stats */
+    pthread_cond_t wake;            /* Wakes the writer (monotonic clock) */
+    pthread_cond_t room;            /* Wakes producers blocked on a full ring */
+    WriteBehindOp *ring;
+    size_t head;
+    size_t count;
+    bool running;
+    pthread_t writer;
+    bool writer_started;
+
+    /* Under apply_lock: one batch is applied at a time */
+    pthread_mutex_t apply_lock;
+    WriteBehindOp *batch;           /* batch_size ops detached from the ring */
+    TouchedKey *touched;            /* Keys of the open transaction */
+    size_t touched_capacity;        /* Power of two, > 2 * batch_size */
+    unsigned int touched_gen;
+
+    /* Statistics (under lock) */
+    size_t peak_depth;
+    unsigned long long enqueued;
+    unsigned long long applied;
+    unsigned long long failed;      /* Ops whose write or commit failed */
+    unsigned long long dropped;
+    unsigned long long sync_applied;
+    unsigned long long blocked;
+    unsigned long long batches;
+    unsigned long long commit_ms_total;
+    unsigned long long commit_ms_max;
+    unsigned long long delay_ms_total;  /* Enqueue to commit, summed over ops */
+    unsigned long long delay_ms_max;
+};
+
+/* Monotonic clock in milliseconds */
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Free the texts of an op */
+static void op_release(WriteBehindOp *op) {
+    free(op->source_text);
+    op->source_text = NULL;
+    op->translated_text = NULL;
+}
+
+/* Fill op with copies of the texts. Returns -1 on allocation failure. */
+static int op_init(WriteBehindOp *op, const unsigned char *key, const char *from_lang,
+                   const char *to_lang, const char *source_text, const char *translated_text) {
+    size_t source_len = strlen(source_text);
+    size_t translated_len = strlen(translated_text);
+
+    op->source_text = malloc(source_len + translated_len + 2);
+    if (!op->source_text) {
+        LOG_DEBUG("Error: Memory allocation failed for cache write\n");
+        return -1;
+    }
+    memcpy(op->source_text, source_text, source_len + 1);
+    op->translated_text = op->source_text + source_len + 1;
+    memcpy(op->translated_text, translated_text, translated_len + 1);
+
+    memcpy(op->key, key, TRANS_CACHE_DIGEST_SIZE);
+    op->from_id = trans_cache_lang_id(from_lang);
+    op->to_id = trans_cache_lang_id(to_lang);
+    op->queued_ms = monotonic_ms();
+    return 0;
+}
+
+/* ============================================================================
+ * Applying ops (caller holds the shard write lock, inside a read section)
+ * ============================================================================ */
+
+/* Store the op's translation: insert it, count a repeat of the cached
+ * translation or replace a different one, as the request thread would
+ * have done with the entry it looked up */
+static int apply_op(TransCache *cache, void *backend_ctx, const WriteBehindOp *op) {
+    CacheEntry *entry = cache->ops->lookup(backend_ctx, op->key);
+
+    if (!entry) {
+        return cache->ops->add(backend_ctx, op->key, trans_cache_lang_code(op->from_id),
+                               trans_cache_lang_code(op->to_id), op->source_text,
+                               op->translated_text);
+    }
+    if (strcmp(entry->translated_text, op->translated_text) == 0) {
+        return cache->ops->update_count(backend_ctx, entry);
+    }
+    return cache->ops->update_translation(backend_ctx, entry, op->translated_text);
+}
+
+/* Apply one op right away on the calling thread (autocommit) */
+static int apply_now(CacheWriteBehind *wb, const WriteBehindOp *op) {
+    TransCache *cache = wb->cache;
+    size_t shard = trans_cache_shard_of(op->key, cache->shard_count);
+
+    trans_cache_read_begin(cache);
+    trans_cache_lock_shard(cache, shard, true);
+    int result = apply_op(cache, cache->shards[shard].backend_ctx, op);
+    trans_cache_unlock_shard(cache, shard);
+    trans_cache_read_end(cache);
+
+    hot_tier_invalidate(cache->hot_tier, op->key);
+
+    return result;
+}
+
+/* Remember key as written in the open transaction. Returns false if it
+ * already was: lookups may not see uncommitted writes, so the caller
+ * commits before writing the key again. */
+static bool touch_key(CacheWriteBehind *wb, const unsigned char *key) {
+    uint64_t tag;
+    memcpy(&tag, key, sizeof(tag));
+
+    size_t mask = wb->touched_capacity - 1;
+    for (size_t i = (size_t)tag & mask;; i = (i + 1) & mask) {
+        TouchedKey *slot = &wb->touched[i];
+        if (slot->gen != wb->touched_gen) {
+            slot->tag = tag;
+            slot->gen = wb->touched_gen;
+            return true;
+        }
+        if (slot->tag == tag) {
+            return false;
+        }
+    }
+}
+
+/* Forget the keys of the open transaction */
+static void touched_reset(CacheWriteBehind *wb) {
+    if (++wb->touched_gen == 0) {
+        memset(wb->touched, 0, wb->touched_capacity * sizeof(TouchedKey));
+        wb->touched_gen = 1;
+    }
+}
+
+/* Open a backend transaction. Returns false if writes autocommit instead. */
+static bool batch_begin(TransCache *cache, void *backend_ctx) {
+    return cache->ops->begin_batch && cache->ops->begin_batch(backend_ctx) == 0;
+}
+
+/* Commit the open transaction. Returns false if its writes were lost. */
+static bool batch_end(TransCache *cache, void *backend_ctx, bool open) {
+    return !open || !cache->ops->end_batch || cache->ops->end_batch(backend_ctx) == 0;
+}
+
+/* Drop hot tier copies of the keys of ops order[from .. to), once their
+ * transaction has ended (a copy taken before the commit is then stale) */
+static void invalidate_hot(CacheWriteBehind *wb, const size_t *order, size_t from, size_t to) {
+    for (size_t k = from; k < to; k++) {
+        hot_tier_invalidate(wb->cache->hot_tier, wb->batch[order[k]].key);
+    }
+}
+
+/* Apply the n detached ops in wb->batch (caller holds apply_lock). Ops are
+ * grouped by shard, in queue order within a shard, one transaction each. */
+static void apply_batch(CacheWriteBehind *wb, size_t n) {
+    TransCache *cache = wb->cache;
+    long long start_ms = monotonic_ms();
+    unsigned long long failed = 0;
+
+    /* Ops of shard s are order[first[s] .. first[s + 1]) (at most 256 shards) */
+    size_t first[257] = { 0 };
+    size_t *order = malloc(n * sizeof(size_t));
+    if (!order) {
+        /* Apply in queue order, one shard lock each */
+        for (size_t i = 0; i < n; i++) {
+            failed += apply_now(wb, &wb->batch[i]) != 0;
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            first[trans_cache_shard_of(wb->batch[i].key, cache->shard_count) + 1]++;
+        }
+        for (size_t s = 0; s < cache->shard_count; s++) {
+            first[s + 1] += first[s];
+        }
+        size_t fill[257];
+        memcpy(fill, first, sizeof(fill));
+        for (size_t i = 0; i < n; i++) {
+            order[fill[trans_cache_shard_of(wb->batch[i].key, cache->shard_count)]++] = i;
+        }
+
+        trans_cache_read_begin(cache);
+        for (size_t s = 0; s < cache->shard_count; s++) {
+            if (first[s] == first[s + 1]) {
+                continue;
+            }
+
+            void *backend_ctx = cache->shards[s].backend_ctx;
+            trans_cache_lock_shard(cache, s, true);
+
+            bool open = batch_begin(cache, backend_ctx);
+            size_t in_transaction = 0;
+            size_t transaction_first = first[s];
+            touched_reset(wb);
+
+            for (size_t k = first[s]; k < first[s + 1]; k++) {
+                WriteBehindOp *op = &wb->batch[order[k]];
+
+                if (!touch_key(wb, op->key)) {
+                    if (!batch_end(cache, backend_ctx, open)) {
+                        failed += in_transaction;
+                    }
+                    invalidate_hot(wb, order, transaction_first, k);
+                    transaction_first = k;
+                    open = batch_begin(cache, backend_ctx);
+                    in_transaction = 0;
+                    touched_reset(wb);
+                    touch_key(wb, op->key);
+                }
+
+                if (apply_op(cache, backend_ctx, op) == 0) {
+                    in_transaction++;
+                } else {
+                    failed++;
+                }
+            }
+
+            if (!batch_end(cache, backend_ctx, open)) {
+                failed += in_transaction;
+            }
+            invalidate_hot(wb, order, transaction_first, first[s + 1]);
+            trans_cache_unlock_shard(cache, s);
+        }
+        trans_cache_read_end(cache);
+        free(order);
+    }
+
+    long long end_ms = monotonic_ms();
+    unsigned long long commit_ms = (unsigned long long)(end_ms - start_ms);
+    unsigned long long delay_total = 0;
+    unsigned long long delay_max = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long delay = (unsigned long long)(end_ms - wb->batch[i].queued_ms);
+        delay_total += delay;
+        if (delay > delay_max) {
+            delay_max = delay;
+        }
+        op_release(&wb->batch[i]);
+    }
+
+    if (failed > 0) {
+        LOG_INFO("Warning: %llu of %zu queued cache writes failed\n", failed, n);
+    }
+
+    pthread_mutex_lock(&wb->lock);
+    wb->batches++;
+    wb->applied += n - failed;
+    wb->failed += failed;
+    wb->commit_ms_total += commit_ms;
+    if (commit_ms > wb->commit_ms_max) {
+        wb->commit_ms_max = commit_ms;
+    }
+    wb->delay_ms_total += delay_total;
+    if (delay_max > wb->delay_ms_max) {
+        wb->delay_ms_max = delay_max;
+    }
+    pthread_mutex_unlock(&wb->lock);
+}
+
+/* Move up to batch_size ops from the ring into wb->batch (called with lock
+ * and apply_lock held). Returns the number moved. */
+static size_t detach_ops(CacheWriteBehind *wb) {
+    size_t n = wb->count < wb->batch_size ? wb->count : wb->batch_size;
+
+    for (size_t i = 0; i < n; i++) {
+        wb->batch[i] = wb->ring[wb->head];
+        wb->head = (wb->head + 1) % wb->capacity;
+    }
+    wb->count -= n;
+
+    if (n > 0) {
+        pthread_cond_broadcast(&wb->room);
+    }
+    return n;
+}
+
+/* Writer thread: apply a batch once it is full or its oldest op is
+ * interval_ms old */
+static void *write_behind_thread(void *arg) {
+    CacheWriteBehind *wb = (CacheWriteBehind *)arg;
+
+    pthread_mutex_lock(&wb->lock);
+
+    while (wb->running) {
+        if (wb->count == 0) {
+            pthread_cond_wait(&wb->wake, &wb->lock);
+            continue;
+        }
+
+        long long deadline = wb->ring[wb->head].queued_ms + wb->interval_ms;
+        if (wb->count < wb->batch_size && monotonic_ms() < deadline) {
+            struct timespec ts;
+            ts.tv_sec = deadline / 1000;
+            ts.tv_nsec = (deadline % 1000) * 1000000;
+            pthread_cond_timedwait(&wb->wake, &wb->lock, &ts);
+            continue;
+        }
+
+        pthread_mutex_unlock(&wb->lock);
+
+        pthread_mutex_lock(&wb->apply_lock);
+        pthread_mutex_lock(&wb->lock);
+        size_t n = detach_ops(wb);
+        pthread_mutex_unlock(&wb->lock);
+        if (n > 0) {
+            apply_batch(wb, n);
+        }
+        pthread_mutex_unlock(&wb->apply_lock);
+
+        pthread_mutex_lock(&wb->lock);
+    }
+
+    pthread_mutex_unlock(&wb->lock);
+    return NULL;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/* Free queue structures (writer stopped, nothing queued) */
+static void write_behind_destroy(CacheWriteBehind *wb) {
+    pthread_mutex_destroy(&wb->lock);
+    pthread_cond_destroy(&wb->wake);
+    pthread_cond_destroy(&wb->room);
+    pthread_mutex_destroy(&wb->apply_lock);
+    free(wb->ring);
+    free(wb->batch);
+    free(wb->touched);
+    free(wb);
+}
+
+/* Enable write-behind */
+int trans_cache_enable_write_behind(TransCache *cache, const WriteBehindOptions *options) {
+    if (!cache || cache->write_behind) {
+        return -1;
+    }
+
+    CacheWriteBehind *wb = calloc(1, sizeof(CacheWriteBehind));
+    if (!wb) {
+        LOG_INFO("Error: Memory allocation failed for cache write-behind queue\n");
+        return -1;
+    }
+
+    wb->cache = cache;
+    wb->capacity = options && options->capacity > 0 ? options->capacity : DEFAULT_CAPACITY;
+    wb->interval_ms = options && options->interval_ms > 0 ?
+                      options->interval_ms : DEFAULT_INTERVAL_MS;
+    wb->batch_size = options && options->batch_size > 0 ?
+                     options->batch_size : DEFAULT_BATCH_SIZE;
+    if (wb->batch_size > wb->capacity) {
+        wb->batch_size = wb->capacity;
+    }
+    wb->overflow = options ? options->overflow : WRITE_BEHIND_OVERFLOW_SYNC;
+    wb->running = true;
+
+    wb->touched_capacity = 1;
+    while (wb->touched_capacity <= wb->batch_size * 2) {
+        wb->touched_capacity <<= 1;
+    }
+    wb->touched_gen = 1;
+
+    /* Batch deadlines use the monotonic clock */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wb->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&wb->room, NULL);
+    pthread_mutex_init(&wb->lock, NULL);
+    pthread_mutex_init(&wb->apply_lock, NULL);
+
+    wb->ring = malloc(wb->capacity * sizeof(WriteBehindOp));
+    wb->batch = malloc(wb->batch_size * sizeof(WriteBehindOp));
+    wb->touched = calloc(wb->touched_capacity, sizeof(TouchedKey));
+    if (!wb->ring || !wb->batch || !wb->touched) {
+        LOG_INFO("Error: Memory allocation failed for cache write-behind queue\n");
+        write_behind_destroy(wb);
+        return -1;
+    }
+
+    if (pthread_create(&wb->writer, NULL, write_behind_thread, wb) != 0) {
+        LOG_INFO("Error: Failed to start cache write-behind thread\n");
+        write_behind_destroy(wb);
+        return -1;
+    }
+    wb->writer_started = true;
+
+    cache->write_behind = wb;
+
+    LOG_INFO("Cache write-behind enabled: queue %zu, every %d ms or %zu writes\n",
+             wb->capacity, wb->interval_ms, wb->batch_size);
+    return 0;
+}
+
+/* Queue a translation store */
+int write_behind_enqueue(CacheWriteBehind *wb, const unsigned char *key,
+                         const char *from_lang, const char *to_lang,
+                         const char *source_text, const char *translated_text) {
+    if (!wb || !key || !from_lang || !to_lang || !source_text || !translated_text) {
+        return -1;
+    }
+
+    WriteBehindOp op;
+    if (op_init(&op, key, from_lang, to_lang, source_text, translated_text) != 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&wb->lock);
+
+    if (wb->count == wb->capacity && wb->running &&
+        wb->overflow == WRITE_BEHIND_OVERFLOW_BLOCK) {
+        wb->blocked++;
+        while (wb->count == wb->capacity && wb->running) {
+            pthread_cond_wait(&wb->room, &wb->lock);
+        }
+    }
+
+    if (wb->count < wb->capacity && wb->running) {
+        wb->ring[(wb->head + wb->count) % wb->capacity] = op;
+        wb->count++;
+        wb->enqueued++;
+        if (wb->count > wb->peak_depth) {
+            wb->peak_depth = wb->count;
+        }
+
+        /* First op starts the interval; a full batch goes right away */
+        if (wb->count == 1 || wb->count == wb->batch_size) {
+            pthread_cond_signal(&wb->wake);
+        }
+        pthread_mutex_unlock(&wb->lock);
+        return 0;
+    }
+
+    /* Queue full (or writer stopped) */
+    if (wb->overflow == WRITE_BEHIND_OVERFLOW_DROP && wb->running) {
+        wb->dropped++;
+        pthread_mutex_unlock(&wb->lock);
+        op_release(&op);
+        return -1;
+    }
+
+    wb->sync_applied++;
+    pthread_mutex_unlock(&wb->lock);
+
+    int result = apply_now(wb, &op);
+    op_release(&op);
+    return result;
+}
+
+/* Apply everything queued */
+void write_behind_flush(CacheWriteBehind *wb) {
+    if (!wb) {
+        return;
+    }
+
+    pthread_mutex_lock(&wb->apply_lock);
+    for (;;) {
+        pthread_mutex_lock(&wb->lock);
+        size_t n = detach_ops(wb);
+        pthread_mutex_unlock(&wb->lock);
+
+        if (n == 0) {
+            break;
+        }
+        apply_batch(wb, n);
+    }
+    pthread_mutex_unlock(&wb->apply_lock);
+}
+
+/* Stop writer, apply what is left and free */
+void write_behind_free(CacheWriteBehind *wb) {
+    if (!wb) {
+        return;
+    }
+
+    pthread_mutex_lock(&wb->lock);
+    wb->running = false;
+    pthread_cond_signal(&wb->wake);
+    pthread_cond_broadcast(&wb->room);
+    pthread_mutex_unlock(&wb->lock);
+
+    if (wb->writer_started) {
+        pthread_join(wb->writer, NULL);
+    }
+
+    write_behind_flush(wb);
+    write_behind_destroy(wb);
+}
+
+/* Overflow policy name for metrics */
+static const char *overflow_name(WriteBehindOverflow overflow) {
+    switch (overflow) {
+        case WRITE_BEHIND_OVERFLOW_BLOCK: return "block";
+        case WRITE_BEHIND_OVERFLOW_DROP: return "drop";
+        case WRITE_BEHIND_OVERFLOW_SYNC:
+        default: return "sync";
+    }
+}
+
+/* Queue metrics */
+cJSON *write_behind_stats(CacheWriteBehind *wb) {
+    if (!wb) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&wb->lock);
+    size_t depth = wb->count;
+    size_t peak_depth = wb->peak_depth;
+    unsigned long long enqueued = wb->enqueued;
+    unsigned long long applied = wb->applied;
+    unsigned long long failed = wb->failed;
+    unsigned long long dropped = wb->dropped;
+    unsigned long long sync_applied = wb->sync_applied;
+    unsigned long long blocked = wb->blocked;
+    unsigned long long batches = wb->batches;
+    unsigned long long commit_total = wb->commit_ms_total;
+    unsigned long long commit_max = wb->commit_ms_max;
+    unsigned long long delay_total = wb->delay_ms_total;
+    unsigned long long delay_max = wb->delay_ms_max;
+    pthread_mutex_unlock(&wb->lock);
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) {
+        return NULL;
+    }
+
+    unsigned long long batched = applied + failed;
+
+    cJSON_AddNumberToObject(stats, "depth", (double)depth);
+    cJSON_AddNumberToObject(stats, "capacity", (double)wb->capacity);
+    cJSON_AddNumberToObject(stats, "peak_depth", (double)peak_depth);
+    cJSON_AddStringToObject(stats, "overflow", overflow_name(wb->overflow));
+    cJSON_AddNumberToObject(stats, "enqueued", (double)enqueued);
+    cJSON_AddNumberToObject(stats, "applied", (double)applied);
+    cJSON_AddNumberToObject(stats, "failed", (double)failed);
+    cJSON_AddNumberToObject(stats, "dropped", (double)dropped);
+    cJSON_AddNumberToObject(stats, "sync_applied", (double)sync_applied);
+    cJSON_AddNumberToObject(stats, "blocked", (double)blocked);
+    cJSON_AddNumberToObject(stats, "batches", (double)batches);
+    cJSON_AddNumberToObject(stats, "avg_batch_size",
+                            batches ? (double)batched / (double)batches : 0.0);
+    cJSON_AddNumberToObject(stats, "avg_commit_ms",
+                            batches ? (double)commit_total / (double)batches : 0.0);
+    cJSON_AddNumberToObject(stats, "max_commit_ms", (double)commit_max);
+    cJSON_AddNumberToObject(stats, "avg_delay_ms",
+                            batched ? (double)delay_total / (double)batched : 0.0);
+    cJSON_AddNumberToObject(stats, "max_delay_ms", (double)delay_max);
+
+    return stats;
+}
@@ -281,6 +281,25 @@ Config *load_config(const char *config_path, const char *prompt_prefix_path, con
     config->frequency_penalty = 0.0;
     config->presence_penalty = 0.0;
     config->reasoning_effort = strdup("none");
+    config->upstream_concurrency = 1024;
+    config->upstream_threads = 1;
+
+    /* Batch endpoint defaults */
+    config->batch_max_items = 500;
+    config->batch_max_concurrency = 16;
+
+    /* Micro-batching defaults */
+    config->micro_batch_enabled = false;
+    config->micro_batch_window_ms = 5;
+    config->micro_batch_max_items = 16;
+    config->micro_batch_max_chars = 200;
+
+    /* HTTP server defaults */
+    config->server_mode = SERVER_MODE_EPOLL;
+    config->server_mode_str = strdup("epoll");
+    config->max_connections = 1024;
+    config->per_ip_connection_limit = 0;
+    config->connection_timeout = 120;
 
     /* Cache defaults */
     config->cache_type = CACHE_BACKEND_TEXT;  /* Default to text (JSONL) backend */
@@ -289,9 +308,31 @@ Config *load_config(const char *config_path, const char *prompt_prefix_path, con
     config->cache_sqlite_path = strdup("./trans_cache.db");
     config->cache_sqlite_journal_mode = strdup("WAL");
     config->cache_sqlite_sync = strdup("NORMAL");
+    config->cache_sqlite_readers = 8;
+    config->cache_sqlite_full_mutex = false;
+    config->cache_sqlite_page_size = 4096;
+    config->cache_sqlite_cache_size_kb = 8192;
+    config->cache_sqlite_mmap_size_mb = 256;
+    config->cache_sqlite_temp_store = strdup("MEMORY");
+    config->cache_sqlite_busy_timeout_ms = 5000;
+    config->cache_sqlite_checkpoint = strdup("PASSIVE");
+    config->cache_redis_url = strdup("redis://127.0.0.1:6379/0");
+    config->cache_redis_pool = 8;
+    config->cache_redis_timeout_ms = 2000;
+    config->cache_redis_prefix = strdup("transbasket:");
     config->cache_threshold = 5;
     config->cache_cleanup_enabled = true;
     config->cache_cleanup_days = 60;
+    config->cache_max_entries = 0;
+    config->cache_max_mb = 0;
+    config->cache_snapshot = false;
+    config->cache_load_threads = 0;
+    config->cache_write_behind = true;
+    config->cache_write_behind_queue = 10000;
+    config->cache_write_behind_interval_ms = 50;
+    config->cache_write_behind_batch = 1000;
+    config->cache_write_behind_overflow = WRITE_BEHIND_OVERFLOW_SYNC;
+    config->cache_l1_size_mb = 64;
 
     /* Parse config file */
     char line[MAX_LINE_LENGTH];
@@ -344,6 +385,87 @@ Config *load_config(const char *config_path, const char *prompt_prefix_path, con
             /* Clamp to valid range: -2.0 to 2.0 */
             if (config->presence_penalty < -2.0) config->presence_penalty = -2.0;
             if (config->presence_penalty > 2.0) config->presence_penalty = 2.0;
+        } else if (strcmp(key, "UPSTREAM_CONCURRENCY") == 0) {
+            config->upstream_concurrency = atoi(value);
+            if (config->upstream_concurrency < 1) {
+                LOG_INFO("Warning: Invalid UPSTREAM_CONCURRENCY '%s', using 1024\n", value);
+                config->upstream_concurrency = 1024;
+            }
+        } else if (strcmp(key, "UPSTREAM_THREADS") == 0) {
+            int upstream_threads = atoi(value);
+            if (upstream_threads < 1 || upstream_threads > 64) {
+                LOG_INFO("Warning: Invalid UPSTREAM_THREADS '%s', using 1\n", value);
+                upstream_threads = 1;
+            }
+            config->upstream_threads = upstream_threads;
+        } else if (strcmp(key, "BATCH_MAX_ITEMS") == 0) {
+            int batch_max_items = atoi(value);
+            if (batch_max_items < 1 || batch_max_items > 100000) {
+                LOG_INFO("Warning: Invalid BATCH_MAX_ITEMS '%s', using 500\n", value);
+                batch_max_items = 500;
+            }
+            config->batch_max_items = batch_max_items;
+        } else if (strcmp(key, "BATCH_MAX_CONCURRENCY") == 0) {
+            int batch_max_concurrency = atoi(value);
+            if (batch_max_concurrency < 1 || batch_max_concurrency > 1024) {
+                LOG_INFO("Warning: Invalid BATCH_MAX_CONCURRENCY '%s', using 16\n", value);
+                batch_max_concurrency = 16;
+            }
+            config->batch_max_concurrency = batch_max_concurrency;
+        } else if (strcmp(key, "MICRO_BATCH_ENABLED") == 0) {
+            config->micro_batch_enabled = (strcasecmp(value, "yes") == 0 || strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+        } else if (strcmp(key, "MICRO_BATCH_WINDOW_MS") == 0) {
+            int window_ms = atoi(value);
+            if (window_ms < 1 || window_ms > 1000) {
+                LOG_INFO("Warning: Invalid MICRO_BATCH_WINDOW_MS '%s', using 5\n", value);
+                window_ms = 5;
+            }
+            config->micro_batch_window_ms = window_ms;
+        } else if (strcmp(key, "MICRO_BATCH_MAX_ITEMS") == 0) {
+            int max_items = atoi(value);
+            if (max_items < 2 || max_items > 256) {
+                LOG_INFO("Warning: Invalid MICRO_BATCH_MAX_ITEMS '%s', using 16\n", value);
+                max_items = 16;
+            }
+            config->micro_batch_max_items = max_items;
+        } else if (strcmp(key, "MICRO_BATCH_MAX_CHARS") == 0) {
+            int max_chars = atoi(value);
+            if (max_chars < 1 || max_chars > 100000) {
+                LOG_INFO("Warning: Invalid MICRO_BATCH_MAX_CHARS '%s', using 200\n", value);
+                max_chars = 200;
+            }
+            config->micro_batch_max_chars = max_chars;
+        } else if (strcmp(key, "SERVER_MODE") == 0) {
+            free(config->server_mode_str);
+            /* Parse server mode */
+            if (strcasecmp(value, "epoll") == 0) {
+                config->server_mode = SERVER_MODE_EPOLL;
+                config->server_mode_str = strdup("epoll");
+            } else if (strcasecmp(value, "thread") == 0) {
+                config->server_mode = SERVER_MODE_THREAD;
+                config->server_mode_str = strdup("thread");
+            } else {
+                LOG_INFO("Warning: Invalid SERVER_MODE '%s', using 'epoll'\n", value);
+                config->server_mode = SERVER_MODE_EPOLL;
+                config->server_mode_str = strdup("epoll");
+            }
+        } else if (strcmp(key, "MAX_CONNECTIONS") == 0) {
+            int max_connections = atoi(value);
+            if (max_connections < 1) {
+                LOG_INFO("Warning: Invalid MAX_CONNECTIONS '%s', using 1024\n", value);
+                max_connections = 1024;
+            }
+            config->max_connections = (unsigned int)max_connections;
+        } else if (strcmp(key, "PER_IP_CONNECTION_LIMIT") == 0) {
+            int per_ip_limit = atoi(value);
+            config->per_ip_connection_limit = per_ip_limit > 0 ? (unsigned int)per_ip_limit : 0;
+        } else if (strcmp(key, "CONNECTION_TIMEOUT") == 0) {
+            int connection_timeout = atoi(value);
+            if (connection_timeout < 1) {
+                LOG_INFO("Warning: Invalid CONNECTION_TIMEOUT '%s', using 120\n", value);
+                connection_timeout = 120;
+            }
+            config->connection_timeout = (unsigned int)connection_timeout;
         } else if (strcmp(key, "TRANS_CACHE_TYPE") == 0) {
             free(config->cache_type_str);
             config->cache_type_str = strdup(value);
@@ -358,8 +480,6 @@ Config *load_config(const char *config_path, const char *prompt_prefix_path, con
                 config->cache_type = CACHE_BACKEND_TEXT;
             } else if (strcasecmp(value, "redis") == 0) {
                 config->cache_type = CACHE_BACKEND_REDIS;
-                LOG_INFO("Warning: Redis backend not yet implemented, using text backend\n");
-                config->cache_type = CACHE_BACKEND_TEXT;
             } else {
                 LOG_INFO("Warning: Invalid TRANS_CACHE_TYPE '%s', using 'text'\n", value);
                 config->cache_type = CACHE_BACKEND_TEXT;
@@ -393,6 +513,94 @@ Config *load_config(const char *config_path, const char *prompt_prefix_path, con
                 LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_SYNC '%s', using 'NORMAL'\n", value);
                 config->cache_sqlite_sync = strdup("NORMAL");
             }
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_READERS") == 0) {
+            int readers = atoi(value);
+            if (readers < 1 || readers > 256) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_READERS '%s', using 8\n", value);
+                readers = 8;
+            }
+            config->cache_sqlite_readers = readers;
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_MUTEX") == 0) {
+            if (strcasecmp(value, "FULLMUTEX") == 0) {
+                config->cache_sqlite_full_mutex = true;
+            } else if (strcasecmp(value, "NOMUTEX") == 0) {
+                config->cache_sqlite_full_mutex = false;
+            } else {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_MUTEX '%s', using 'NOMUTEX'\n", value);
+                config->cache_sqlite_full_mutex = false;
+            }
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_PAGE_SIZE") == 0) {
+            int page_size = atoi(value);
+            /* Power of two between 512 and 65536 */
+            if (page_size < 512 || page_size > 65536 || (page_size & (page_size - 1)) != 0) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_PAGE_SIZE '%s', using 4096\n", value);
+                page_size = 4096;
+            }
+            config->cache_sqlite_page_size = page_size;
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_CACHE_SIZE_KB") == 0) {
+            int cache_size_kb = atoi(value);
+            if (cache_size_kb < 1) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_CACHE_SIZE_KB '%s', using 8192\n", value);
+                cache_size_kb = 8192;
+            }
+            config->cache_sqlite_cache_size_kb = cache_size_kb;
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_MMAP_SIZE_MB") == 0) {
+            int mmap_size_mb = atoi(value);
+            if (mmap_size_mb < 0 || (mmap_size_mb == 0 && strcmp(value, "0") != 0)) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_MMAP_SIZE_MB '%s', using 256\n", value);
+                mmap_size_mb = 256;
+            }
+            config->cache_sqlite_mmap_size_mb = mmap_size_mb;
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_TEMP_STORE") == 0) {
+            free(config->cache_sqlite_temp_store);
+            if (strcasecmp(value, "DEFAULT") == 0 || strcasecmp(value, "FILE") == 0 ||
+                strcasecmp(value, "MEMORY") == 0) {
+                config->cache_sqlite_temp_store = strdup(value);
+            } else {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_TEMP_STORE '%s', using 'MEMORY'\n", value);
+                config->cache_sqlite_temp_store = strdup("MEMORY");
+            }
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_BUSY_TIMEOUT_MS") == 0) {
+            int busy_timeout_ms = atoi(value);
+            if (busy_timeout_ms < 0 || (busy_timeout_ms == 0 && strcmp(value, "0") != 0)) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_BUSY_TIMEOUT_MS '%s', using 5000\n", value);
+                busy_timeout_ms = 5000;
+            }
+            config->cache_sqlite_busy_timeout_ms = busy_timeout_ms;
+        } else if (strcmp(key, "TRANS_CACHE_SQLITE_CHECKPOINT") == 0) {
+            free(config->cache_sqlite_checkpoint);
+            if (strcasecmp(value, "PASSIVE") == 0 || strcasecmp(value, "FULL") == 0 ||
+                strcasecmp(value, "RESTART") == 0 || strcasecmp(value, "TRUNCATE") == 0) {
+                config->cache_sqlite_checkpoint = strdup(value);
+            } else {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_SQLITE_CHECKPOINT '%s', using 'PASSIVE'\n", value);
+                config->cache_sqlite_checkpoint = strdup("PASSIVE");
+            }
+        } else if (strcmp(key, "TRANS_CACHE_REDIS_URL") == 0) {
+            free(config->cache_redis_url);
+            config->cache_redis_url = strdup(value);
+        } else if (strcmp(key, "TRANS_CACHE_REDIS_POOL") == 0) {
+            int pool = atoi(value);
+            if (pool < 2 || pool > 256) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_REDIS_POOL '%s', using 8\n", value);
+                pool = 8;
+            }
+            config->cache_redis_pool = pool;
+        } else if (strcmp(key, "TRANS_CACHE_REDIS_TIMEOUT_MS") == 0) {
+            int timeout_ms = atoi(value);
+            if (timeout_ms < 1) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_REDIS_TIMEOUT_MS '%s', using 2000\n", value);
+                timeout_ms = 2000;
+            }
+            config->cache_redis_timeout_ms = timeout_ms;
+        } else if (strcmp(key, "TRANS_CACHE_REDIS_PREFIX") == 0) {
+            free(config->cache_redis_prefix);
+            if (strlen(value) <= 64) {
+                config->cache_redis_prefix = strdup(value);
+            } else {
+                LOG_INFO("Warning: TRANS_CACHE_REDIS_PREFIX longer than 64 bytes, using 'transbasket:'\n");
+                config->cache_redis_prefix = strdup("transbasket:");
+            }
         } else if (strcmp(key, "TRANS_CACHE_THRESHOLD") == 0) {
             config->cache_threshold = atoi(value);
             if (config->cache_threshold < 1) {
@@ -401,10 +609,76 @@ Config *load_config(const char *config_path, const char *prompt_prefix_path, con
         } else if (strcmp(key, "TRANS_CACHE_CLEANUP_ENABLED") == 0) {
             config->cache_cleanup_enabled = (strcasecmp(value, "yes") == 0 || strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
         } else if (strcmp(key, "TRANS_CACHE_CLEANUP_DAYS") == 0) {
-            config->cache_cleanup_days = atoi(value);
-            if (config->cache_cleanup_days <= 0) {
-                config->cache_cleanup_days = 60;  /* Default */
+            int cleanup_days = atoi(value);
+            if (cleanup_days <= 0 || cleanup_days > 10000) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_CLEANUP_DAYS '%s', using 60\n", value);
+                cleanup_days = 60;  /* Default */
+            }
+            config->cache_cleanup_days = cleanup_days;
+        } else if (strcmp(key, "TRANS_CACHE_MAX_ENTRIES") == 0) {
+            int max_entries = atoi(value);
+            if (max_entries < 0 || (max_entries == 0 && strcmp(value, "0") != 0)) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_MAX_ENTRIES '%s', using 0 (no limit)\n", value);
+                max_entries = 0;
+            }
+            config->cache_max_entries = max_entries;
+        } else if (strcmp(key, "TRANS_CACHE_MAX_MB") == 0) {
+            int max_mb = atoi(value);
+            if (max_mb < 0 || (max_mb == 0 && strcmp(value, "0") != 0)) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_MAX_MB '%s', using 0 (no limit)\n", value);
+                max_mb = 0;
+            }
+            config->cache_max_mb = max_mb;
+        } else if (strcmp(key, "TRANS_CACHE_SNAPSHOT") == 0) {
+            config->cache_snapshot = (strcasecmp(value, "yes") == 0 || strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+        } else if (strcmp(key, "TRANS_CACHE_LOAD_THREADS") == 0) {
+            int load_threads = atoi(value);
+            if (load_threads < 0 || (load_threads == 0 && strcmp(value, "0") != 0)) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_LOAD_THREADS '%s', using 0 (one per CPU)\n", value);
+                load_threads = 0;
+            }
+            config->cache_load_threads = load_threads;
+        } else if (strcmp(key, "TRANS_CACHE_WRITE_BEHIND") == 0) {
+            config->cache_write_behind = (strcasecmp(value, "yes") == 0 || strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+        } else if (strcmp(key, "TRANS_CACHE_WRITE_BEHIND_QUEUE") == 0) {
+            int queue = atoi(value);
+            if (queue < 1) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_WRITE_BEHIND_QUEUE '%s', using 10000\n", value);
+                queue = 10000;
+            }
+            config->cache_write_behind_queue = queue;
+        } else if (strcmp(key, "TRANS_CACHE_WRITE_BEHIND_INTERVAL_MS") == 0) {
+            int interval_ms = atoi(value);
+            if (interval_ms < 1) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_WRITE_BEHIND_INTERVAL_MS '%s', using 50\n", value);
+                interval_ms = 50;
+            }
+            config->cache_write_behind_interval_ms = interval_ms;
+        } else if (strcmp(key, "TRANS_CACHE_WRITE_BEHIND_BATCH") == 0) {
+            int batch = atoi(value);
+            if (batch < 1) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_WRITE_BEHIND_BATCH '%s', using 1000\n", value);
+                batch = 1000;
+            }
+            config->cache_write_behind_batch = batch;
+        } else if (strcmp(key, "TRANS_CACHE_WRITE_BEHIND_OVERFLOW") == 0) {
+            if (strcasecmp(value, "sync") == 0) {
+                config->cache_write_behind_overflow = WRITE_BEHIND_OVERFLOW_SYNC;
+            } else if (strcasecmp(value, "block") == 0) {
+                config->cache_write_behind_overflow = WRITE_BEHIND_OVERFLOW_BLOCK;
+            } else if (strcasecmp(value, "drop") == 0) {
+                config->cache_write_behind_overflow = WRITE_BEHIND_OVERFLOW_DROP;
+            } else {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_WRITE_BEHIND_OVERFLOW '%s', using 'sync'\n", value);
+                config->cache_write_behind_overflow = WRITE_BEHIND_OVERFLOW_SYNC;
+            }
+        } else if (strcmp(key, "TRANS_CACHE_L1_SIZE_MB") == 0) {
+            int size_mb = atoi(value);
+            if (size_mb < 0 || (size_mb == 0 && strcmp(value, "0") != 0)) {
+                LOG_INFO("Warning: Invalid TRANS_CACHE_L1_SIZE_MB '%s', using 64\n", value);
+                size_mb = 64;
             }
+            config->cache_l1_size_mb = size_mb;
         } else if (strcmp(key, "REASONING_EFFORT") == 0) {
             free(config->reasoning_effort);
             /* Validate reasoning effort value */
@@ -478,11 +752,16 @@ void free_config(Config *config) {
     free(config->listen);
     free(config->prompt_prefix);
     free(config->system_role);
+    free(config->server_mode_str);
     free(config->cache_type_str);
     free(config->cache_file);
     free(config->cache_sqlite_path);
     free(config->cache_sqlite_journal_mode);
     free(config->cache_sqlite_sync);
+    free(config->cache_sqlite_temp_store);
+    free(config->cache_sqlite_checkpoint);
+    free(config->cache_redis_url);
+    free(config->cache_redis_prefix);
     free(config->reasoning_effort);
     free(config);
 }
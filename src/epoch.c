@@ -0,0 +1,290 @@
+/**
+ * Epoch-based reclamation module for transbasket.
+ * Lets cache readers run without locks: memory they may still be reading
+ * is retired instead of freed and released two epochs later, once every
+ * thread in a read section has been seen in the current epoch. Each thread
+ * keeps its own retired list and reclaims it every RECLAIM_INTERVAL
+ * retires, so retiring takes no global lock.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <pthread.h>
+#include "epoch.h"
+#include "utils.h"
+
+#define BARRIER_POLL_NS (1000 * 1000)   /* 1ms between epoch_barrier attempts */
+#define RECLAIM_INTERVAL 64             /* Retires between a thread's reclaims */
+
+/* Retired object waiting for its grace period */
+typedef struct Retired {
+    void *ptr;
+    EpochFreeFn free_fn;
+    unsigned long long epoch;       /* Global epoch when retired */
+    struct Retired *next;
+} Retired;
+
+/* Per-thread reader record with the thread's retired list. Records are
+ * never freed; a record released by an exiting thread is reused by the
+ * next thread that registers, and keeps its retired list until then
+ * (epoch_reclaim frees it meanwhile). */
+typedef struct EpochThread {
+    atomic_ullong state;            /* (epoch << 1) | 1 inside a section, 0 outside */
+    atomic_bool in_use;
+
+    /* Retired list, oldest first, so epochs never decrease along it. Under
+     * retire_lock, which only epoch_reclaim / epoch_barrier contend for. */
+    pthread_mutex_t retire_lock;
+    Retired *retired;
+    Retired **retired_tail;         /* Link to append to */
+    unsigned int retires;           /* Retires since the last reclaim */
+    size_t retired_count;           /* Objects on the list */
+    unsigned long long reclaimed_count;
+
+    struct EpochThread *next;
+} EpochThread;
+
+static atomic_ullong global_epoch = 1;
+static _Atomic(EpochThread *) threads = NULL;
+
+static pthread_key_t thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static _Thread_local EpochThread *local_thread = NULL;
+static _Thread_local unsigned int local_depth = 0;
+
+/* Thread exit: hand the record to the next thread */
+static void release_thread(void *arg) {
+    EpochThread *thread = (EpochThread *)arg;
+    atomic_store(&thread->state, 0);
+    atomic_store(&thread->in_use, false);
+}
+
+static void create_thread_key(void) {
+    pthread_key_create(&thread_key, release_thread);
+}
+
+/* Claim a free record or add a new one for the calling thread */
+static EpochThread *register_thread(void) {
+    pthread_once(&thread_key_once, create_thread_key);
+
+    EpochThread *thread = NULL;
+    while (!thread) {
+        for (EpochThread *t = atomic_load(&threads); t; t = t->next) {
+            bool expected = false;
+            if (atomic_compare_exchange_strong(&t->in_use, &expected, true)) {
+                thread = t;
+                break;
+            }
+        }
+        if (thread) {
+            break;
+        }
+
+        thread = malloc(sizeof(EpochThread));
+        if (!thread) {
+            /* Wait for a record to be released rather than read unprotected */
+            LOG_INFO("Warning: Memory allocation failed for epoch record, retrying\n");
+            struct timespec delay = { 0, BARRIER_POLL_NS };
+            nanosleep(&delay, NULL);
+            continue;
+        }
+
+        atomic_init(&thread->state, 0);
+        atomic_init(&thread->in_use, true);
+        pthread_mutex_init(&thread->retire_lock, NULL);
+        thread->retired = NULL;
+        thread->retired_tail = &thread->retired;
+        thread->retires = 0;
+        thread->retired_count = 0;
+        thread->reclaimed_count = 0;
+        thread->next = atomic_load(&threads);
+        while (!atomic_compare_exchange_weak(&threads, &thread->next, thread)) {
+        }
+    }
+
+    pthread_setspecific(thread_key, thread);
+    local_thread = thread;
+    return thread;
+}
+
+/* Enter read section */
+void epoch_enter(void) {
+    if (local_depth++ > 0) {
+        return;
+    }
+
+    EpochThread *thread = local_thread ? local_thread : register_thread();
+    unsigned long long epoch = atomic_load(&global_epoch);
+    atomic_store_explicit(&thread->state, (epoch << 1) | 1, memory_order_relaxed);
+
+    /* Publish the section before reading any shared pointer */
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/* Leave read section */
+void epoch_exit(void) {
+    if (--local_depth > 0) {
+        return;
+    }
+
+    atomic_store_explicit(&local_thread->state, 0, memory_order_release);
+}
+
+/* Advance the global epoch if every active reader has seen the current one.
+ * Lock-free: of concurrent callers, one moves the epoch on. */
+static void try_advance(void) {
+    atomic_thread_fence(memory_order_seq_cst);
+
+    unsigned long long epoch = atomic_load(&global_epoch);
+    for (EpochThread *t = atomic_load(&threads); t; t = t->next) {
+        unsigned long long state = atomic_load(&t->state);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return;
+        }
+    }
+
+    atomic_compare_exchange_strong(&global_epoch, &epoch, epoch + 1);
+}
+
+/* Unlink the objects of a retired list that are two epochs old: the list
+ * is oldest first, so they form its head. Caller holds the record's
+ * retire_lock and frees the returned list after releasing it. */
+static Retired *collect_reclaimable(EpochThread *thread, unsigned long long epoch) {
+    Retired *last = NULL;
+
+    for (Retired *r = thread->retired; r && r->epoch + 2 <= epoch; r = r->next) {
+        last = r;
+        thread->retired_count--;
+        thread->reclaimed_count++;
+    }
+    if (!last) {
+        return NULL;
+    }
+
+    Retired *done = thread->retired;
+    thread->retired = last->next;
+    last->next = NULL;
+    if (!thread->retired) {
+        thread->retired_tail = &thread->retired;
+    }
+
+    return done;
+}
+
+/* Run destructors of reclaimed objects; returns how many were freed */
+static size_t free_reclaimed(Retired *done) {
+    size_t freed = 0;
+
+    while (done) {
+        Retired *next = done->next;
+        done->free_fn(done->ptr);
+        free(done);
+        done = next;
+        freed++;
+    }
+
+    return freed;
+}
+
+/* Sum the counters of all records */
+static void sum_counters(size_t *pending, unsigned long long *reclaimed) {
+    size_t pending_sum = 0;
+    unsigned long long reclaimed_sum = 0;
+
+    for (EpochThread *t = atomic_load(&threads); t; t = t->next) {
+        pthread_mutex_lock(&t->retire_lock);
+        pending_sum += t->retired_count;
+        reclaimed_sum += t->reclaimed_count;
+        pthread_mutex_unlock(&t->retire_lock);
+    }
+
+    if (pending) *pending = pending_sum;
+    if (reclaimed) *reclaimed = reclaimed_sum;
+}
+
+/* Reclaim what is safe now on every thread's list */
+static size_t reclaim_all(void) {
+    try_advance();
+
+    unsigned long long epoch = atomic_load(&global_epoch);
+    size_t freed = 0;
+
+    for (EpochThread *t = atomic_load(&threads); t; t = t->next) {
+        pthread_mutex_lock(&t->retire_lock);
+        Retired *done = collect_reclaimable(t, epoch);
+        pthread_mutex_unlock(&t->retire_lock);
+
+        freed += free_reclaimed(done);
+    }
+
+    return freed;
+}
+
+/* Retire memory */
+void epoch_retire(void *ptr, EpochFreeFn free_fn) {
+    if (!ptr || !free_fn) {
+        return;
+    }
+
+    Retired *r = malloc(sizeof(Retired));
+    if (!r) {
+        /* Leaking is the only safe option without a grace period */
+        LOG_INFO("Warning: Memory allocation failed, leaking retired memory\n");
+        return;
+    }
+    r->ptr = ptr;
+    r->free_fn = free_fn;
+
+    EpochThread *thread = local_thread ? local_thread : register_thread();
+    Retired *done = NULL;
+
+    pthread_mutex_lock(&thread->retire_lock);
+    r->epoch = atomic_load(&global_epoch);
+    r->next = NULL;
+    *thread->retired_tail = r;
+    thread->retired_tail = &r->next;
+    thread->retired_count++;
+
+    /* Reclaim the own list now and then, not on every retire */
+    if (++thread->retires >= RECLAIM_INTERVAL) {
+        thread->retires = 0;
+        try_advance();
+        done = collect_reclaimable(thread, atomic_load(&global_epoch));
+    }
+    pthread_mutex_unlock(&thread->retire_lock);
+
+    free_reclaimed(done);
+}
+
+/* Reclaim what is safe now */
+void epoch_reclaim(void) {
+    reclaim_all();
+}
+
+/* Wait until nothing is retired */
+void epoch_barrier(void) {
+    for (;;) {
+        size_t freed = reclaim_all();
+        size_t pending = 0;
+        sum_counters(&pending, NULL);
+        if (pending == 0) {
+            return;
+        }
+
+        /* Readers still inside a section hold the epoch back */
+        if (freed == 0) {
+            struct timespec delay = { 0, BARRIER_POLL_NS };
+            nanosleep(&delay, NULL);
+        }
+    }
+}
+
+/* Reclamation counters */
+void epoch_stats(unsigned long long *epoch, size_t *pending,
+                 unsigned long long *reclaimed) {
+    if (epoch) *epoch = atomic_load(&global_epoch);
+    sum_counters(pending, reclaimed);
+}
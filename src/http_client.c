@@ -12,41 +12,43 @@
 #include <libgen.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <pthread.h>
 #include <curl/curl.h>
 #include <cjson/cJSON.h>
 #include "http_client.h"
+#include "sse_parser.h"
+#include "request_template.h"
 #include "utils.h"
 
 #define DEFAULT_TIMEOUT 60
 #define DEFAULT_MAX_RETRIES 3
-#define MAX_TRANSLATION_BUFFER 16384  /* 16KB for unescaped text */
-#define MAX_CLEANED_TEXT_BUFFER 8192  /* 8KB for cleaned text */
-#define MAX_STREAM_BUFFER 65536       /* 64KB for streaming response accumulation */
+#define DEFAULT_UPSTREAM_CONCURRENCY 1024
+#define DEFAULT_UPSTREAM_THREADS 1
 
-/* Structure for curl response data */
+/* In-flight translation: request body is kept for retries */
 typedef struct {
-    char *data;
-    size_t size;
-} CurlResponse;
-
-/* Curl write callback */
-static size_t transbasket_curl_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    CurlResponse *response = (CurlResponse *)userp;
-
-    char *ptr = realloc(response->data, response->size + realsize + 1);
-    if (!ptr) {
-        LOG_DEBUG( "Error: Memory allocation failed in curl callback");
-        return 0;
-    }
-
-    response->data = ptr;
-    memcpy(&(response->data[response->size]), contents, realsize);
-    response->size += realsize;
-    response->data[response->size] = '\0';
-
-    return realsize;
-}
+    OpenAITranslator *translator;
+    char *request_uuid;
+    char *json_request;
+    int attempt;
+    int item_count;                 /* > 0 for numbered multi-item requests */
+    SseParser *stream;              /* Incremental SSE decoder (streamed requests only) */
+    TranslationDeltaCallback delta_callback;
+    TextCleaner cleaner;            /* Cleans deltas before they are relayed */
+    size_t relayed;                 /* Bytes relayed during the current attempt */
+    TranslationCallback callback;
+    MultiTranslationCallback multi_callback;
+    void *user_data;
+} TranslationJob;
+
+/* Synchronous wait state for openai_translate() */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool done;
+    char *result;
+    TranslationError error;
+} SyncTranslation;
 
 /* Save debug curl command to file */
 static void save_debug_curl(const char *timestamp, const char *uuid,
@@ -98,280 +100,450 @@ static void save_debug_curl(const char *timestamp, const char *uuid,
     LOG_INFO( "[%s] Debug curl saved to: %s\n", uuid, filepath);
 }
 
-/* Replace all occurrences of a substring */
-static char *str_replace(const char *orig, const char *rep, const char *with) {
-    char *result;
-    char *ins;
-    char *tmp;
-    int len_rep;
-    int len_with;
-    int len_front;
-    int count;
-
-    if (!orig || !rep)
-        return NULL;
-    len_rep = strlen(rep);
-    if (len_rep == 0)
+/* Handle non-streaming response - extract from message.content */
+static char *handle_non_streaming_response(const char *response_data, const char *request_uuid) {
+    if (!response_data || !request_uuid) {
         return NULL;
-    if (!with)
-        with = "";
-    len_with = strlen(with);
+    }
 
-    ins = (char *)orig;
-    for (count = 0; (tmp = strstr(ins, rep)); ++count) {
-        ins = tmp + len_rep;
+    cJSON *response_json = cJSON_Parse(response_data);
+    if (!response_json) {
+        LOG_DEBUG("[%s] Failed to parse response JSON\n", request_uuid);
+        return NULL;
     }
 
-    tmp = result = malloc(strlen(orig) + (len_with - len_rep) * count + 1);
+    char *result = NULL;
+    cJSON *choices = cJSON_GetObjectItem(response_json, "choices");
 
-    if (!result)
-        return NULL;
+    if (cJSON_IsArray(choices) && cJSON_GetArraySize(choices) > 0) {
+        cJSON *first_choice = cJSON_GetArrayItem(choices, 0);
+        cJSON *message_obj = cJSON_GetObjectItem(first_choice, "message");
+
+        /* Check if message object exists */
+        if (!message_obj) {
+            LOG_DEBUG("[%s] No message object in response\n", request_uuid);
+            result = strdup("nothing contents");
+            cJSON_Delete(response_json);
+            return result;
+        }
+
+        cJSON *content = cJSON_GetObjectItem(message_obj, "content");
+
+        /* Check if content exists and is a string */
+        if (!cJSON_IsString(content) || !content->valuestring) {
+            LOG_DEBUG("[%s] No content in message object\n", request_uuid);
+            result = strdup("nothing contents");
+            cJSON_Delete(response_json);
+            return result;
+        }
 
-    while (count--) {
-        ins = strstr(orig, rep);
-        len_front = ins - orig;
-        tmp = strncpy(tmp, orig, len_front) + len_front;
-        tmp = strcpy(tmp, with) + len_with;
-        orig += len_front + len_rep;
+        result = strdup(content->valuestring);
+    } else {
+        LOG_DEBUG("[%s] No choices in response\n", request_uuid);
+        result = strdup("nothing contents");
     }
-    strcpy(tmp, orig);
+
+    cJSON_Delete(response_json);
     return result;
 }
 
-/* Parse SSE (Server-Sent Events) chunk and extract content from delta */
-static char *parse_sse_chunk(const char *chunk, const char *request_uuid) {
-    if (!chunk) {
-        return NULL;
+/* Build request headers (owned by the upstream engine once submitted) */
+static struct curl_slist *build_request_headers(OpenAITranslator *translator) {
+    struct curl_slist *headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json; charset=utf-8");
+
+    char auth_header[512];
+    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s",
+            translator->config->openai_api_key);
+    headers = curl_slist_append(headers, auth_header);
+
+    return headers;
+}
+
+/* Set translation error fields */
+static void set_translation_error(TranslationError *error, const char *message,
+                                  bool retryable, int status_code) {
+    if (!error) {
+        return;
     }
 
-    /* SSE format: "data: {json}\n\n" */
-    const char *data_prefix = "data: ";
-    const char *line_start = strstr(chunk, data_prefix);
+    error->message = strdup(message);
+    error->retryable = retryable;
+    error->status_code = status_code;
+}
 
-    if (!line_start) {
+/* Unescape and clean raw model output */
+static char *process_raw_translation(const char *raw_translation, const char *request_uuid,
+                                     TranslationError *error) {
+    /* Unescape, strip emoji/shortcodes and normalize whitespace in one pass */
+    char *result = clean_text(raw_translation, strlen(raw_translation), NULL);
+    if (!result) {
+        LOG_DEBUG("[%s] Memory allocation failed for cleaned translation\n", request_uuid);
+        set_translation_error(error, "Memory allocation failed", false, 0);
         return NULL;
     }
 
-    line_start += strlen(data_prefix);
+    return result;
+}
 
-    /* Check for [DONE] marker */
-    if (strncmp(line_start, "[DONE]", 6) == 0) {
-        return NULL;
+/* Free translation job */
+static void free_translation_job(TranslationJob *job) {
+    if (!job) {
+        return;
     }
 
-    /* Find end of JSON (newline or end of string) */
-    const char *line_end = strchr(line_start, '\n');
-    size_t json_len;
+    sse_parser_free(job->stream);
+    free(job->request_uuid);
+    free(job->json_request);
+    free(job);
+}
 
-    if (line_end) {
-        json_len = line_end - line_start;
+/* Deliver final result to the caller and release the job */
+static void finish_translation_job(TranslationJob *job, char *result, TranslationError *error) {
+    if (job->item_count > 0) {
+        /* Multi-item jobs only finish through here on failure */
+        free(result);
+        job->multi_callback(NULL, job->item_count, error, job->user_data);
     } else {
-        json_len = strlen(line_start);
+        job->callback(result, result ? NULL : error, job->user_data);
     }
+    free_translation_job(job);
+}
 
-    if (json_len == 0) {
-        return NULL;
+/* Split numbered <target id="N">...</target> blocks out of model output.
+ * out[i] is NULL for items that are missing, empty or duplicated.
+ * Returns number of items extracted. */
+static int split_numbered_output(const char *raw, int count, char **out) {
+    int extracted = 0;
+    bool *seen = calloc(count, sizeof(bool));
+    if (!seen) {
+        return 0;
     }
 
-    /* Extract JSON string */
-    char *json_str = malloc(json_len + 1);
-    if (!json_str) {
-        LOG_DEBUG("[%s] Failed to allocate memory for SSE JSON\n", request_uuid);
-        return NULL;
+    const char *p = raw;
+    while ((p = strstr(p, "<target")) != NULL) {
+        const char *id_attr = strstr(p, "id=");
+        const char *tag_end = strchr(p, '>');
+        if (!id_attr || !tag_end || id_attr > tag_end) {
+            p += strlen("<target");
+            continue;
+        }
+
+        id_attr += strlen("id=");
+        if (*id_attr == '"' || *id_attr == '\'') {
+            id_attr++;
+        }
+
+        int id = atoi(id_attr);
+        const char *content = tag_end + 1;
+        const char *close = strstr(content, "</target>");
+        if (!close) {
+            break;
+        }
+
+        if (id >= 1 && id <= count) {
+            if (seen[id - 1]) {
+                /* Duplicate number - ambiguous, drop the item */
+                if (out[id - 1]) {
+                    free(out[id - 1]);
+                    out[id - 1] = NULL;
+                    extracted--;
+                }
+            } else {
+                seen[id - 1] = true;
+
+                /* Trim surrounding whitespace */
+                while (content < close && (*content == ' ' || *content == '\n' ||
+                                           *content == '\r' || *content == '\t')) {
+                    content++;
+                }
+                const char *end = close;
+                while (end > content && (end[-1] == ' ' || end[-1] == '\n' ||
+                                         end[-1] == '\r' || end[-1] == '\t')) {
+                    end--;
+                }
+
+                if (end > content) {
+                    out[id - 1] = strndup(content, end - content);
+                    if (out[id - 1]) {
+                        extracted++;
+                    }
+                }
+            }
+        }
+
+        p = close + strlen("</target>");
     }
 
-    strncpy(json_str, line_start, json_len);
-    json_str[json_len] = '\0';
+    free(seen);
+    return extracted;
+}
 
-    /* Parse JSON */
-    cJSON *json = cJSON_Parse(json_str);
-    free(json_str);
+/* Finish multi-item job: split output per item and clean each one */
+static void finish_multi_translation_job(TranslationJob *job, const char *raw_translation) {
+    int count = job->item_count;
+    char **texts = calloc(count, sizeof(char *));
 
-    if (!json) {
-        LOG_DEBUG("[%s] Failed to parse SSE JSON chunk\n", request_uuid);
-        return NULL;
+    if (!texts) {
+        TranslationError error = {0};
+        set_translation_error(&error, "Memory allocation failed", true, 0);
+        finish_translation_job(job, NULL, &error);
+        return;
     }
 
-    /* Extract content from choices[0].delta.content */
-    char *content = NULL;
-    cJSON *choices = cJSON_GetObjectItem(json, "choices");
+    int extracted = split_numbered_output(raw_translation, count, texts);
 
-    if (cJSON_IsArray(choices) && cJSON_GetArraySize(choices) > 0) {
-        cJSON *first_choice = cJSON_GetArrayItem(choices, 0);
-        cJSON *delta = cJSON_GetObjectItem(first_choice, "delta");
+    for (int i = 0; i < count; i++) {
+        if (!texts[i]) {
+            continue;
+        }
 
-        if (delta) {
-            cJSON *content_obj = cJSON_GetObjectItem(delta, "content");
+        TranslationError item_error = {0};
+        char *cleaned = process_raw_translation(texts[i], job->request_uuid, &item_error);
+        free(item_error.message);
+        free(texts[i]);
+        texts[i] = cleaned;
 
-            if (cJSON_IsString(content_obj) && content_obj->valuestring) {
-                content = strdup(content_obj->valuestring);
-            }
+        if (!cleaned) {
+            extracted--;
         }
     }
 
-    cJSON_Delete(json);
-    return content;
+    LOG_INFO("[%s] Multi-item translation completed (attempt %d/%d, %d/%d items extracted)\n",
+           job->request_uuid, job->attempt, job->translator->max_retries, extracted, count);
+
+    job->multi_callback(texts, count, NULL, job->user_data);
+    free_translation_job(job);
 }
 
-/* Handle streaming response - accumulate delta content */
-static char *handle_streaming_response(const char *response_data, const char *request_uuid) {
-    if (!response_data || !request_uuid) {
-        return NULL;
+static void on_upstream_complete(const UpstreamResult *result, void *user_data);
+
+/* Relay cleaned text to the delta callback */
+static void relay_delta(TranslationJob *job, const char *text, size_t len) {
+    if (len == 0) {
+        return;
     }
 
-    char *accumulated_text = calloc(MAX_STREAM_BUFFER, 1);
-    if (!accumulated_text) {
-        LOG_DEBUG("[%s] Failed to allocate buffer for streaming response\n", request_uuid);
-        return NULL;
+    job->relayed += len;
+    job->delta_callback(text, len, job->user_data);
+}
+
+/* Decoded content delta - clean it and pass it on while the stream runs */
+static int on_stream_delta(const char *delta, size_t len, size_t index, void *user_data) {
+    (void)index;
+    TranslationJob *job = (TranslationJob *)user_data;
+
+    char small[256];
+    char *cleaned = small;
+    if (len + TEXT_CLEANER_SLACK > sizeof(small)) {
+        cleaned = malloc(len + TEXT_CLEANER_SLACK);
+        if (!cleaned) {
+            return -1;
+        }
     }
 
-    size_t accumulated_len = 0;
-    const char *chunk_start = response_data;
+    size_t cleaned_len = text_cleaner_feed(&job->cleaner, delta, len, cleaned);
+    relay_delta(job, cleaned, cleaned_len);
 
-    /* Process each SSE chunk */
-    while (*chunk_start) {
-        /* Find the next "data: " prefix */
-        const char *next_chunk = strstr(chunk_start, "data: ");
+    if (cleaned != small) {
+        free(cleaned);
+    }
 
-        if (!next_chunk) {
-            break;
-        }
+    return 0;
+}
 
-        /* Find the end of this chunk (double newline or end of string) */
-        const char *chunk_end = strstr(next_chunk, "\n\n");
-        size_t chunk_len;
+/* Streamed response bytes - decoded as they arrive */
+static int on_upstream_data(const char *data, size_t size, void *user_data) {
+    TranslationJob *job = (TranslationJob *)user_data;
+    return sse_parser_feed(job->stream, data, size);
+}
 
-        if (chunk_end) {
-            chunk_len = chunk_end - next_chunk + 2;
-        } else {
-            chunk_len = strlen(next_chunk);
-        }
+/* Submit current attempt to the upstream engine */
+static int submit_translation_attempt(TranslationJob *job, long delay_ms) {
+    OpenAITranslator *translator = job->translator;
 
-        /* Create null-terminated chunk string */
-        char *chunk_str = malloc(chunk_len + 1);
-        if (!chunk_str) {
-            LOG_DEBUG("[%s] Failed to allocate memory for chunk\n", request_uuid);
-            continue;
+    char *body = strdup(job->json_request);
+    if (!body) {
+        return -1;
+    }
+
+    if (job->stream) {
+        /* Previous attempt may have left a partial stream behind */
+        sse_parser_reset(job->stream);
+
+        if (job->delta_callback) {
+            if (job->relayed > 0) {
+                job->delta_callback(NULL, 0, job->user_data);
+                job->relayed = 0;
+            }
+            text_cleaner_init(&job->cleaner);
         }
 
-        strncpy(chunk_str, next_chunk, chunk_len);
-        chunk_str[chunk_len] = '\0';
+        return upstream_engine_submit_stream(translator->engine, translator->api_url,
+                                             build_request_headers(translator), body,
+                                             delay_ms, on_upstream_data,
+                                             on_upstream_complete, job);
+    }
+
+    return upstream_engine_submit(translator->engine, translator->api_url,
+                                  build_request_headers(translator), body, delay_ms,
+                                  on_upstream_complete, job);
+}
 
-        /* Parse this chunk */
-        char *content = parse_sse_chunk(chunk_str, request_uuid);
-        free(chunk_str);
+/* Take decoded stream content and record streaming metrics */
+static char *finish_stream(TranslationJob *job, const UpstreamResult *result) {
+    OpenAITranslator *translator = job->translator;
+    SseParser *parser = job->stream;
 
-        if (content) {
-            size_t content_len = strlen(content);
+    if (!result->streamed) {
+        /* Empty body: nothing reached the parser */
+        return NULL;
+    }
 
-            /* Check buffer overflow */
-            if (accumulated_len + content_len >= MAX_STREAM_BUFFER - 1) {
-                LOG_DEBUG("[%s] Stream buffer overflow, truncating\n", request_uuid);
-                free(content);
-                break;
-            }
+    sse_parser_finish(parser);
 
-            /* Append content */
-            memcpy(accumulated_text + accumulated_len, content, content_len);
-            accumulated_len += content_len;
-            accumulated_text[accumulated_len] = '\0';
+    if (job->delta_callback) {
+        char tail[TEXT_CLEANER_SLACK];
+        size_t tail_len = text_cleaner_finish(&job->cleaner, tail);
+        relay_delta(job, tail, tail_len);
+    }
 
-            free(content);
-        }
+    size_t deltas = sse_parser_delta_count(parser);
+    long long first_delta_at = sse_parser_first_delta_at(parser);
+    long long ttft_ms = (first_delta_at && result->started_ms) ?
+                        first_delta_at - result->started_ms : -1;
+    bool done = sse_parser_done(parser);
 
-        /* Move to next chunk */
-        if (chunk_end) {
-            chunk_start = chunk_end + 2;
-        } else {
-            break;
-        }
+    if (!done) {
+        LOG_DEBUG("[%s] Stream ended without [DONE] marker\n", job->request_uuid);
     }
+    LOG_DEBUG("[%s] Stream finished: %zu deltas, first token after %lld ms\n",
+              job->request_uuid, deltas, ttft_ms);
 
-    if (accumulated_len == 0) {
-        free(accumulated_text);
-        return NULL;
+    pthread_mutex_lock(&translator->stats_lock);
+    translator->streamed_responses++;
+    translator->stream_deltas += deltas;
+    if (!done) {
+        translator->streams_incomplete++;
     }
+    if (ttft_ms >= 0) {
+        translator->ttft_samples++;
+        translator->ttft_ms_total += (unsigned long long)ttft_ms;
+        if ((unsigned long long)ttft_ms > translator->ttft_ms_max) {
+            translator->ttft_ms_max = (unsigned long long)ttft_ms;
+        }
+    }
+    pthread_mutex_unlock(&translator->stats_lock);
 
-    return accumulated_text;
+    return sse_parser_take_output(parser);
 }
 
-/* Handle non-streaming response - extract from message.content */
-static char *handle_non_streaming_response(const char *response_data, const char *request_uuid) {
-    if (!response_data || !request_uuid) {
-        return NULL;
+/* Schedule next attempt with exponential backoff; false if retries are exhausted */
+static bool retry_translation_job(TranslationJob *job) {
+    OpenAITranslator *translator = job->translator;
+
+    if (job->attempt >= translator->max_retries) {
+        return false;
     }
 
-    cJSON *response_json = cJSON_Parse(response_data);
-    if (!response_json) {
-        LOG_DEBUG("[%s] Failed to parse response JSON\n", request_uuid);
-        return NULL;
+    int backoff = (int)pow(2, job->attempt);
+    LOG_DEBUG( "[%s] Retrying in %d seconds...\n", job->request_uuid, backoff);
+
+    job->attempt++;
+    if (submit_translation_attempt(job, (long)backoff * 1000) != 0) {
+        TranslationError error = {0};
+        set_translation_error(&error, "Failed to schedule retry", true, 0);
+        finish_translation_job(job, NULL, &error);
     }
 
-    char *result = NULL;
-    cJSON *choices = cJSON_GetObjectItem(response_json, "choices");
+    return true;
+}
 
-    if (cJSON_IsArray(choices) && cJSON_GetArraySize(choices) > 0) {
-        cJSON *first_choice = cJSON_GetArrayItem(choices, 0);
-        cJSON *message_obj = cJSON_GetObjectItem(first_choice, "message");
+/* Upstream completion - runs on an upstream event loop thread */
+static void on_upstream_complete(const UpstreamResult *result, void *user_data) {
+    TranslationJob *job = (TranslationJob *)user_data;
+    OpenAITranslator *translator = job->translator;
+    const char *request_uuid = job->request_uuid;
+    TranslationError error = {0};
 
-        /* Check if message object exists */
-        if (!message_obj) {
-            LOG_DEBUG("[%s] No message object in response\n", request_uuid);
-            result = strdup("nothing contents");
-            cJSON_Delete(response_json);
-            return result;
-        }
+    if (result->cancelled) {
+        set_translation_error(&error, "Server shutting down", true, 0);
+        finish_translation_job(job, NULL, &error);
+        return;
+    }
 
-        cJSON *content = cJSON_GetObjectItem(message_obj, "content");
+    if (result->curl_code != CURLE_OK) {
+        LOG_DEBUG( "[%s] Curl error (attempt %d/%d): %s\n",
+               request_uuid, job->attempt, translator->max_retries,
+               curl_easy_strerror(result->curl_code));
 
-        /* Check if content exists and is a string */
-        if (!cJSON_IsString(content) || !content->valuestring) {
-            LOG_DEBUG("[%s] No content in message object\n", request_uuid);
-            result = strdup("nothing contents");
-            cJSON_Delete(response_json);
-            return result;
+        if (retry_translation_job(job)) {
+            return;
         }
 
-        result = strdup(content->valuestring);
-    } else {
-        LOG_DEBUG("[%s] No choices in response\n", request_uuid);
-        result = strdup("nothing contents");
+        set_translation_error(&error, curl_easy_strerror(result->curl_code), true, 0);
+        finish_translation_job(job, NULL, &error);
+        return;
     }
 
-    cJSON_Delete(response_json);
-    return result;
-}
+    long http_code = result->http_code;
 
-/* Build translation instruction message from PROMPT_PREFIX */
-static char *build_instruction_message(OpenAITranslator *translator, const char *to_lang) {
-    if (!translator || !to_lang) {
-        return NULL;
+    /* Check HTTP status */
+    if (http_code >= 500) {
+        LOG_DEBUG( "[%s] Server error %ld (attempt %d/%d)\n",
+               request_uuid, http_code, job->attempt, translator->max_retries);
+
+        if (retry_translation_job(job)) {
+            return;
+        }
+
+        set_translation_error(&error, "Server error", true, http_code);
+        finish_translation_job(job, NULL, &error);
+        return;
     }
 
-    const char *to_name = get_language_name(to_lang);
-    if (!to_name) to_name = to_lang;
+    if (http_code >= 400) {
+        LOG_DEBUG( "[%s] Client error %ld\n", request_uuid, http_code);
+        set_translation_error(&error, "Client error", false, http_code);
+        finish_translation_job(job, NULL, &error);
+        return;
+    }
 
-    /* Use PROMPT_PREFIX as the instruction message */
-    char *instruction = strdup(translator->config->prompt_prefix);
-    if (!instruction) {
-        return NULL;
+    /* Parse response based on streaming mode */
+    char *raw_translation = NULL;
+
+    if (job->stream) {
+        /* Content was decoded incrementally while the body arrived */
+        raw_translation = finish_stream(job, result);
+    } else {
+        /* Handle non-streaming response */
+        raw_translation = handle_non_streaming_response(result->body, request_uuid);
+    }
+
+    if (!raw_translation) {
+        LOG_DEBUG("[%s] Failed to extract translation from response\n", request_uuid);
+        set_translation_error(&error, "No translation in response", false, http_code);
+        finish_translation_job(job, NULL, &error);
+        return;
     }
 
-    /* Replace [TARGET LANGUAGE] with actual target language name */
-    char *temp = str_replace(instruction, "[TARGET LANGUAGE]", to_name);
-    if (temp) {
-        free(instruction);
-        instruction = temp;
+    if (job->item_count > 0) {
+        finish_multi_translation_job(job, raw_translation);
+        free(raw_translation);
+        return;
     }
 
-    /* Also try replacing {{LANGUAGE_TO}} for backward compatibility */
-    temp = str_replace(instruction, "{{LANGUAGE_TO}}", to_name);
-    if (temp) {
-        free(instruction);
-        instruction = temp;
+    /* Process the raw translation: unescape and clean */
+    char *translated = process_raw_translation(raw_translation, request_uuid, &error);
+    free(raw_translation);
+
+    if (translated) {
+        LOG_INFO("[%s] Translation completed (attempt %d/%d, mode: %s)\n",
+               request_uuid, job->attempt, translator->max_retries,
+               job->stream ? "streaming" : "non-streaming");
     }
 
-    return instruction;
+    finish_translation_job(job, translated, &error);
 }
 
 /* Initialize OpenAI translator */
@@ -390,310 +562,301 @@ OpenAITranslator *openai_translator_init(Config *config, int max_retries, int ti
     translator->config = config;
     translator->max_retries = max_retries > 0 ? max_retries : DEFAULT_MAX_RETRIES;
     translator->timeout = timeout > 0 ? timeout : DEFAULT_TIMEOUT;
+    pthread_mutex_init(&translator->stats_lock, NULL);
+
+    /* Build API endpoint URL */
+    snprintf(translator->api_url, sizeof(translator->api_url), "%s/chat/completions",
+             config->openai_base_url);
+
+    /* Serialize the fixed part of request bodies once */
+    translator->templates = request_templates_create(config);
+    if (!translator->templates) {
+        LOG_INFO("Error: Failed to build request templates");
+        openai_translator_free(translator);
+        return NULL;
+    }
 
     /* Initialize curl */
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
-    LOG_INFO( "OpenAI translator initialized: base_url=%s, model=%s\n",
-            config->openai_base_url, config->openai_model);
+    /* Start upstream engine: keep-alive connections are reused across requests */
+    int event_threads = config->upstream_threads > 0 ?
+                        config->upstream_threads : DEFAULT_UPSTREAM_THREADS;
+    int max_inflight = config->upstream_concurrency > 0 ?
+                       config->upstream_concurrency : DEFAULT_UPSTREAM_CONCURRENCY;
+
+    translator->engine = upstream_engine_create(event_threads, max_inflight, translator->timeout);
+    if (!translator->engine) {
+        LOG_INFO("Error: Failed to start upstream engine");
+        openai_translator_free(translator);
+        return NULL;
+    }
+
+    LOG_INFO( "OpenAI translator initialized: base_url=%s, model=%s, upstream concurrency=%d\n",
+            config->openai_base_url, config->openai_model, max_inflight);
 
     return translator;
 }
 
+/* Stop upstream engine: fail queued requests and wait for running ones */
+void openai_translator_shutdown(OpenAITranslator *translator) {
+    if (!translator) {
+        return;
+    }
+
+    upstream_engine_shutdown(translator->engine);
+}
+
 /* Free OpenAI translator */
 void openai_translator_free(OpenAITranslator *translator) {
     if (!translator) {
         return;
     }
 
+    upstream_engine_free(translator->engine);
+    request_templates_free(translator->templates);
+    pthread_mutex_destroy(&translator->stats_lock);
     free(translator);
 
     curl_global_cleanup();
 }
 
-/* Translate text using OpenAI API */
-char *openai_translate(OpenAITranslator *translator, const char *from_lang,
-                      const char *to_lang, const char *text,
-                      const char *request_uuid, const char *timestamp,
-                      TranslationError *error) {
-    if (!translator || !from_lang || !to_lang || !text || !request_uuid || !timestamp) {
-        if (error) {
-            error->message = strdup("Invalid parameters");
-            error->retryable = false;
-            error->status_code = 0;
-        }
+/* Upstream metrics as JSON object */
+cJSON *openai_translator_stats(OpenAITranslator *translator) {
+    if (!translator) {
         return NULL;
     }
 
-    char *instruction = build_instruction_message(translator, to_lang);
-    if (!instruction) {
-        if (error) {
-            error->message = strdup("Failed to build instruction message");
-            error->retryable = false;
-            error->status_code = 0;
-        }
+    cJSON *stats = upstream_engine_stats(translator->engine);
+    if (!stats) {
         return NULL;
     }
 
-    LOG_INFO( "[%s] Starting translation: %s -> %s\n", request_uuid, from_lang, to_lang);
+    cJSON *templates = request_templates_stats(translator->templates);
+    if (templates) {
+        cJSON_AddItemToObject(stats, "templates", templates);
+    }
 
-    char *result = NULL;
-    int attempt;
+    pthread_mutex_lock(&translator->stats_lock);
+    unsigned long long responses = translator->streamed_responses;
+    unsigned long long deltas = translator->stream_deltas;
+    unsigned long long incomplete = translator->streams_incomplete;
+    unsigned long long ttft_samples = translator->ttft_samples;
+    unsigned long long ttft_total = translator->ttft_ms_total;
+    unsigned long long ttft_max = translator->ttft_ms_max;
+    pthread_mutex_unlock(&translator->stats_lock);
 
-    for (attempt = 1; attempt <= translator->max_retries; attempt++) {
-        CURL *curl = curl_easy_init();
-        if (!curl) {
-            LOG_DEBUG( "[%s] Failed to initialize curl\n", request_uuid);
-            continue;
-        }
+    /* Streamed only with STREAM=yes or for clients that asked for a stream */
+    if (!translator->config->stream && responses == 0) {
+        return stats;
+    }
 
-        /* Build API endpoint URL */
-        char url[512];
-        snprintf(url, sizeof(url), "%s/chat/completions", translator->config->openai_base_url);
-
-        /* Build JSON request body */
-        cJSON *root = cJSON_CreateObject();
-        cJSON_AddStringToObject(root, "model", translator->config->openai_model);
-
-        /* Add reasoning object (always included) */
-        cJSON *reasoning = cJSON_CreateObject();
-        cJSON_AddStringToObject(reasoning, "effort", translator->config->reasoning_effort);
-        cJSON_AddItemToObject(root, "reasoning", reasoning);
-
-        cJSON_AddNumberToObject(root, "temperature", translator->config->temperature);
-        cJSON_AddNumberToObject(root, "top_p", translator->config->top_p);
-        cJSON_AddNumberToObject(root, "seed", translator->config->seed);
-        cJSON_AddBoolToObject(root, "stream", translator->config->stream);
-        cJSON_AddNumberToObject(root, "frequency_penalty", translator->config->frequency_penalty);
-        cJSON_AddNumberToObject(root, "presence_penalty", translator->config->presence_penalty);
-
-        cJSON *messages = cJSON_CreateArray();
-
-        /* Message 1: System role */
-        cJSON *system_message = cJSON_CreateObject();
-        cJSON_AddStringToObject(system_message, "role", "system");
-        cJSON_AddStringToObject(system_message, "content", translator->config->system_role);
-        cJSON_AddItemToArray(messages, system_message);
-
-        /* Message 2: Translation instructions with PROMPT_PREFIX */
-        cJSON *instruction_message = cJSON_CreateObject();
-        cJSON_AddStringToObject(instruction_message, "role", "user");
-        cJSON_AddStringToObject(instruction_message, "content", instruction);
-        cJSON_AddItemToArray(messages, instruction_message);
-
-        /* Message 3: Language direction */
-        char language_info[256];
-        snprintf(language_info, sizeof(language_info), "Translate FROM %s TO %s",
-                 get_language_name(from_lang), get_language_name(to_lang));
-        cJSON *language_message = cJSON_CreateObject();
-        cJSON_AddStringToObject(language_message, "role", "user");
-        cJSON_AddStringToObject(language_message, "content", language_info);
-        cJSON_AddItemToArray(messages, language_message);
-
-        /* Message 4: Actual text to translate */
-        /* cJSON automatically escapes newlines (\n) and other special characters */
-        /* Wrap text in <source> tags */
-        size_t wrapped_text_len = strlen(text) + strlen("<source></source>") + 1;
-        char *wrapped_text = malloc(wrapped_text_len);
-        if (!wrapped_text) {
-            LOG_DEBUG( "[%s] Failed to allocate memory for wrapped text\n", request_uuid);
-            cJSON_Delete(root);
-            free(instruction);
-            if (error) {
-                error->message = strdup("Memory allocation failed");
-                error->retryable = false;
-                error->status_code = 0;
-            }
-            return NULL;
+    cJSON *stream = cJSON_CreateObject();
+    if (stream) {
+        cJSON_AddNumberToObject(stream, "responses", (double)responses);
+        cJSON_AddNumberToObject(stream, "deltas", (double)deltas);
+        cJSON_AddNumberToObject(stream, "avg_deltas",
+                                responses ? (double)deltas / (double)responses : 0.0);
+        cJSON_AddNumberToObject(stream, "incomplete", (double)incomplete);
+        cJSON_AddNumberToObject(stream, "avg_first_token_ms",
+                                ttft_samples ? (double)ttft_total / (double)ttft_samples : 0.0);
+        cJSON_AddNumberToObject(stream, "max_first_token_ms", (double)ttft_max);
+        cJSON_AddItemToObject(stats, "stream", stream);
+    }
+
+    return stats;
+}
+
+/* Build request body for job and submit the first attempt (frees job on failure) */
+static int start_translation_job(TranslationJob *job, RequestTemplateKind kind,
+                                 const char *from_lang, const char *to_lang,
+                                 const char *source, const char *request_uuid,
+                                 const char *timestamp) {
+    OpenAITranslator *translator = job->translator;
+
+    if (translator->config->stream || job->delta_callback) {
+        job->stream = sse_parser_create(job->delta_callback ? on_stream_delta : NULL, job);
+        if (!job->stream) {
+            free_translation_job(job);
+            return -1;
         }
-        snprintf(wrapped_text, wrapped_text_len, "<source>%s</source>", text);
+    }
 
-        cJSON *text_message = cJSON_CreateObject();
-        cJSON_AddStringToObject(text_message, "role", "user");
-        cJSON_AddStringToObject(text_message, "content", wrapped_text);
-        cJSON_AddItemToArray(messages, text_message);
+    /* Only the source text is serialized per request */
+    job->json_request = request_templates_build(translator->templates, kind, from_lang,
+                                                to_lang, source, job->stream != NULL);
 
-        free(wrapped_text);
+    if (!job->json_request) {
+        LOG_DEBUG("[%s] Failed to build request body\n", request_uuid);
+        free_translation_job(job);
+        return -1;
+    }
 
-        cJSON_AddItemToObject(root, "messages", messages);
+    /* Save debug curl command if DEBUG enabled */
+    if (translator->config->debug) {
+        save_debug_curl(timestamp, request_uuid, translator->api_url,
+                      translator->config->openai_api_key, job->json_request);
+    }
 
-        char *json_request = cJSON_PrintUnformatted(root);
-        cJSON_Delete(root);
+    job->request_uuid = strdup(request_uuid);
+    job->attempt = 1;
 
-        /* Save debug curl command on first attempt if DEBUG enabled */
-        if (attempt == 1 && translator->config->debug) {
-            save_debug_curl(timestamp, request_uuid, url,
-                          translator->config->openai_api_key, json_request);
-        }
+    if (!job->request_uuid || submit_translation_attempt(job, 0) != 0) {
+        free_translation_job(job);
+        return -1;
+    }
 
-        /* Setup curl */
-        CurlResponse response = {0};
-        struct curl_slist *headers = NULL;
-        headers = curl_slist_append(headers, "Content-Type: application/json; charset=utf-8");
-
-        char auth_header[512];
-        snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s",
-                translator->config->openai_api_key);
-        headers = curl_slist_append(headers, auth_header);
-
-        curl_easy_setopt(curl, CURLOPT_URL, url);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_request);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, transbasket_curl_write_callback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, translator->timeout);
-
-        /* Perform request */
-        CURLcode res = curl_easy_perform(curl);
-        long http_code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-        free(json_request);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-
-        if (res != CURLE_OK) {
-            LOG_DEBUG( "[%s] Curl error (attempt %d/%d): %s\n",
-                   request_uuid, attempt, translator->max_retries, curl_easy_strerror(res));
-            free(response.data);
-
-            if (attempt < translator->max_retries) {
-                int backoff = (int)pow(2, attempt);
-                LOG_DEBUG( "[%s] Retrying in %d seconds...\n", request_uuid, backoff);
-                sleep(backoff);
-                continue;
-            }
+    return 0;
+}
 
-            if (error) {
-                error->message = strdup(curl_easy_strerror(res));
-                error->retryable = true;
-                error->status_code = 0;
-            }
-            break;
-        }
+/* Start translation on the upstream engine */
+int openai_translate_async(OpenAITranslator *translator, const char *from_lang,
+                           const char *to_lang, const char *text,
+                           const char *request_uuid, const char *timestamp,
+                           TranslationCallback callback, void *user_data) {
+    return openai_translate_stream_async(translator, from_lang, to_lang, text,
+                                         request_uuid, timestamp, NULL,
+                                         callback, user_data);
+}
 
-        /* Check HTTP status */
-        if (http_code >= 500) {
-            LOG_DEBUG( "[%s] Server error %ld (attempt %d/%d)\n",
-                   request_uuid, http_code, attempt, translator->max_retries);
-            free(response.data);
-
-            if (attempt < translator->max_retries) {
-                int backoff = (int)pow(2, attempt);
-                LOG_DEBUG( "[%s] Retrying in %d seconds...\n", request_uuid, backoff);
-                sleep(backoff);
-                continue;
-            }
+/* Start translation, relaying cleaned text fragments as they are generated */
+int openai_translate_stream_async(OpenAITranslator *translator, const char *from_lang,
+                                  const char *to_lang, const char *text,
+                                  const char *request_uuid, const char *timestamp,
+                                  TranslationDeltaCallback delta_callback,
+                                  TranslationCallback callback, void *user_data) {
+    if (!translator || !from_lang || !to_lang || !text || !request_uuid ||
+        !timestamp || !callback) {
+        return -1;
+    }
 
-            if (error) {
-                error->message = strdup("Server error");
-                error->retryable = true;
-                error->status_code = http_code;
-            }
-            break;
-        }
+    TranslationJob *job = calloc(1, sizeof(TranslationJob));
+    if (!job) {
+        LOG_DEBUG("[%s] Memory allocation failed for translation job\n", request_uuid);
+        return -1;
+    }
 
-        if (http_code >= 400) {
-            LOG_DEBUG( "[%s] Client error %ld\n", request_uuid, http_code);
-            free(response.data);
+    job->translator = translator;
+    job->callback = callback;
+    job->delta_callback = delta_callback;
+    job->user_data = user_data;
+    text_cleaner_init(&job->cleaner);
 
-            if (error) {
-                error->message = strdup("Client error");
-                error->retryable = false;
-                error->status_code = http_code;
-            }
-            break;
-        }
+    LOG_INFO( "[%s] Starting translation: %s -> %s\n", request_uuid, from_lang, to_lang);
 
-        /* Parse response based on streaming mode */
-        char *raw_translation = NULL;
+    return start_translation_job(job, REQUEST_TEMPLATE_SINGLE, from_lang, to_lang,
+                                 text, request_uuid, timestamp);
+}
 
-        if (translator->config->stream) {
-            /* Handle streaming response */
-            raw_translation = handle_streaming_response(response.data, request_uuid);
-        } else {
-            /* Handle non-streaming response */
-            raw_translation = handle_non_streaming_response(response.data, request_uuid);
-        }
+/* Start one upstream call translating several texts with numbered delimiters */
+int openai_translate_multi_async(OpenAITranslator *translator, const char *from_lang,
+                                 const char *to_lang, const char **texts, int count,
+                                 const char *request_uuid, const char *timestamp,
+                                 MultiTranslationCallback callback, void *user_data) {
+    if (!translator || !from_lang || !to_lang || !texts || count < 1 ||
+        !request_uuid || !timestamp || !callback) {
+        return -1;
+    }
 
-        free(response.data);
+    /* <source id="N">text</source> blocks, one per line */
+    size_t source_len = 1;
+    for (int i = 0; i < count; i++) {
+        source_len += strlen(texts[i]) + 48;
+    }
 
-        if (!raw_translation) {
-            LOG_DEBUG("[%s] Failed to extract translation from response\n", request_uuid);
-            if (error) {
-                error->message = strdup("No translation in response");
-                error->retryable = false;
-                error->status_code = http_code;
-            }
-            break;
-        }
+    char *source_content = malloc(source_len);
+    if (!source_content) {
+        LOG_DEBUG("[%s] Failed to allocate memory for multi-item source\n", request_uuid);
+        return -1;
+    }
 
-        /* Process the raw translation: unescape and clean */
-        char *unescaped_text = malloc(MAX_TRANSLATION_BUFFER);
-        char *cleaned_text = malloc(MAX_CLEANED_TEXT_BUFFER);
-
-        if (!unescaped_text || !cleaned_text) {
-            LOG_DEBUG("[%s] Memory allocation failed for translation buffers\n", request_uuid);
-            free(unescaped_text);
-            free(cleaned_text);
-            free(raw_translation);
-            if (error) {
-                error->message = strdup("Memory allocation failed");
-                error->retryable = false;
-                error->status_code = 0;
-            }
-            break;
-        }
+    size_t offset = 0;
+    for (int i = 0; i < count; i++) {
+        offset += snprintf(source_content + offset, source_len - offset,
+                           "%s<source id=\"%d\">%s</source>",
+                           i > 0 ? "\n" : "", i + 1, texts[i]);
+    }
 
-        /* First unescape \\n to \n, \\t to \t, etc. */
-        if (unescape_string(raw_translation, unescaped_text, MAX_TRANSLATION_BUFFER) != 0) {
-            LOG_DEBUG("[%s] Failed to unescape translation text\n", request_uuid);
-            free(unescaped_text);
-            free(cleaned_text);
-            free(raw_translation);
-            if (error) {
-                error->message = strdup("Failed to process translation text");
-                error->retryable = false;
-                error->status_code = 0;
-            }
-            break;
-        }
+    TranslationJob *job = calloc(1, sizeof(TranslationJob));
+    if (!job) {
+        LOG_DEBUG("[%s] Memory allocation failed for translation job\n", request_uuid);
+        free(source_content);
+        return -1;
+    }
 
-        /* Then strip emoji and shortcodes */
-        if (strip_emoji_and_shortcodes(unescaped_text, cleaned_text, MAX_CLEANED_TEXT_BUFFER) != 0) {
-            LOG_DEBUG("[%s] Failed to clean translation text\n", request_uuid);
-            free(unescaped_text);
-            free(cleaned_text);
-            free(raw_translation);
-            if (error) {
-                error->message = strdup("Failed to clean translation text");
-                error->retryable = false;
-                error->status_code = 0;
-            }
-            break;
-        }
+    job->translator = translator;
+    job->item_count = count;
+    job->multi_callback = callback;
+    job->user_data = user_data;
 
-        result = strdup(cleaned_text);
-        free(unescaped_text);
-        free(cleaned_text);
-        free(raw_translation);
+    LOG_INFO( "[%s] Starting multi-item translation: %s -> %s, %d items\n",
+            request_uuid, from_lang, to_lang, count);
 
-        LOG_INFO("[%s] Translation completed (attempt %d/%d, mode: %s)\n",
-               request_uuid, attempt, translator->max_retries,
-               translator->config->stream ? "streaming" : "non-streaming");
+    int ret = start_translation_job(job, REQUEST_TEMPLATE_MULTI, from_lang, to_lang,
+                                    source_content, request_uuid, timestamp);
+    free(source_content);
+
+    return ret;
+}
+
+/* Synchronous completion callback */
+static void sync_translation_done(char *translated_text, TranslationError *error,
+                                  void *user_data) {
+    SyncTranslation *sync = (SyncTranslation *)user_data;
+
+    pthread_mutex_lock(&sync->lock);
+    sync->result = translated_text;
+    if (error) {
+        sync->error = *error;
+    }
+    sync->done = true;
+    pthread_cond_signal(&sync->cond);
+    pthread_mutex_unlock(&sync->lock);
+}
 
-        break;
+/* Translate text using OpenAI API (blocks until the upstream engine completes) */
+char *openai_translate(OpenAITranslator *translator, const char *from_lang,
+                      const char *to_lang, const char *text,
+                      const char *request_uuid, const char *timestamp,
+                      TranslationError *error) {
+    if (!translator || !from_lang || !to_lang || !text || !request_uuid || !timestamp) {
+        set_translation_error(error, "Invalid parameters", false, 0);
+        return NULL;
     }
 
-    free(instruction);
+    SyncTranslation sync = {0};
+    pthread_mutex_init(&sync.lock, NULL);
+    pthread_cond_init(&sync.cond, NULL);
 
-    if (!result && error && !error->message) {
-        error->message = strdup("Translation failed after all retries");
-        error->retryable = true;
-        error->status_code = 0;
+    if (openai_translate_async(translator, from_lang, to_lang, text, request_uuid,
+                               timestamp, sync_translation_done, &sync) != 0) {
+        pthread_cond_destroy(&sync.cond);
+        pthread_mutex_destroy(&sync.lock);
+        set_translation_error(error, "Failed to start translation", true, 0);
+        return NULL;
     }
 
-    return result;
+    pthread_mutex_lock(&sync.lock);
+    while (!sync.done) {
+        pthread_cond_wait(&sync.cond, &sync.lock);
+    }
+    pthread_mutex_unlock(&sync.lock);
+
+    pthread_cond_destroy(&sync.cond);
+    pthread_mutex_destroy(&sync.lock);
+
+    if (!sync.result) {
+        if (error) {
+            *error = sync.error;
+            if (!error->message) {
+                set_translation_error(error, "Translation failed after all retries", true, 0);
+            }
+        } else {
+            free(sync.error.message);
+        }
+    }
+
+    return sync.result;
 }
 
 /* Free translated text */
@@ -7,15 +7,27 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <microhttpd.h>
+#include <cjson/cJSON.h>
 #include "http_server.h"
 #include "json_handler.h"
 #include "utils.h"
 #include "trans_cache.h"
+#include "cache_backend_text.h"
+#include "cache_backend_sqlite.h"
+#include "cache_backend_redis.h"
+#include "cache_write_behind.h"
+#include "cache_hot_tier.h"
+#include "singleflight.h"
+#include "micro_batcher.h"
 
 #define DEFAULT_MAX_WORKERS 30
 #define TRUNCATE_DISPLAY_LENGTH 50
 #define TRUNCATE_BUFFER_SIZE 100
+#define EVENT_STREAM_BLOCK_SIZE 4096
 
 /* Response helper function */
 static struct MHD_Response *create_json_response(const char *json_str, int status_code) {
@@ -87,9 +99,9 @@ static void *cache_background_thread(void *arg) {
 
         if (!server->cache_bg_running) break;
 
-        /* Periodic save */
-        if (trans_cache_save(server->cache) == 0) {
-            LOG_DEBUG("Cache periodically saved to disk (%d entries)", (int)server->cache->size);
+        /* Periodic save (text backend appends changes to its journal only) */
+        if (trans_cache_save(server->cache) != 0) {
+            LOG_INFO("Warning: Periodic cache save failed");
         }
 
         /* Cleanup check (if enabled) */
@@ -123,106 +135,687 @@ static int handle_health_check(struct MHD_Connection *connection) {
     return ret;
 }
 
-/* Translation endpoint handler */
-static int handle_translate(struct MHD_Connection *connection, const char *upload_data,
-                           size_t *upload_data_size, void **con_cls,
-                           TranslationServer *server) {
-    /* First call - setup connection */
-    if (*con_cls == NULL) {
-        char *buffer = malloc(1);
+/* Runtime statistics endpoint handler */
+static int handle_stats(struct MHD_Connection *connection, TranslationServer *server) {
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        return MHD_NO;
+    }
+
+    cJSON *upstream = openai_translator_stats(server->translator);
+    if (upstream) {
+        cJSON_AddItemToObject(root, "upstream", upstream);
+    }
+
+    cJSON *singleflight = singleflight_stats(server->flights);
+    if (singleflight) {
+        cJSON_AddItemToObject(root, "singleflight", singleflight);
+    }
+
+    cJSON *micro_batch = micro_batcher_stats(server->batcher);
+    if (micro_batch) {
+        cJSON_AddItemToObject(root, "micro_batch", micro_batch);
+    }
+
+    cJSON *cache = trans_cache_metrics(server->cache);
+    if (cache) {
+        cJSON_AddItemToObject(root, "cache", cache);
+    }
+
+    char *response_json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+
+    return send_json_response(connection, response_json, MHD_HTTP_OK, false);
+}
+
+/* Per-connection request state (stored in MHD con_cls) */
+typedef enum {
+    REQUEST_STATE_RECEIVING = 0,   /* Accumulating POST body */
+    REQUEST_STATE_PENDING,         /* Suspended while upstream translation is in flight */
+    REQUEST_STATE_COMPLETE         /* Response prepared, waiting to be queued */
+} RequestState;
+
+typedef struct {
+    RequestState state;
+    TranslationServer *server;
+    struct MHD_Connection *connection;
+
+    /* Request body accumulation */
+    char *body;
+    size_t body_size;
+
+    /* Parsed request (kept while upstream call is in flight) */
+    TranslationRequest *req;
+    struct BatchContext *batch;     /* Batch request state (/translate/batch only) */
+
+    /* Prepared response */
+    char *response_json;
+    int status_code;
+    bool retry_header;
+} RequestContext;
+
+static void batch_context_free(struct BatchContext *batch);
+
+/* Allocate request context for a new connection */
+static RequestContext *request_context_create(TranslationServer *server,
+                                              struct MHD_Connection *connection) {
+    RequestContext *ctx = calloc(1, sizeof(RequestContext));
+    if (!ctx) {
+        return NULL;
+    }
+
+    ctx->state = REQUEST_STATE_RECEIVING;
+    ctx->server = server;
+    ctx->connection = connection;
+
+    return ctx;
+}
+
+/* Free request context and everything it owns */
+static void request_context_free(RequestContext *ctx) {
+    if (!ctx) {
+        return;
+    }
+
+    free(ctx->body);
+    free_translation_request(ctx->req);
+    batch_context_free(ctx->batch);
+    free_json_response(ctx->response_json);
+    free(ctx);
+}
+
+/* Store prepared response in request context */
+static void request_context_set_response(RequestContext *ctx, char *response_json,
+                                         int status_code, bool retry_header) {
+    free_json_response(ctx->response_json);
+    ctx->response_json = response_json;
+    ctx->status_code = status_code;
+    ctx->retry_header = retry_header;
+    ctx->state = REQUEST_STATE_COMPLETE;
+}
+
+/* Queue the prepared response of a completed request */
+static int send_prepared_response(RequestContext *ctx) {
+    char *response_json = ctx->response_json;
+    ctx->response_json = NULL;
+
+    return send_json_response(ctx->connection, response_json, ctx->status_code,
+                              ctx->retry_header);
+}
+
+/* Shared state of a coalesced upstream translation (owned by the flight leader) */
+typedef struct {
+    TranslationServer *server;
+    char key[65];                   /* Cache hash, also the singleflight key */
+    char *from_lang;
+    char *to_lang;
+    char *text;
+    char *uuid;                     /* Leader request UUID (for logs) */
+
+    /* Live text fragments for a streaming leader (NULL otherwise) */
+    TranslationDeltaCallback on_delta;
+    void *delta_data;
+} FlightContext;
+
+/* Blocking wait for a translation result (thread-per-connection mode) */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool done;
+    char *translated_text;
+    TranslationError error;
+} TranslationWait;
+
+/* Free flight context */
+static void flight_context_free(FlightContext *fc) {
+    if (!fc) {
+        return;
+    }
+
+    free(fc->from_lang);
+    free(fc->to_lang);
+    free(fc->text);
+    free(fc->uuid);
+    free(fc);
+}
+
+/* Update cache with a fresh upstream translation */
+static void update_cache_with_translation(TranslationServer *server,
+                                          const FlightContext *fc,
+                                          const char *translated_text) {
+    if (!server->cache) {
+        return;
+    }
+
+    /* Re-lookup: the entry may have been added or changed while the upstream call ran */
+    trans_cache_read_begin(server->cache);
+    CacheEntry *cached = trans_cache_lookup(server->cache, fc->from_lang, fc->to_lang, fc->text);
+
+    if (cached) {
+        /* Existing cache entry - check if translation matches */
+        if (strcmp(cached->translated_text, translated_text) == 0) {
+            /* Same translation - increment count */
+            trans_cache_update_count(server->cache, cached);
+            LOG_DEBUG("[%s] Cache updated (same translation, count: %d)",
+                    fc->uuid, (int)cached->count);
+        } else {
+            /* Different translation - update translation and reset count */
+            trans_cache_update_translation(server->cache, cached, translated_text);
+            LOG_DEBUG("[%s] Cache updated (different translation, count reset to 1)",
+                    fc->uuid);
+        }
+    } else {
+        /* New cache entry */
+        if (trans_cache_add(server->cache, fc->from_lang, fc->to_lang,
+                           fc->text, translated_text) == 0) {
+            LOG_DEBUG("[%s] Added to cache (count: 1)", fc->uuid);
+        }
+    }
+    trans_cache_read_end(server->cache);
+}
+
+/* Leader upstream completion: update cache once, then fan out to all waiters */
+static void on_flight_complete(char *translated_text, TranslationError *error,
+                               void *user_data) {
+    FlightContext *fc = (FlightContext *)user_data;
+    TranslationServer *server = fc->server;
+
+    /* Cache is updated before the flight is released so that requests
+     * arriving afterwards find the result instead of starting a new call */
+    if (translated_text) {
+        update_cache_with_translation(server, fc, translated_text);
+    }
+
+    singleflight_complete(server->flights, fc->key, translated_text, error);
+    flight_context_free(fc);
+}
+
+/* Leader text fragment: forward to the streaming client that started the flight */
+static void on_flight_delta(const char *fragment, size_t len, void *user_data) {
+    FlightContext *fc = (FlightContext *)user_data;
+    fc->on_delta(fragment, len, fc->delta_data);
+}
+
+/* Start (or join) the upstream translation for req. callback is invoked
+ * exactly once with the result unless -1 is returned. If on_delta is set and
+ * this request leads the flight, it also receives text fragments as they are
+ * generated (followers only get the final result). */
+static int start_translation(TranslationServer *server, const TranslationRequest *req,
+                             TranslationDeltaCallback on_delta,
+                             TranslationCallback callback, void *user_data) {
+    char key[65];
+    trans_cache_calculate_hash(req->from_lang, req->to_lang, req->text, key);
+
+    SingleFlightRole role = singleflight_join(server->flights, key, callback, user_data);
+
+    if (role == SINGLEFLIGHT_ERROR) {
+        return -1;
+    }
+
+    if (role == SINGLEFLIGHT_FOLLOWER) {
+        LOG_DEBUG("[%s] Joined in-flight translation (key: %.16s...)", req->uuid, key);
+        return 0;
+    }
+
+    /* Leader - start the upstream call for everyone on this key */
+    FlightContext *fc = calloc(1, sizeof(FlightContext));
+    if (fc) {
+        fc->server = server;
+        memcpy(fc->key, key, sizeof(fc->key));
+        fc->from_lang = strdup(req->from_lang);
+        fc->to_lang = strdup(req->to_lang);
+        fc->text = strdup(req->text);
+        fc->uuid = strdup(req->uuid);
+        fc->on_delta = on_delta;
+        fc->delta_data = user_data;
+    }
+
+    if (fc && fc->from_lang && fc->to_lang && fc->text && fc->uuid) {
+        int started;
+
+        if (on_delta) {
+            /* Streaming client: relay fragments while the upstream generates them */
+            started = openai_translate_stream_async(server->translator, req->from_lang,
+                                                    req->to_lang, req->text, req->uuid,
+                                                    req->timestamp, on_flight_delta,
+                                                    on_flight_complete, fc);
+        } else if (micro_batcher_accepts(server->batcher, req->text)) {
+            /* Short texts may share one upstream call with other misses of the same pair */
+            started = micro_batcher_submit(server->batcher, req->from_lang, req->to_lang,
+                                           req->text, req->uuid, req->timestamp,
+                                           on_flight_complete, fc);
+        } else {
+            started = openai_translate_async(server->translator, req->from_lang, req->to_lang,
+                                             req->text, req->uuid, req->timestamp,
+                                             on_flight_complete, fc);
+        }
+
+        if (started == 0) {
+            return 0;
+        }
+    }
+
+    LOG_INFO("[%s] Failed to queue translation", req->uuid);
+    flight_context_free(fc);
+
+    /* Fail the flight so that followers that joined meanwhile are released too */
+    TranslationError error = {
+        .message = strdup("Translation service unavailable"),
+        .retryable = true,
+        .status_code = 0
+    };
+    singleflight_complete(server->flights, key, NULL, &error);
+
+    return 0;
+}
+
+/* Build response for a finished upstream translation */
+static void complete_translation(RequestContext *ctx, char *translated_text,
+                                 TranslationError *error) {
+    TranslationRequest *req = ctx->req;
+
+    if (!translated_text) {
+        const char *message = (error && error->message) ? error->message : "Translation failed";
+        bool retryable = error ? error->retryable : true;
+
+        LOG_INFO("[%s] Translation error: %s", req->uuid, message);
+
+        int status_code = retryable ? MHD_HTTP_SERVICE_UNAVAILABLE : MHD_HTTP_BAD_GATEWAY;
+        char *error_json = create_error_response("TRANSLATION_ERROR", message, req->uuid);
+
+        if (error) {
+            free(error->message);
+            error->message = NULL;
+        }
+
+        request_context_set_response(ctx, error_json, status_code, retryable);
+        return;
+    }
+
+    /* Create success response */
+    char *response_json = create_translation_response(req, translated_text);
+
+    char truncated_result[TRUNCATE_BUFFER_SIZE];
+    truncate_text(translated_text, truncated_result, TRUNCATE_DISPLAY_LENGTH, "...");
+    LOG_INFO("[%s] Translation completed, result: %s", req->uuid, truncated_result);
+
+    free_translated_text(translated_text);
+
+    request_context_set_response(ctx, response_json, MHD_HTTP_OK, false);
+}
+
+/* Translation completion callback - runs on an upstream event loop thread */
+static void on_translation_complete(char *translated_text, TranslationError *error,
+                                    void *user_data) {
+    RequestContext *ctx = (RequestContext *)user_data;
+
+    complete_translation(ctx, translated_text, error);
+
+    /* Hand the connection back to MHD; the access handler sends the response */
+    MHD_resume_connection(ctx->connection);
+}
+
+/* Translation completion callback for blocking waiters */
+static void on_translation_wait_complete(char *translated_text, TranslationError *error,
+                                         void *user_data) {
+    TranslationWait *wait = (TranslationWait *)user_data;
+
+    pthread_mutex_lock(&wait->lock);
+    wait->translated_text = translated_text;
+    if (error) {
+        wait->error = *error;
+    }
+    wait->done = true;
+    pthread_cond_signal(&wait->cond);
+    pthread_mutex_unlock(&wait->lock);
+}
+
+/* Server-sent event stream of one /translate request (stream=1 or
+ * Accept: text/event-stream). Shared between the MHD content reader and the
+ * translation callbacks, so it holds a reference for each. */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;            /* Signalled on new data (thread-per-connection mode) */
+    struct MHD_Connection *connection;
+    bool blocking;                  /* Reader waits on cond instead of suspending */
+    TranslationRequest *req;        /* Moved from the request context */
+
+    /* Encoded events not yet handed to MHD */
+    char *buffer;
+    size_t length;
+    size_t offset;
+    size_t capacity;
+
+    bool relayed;                   /* Delta events sent for the current attempt (under lock) */
+    bool finished;                  /* Final done/error event written */
+    bool suspended;                 /* Reader suspended the connection waiting for data */
+    bool closed;                    /* Response destroyed; connection may be gone */
+    int refs;
+} ClientStream;
+
+/* Create event stream taking ownership of req (2 references: reader and producer) */
+static ClientStream *client_stream_create(struct MHD_Connection *connection,
+                                          TranslationRequest *req, bool blocking) {
+    ClientStream *stream = calloc(1, sizeof(ClientStream));
+    if (!stream) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->cond, NULL);
+    stream->connection = connection;
+    stream->blocking = blocking;
+    stream->req = req;
+    stream->refs = 2;
+
+    return stream;
+}
+
+/* Drop one reference */
+static void client_stream_release(ClientStream *stream) {
+    pthread_mutex_lock(&stream->lock);
+    int refs = --stream->refs;
+    pthread_mutex_unlock(&stream->lock);
+
+    if (refs > 0) {
+        return;
+    }
+
+    pthread_cond_destroy(&stream->cond);
+    pthread_mutex_destroy(&stream->lock);
+    free_translation_request(stream->req);
+    free(stream->buffer);
+    free(stream);
+}
+
+/* Append "event: name\ndata: json\n\n" and wake the reader (under lock) */
+static void client_stream_append_locked(ClientStream *stream, const char *event,
+                                        const char *data) {
+    if (stream->closed) {
+        return;  /* Client is gone; keep going only for the cache */
+    }
+
+    if (stream->offset == stream->length) {
+        stream->offset = 0;
+        stream->length = 0;
+    }
+
+    size_t needed = stream->length + strlen(event) + strlen(data) + 32;
+    if (needed > stream->capacity) {
+        size_t capacity = stream->capacity ? stream->capacity : EVENT_STREAM_BLOCK_SIZE;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+
+        char *buffer = realloc(stream->buffer, capacity);
         if (!buffer) {
-            return MHD_NO;
+            LOG_INFO("[%s] Memory allocation failed for event stream", stream->req->uuid);
+            return;
         }
-        buffer[0] = '\0';
-        *con_cls = buffer;
-        return MHD_YES;
+        stream->buffer = buffer;
+        stream->capacity = capacity;
     }
 
-    /* Accumulate POST data */
-    if (*upload_data_size != 0) {
-        char *buffer = *con_cls;
-        size_t current_size = strlen(buffer);
-        char *new_buffer = realloc(buffer, current_size + *upload_data_size + 1);
+    stream->length += snprintf(stream->buffer + stream->length,
+                               stream->capacity - stream->length,
+                               "event: %s\ndata: %s\n\n", event, data);
 
-        if (!new_buffer) {
-            free(buffer);
-            return MHD_NO;
+    if (stream->blocking) {
+        pthread_cond_signal(&stream->cond);
+    } else if (stream->suspended) {
+        stream->suspended = false;
+        MHD_resume_connection(stream->connection);
+    }
+}
+
+/* Append event with a JSON payload */
+static void client_stream_send(ClientStream *stream, const char *event, char *json,
+                               bool final) {
+    pthread_mutex_lock(&stream->lock);
+    client_stream_append_locked(stream, event, json ? json : "{}");
+    if (final) {
+        stream->finished = true;
+        if (stream->blocking) {
+            pthread_cond_signal(&stream->cond);
+        } else if (stream->suspended && !stream->closed) {
+            stream->suspended = false;
+            MHD_resume_connection(stream->connection);
         }
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    free_json_response(json);
+}
 
-        memcpy(new_buffer + current_size, upload_data, *upload_data_size);
-        new_buffer[current_size + *upload_data_size] = '\0';
+/* MHD content reader: hand out pending events, suspend while there are none */
+static ssize_t client_stream_read(void *cls, uint64_t pos, char *buf, size_t max) {
+    (void)pos;
+    ClientStream *stream = (ClientStream *)cls;
 
-        *con_cls = new_buffer;
-        *upload_data_size = 0;
+    pthread_mutex_lock(&stream->lock);
 
-        return MHD_YES;
+    while (stream->blocking && stream->offset == stream->length && !stream->finished) {
+        pthread_cond_wait(&stream->cond, &stream->lock);
     }
 
-    /* Process request */
-    char *request_data = *con_cls;
-    char *request_uuid = NULL;
+    if (stream->offset < stream->length) {
+        size_t available = stream->length - stream->offset;
+        size_t n = available < max ? available : max;
 
-    /* Parse translation request */
-    TranslationRequest *req = parse_translation_request(request_data);
-    free(request_data);
-    *con_cls = NULL;
+        memcpy(buf, stream->buffer + stream->offset, n);
+        stream->offset += n;
 
-    if (!req) {
-        char *error_json = create_error_response("VALIDATION_ERROR",
-                                                 "Request validation failed",
-                                                 NULL);
-        return send_json_response(connection, error_json, MHD_HTTP_UNPROCESSABLE_ENTITY, false);
+        pthread_mutex_unlock(&stream->lock);
+        return (ssize_t)n;
+    }
+
+    if (stream->finished) {
+        pthread_mutex_unlock(&stream->lock);
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    /* Nothing yet: park the connection until the producer resumes it */
+    stream->suspended = true;
+    MHD_suspend_connection(stream->connection);
+
+    pthread_mutex_unlock(&stream->lock);
+    return 0;
+}
+
+/* MHD response destroyed (stream finished or client disconnected) */
+static void client_stream_response_free(void *cls) {
+    ClientStream *stream = (ClientStream *)cls;
+
+    pthread_mutex_lock(&stream->lock);
+    stream->closed = true;
+    pthread_mutex_unlock(&stream->lock);
+
+    client_stream_release(stream);
+}
+
+/* Upstream text fragment for a streaming leader */
+static void on_stream_delta(const char *fragment, size_t len, void *user_data) {
+    ClientStream *stream = (ClientStream *)user_data;
+
+    if (!fragment) {
+        /* Upstream retry: the client drops what it has received so far */
+        pthread_mutex_lock(&stream->lock);
+        stream->relayed = false;
+        client_stream_append_locked(stream, "reset", "{}");
+        pthread_mutex_unlock(&stream->lock);
+        return;
     }
 
-    request_uuid = strdup(req->uuid);
+    char *text = strndup(fragment, len);
+    cJSON *root = cJSON_CreateObject();
+    char *json = NULL;
+
+    if (text && root) {
+        cJSON_AddStringToObject(root, "text", text);
+        json = cJSON_PrintUnformatted(root);
+    }
+    cJSON_Delete(root);
+    free(text);
+
+    if (json) {
+        pthread_mutex_lock(&stream->lock);
+        stream->relayed = true;
+        client_stream_append_locked(stream, "delta", json);
+        pthread_mutex_unlock(&stream->lock);
+        free_json_response(json);
+    }
+}
+
+/* Final result for a streaming request: done (full response) or error event */
+static void on_stream_complete(char *translated_text, TranslationError *error,
+                               void *user_data) {
+    ClientStream *stream = (ClientStream *)user_data;
+    TranslationRequest *req = stream->req;
+
+    if (!translated_text) {
+        const char *message = (error && error->message) ? error->message : "Translation failed";
+
+        LOG_INFO("[%s] Translation error: %s", req->uuid, message);
+
+        client_stream_send(stream, "error",
+                           create_error_response("TRANSLATION_ERROR", message, req->uuid),
+                           true);
+
+        if (error) {
+            free(error->message);
+            error->message = NULL;
+        }
+
+        client_stream_release(stream);
+        return;
+    }
 
+    /* Followers and cache hits never saw fragments: send the text as one delta */
+    pthread_mutex_lock(&stream->lock);
+    bool relayed = stream->relayed;
+    pthread_mutex_unlock(&stream->lock);
+
+    if (!relayed) {
+        on_stream_delta(translated_text, strlen(translated_text), stream);
+    }
+
+    char truncated_result[TRUNCATE_BUFFER_SIZE];
+    truncate_text(translated_text, truncated_result, TRUNCATE_DISPLAY_LENGTH, "...");
+    LOG_INFO("[%s] Translation streamed, result: %s", req->uuid, truncated_result);
+
+    client_stream_send(stream, "done", create_translation_response(req, translated_text), true);
+    free_translated_text(translated_text);
+
+    client_stream_release(stream);
+}
+
+/* True if the client asked for a server-sent event stream */
+static bool wants_event_stream(struct MHD_Connection *connection) {
+    const char *stream = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "stream");
+    if (stream && (strcmp(stream, "1") == 0 || strcmp(stream, "true") == 0)) {
+        return true;
+    }
+
+    const char *accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Accept");
+    return accept && strstr(accept, "text/event-stream") != NULL;
+}
+
+/* Queue the event stream response; the reader reference is released by MHD */
+static int queue_event_stream(ClientStream *stream) {
+    struct MHD_Response *response = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN, EVENT_STREAM_BLOCK_SIZE,
+        client_stream_read, stream, client_stream_response_free);
+
+    if (!response) {
+        client_stream_release(stream);
+        return MHD_NO;
+    }
+
+    MHD_add_response_header(response, "Content-Type", "text/event-stream; charset=utf-8");
+    MHD_add_response_header(response, "Cache-Control", "no-cache");
+    MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+
+    int ret = MHD_queue_response(stream->connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+
+    return ret;
+}
+
+/* Translate req as an event stream (cached_text set on cache hit) */
+static int handle_translate_stream(RequestContext *ctx, const char *cached_text) {
+    TranslationServer *server = ctx->server;
+    bool blocking = server->config->server_mode == SERVER_MODE_THREAD;
+
+    ClientStream *stream = client_stream_create(ctx->connection, ctx->req, blocking);
+    if (!stream) {
+        char *error_json = create_error_response("INTERNAL_ERROR",
+                                                 "Memory allocation failed",
+                                                 ctx->req->uuid);
+        return send_json_response(ctx->connection, error_json,
+                                  MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+    }
+    ctx->req = NULL;  /* Owned by the stream now */
+
+    if (cached_text) {
+        char *text = strdup(cached_text);
+        if (text) {
+            on_stream_complete(text, NULL, stream);
+        } else {
+            TranslationError error = {
+                .message = strdup("Memory allocation failed"),
+                .retryable = true,
+                .status_code = 0
+            };
+            on_stream_complete(NULL, &error, stream);
+        }
+        return queue_event_stream(stream);
+    }
+
+    /* Keep the producer reference alive past a failed queue */
+    int ret = queue_event_stream(stream);
+
+    if (start_translation(server, stream->req, on_stream_delta,
+                          on_stream_complete, stream) != 0) {
+        TranslationError error = {
+            .message = strdup("Translation service unavailable"),
+            .retryable = true,
+            .status_code = 0
+        };
+        on_stream_complete(NULL, &error, stream);
+    }
+
+    return ret;
+}
+
+/* Strip ANSI escape codes and control characters from request text in place */
+static int sanitize_request_text(TranslationRequest *req) {
     /* Strip ANSI escape codes and control characters from text */
     size_t text_len = strlen(req->text);
     char *cleaned_text = malloc(text_len + 1);
     if (!cleaned_text) {
-        LOG_INFO("[%s] Memory allocation failed for ANSI stripping", request_uuid);
-        free(request_uuid);
-        free_translation_request(req);
-        char *error_json = create_error_response("INTERNAL_ERROR",
-                                                 "Memory allocation failed",
-                                                 request_uuid);
-        return send_json_response(connection, error_json, MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+        LOG_INFO("[%s] Memory allocation failed for ANSI stripping", req->uuid);
+        return -1;
     }
 
     if (strip_ansi_codes(req->text, cleaned_text, text_len + 1) != 0) {
-        LOG_INFO("[%s] Failed to strip ANSI codes", request_uuid);
+        LOG_INFO("[%s] Failed to strip ANSI codes", req->uuid);
         free(cleaned_text);
-        free(request_uuid);
-        free_translation_request(req);
-        char *error_json = create_error_response("INTERNAL_ERROR",
-                                                 "Text processing failed",
-                                                 request_uuid);
-        return send_json_response(connection, error_json, MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+        return -1;
     }
 
     /* Strip control characters from text */
     char *control_filtered_text = malloc(strlen(cleaned_text) + 1);
     if (!control_filtered_text) {
-        LOG_INFO("[%s] Memory allocation failed for control character stripping", request_uuid);
+        LOG_INFO("[%s] Memory allocation failed for control character stripping", req->uuid);
         free(cleaned_text);
-        free(request_uuid);
-        free_translation_request(req);
-        char *error_json = create_error_response("INTERNAL_ERROR",
-                                                 "Memory allocation failed",
-                                                 request_uuid);
-        return send_json_response(connection, error_json, MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+        return -1;
     }
 
     if (strip_control_characters(cleaned_text, control_filtered_text, strlen(cleaned_text) + 1) != 0) {
-        LOG_INFO("[%s] Failed to strip control characters", request_uuid);
+        LOG_INFO("[%s] Failed to strip control characters", req->uuid);
         free(control_filtered_text);
         free(cleaned_text);
-        free(request_uuid);
-        free_translation_request(req);
-        char *error_json = create_error_response("INTERNAL_ERROR",
-                                                 "Text processing failed",
-                                                 request_uuid);
-        return send_json_response(connection, error_json, MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+        return -1;
     }
 
     /* Replace original text with fully cleaned text */
@@ -230,108 +823,612 @@ static int handle_translate(struct MHD_Connection *connection, const char *uploa
     free(cleaned_text);
     req->text = control_filtered_text;
 
+    return 0;
+}
+
+/* Append a chunk of POST data to the request body */
+static int append_request_body(RequestContext *ctx, const char *upload_data,
+                               size_t *upload_data_size) {
+    char *new_body = realloc(ctx->body, ctx->body_size + *upload_data_size + 1);
+
+    if (!new_body) {
+        return MHD_NO;
+    }
+
+    memcpy(new_body + ctx->body_size, upload_data, *upload_data_size);
+    ctx->body_size += *upload_data_size;
+    new_body[ctx->body_size] = '\0';
+
+    ctx->body = new_body;
+    *upload_data_size = 0;
+
+    return MHD_YES;
+}
+
+/* Translation endpoint handler */
+static int handle_translate(struct MHD_Connection *connection, const char *upload_data,
+                           size_t *upload_data_size, void **con_cls,
+                           TranslationServer *server) {
+    /* First call - setup connection */
+    if (*con_cls == NULL) {
+        RequestContext *ctx = request_context_create(server, connection);
+        if (!ctx) {
+            return MHD_NO;
+        }
+        *con_cls = ctx;
+        return MHD_YES;
+    }
+
+    RequestContext *ctx = *con_cls;
+
+    /* Resumed after upstream completion - send prepared response */
+    if (ctx->state == REQUEST_STATE_COMPLETE) {
+        return send_prepared_response(ctx);
+    }
+
+    if (ctx->state == REQUEST_STATE_PENDING) {
+        /* Spurious call while suspended; nothing to do until resumed */
+        return MHD_YES;
+    }
+
+    /* Accumulate POST data */
+    if (*upload_data_size != 0) {
+        return append_request_body(ctx, upload_data, upload_data_size);
+    }
+
+    /* Process request */
+    TranslationRequest *req = parse_translation_request(ctx->body ? ctx->body : "");
+    free(ctx->body);
+    ctx->body = NULL;
+    ctx->body_size = 0;
+
+    if (!req) {
+        char *error_json = create_error_response("VALIDATION_ERROR",
+                                                 "Request validation failed",
+                                                 NULL);
+        return send_json_response(connection, error_json, MHD_HTTP_UNPROCESSABLE_ENTITY, false);
+    }
+
+    ctx->req = req;
+
+    if (sanitize_request_text(req) != 0) {
+        char *error_json = create_error_response("INTERNAL_ERROR",
+                                                 "Text processing failed",
+                                                 req->uuid);
+        return send_json_response(connection, error_json, MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+    }
+
     char truncated_text[TRUNCATE_BUFFER_SIZE];
     truncate_text(req->text, truncated_text, TRUNCATE_DISPLAY_LENGTH, "...");
     LOG_INFO("[%s] Translation request received: %s -> %s, text: %s",
-            request_uuid, req->from_lang, req->to_lang, truncated_text);
+            req->uuid, req->from_lang, req->to_lang, truncated_text);
 
     /* Check cache first if enabled */
-    CacheEntry *cached = NULL;
     if (server->cache) {
-        cached = trans_cache_lookup(server->cache, req->from_lang, req->to_lang, req->text);
+        trans_cache_read_begin(server->cache);
+        CacheEntry *cached = trans_cache_lookup(server->cache, req->from_lang, req->to_lang, req->text);
+        /* Hits not yet written by the backend are already counted here */
+        int count = cached ? (int)cached->count : 0;
 
-        if (cached && cached->count >= server->config->cache_threshold) {
+        if (cached && count >= server->config->cache_threshold) {
             /* Cache hit - use cached translation */
             LOG_DEBUG("[%s] Cache hit (count: %d >= threshold: %d)",
-                    request_uuid, cached->count, server->config->cache_threshold);
+                    req->uuid, count, server->config->cache_threshold);
 
             /* Increment count */
             trans_cache_update_count(server->cache, cached);
 
+            if (wants_event_stream(connection)) {
+                /* Stream setup may block: leave the read section first */
+                char *cached_text = strdup(cached->translated_text);
+                trans_cache_read_end(server->cache);
+                if (cached_text) {
+                    LOG_INFO("[%s] Translation from cache (event stream)", req->uuid);
+                    int ret = handle_translate_stream(ctx, cached_text);
+                    free(cached_text);
+                    return ret;
+                }
+                char *error_json = create_error_response("INTERNAL_ERROR",
+                                                         "Memory allocation failed",
+                                                         req->uuid);
+                return send_json_response(connection, error_json,
+                                          MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+            }
+
             /* Create response with cached translation */
             char *response_json = create_translation_response(req, cached->translated_text);
 
             char truncated_result[TRUNCATE_BUFFER_SIZE];
             truncate_text(cached->translated_text, truncated_result, TRUNCATE_DISPLAY_LENGTH, "...");
-            LOG_INFO("[%s] Translation from cache, result: %s", request_uuid, truncated_result);
-
-            free(request_uuid);
-            free_translation_request(req);
+            trans_cache_read_end(server->cache);
+            LOG_INFO("[%s] Translation from cache, result: %s", req->uuid, truncated_result);
 
             return send_json_response(connection, response_json, MHD_HTTP_OK, false);
         }
+        trans_cache_read_end(server->cache);
 
         if (cached) {
             LOG_DEBUG("[%s] Cache found but count insufficient (%d < %d), requesting API",
-                    request_uuid, cached->count, server->config->cache_threshold);
+                    req->uuid, count, server->config->cache_threshold);
         }
     }
 
-    /* Perform translation via OpenAI API */
-    TranslationError trans_error = {0};
-    char *translated_text = openai_translate(
-        server->translator,
-        req->from_lang,
-        req->to_lang,
-        req->text,
-        request_uuid,
-        req->timestamp,
-        &trans_error
-    );
+    /* Relay fragments to the client as the upstream generates them */
+    if (wants_event_stream(connection)) {
+        return handle_translate_stream(ctx, NULL);
+    }
 
-    if (!translated_text) {
-        LOG_INFO("[%s] Translation error: %s", request_uuid,
-                trans_error.message ? trans_error.message : "Unknown error");
+    /* Thread-per-connection mode cannot suspend; wait on this connection's thread */
+    if (server->config->server_mode == SERVER_MODE_THREAD) {
+        TranslationWait wait = {0};
+        pthread_mutex_init(&wait.lock, NULL);
+        pthread_cond_init(&wait.cond, NULL);
+
+        if (start_translation(server, req, NULL, on_translation_wait_complete, &wait) != 0) {
+            wait.error.message = strdup("Translation service unavailable");
+            wait.error.retryable = true;
+        } else {
+            pthread_mutex_lock(&wait.lock);
+            while (!wait.done) {
+                pthread_cond_wait(&wait.cond, &wait.lock);
+            }
+            pthread_mutex_unlock(&wait.lock);
+        }
 
-        int status_code = trans_error.retryable ? MHD_HTTP_SERVICE_UNAVAILABLE : MHD_HTTP_BAD_GATEWAY;
+        pthread_cond_destroy(&wait.cond);
+        pthread_mutex_destroy(&wait.lock);
 
+        complete_translation(ctx, wait.translated_text, &wait.error);
+        return send_prepared_response(ctx);
+    }
+
+    /* Suspend the connection while the upstream call is in flight so this
+     * worker thread can serve other connections (e.g. cache hits) meanwhile */
+    ctx->state = REQUEST_STATE_PENDING;
+    MHD_suspend_connection(connection);
+
+    if (start_translation(server, req, NULL, on_translation_complete, ctx) != 0) {
+        LOG_INFO("[%s] Failed to queue translation", req->uuid);
         char *error_json = create_error_response("TRANSLATION_ERROR",
-                                                 trans_error.message ? trans_error.message : "Translation failed",
-                                                 request_uuid);
+                                                 "Translation service unavailable",
+                                                 req->uuid);
+        request_context_set_response(ctx, error_json, MHD_HTTP_SERVICE_UNAVAILABLE, true);
+        MHD_resume_connection(connection);
+    }
 
-        free(trans_error.message);
-        free(request_uuid);
-        free_translation_request(req);
+    return MHD_YES;
+}
 
-        return send_json_response(connection, error_json, status_code, trans_error.retryable);
+/* Unique (from, to, text) within a batch */
+typedef struct {
+    struct BatchContext *batch;
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];  /* Cache key digest */
+    const TranslationRequest *req;  /* First item with this key */
+    char *translated_text;          /* Result (cache or upstream) */
+    TranslationError error;         /* Set when translated_text is NULL */
+    bool cached;
+} BatchGroup;
+
+/* One item of the batch in request order */
+typedef struct {
+    TranslationRequest *req;        /* NULL if the item failed validation */
+    int group;                      /* Index into groups, -1 if invalid */
+} BatchItem;
+
+/* Batch request state; groups are dispatched upstream with bounded fan-out */
+typedef struct BatchContext {
+    RequestContext *ctx;
+    TranslationServer *server;
+
+    BatchItem *items;
+    int item_count;
+    BatchGroup *groups;
+    int group_count;
+    int *misses;                    /* Group indices that need an upstream call */
+    int miss_count;
+
+    pthread_mutex_t lock;           /* Protects dispatch state below */
+    int next_miss;                  /* Next miss to dispatch */
+    int inflight;                   /* Upstream calls running for this batch */
+    int max_inflight;
+    int remaining;                  /* Misses not yet completed */
+    bool dispatching;               /* A thread is running batch_dispatch() */
+
+    /* Thread-per-connection mode waits here instead of suspending */
+    pthread_cond_t done_cond;
+    bool done;
+} BatchContext;
+
+/* Free batch context */
+static void batch_context_free(BatchContext *batch) {
+    if (!batch) {
+        return;
     }
 
-    /* Update cache with translation result */
-    if (server->cache) {
-        if (cached) {
-            /* Existing cache entry - check if translation matches */
-            if (strcmp(cached->translated_text, translated_text) == 0) {
-                /* Same translation - increment count */
-                trans_cache_update_count(server->cache, cached);
-                LOG_DEBUG("[%s] Cache updated (same translation, count: %d)",
-                        request_uuid, cached->count + 1);
+    for (int i = 0; i < batch->item_count; i++) {
+        free_translation_request(batch->items[i].req);
+    }
+
+    for (int i = 0; i < batch->group_count; i++) {
+        free_translated_text(batch->groups[i].translated_text);
+        free(batch->groups[i].error.message);
+    }
+
+    pthread_cond_destroy(&batch->done_cond);
+    pthread_mutex_destroy(&batch->lock);
+    free(batch->items);
+    free(batch->groups);
+    free(batch->misses);
+    free(batch);
+}
+
+/* Build ordered batch response once every group is resolved */
+static void batch_build_response(BatchContext *batch) {
+    RequestContext *ctx = batch->ctx;
+    int cached = 0, translated = 0, failed = 0;
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *results = cJSON_CreateArray();
+
+    for (int i = 0; i < batch->item_count; i++) {
+        BatchItem *item = &batch->items[i];
+        cJSON *result;
+        int status;
+
+        if (!item->req) {
+            status = MHD_HTTP_UNPROCESSABLE_ENTITY;
+            result = create_error_response_object("VALIDATION_ERROR",
+                                                  "Request validation failed", NULL);
+            failed++;
+        } else {
+            BatchGroup *group = &batch->groups[item->group];
+
+            if (group->translated_text) {
+                status = MHD_HTTP_OK;
+                result = create_translation_response_object(item->req, group->translated_text);
+                if (group->cached) {
+                    cached++;
+                } else {
+                    translated++;
+                }
             } else {
-                /* Different translation - update translation and reset count */
-                trans_cache_update_translation(server->cache, cached, translated_text);
-                LOG_DEBUG("[%s] Cache updated (different translation, count reset to 1)",
-                        request_uuid);
+                const char *message = group->error.message ? group->error.message :
+                                      "Translation failed";
+                status = group->error.retryable ? MHD_HTTP_SERVICE_UNAVAILABLE :
+                                                  MHD_HTTP_BAD_GATEWAY;
+                result = create_error_response_object("TRANSLATION_ERROR", message,
+                                                      item->req->uuid);
+                failed++;
             }
+        }
+
+        if (result) {
+            cJSON_AddNumberToObject(result, "status", status);
+            cJSON_AddItemToArray(results, result);
         } else {
-            /* New cache entry */
-            if (trans_cache_add(server->cache, req->from_lang, req->to_lang,
-                               req->text, translated_text) == 0) {
-                LOG_DEBUG("[%s] Added to cache (count: 1)", request_uuid);
+            cJSON_AddItemToArray(results, cJSON_CreateNull());
+        }
+    }
+
+    cJSON_AddItemToObject(root, "results", results);
+
+    cJSON *summary = cJSON_CreateObject();
+    cJSON_AddNumberToObject(summary, "total", batch->item_count);
+    cJSON_AddNumberToObject(summary, "unique", batch->group_count);
+    cJSON_AddNumberToObject(summary, "cached", cached);
+    cJSON_AddNumberToObject(summary, "translated", translated);
+    cJSON_AddNumberToObject(summary, "failed", failed);
+    cJSON_AddItemToObject(root, "summary", summary);
+
+    char *response_json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+
+    LOG_INFO("[batch] Completed %d items (%d unique): %d cached, %d translated, %d failed",
+            batch->item_count, batch->group_count, cached, translated, failed);
+
+    if (response_json) {
+        request_context_set_response(ctx, response_json, MHD_HTTP_OK, false);
+    } else {
+        request_context_set_response(ctx, create_error_response("INTERNAL_ERROR",
+                                     "Failed to build batch response", NULL),
+                                     MHD_HTTP_INTERNAL_SERVER_ERROR, false);
+    }
+}
+
+/* Build the response and hand it to the waiting connection */
+static void batch_finish(BatchContext *batch) {
+    RequestContext *ctx = batch->ctx;
+
+    batch_build_response(batch);
+
+    if (batch->server->config->server_mode == SERVER_MODE_THREAD) {
+        pthread_mutex_lock(&batch->lock);
+        batch->done = true;
+        pthread_cond_signal(&batch->done_cond);
+        pthread_mutex_unlock(&batch->lock);
+    } else {
+        MHD_resume_connection(ctx->connection);
+    }
+}
+
+static void on_batch_group_complete(char *translated_text, TranslationError *error,
+                                    void *user_data);
+
+/* Dispatch pending misses while fan-out slots are free. The caller must have
+ * set batch->dispatching; exactly one thread finishes the batch. */
+static void batch_dispatch(BatchContext *batch) {
+    while (1) {
+        pthread_mutex_lock(&batch->lock);
+
+        if (batch->next_miss < batch->miss_count && batch->inflight < batch->max_inflight) {
+            BatchGroup *group = &batch->groups[batch->misses[batch->next_miss++]];
+            batch->inflight++;
+            pthread_mutex_unlock(&batch->lock);
+
+            if (start_translation(batch->server, group->req, NULL,
+                                  on_batch_group_complete, group) != 0) {
+                group->error.message = strdup("Translation service unavailable");
+                group->error.retryable = true;
+
+                pthread_mutex_lock(&batch->lock);
+                batch->inflight--;
+                batch->remaining--;
+                pthread_mutex_unlock(&batch->lock);
             }
+            continue;
+        }
+
+        batch->dispatching = false;
+        bool finished = (batch->remaining == 0);
+        pthread_mutex_unlock(&batch->lock);
+
+        if (finished) {
+            batch_finish(batch);
         }
+        return;
     }
+}
 
-    /* Create success response */
-    char *response_json = create_translation_response(req, translated_text);
+/* Completion of one unique item - may run on an upstream event loop thread
+ * or synchronously from within batch_dispatch() */
+static void on_batch_group_complete(char *translated_text, TranslationError *error,
+                                    void *user_data) {
+    BatchGroup *group = (BatchGroup *)user_data;
+    BatchContext *batch = group->batch;
 
-    char truncated_result[TRUNCATE_BUFFER_SIZE];
-    truncate_text(translated_text, truncated_result, TRUNCATE_DISPLAY_LENGTH, "...");
-    LOG_INFO("[%s] Translation completed, result: %s", request_uuid, truncated_result);
+    group->translated_text = translated_text;
+    if (!translated_text && error) {
+        group->error = *error;
+    }
 
-    free_translated_text(translated_text);
-    free(request_uuid);
-    free_translation_request(req);
+    bool finished = false;
+    bool dispatch = false;
 
-    return send_json_response(connection, response_json, MHD_HTTP_OK, false);
+    pthread_mutex_lock(&batch->lock);
+    batch->inflight--;
+    batch->remaining--;
+
+    if (!batch->dispatching) {
+        if (batch->remaining == 0) {
+            finished = true;
+        } else if (batch->next_miss < batch->miss_count) {
+            batch->dispatching = true;
+            dispatch = true;
+        }
+    }
+    pthread_mutex_unlock(&batch->lock);
+
+    if (finished) {
+        batch_finish(batch);
+    } else if (dispatch) {
+        batch_dispatch(batch);
+    }
+}
+
+/* Parse batch body, dedupe items and resolve cache hits.
+ * Returns NULL and sets *error_message on a malformed batch. */
+static BatchContext *batch_prepare(RequestContext *ctx, const char *body,
+                                   const char **error_message) {
+    TranslationServer *server = ctx->server;
+
+    cJSON *root = cJSON_Parse(body);
+    if (!root) {
+        *error_message = "Invalid JSON";
+        return NULL;
+    }
+
+    /* Accept a bare array or {"items": [...]} */
+    cJSON *array = cJSON_IsArray(root) ? root : cJSON_GetObjectItem(root, "items");
+    if (!cJSON_IsArray(array)) {
+        *error_message = "Batch must be an array of translation requests";
+        cJSON_Delete(root);
+        return NULL;
+    }
+
+    int count = cJSON_GetArraySize(array);
+    if (count < 1 || count > server->config->batch_max_items) {
+        *error_message = "Batch size out of range";
+        cJSON_Delete(root);
+        return NULL;
+    }
+
+    /* Open-addressing index of groups by key digest (group + 1, 0 = empty) */
+    size_t slots = 2;
+    while (slots < (size_t)count * 2) {
+        slots <<= 1;
+    }
+    int *group_index = calloc(slots, sizeof(int));
+
+    BatchContext *batch = calloc(1, sizeof(BatchContext));
+    if (batch) {
+        pthread_mutex_init(&batch->lock, NULL);
+        pthread_cond_init(&batch->done_cond, NULL);
+        batch->items = calloc(count, sizeof(BatchItem));
+        batch->groups = calloc(count, sizeof(BatchGroup));
+        batch->misses = calloc(count, sizeof(int));
+    }
+
+    if (!group_index || !batch || !batch->items || !batch->groups || !batch->misses) {
+        *error_message = "Memory allocation failed";
+        free(group_index);
+        batch_context_free(batch);
+        cJSON_Delete(root);
+        return NULL;
+    }
+
+    batch->ctx = ctx;
+    batch->server = server;
+    batch->max_inflight = server->config->batch_max_concurrency;
+
+    /* Validate items and group identical (from, to, text) */
+    for (int i = 0; i < count; i++) {
+        BatchItem *item = &batch->items[batch->item_count++];
+        item->group = -1;
+        item->req = parse_translation_request_object(cJSON_GetArrayItem(array, i));
+
+        if (item->req && sanitize_request_text(item->req) != 0) {
+            free_translation_request(item->req);
+            item->req = NULL;
+        }
+
+        if (!item->req) {
+            continue;
+        }
+
+        unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+        trans_cache_calculate_digest(item->req->from_lang, item->req->to_lang,
+                                     item->req->text, key);
+
+        uint64_t h;
+        memcpy(&h, key, sizeof(h));
+        size_t slot = (size_t)h & (slots - 1);
+
+        while (group_index[slot] != 0) {
+            int g = group_index[slot] - 1;
+            if (memcmp(batch->groups[g].key, key, sizeof(key)) == 0) {
+                item->group = g;
+                break;
+            }
+            slot = (slot + 1) & (slots - 1);
+        }
+
+        if (item->group < 0) {
+            BatchGroup *group = &batch->groups[batch->group_count];
+            group->batch = batch;
+            group->req = item->req;
+            memcpy(group->key, key, sizeof(group->key));
+            item->group = batch->group_count++;
+            group_index[slot] = batch->group_count;
+        }
+    }
+
+    free(group_index);
+    cJSON_Delete(root);
+
+    /* Single cache pass over unique items */
+    for (int g = 0; g < batch->group_count; g++) {
+        BatchGroup *group = &batch->groups[g];
+
+        if (server->cache) {
+            trans_cache_read_begin(server->cache);
+            CacheEntry *cached = trans_cache_lookup(server->cache, group->req->from_lang,
+                                                    group->req->to_lang, group->req->text);
+
+            if (cached && cached->count >= server->config->cache_threshold) {
+                group->translated_text = strdup(cached->translated_text);
+                if (group->translated_text) {
+                    group->cached = true;
+                    trans_cache_update_count(server->cache, cached);
+                }
+            }
+            trans_cache_read_end(server->cache);
+
+            if (group->cached) {
+                continue;
+            }
+        }
+
+        batch->misses[batch->miss_count++] = g;
+    }
+
+    batch->remaining = batch->miss_count;
+
+    LOG_INFO("[batch] Received %d items (%d unique): %d cache hits, %d upstream",
+            batch->item_count, batch->group_count,
+            batch->group_count - batch->miss_count, batch->miss_count);
+
+    return batch;
+}
+
+/* Batch translation endpoint handler */
+static int handle_translate_batch(struct MHD_Connection *connection, const char *upload_data,
+                                  size_t *upload_data_size, void **con_cls,
+                                  TranslationServer *server) {
+    /* First call - setup connection */
+    if (*con_cls == NULL) {
+        RequestContext *ctx = request_context_create(server, connection);
+        if (!ctx) {
+            return MHD_NO;
+        }
+        *con_cls = ctx;
+        return MHD_YES;
+    }
+
+    RequestContext *ctx = *con_cls;
+
+    /* Resumed after all upstream calls completed - send prepared response */
+    if (ctx->state == REQUEST_STATE_COMPLETE) {
+        return send_prepared_response(ctx);
+    }
+
+    if (ctx->state == REQUEST_STATE_PENDING) {
+        return MHD_YES;
+    }
+
+    /* Accumulate POST data */
+    if (*upload_data_size != 0) {
+        return append_request_body(ctx, upload_data, upload_data_size);
+    }
+
+    const char *error_message = NULL;
+    BatchContext *batch = batch_prepare(ctx, ctx->body ? ctx->body : "", &error_message);
+    free(ctx->body);
+    ctx->body = NULL;
+    ctx->body_size = 0;
+
+    if (!batch) {
+        char *error_json = create_error_response("VALIDATION_ERROR", error_message, NULL);
+        return send_json_response(connection, error_json, MHD_HTTP_UNPROCESSABLE_ENTITY, false);
+    }
+
+    ctx->batch = batch;
+
+    if (batch->miss_count == 0) {
+        /* Everything resolved from cache or failed validation */
+        batch_build_response(batch);
+        return send_prepared_response(ctx);
+    }
+
+    ctx->state = REQUEST_STATE_PENDING;
+    batch->dispatching = true;
+
+    if (server->config->server_mode == SERVER_MODE_THREAD) {
+        /* Thread-per-connection mode cannot suspend; wait on this connection's thread */
+        batch_dispatch(batch);
+
+        pthread_mutex_lock(&batch->lock);
+        while (!batch->done) {
+            pthread_cond_wait(&batch->done_cond, &batch->lock);
+        }
+        pthread_mutex_unlock(&batch->lock);
+
+        return send_prepared_response(ctx);
+    }
+
+    MHD_suspend_connection(connection);
+    batch_dispatch(batch);
+
+    return MHD_YES;
 }
 
 /* Main request handler */
@@ -348,6 +1445,16 @@ static enum MHD_Result request_handler(void *cls, struct MHD_Connection *connect
         return handle_health_check(connection);
     }
 
+    /* Batch translation endpoint */
+    if (strcmp(url, "/translate/batch") == 0 && strcmp(method, "POST") == 0) {
+        return handle_translate_batch(connection, upload_data, upload_data_size, con_cls, server);
+    }
+
+    /* Runtime statistics endpoint */
+    if (strcmp(url, "/stats") == 0 && strcmp(method, "GET") == 0) {
+        return handle_stats(connection, server);
+    }
+
     /* Translation endpoint */
     if (strcmp(url, "/translate") == 0 && strcmp(method, "POST") == 0) {
         return handle_translate(connection, upload_data, upload_data_size, con_cls, server);
@@ -375,7 +1482,7 @@ static void request_completed(void *cls, struct MHD_Connection *connection,
     (void)toe;
 
     if (*con_cls != NULL) {
-        free(*con_cls);
+        request_context_free((RequestContext *)*con_cls);
         *con_cls = NULL;
     }
 }
@@ -404,29 +1511,109 @@ TranslationServer *translation_server_init(Config *config, int max_workers) {
         return NULL;
     }
 
+    /* Coalesce identical in-flight translations */
+    server->flights = singleflight_create();
+    if (!server->flights) {
+        openai_translator_free(server->translator);
+        free(server);
+        return NULL;
+    }
+
+    /* Optional micro-batching of short texts */
+    server->batcher = NULL;
+    if (config->micro_batch_enabled) {
+        server->batcher = micro_batcher_create(server->translator,
+                                               config->micro_batch_window_ms,
+                                               config->micro_batch_max_items,
+                                               config->micro_batch_max_chars);
+        if (!server->batcher) {
+            LOG_INFO("Warning: Micro-batching disabled (initialization failed)");
+        }
+    }
+
     /* Initialize cache */
     server->cache = NULL;
     server->cache_bg_running = false;
 
-    /* Determine cache path based on backend type */
+    /* Determine cache path and options based on backend type */
     const char *cache_path = NULL;
+    const char *cache_label = NULL;     /* cache_path as logged */
+    void *cache_options = NULL;
+    SqliteBackendOptions sqlite_options = {
+        .journal_mode = config->cache_sqlite_journal_mode,
+        .sync_mode = config->cache_sqlite_sync,
+        .read_connections = config->cache_sqlite_readers,
+        .full_mutex = config->cache_sqlite_full_mutex,
+        .page_size = config->cache_sqlite_page_size,
+        .cache_size_kb = config->cache_sqlite_cache_size_kb,
+        .mmap_size = config->cache_sqlite_mmap_size_mb > 0 ?
+                     (long long)config->cache_sqlite_mmap_size_mb * 1024 * 1024 : -1,
+        .temp_store = config->cache_sqlite_temp_store,
+        .busy_timeout_ms = config->cache_sqlite_busy_timeout_ms > 0 ?
+                           config->cache_sqlite_busy_timeout_ms : -1,
+        .checkpoint_mode = config->cache_sqlite_checkpoint
+    };
+    TextBackendOptions text_options = {
+        .max_entries = (size_t)config->cache_max_entries,
+        .max_bytes = (size_t)config->cache_max_mb * 1024 * 1024,
+        .snapshot = config->cache_snapshot,
+        .load_threads = (size_t)config->cache_load_threads
+    };
+    /* Entries unused for the cleanup period expire on the server */
+    RedisBackendOptions redis_options = {
+        .pool_size = config->cache_redis_pool,
+        .timeout_ms = config->cache_redis_timeout_ms,
+        .key_prefix = config->cache_redis_prefix,
+        .ttl_seconds = config->cache_cleanup_enabled ?
+                       (long long)config->cache_cleanup_days * 24 * 60 * 60 : 0
+    };
     switch (config->cache_type) {
         case CACHE_BACKEND_SQLITE:
             cache_path = config->cache_sqlite_path;
+            cache_options = &sqlite_options;
+            break;
+        case CACHE_BACKEND_REDIS:
+            cache_path = config->cache_redis_url;
+            cache_options = &redis_options;
+            /* Keep credentials out of the log */
+            cache_label = strrchr(cache_path, '@') ? strrchr(cache_path, '@') + 1 : NULL;
             break;
         case CACHE_BACKEND_TEXT:
         default:
             cache_path = config->cache_file;
+            cache_options = &text_options;
             break;
     }
 
     if (cache_path) {
-        server->cache = trans_cache_init_with_backend(config->cache_type, cache_path, NULL);
+        server->cache = trans_cache_init_with_backend(config->cache_type, cache_path,
+                                                      cache_options);
         if (!server->cache) {
             LOG_INFO("Warning: Failed to initialize cache, continuing without cache");
         } else {
             LOG_INFO("Translation cache initialized: %s backend at %s (threshold: %d)",
-                    config->cache_type_str, cache_path, config->cache_threshold);
+                    config->cache_type_str, cache_label ? cache_label : cache_path,
+                    config->cache_threshold);
+
+            /* Inserts and translation updates leave the request path */
+            if (config->cache_write_behind) {
+                WriteBehindOptions write_behind_options = {
+                    .capacity = (size_t)config->cache_write_behind_queue,
+                    .interval_ms = config->cache_write_behind_interval_ms,
+                    .batch_size = (size_t)config->cache_write_behind_batch,
+                    .overflow = config->cache_write_behind_overflow
+                };
+                if (trans_cache_enable_write_behind(server->cache, &write_behind_options) != 0) {
+                    LOG_INFO("Warning: Cache write-behind disabled (initialization failed)");
+                }
+            }
+
+            /* Repeated lookups served from memory instead of the database */
+            if (config->cache_l1_size_mb > 0 &&
+                trans_cache_enable_hot_tier(server->cache,
+                                            (size_t)config->cache_l1_size_mb * 1024 * 1024) != 0) {
+                LOG_INFO("Warning: Cache hot tier disabled (initialization failed)");
+            }
 
             /* Always start background thread for periodic cache saving */
             server->cache_bg_running = true;
@@ -441,11 +1628,47 @@ TranslationServer *translation_server_init(Config *config, int max_workers) {
         }
     }
 
-    LOG_INFO("Translation server initialized with %d workers", server->max_workers);
+    LOG_INFO("Translation server initialized with %d workers (mode: %s)",
+            server->max_workers, config->server_mode_str);
 
     return server;
 }
 
+/* Resolve LISTEN address into a socket address for MHD_OPTION_SOCK_ADDR */
+static int build_listen_address(const char *listen, int port,
+                                struct sockaddr_storage *addr, bool *is_ipv6) {
+    memset(addr, 0, sizeof(*addr));
+    *is_ipv6 = false;
+
+    struct sockaddr_in *addr4 = (struct sockaddr_in *)addr;
+    if (inet_pton(AF_INET, listen, &addr4->sin_addr) == 1) {
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons((uint16_t)port);
+        return 0;
+    }
+
+    /* Accept both "::1" and "[::1]" forms for IPv6 */
+    char ipv6_buf[INET6_ADDRSTRLEN];
+    const char *ipv6_str = listen;
+    size_t listen_len = strlen(listen);
+    if (listen_len > 2 && listen[0] == '[' && listen[listen_len - 1] == ']' &&
+        listen_len - 2 < sizeof(ipv6_buf)) {
+        memcpy(ipv6_buf, listen + 1, listen_len - 2);
+        ipv6_buf[listen_len - 2] = '\0';
+        ipv6_str = ipv6_buf;
+    }
+
+    struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)addr;
+    if (inet_pton(AF_INET6, ipv6_str, &addr6->sin6_addr) == 1) {
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons((uint16_t)port);
+        *is_ipv6 = true;
+        return 0;
+    }
+
+    return -1;
+}
+
 /* Start translation server */
 int translation_server_start(TranslationServer *server) {
     if (!server) {
@@ -453,26 +1676,79 @@ int translation_server_start(TranslationServer *server) {
         return -1;
     }
 
-    LOG_INFO("Starting HTTP server on %s:%d...",
-            server->config->listen, server->config->port);
+    const Config *config = server->config;
+
+    LOG_INFO("Starting HTTP server on %s:%d...", config->listen, config->port);
+
+    struct sockaddr_storage listen_addr;
+    bool is_ipv6 = false;
+    if (build_listen_address(config->listen, config->port, &listen_addr, &is_ipv6) != 0) {
+        LOG_INFO("Error: Invalid LISTEN address '%s' (expected IPv4 or IPv6 literal)",
+                config->listen);
+        return -1;
+    }
+
+    unsigned int flags = MHD_USE_ERROR_LOG;
+    if (is_ipv6) {
+        flags |= MHD_USE_IPv6;
+    }
+
+    if (config->server_mode == SERVER_MODE_THREAD) {
+        flags |= MHD_USE_THREAD_PER_CONNECTION | MHD_USE_INTERNAL_POLLING_THREAD;
+
+        server->daemon = MHD_start_daemon(
+            flags,
+            (uint16_t)config->port,
+            NULL, NULL,
+            &request_handler, server,
+            MHD_OPTION_NOTIFY_COMPLETED, &request_completed, NULL,
+            MHD_OPTION_SOCK_ADDR, (struct sockaddr *)&listen_addr,
+            MHD_OPTION_CONNECTION_LIMIT, config->max_connections,
+            MHD_OPTION_PER_IP_CONNECTION_LIMIT, config->per_ip_connection_limit,
+            MHD_OPTION_CONNECTION_TIMEOUT, config->connection_timeout,
+            MHD_OPTION_END
+        );
+    } else {
+        /* Fixed pool of internal polling threads, each running its own epoll loop;
+         * connections are suspended while their upstream call is in flight */
+        flags |= MHD_ALLOW_SUSPEND_RESUME;
 
-    server->daemon = MHD_start_daemon(
-        MHD_USE_THREAD_PER_CONNECTION,
-        server->config->port,
-        NULL, NULL,
-        &request_handler, server,
-        MHD_OPTION_NOTIFY_COMPLETED, &request_completed, NULL,
-        MHD_OPTION_CONNECTION_TIMEOUT, (unsigned int)120,
-        MHD_OPTION_END
-    );
+        if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES) {
+            flags |= MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_EPOLL;
+        } else {
+            LOG_INFO("Warning: epoll not supported by libmicrohttpd, using best available poller");
+            flags |= MHD_USE_AUTO_INTERNAL_THREAD;
+        }
+
+        server->daemon = MHD_start_daemon(
+            flags,
+            (uint16_t)config->port,
+            NULL, NULL,
+            &request_handler, server,
+            MHD_OPTION_NOTIFY_COMPLETED, &request_completed, NULL,
+            MHD_OPTION_SOCK_ADDR, (struct sockaddr *)&listen_addr,
+            MHD_OPTION_THREAD_POOL_SIZE, (unsigned int)server->max_workers,
+            MHD_OPTION_CONNECTION_LIMIT, config->max_connections,
+            MHD_OPTION_PER_IP_CONNECTION_LIMIT, config->per_ip_connection_limit,
+            MHD_OPTION_CONNECTION_TIMEOUT, config->connection_timeout,
+            MHD_OPTION_END
+        );
+    }
 
     if (!server->daemon) {
         LOG_INFO("Error: Failed to start HTTP server");
         return -1;
     }
 
-    LOG_INFO("HTTP server started successfully on %s:%d",
-            server->config->listen, server->config->port);
+    if (config->server_mode == SERVER_MODE_THREAD) {
+        LOG_INFO("HTTP server started successfully on %s:%d (mode: thread-per-connection, max connections: %u, per-IP limit: %u)",
+                config->listen, config->port,
+                config->max_connections, config->per_ip_connection_limit);
+    } else {
+        LOG_INFO("HTTP server started successfully on %s:%d (mode: epoll, %d worker threads, max connections: %u, per-IP limit: %u)",
+                config->listen, config->port, server->max_workers,
+                config->max_connections, config->per_ip_connection_limit);
+    }
 
     return 0;
 }
@@ -486,6 +1762,17 @@ void translation_server_stop(TranslationServer *server) {
     LOG_INFO("Stopping HTTP server...");
 
     if (server->daemon) {
+        /* Stop accepting, then let suspended connections receive their
+         * upstream results before the daemon is torn down */
+        MHD_quiesce_daemon(server->daemon);
+
+        /* Send texts still waiting for their batch window */
+        micro_batcher_shutdown(server->batcher);
+
+        if (server->translator) {
+            openai_translator_shutdown(server->translator);
+        }
+
         MHD_stop_daemon(server->daemon);
         server->daemon = NULL;
     }
@@ -517,9 +1804,14 @@ void translation_server_free(TranslationServer *server) {
         LOG_INFO("Translation cache saved and freed");
     }
 
+    micro_batcher_free(server->batcher);
+
     if (server->translator) {
         openai_translator_free(server->translator);
     }
 
+    /* Translator is gone, so no flight can complete any more */
+    singleflight_free(server->flights);
+
     free(server);
 }
@@ -13,23 +13,16 @@
 #define MAX_TEXT_LENGTH 10000
 #define MIN_TEXT_LENGTH 1
 
-/* Parse translation request from JSON string */
-TranslationRequest *parse_translation_request(const char *json_str) {
-    if (!json_str) {
-        fprintf(stderr, "Error: NULL JSON string\n");
-        return NULL;
-    }
-
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
-        fprintf(stderr, "Error: Failed to parse JSON: %s\n", cJSON_GetErrorPtr());
+/* Parse translation request from parsed JSON object */
+TranslationRequest *parse_translation_request_object(const cJSON *root) {
+    if (!cJSON_IsObject(root)) {
+        fprintf(stderr, "Error: Translation request is not a JSON object\n");
         return NULL;
     }
 
     TranslationRequest *req = calloc(1, sizeof(TranslationRequest));
     if (!req) {
         fprintf(stderr, "Error: Memory allocation failed\n");
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -38,14 +31,12 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!cJSON_IsString(timestamp) || !timestamp->valuestring) {
         fprintf(stderr, "Error: Missing or invalid 'timestamp' field\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
     if (!validate_timestamp(timestamp->valuestring)) {
         fprintf(stderr, "Error: Invalid timestamp format: %s\n", timestamp->valuestring);
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -56,14 +47,12 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!cJSON_IsString(uuid) || !uuid->valuestring) {
         fprintf(stderr, "Error: Missing or invalid 'uuid' field\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
     if (!validate_uuid(uuid->valuestring)) {
         fprintf(stderr, "Error: Invalid UUID format: %s\n", uuid->valuestring);
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -74,7 +63,6 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!cJSON_IsString(from) || !from->valuestring) {
         fprintf(stderr, "Error: Missing or invalid 'from' field\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -83,7 +71,6 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!from_code) {
         fprintf(stderr, "Error: Invalid 'from' language code or name: %s\n", from->valuestring);
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -94,7 +81,6 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!cJSON_IsString(to) || !to->valuestring) {
         fprintf(stderr, "Error: Missing or invalid 'to' field\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -103,7 +89,6 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!to_code) {
         fprintf(stderr, "Error: Invalid 'to' language code or name: %s\n", to->valuestring);
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -114,7 +99,6 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!cJSON_IsString(text) || !text->valuestring) {
         fprintf(stderr, "Error: Missing or invalid 'text' field\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -123,14 +107,12 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (text_len < MIN_TEXT_LENGTH) {
         fprintf(stderr, "Error: Text is empty or too short\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
     if (text_len > MAX_TEXT_LENGTH) {
         fprintf(stderr, "Error: Text is too long (max %d characters)\n", MAX_TEXT_LENGTH);
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
@@ -138,11 +120,28 @@ TranslationRequest *parse_translation_request(const char *json_str) {
     if (!req->text) {
         fprintf(stderr, "Error: Memory allocation failed for text\n");
         free(req);
-        cJSON_Delete(root);
         return NULL;
     }
 
+    return req;
+}
+
+/* Parse translation request from JSON string */
+TranslationRequest *parse_translation_request(const char *json_str) {
+    if (!json_str) {
+        fprintf(stderr, "Error: NULL JSON string\n");
+        return NULL;
+    }
+
+    cJSON *root = cJSON_Parse(json_str);
+    if (!root) {
+        fprintf(stderr, "Error: Failed to parse JSON: %s\n", cJSON_GetErrorPtr());
+        return NULL;
+    }
+
+    TranslationRequest *req = parse_translation_request_object(root);
     cJSON_Delete(root);
+
     return req;
 }
 
@@ -156,8 +155,8 @@ void free_translation_request(TranslationRequest *req) {
     free(req);
 }
 
-/* Create translation response JSON */
-char *create_translation_response(const TranslationRequest *req, const char *translated_text) {
+/* Create translation response JSON object */
+cJSON *create_translation_response_object(const TranslationRequest *req, const char *translated_text) {
     if (!req || !translated_text) {
         fprintf(stderr, "Error: NULL request or translated text\n");
         return NULL;
@@ -178,6 +177,16 @@ char *create_translation_response(const TranslationRequest *req, const char *tra
     /* Add translated text */
     cJSON_AddStringToObject(root, "translatedText", translated_text);
 
+    return root;
+}
+
+/* Create translation response JSON */
+char *create_translation_response(const TranslationRequest *req, const char *translated_text) {
+    cJSON *root = create_translation_response_object(req, translated_text);
+    if (!root) {
+        return NULL;
+    }
+
     /* Convert to string */
     char *json_str = cJSON_PrintUnformatted(root);
     cJSON_Delete(root);
@@ -190,8 +199,8 @@ char *create_translation_response(const TranslationRequest *req, const char *tra
     return json_str;
 }
 
-/* Create error response JSON */
-char *create_error_response(const char *error_code, const char *error_message, const char *uuid) {
+/* Create error response JSON object */
+cJSON *create_error_response_object(const char *error_code, const char *error_message, const char *uuid) {
     if (!error_code || !error_message) {
         fprintf(stderr, "Error: NULL error code or message\n");
         return NULL;
@@ -220,6 +229,16 @@ char *create_error_response(const char *error_code, const char *error_message, c
         cJSON_AddStringToObject(root, "timestamp", timestamp);
     }
 
+    return root;
+}
+
+/* Create error response JSON */
+char *create_error_response(const char *error_code, const char *error_message, const char *uuid) {
+    cJSON *root = create_error_response_object(error_code, error_message, uuid);
+    if (!root) {
+        return NULL;
+    }
+
     /* Convert to string */
     char *json_str = cJSON_PrintUnformatted(root);
     cJSON_Delete(root);
@@ -64,11 +64,9 @@ static void signal_handler(int signum) {
     LOG_INFO("Received signal %s (%d), shutting down gracefully...",
             signame, signum);
 
+    /* Server is stopped from the main loop: stopping drains in-flight
+     * upstream calls, which must not run inside a signal handler */
     g_shutdown = true;
-
-    if (g_server) {
-        translation_server_stop(g_server);
-    }
 }
 
 /* Setup signal handlers */
@@ -114,12 +112,12 @@ static void print_usage(const char *program_name) {
     printf("  -c, --config PATH       Path to configuration file (default: transbasket.conf)\n");
     printf("  -p, --prompt PATH       Path to prompt prefix file (default: PROMPT_PREFIX.txt)\n");
     printf("  -r, --role PATH         Path to system role file (default: ROLS.txt)\n");
-    printf("  -w, --workers NUM       Number of worker threads (default: 30)\n");
+    printf("  -w, --workers NUM       Number of HTTP worker threads in epoll mode (default: 30)\n");
     printf("  -d, --daemon            Run as daemon in background\n");
     printf("  -h, --help              Show this help message\n\n");
     printf("Environment Variables:\n");
     printf("  TRANSBASKET_CONFIG      Config file path\n");
-    printf("  MAX_WORKERS             Thread pool size\n\n");
+    printf("  MAX_WORKERS             HTTP worker thread pool size\n\n");
     printf("Examples:\n");
     printf("  %s\n", program_name);
     printf("  %s -c /etc/transbasket.conf -w 20\n", program_name);
@@ -223,6 +221,7 @@ int main(int argc, char *argv[]) {
         LOG_INFO("  Base URL: %s", config->openai_base_url);
         LOG_INFO("  Model: %s", config->openai_model);
         LOG_INFO("  Listen: %s:%d", config->listen, config->port);
+        LOG_INFO("  Server mode: %s", config->server_mode_str);
         LOG_INFO("  Workers: %d", max_workers);
         printf("\n");
     }
@@ -0,0 +1,532 @@
+/**
+ * Micro-batcher module for transbasket.
+ * Packs short cache-miss texts of the same language pair into a single
+ * chat completion so the system role and instructions are sent once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include "micro_batcher.h"
+#include "utils.h"
+
+/* Pending text waiting for its batch */
+typedef struct BatchEntry {
+    char *text;
+    char *request_uuid;
+    char *timestamp;
+    TranslationCallback callback;
+    void *user_data;
+    struct BatchEntry *next;
+} BatchEntry;
+
+/* Pending texts of one (from, to) pair */
+typedef struct PairQueue {
+    char from_lang[4];
+    char to_lang[4];
+    BatchEntry *head;
+    BatchEntry *tail;
+    int count;
+    long long deadline_ms;          /* Flush time of the current window */
+    struct PairQueue *next;
+} PairQueue;
+
+/* Batch detached from its queue, owned by the flushing thread */
+typedef struct {
+    MicroBatcher *batcher;
+    char from_lang[4];
+    char to_lang[4];
+    BatchEntry **entries;
+    int count;
+} FlushBatch;
+
+struct MicroBatcher {
+    OpenAITranslator *translator;
+    int window_ms;
+    int max_items;
+    int max_chars;
+
+    pthread_mutex_t lock;           /* Protects queues, flags and stats */
+    pthread_cond_t cond;            /* Wakes window timer thread */
+    pthread_t timer_thread;
+    bool timer_started;
+    bool running;
+    PairQueue *queues;
+
+    /* Statistics (under lock) */
+    size_t pending;
+    unsigned long long batches;         /* Multi-item upstream calls */
+    unsigned long long batched_items;   /* Items sent in multi-item calls */
+    unsigned long long single_flushes;  /* Windows that closed with one item */
+    unsigned long long fallback_items;  /* Items retried individually after a bad split */
+    unsigned long long split_failures;  /* Multi-item calls with at least one bad item */
+};
+
+/* Monotonic clock in milliseconds */
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Free entry (callback and user_data are not touched) */
+static void free_batch_entry(BatchEntry *entry) {
+    if (!entry) {
+        return;
+    }
+
+    free(entry->text);
+    free(entry->request_uuid);
+    free(entry->timestamp);
+    free(entry);
+}
+
+/* Free detached batch and any entries left in it */
+static void free_flush_batch(FlushBatch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        free_batch_entry(batch->entries[i]);
+    }
+    free(batch->entries);
+    free(batch);
+}
+
+/* Fail entry with message */
+static void fail_entry(BatchEntry *entry, const char *message, bool retryable, int status_code) {
+    TranslationError error = {
+        .message = strdup(message),
+        .retryable = retryable,
+        .status_code = status_code
+    };
+    entry->callback(NULL, &error, entry->user_data);
+}
+
+/* Send one entry as an ordinary single-text translation */
+static void translate_entry_individually(MicroBatcher *batcher, const char *from_lang,
+                                         const char *to_lang, BatchEntry *entry) {
+    if (openai_translate_async(batcher->translator, from_lang, to_lang, entry->text,
+                               entry->request_uuid, entry->timestamp,
+                               entry->callback, entry->user_data) != 0) {
+        fail_entry(entry, "Translation service unavailable", true, 0);
+    }
+}
+
+/* Detach queued entries of a pair into a flush batch (called with lock held) */
+static FlushBatch *detach_queue(MicroBatcher *batcher, PairQueue *queue) {
+    FlushBatch *batch = calloc(1, sizeof(FlushBatch));
+    BatchEntry **entries = calloc(queue->count, sizeof(BatchEntry *));
+
+    if (!batch || !entries) {
+        free(batch);
+        free(entries);
+        return NULL;
+    }
+
+    batch->batcher = batcher;
+    memcpy(batch->from_lang, queue->from_lang, sizeof(batch->from_lang));
+    memcpy(batch->to_lang, queue->to_lang, sizeof(batch->to_lang));
+    batch->entries = entries;
+
+    for (BatchEntry *entry = queue->head; entry; entry = entry->next) {
+        batch->entries[batch->count++] = entry;
+    }
+
+    batcher->pending -= queue->count;
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->count = 0;
+    queue->deadline_ms = 0;
+
+    return batch;
+}
+
+/* Multi-item upstream completion */
+static void on_multi_complete(char **translated_texts, int count, TranslationError *error,
+                              void *user_data) {
+    FlushBatch *batch = (FlushBatch *)user_data;
+    MicroBatcher *batcher = batch->batcher;
+
+    if (!translated_texts) {
+        /* Upstream failed for the whole batch - every item gets the error */
+        for (int i = 0; i < batch->count; i++) {
+            BatchEntry *entry = batch->entries[i];
+            TranslationError item_error = {
+                .message = NULL,
+                .retryable = error ? error->retryable : true,
+                .status_code = error ? error->status_code : 0
+            };
+
+            if (error && error->message) {
+                item_error.message = strdup(error->message);
+            }
+
+            entry->callback(NULL, &item_error, entry->user_data);
+        }
+
+        if (error) {
+            free(error->message);
+            error->message = NULL;
+        }
+
+        free_flush_batch(batch);
+        return;
+    }
+
+    int fallbacks = 0;
+
+    for (int i = 0; i < batch->count && i < count; i++) {
+        BatchEntry *entry = batch->entries[i];
+
+        if (translated_texts[i]) {
+            entry->callback(translated_texts[i], NULL, entry->user_data);
+        } else {
+            /* Item could not be split out reliably - translate it alone */
+            fallbacks++;
+            translate_entry_individually(batcher, batch->from_lang, batch->to_lang, entry);
+        }
+    }
+
+    if (fallbacks > 0) {
+        LOG_INFO("Micro-batch split failed for %d/%d items (%s -> %s), retrying individually",
+                fallbacks, batch->count, batch->from_lang, batch->to_lang);
+
+        pthread_mutex_lock(&batcher->lock);
+        batcher->split_failures++;
+        batcher->fallback_items += fallbacks;
+        pthread_mutex_unlock(&batcher->lock);
+    }
+
+    free(translated_texts);
+    free_flush_batch(batch);
+}
+
+/* Send a detached batch upstream */
+static void flush_batch(MicroBatcher *batcher, FlushBatch *batch) {
+    if (batch->count == 1) {
+        pthread_mutex_lock(&batcher->lock);
+        batcher->single_flushes++;
+        pthread_mutex_unlock(&batcher->lock);
+
+        translate_entry_individually(batcher, batch->from_lang, batch->to_lang,
+                                     batch->entries[0]);
+        free_flush_batch(batch);
+        return;
+    }
+
+    const char **texts = calloc(batch->count, sizeof(char *));
+    if (texts) {
+        for (int i = 0; i < batch->count; i++) {
+            texts[i] = batch->entries[i]->text;
+        }
+    }
+
+    BatchEntry *first = batch->entries[0];
+
+    if (texts && openai_translate_multi_async(batcher->translator, batch->from_lang,
+                                              batch->to_lang, texts, batch->count,
+                                              first->request_uuid, first->timestamp,
+                                              on_multi_complete, batch) == 0) {
+        pthread_mutex_lock(&batcher->lock);
+        batcher->batches++;
+        batcher->batched_items += batch->count;
+        pthread_mutex_unlock(&batcher->lock);
+
+        free(texts);
+        return;
+    }
+
+    free(texts);
+
+    /* Could not start the combined call - send items on their own */
+    for (int i = 0; i < batch->count; i++) {
+        translate_entry_individually(batcher, batch->from_lang, batch->to_lang,
+                                     batch->entries[i]);
+    }
+    free_flush_batch(batch);
+}
+
+/* Window timer thread - flushes queues whose window has closed */
+static void *micro_batcher_timer_thread(void *arg) {
+    MicroBatcher *batcher = (MicroBatcher *)arg;
+
+    pthread_mutex_lock(&batcher->lock);
+
+    while (batcher->running) {
+        long long now = monotonic_ms();
+        long long next_deadline = 0;
+        FlushBatch *due[64];
+        int due_count = 0;
+
+        for (PairQueue *queue = batcher->queues; queue; queue = queue->next) {
+            if (queue->count == 0) {
+                continue;
+            }
+
+            if (queue->deadline_ms <= now && due_count < (int)(sizeof(due) / sizeof(due[0]))) {
+                FlushBatch *batch = detach_queue(batcher, queue);
+                if (batch) {
+                    due[due_count++] = batch;
+                    continue;
+                }
+            }
+
+            if (next_deadline == 0 || queue->deadline_ms < next_deadline) {
+                next_deadline = queue->deadline_ms;
+            }
+        }
+
+        if (due_count > 0) {
+            pthread_mutex_unlock(&batcher->lock);
+            for (int i = 0; i < due_count; i++) {
+                flush_batch(batcher, due[i]);
+            }
+            pthread_mutex_lock(&batcher->lock);
+            continue;
+        }
+
+        if (next_deadline == 0) {
+            pthread_cond_wait(&batcher->cond, &batcher->lock);
+        } else {
+            struct timespec ts;
+            ts.tv_sec = next_deadline / 1000;
+            ts.tv_nsec = (next_deadline % 1000) * 1000000;
+            pthread_cond_timedwait(&batcher->cond, &batcher->lock, &ts);
+        }
+    }
+
+    pthread_mutex_unlock(&batcher->lock);
+    return NULL;
+}
+
+/* Create micro-batcher */
+MicroBatcher *micro_batcher_create(OpenAITranslator *translator, int window_ms,
+                                   int max_items, int max_chars) {
+    if (!translator) {
+        return NULL;
+    }
+
+    MicroBatcher *batcher = calloc(1, sizeof(MicroBatcher));
+    if (!batcher) {
+        LOG_INFO("Error: Memory allocation failed for micro-batcher");
+        return NULL;
+    }
+
+    batcher->translator = translator;
+    batcher->window_ms = window_ms > 0 ? window_ms : 5;
+    batcher->max_items = max_items > 1 ? max_items : 2;
+    batcher->max_chars = max_chars > 0 ? max_chars : 200;
+    batcher->running = true;
+
+    /* Window deadlines use the monotonic clock */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&batcher->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&batcher->lock, NULL);
+
+    if (pthread_create(&batcher->timer_thread, NULL, micro_batcher_timer_thread, batcher) != 0) {
+        LOG_INFO("Error: Failed to start micro-batcher timer thread");
+        micro_batcher_free(batcher);
+        return NULL;
+    }
+    batcher->timer_started = true;
+
+    LOG_INFO("Micro-batching enabled: window %d ms, max %d items, texts up to %d chars",
+            batcher->window_ms, batcher->max_items, batcher->max_chars);
+
+    return batcher;
+}
+
+/* True if text is short enough to be micro-batched */
+bool micro_batcher_accepts(MicroBatcher *batcher, const char *text) {
+    return batcher && text && utf8_strlen(text) <= (size_t)batcher->max_chars;
+}
+
+/* Queue text for its language pair */
+int micro_batcher_submit(MicroBatcher *batcher, const char *from_lang, const char *to_lang,
+                         const char *text, const char *request_uuid, const char *timestamp,
+                         TranslationCallback callback, void *user_data) {
+    if (!batcher || !from_lang || !to_lang || !text || !request_uuid ||
+        !timestamp || !callback) {
+        return -1;
+    }
+
+    BatchEntry *entry = calloc(1, sizeof(BatchEntry));
+    if (!entry) {
+        return -1;
+    }
+
+    entry->text = strdup(text);
+    entry->request_uuid = strdup(request_uuid);
+    entry->timestamp = strdup(timestamp);
+    entry->callback = callback;
+    entry->user_data = user_data;
+
+    if (!entry->text || !entry->request_uuid || !entry->timestamp) {
+        free_batch_entry(entry);
+        return -1;
+    }
+
+    pthread_mutex_lock(&batcher->lock);
+
+    if (!batcher->running) {
+        pthread_mutex_unlock(&batcher->lock);
+        free_batch_entry(entry);
+        return -1;
+    }
+
+    PairQueue *queue = batcher->queues;
+    while (queue && (strcmp(queue->from_lang, from_lang) != 0 ||
+                     strcmp(queue->to_lang, to_lang) != 0)) {
+        queue = queue->next;
+    }
+
+    if (!queue) {
+        queue = calloc(1, sizeof(PairQueue));
+        if (!queue) {
+            pthread_mutex_unlock(&batcher->lock);
+            free_batch_entry(entry);
+            return -1;
+        }
+        snprintf(queue->from_lang, sizeof(queue->from_lang), "%s", from_lang);
+        snprintf(queue->to_lang, sizeof(queue->to_lang), "%s", to_lang);
+        queue->next = batcher->queues;
+        batcher->queues = queue;
+    }
+
+    if (queue->tail) {
+        queue->tail->next = entry;
+    } else {
+        queue->head = entry;
+    }
+    queue->tail = entry;
+    queue->count++;
+    batcher->pending++;
+
+    FlushBatch *full = NULL;
+
+    if (queue->count == 1) {
+        /* First item opens the window */
+        queue->deadline_ms = monotonic_ms() + batcher->window_ms;
+        pthread_cond_signal(&batcher->cond);
+    } else if (queue->count >= batcher->max_items) {
+        full = detach_queue(batcher, queue);
+    }
+
+    pthread_mutex_unlock(&batcher->lock);
+
+    /* Full batch is sent from the submitting thread without waiting for the window */
+    if (full) {
+        flush_batch(batcher, full);
+    }
+
+    return 0;
+}
+
+/* Flush everything and stop the timer */
+void micro_batcher_shutdown(MicroBatcher *batcher) {
+    if (!batcher) {
+        return;
+    }
+
+    pthread_mutex_lock(&batcher->lock);
+    batcher->running = false;
+    pthread_cond_broadcast(&batcher->cond);
+    pthread_mutex_unlock(&batcher->lock);
+
+    if (batcher->timer_started) {
+        pthread_join(batcher->timer_thread, NULL);
+        batcher->timer_started = false;
+    }
+
+    /* Send whatever is still waiting for its window */
+    while (1) {
+        FlushBatch *batch = NULL;
+
+        pthread_mutex_lock(&batcher->lock);
+        for (PairQueue *queue = batcher->queues; queue; queue = queue->next) {
+            if (queue->count > 0) {
+                batch = detach_queue(batcher, queue);
+                break;
+            }
+        }
+        pthread_mutex_unlock(&batcher->lock);
+
+        if (!batch) {
+            break;
+        }
+
+        flush_batch(batcher, batch);
+    }
+}
+
+/* Free micro-batcher */
+void micro_batcher_free(MicroBatcher *batcher) {
+    if (!batcher) {
+        return;
+    }
+
+    micro_batcher_shutdown(batcher);
+
+    PairQueue *queue = batcher->queues;
+    while (queue) {
+        PairQueue *next = queue->next;
+
+        /* Only left over if a flush allocation failed */
+        BatchEntry *entry = queue->head;
+        while (entry) {
+            BatchEntry *next_entry = entry->next;
+            fail_entry(entry, "Server shutting down", true, 0);
+            free_batch_entry(entry);
+            entry = next_entry;
+        }
+
+        free(queue);
+        queue = next;
+    }
+
+    pthread_cond_destroy(&batcher->cond);
+    pthread_mutex_destroy(&batcher->lock);
+    free(batcher);
+}
+
+/* Batching metrics */
+cJSON *micro_batcher_stats(MicroBatcher *batcher) {
+    if (!batcher) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&batcher->lock);
+    size_t pending = batcher->pending;
+    unsigned long long batches = batcher->batches;
+    unsigned long long batched_items = batcher->batched_items;
+    unsigned long long single_flushes = batcher->single_flushes;
+    unsigned long long fallback_items = batcher->fallback_items;
+    unsigned long long split_failures = batcher->split_failures;
+    pthread_mutex_unlock(&batcher->lock);
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) {
+        return NULL;
+    }
+
+    cJSON_AddNumberToObject(stats, "window_ms", batcher->window_ms);
+    cJSON_AddNumberToObject(stats, "max_items", batcher->max_items);
+    cJSON_AddNumberToObject(stats, "pending", (double)pending);
+    cJSON_AddNumberToObject(stats, "batches", (double)batches);
+    cJSON_AddNumberToObject(stats, "batched_items", (double)batched_items);
+    cJSON_AddNumberToObject(stats, "avg_batch_size",
+                            batches ? (double)batched_items / (double)batches : 0.0);
+    cJSON_AddNumberToObject(stats, "single_flushes", (double)single_flushes);
+    cJSON_AddNumberToObject(stats, "split_failures", (double)split_failures);
+    cJSON_AddNumberToObject(stats, "fallback_items", (double)fallback_items);
+
+    return stats;
+}
@@ -0,0 +1,492 @@
+/**
+ * Request template module for transbasket.
+ * Serializes the chat completion request once per (from, to) pair so that
+ * each call only splices the escaped source text between fixed fragments.
+ * Identical prompt bytes also let upstream prompt caching hit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "request_template.h"
+#include "utils.h"
+
+#define TEMPLATE_BUCKETS 256
+#define SOURCE_PLACEHOLDER "\x01TRANSBASKET_SOURCE\x01"
+#define SOURCE_PLACEHOLDER_JSON "\\u0001TRANSBASKET_SOURCE\\u0001"  /* As printed by cJSON */
+
+/* Serialized prefix of one (from, to) pair */
+typedef struct PairTemplate {
+    char from_lang[4];
+    char to_lang[4];
+    char *prefix[REQUEST_TEMPLATE_KIND_COUNT];
+    size_t prefix_len[REQUEST_TEMPLATE_KIND_COUNT];
+    struct PairTemplate *next;
+} PairTemplate;
+
+struct RequestTemplates {
+    const Config *config;
+
+    /* Tail after the source text, per kind and stream flag */
+    char *suffix[REQUEST_TEMPLATE_KIND_COUNT][2];
+    size_t suffix_len[REQUEST_TEMPLATE_KIND_COUNT][2];
+
+    PairTemplate *buckets[TEMPLATE_BUCKETS];
+    pthread_rwlock_t lock;          /* Pairs are immutable once inserted */
+
+    /* Statistics */
+    size_t pairs;                   /* Under lock */
+    size_t prefix_bytes;            /* Under lock */
+    atomic_ullong built;
+};
+
+/* Replace all occurrences of a substring */
+static char *str_replace(const char *orig, const char *rep, const char *with) {
+    char *result;
+    char *ins;
+    char *tmp;
+    int len_rep;
+    int len_with;
+    int len_front;
+    int count;
+
+    if (!orig || !rep)
+        return NULL;
+    len_rep = strlen(rep);
+    if (len_rep == 0)
+        return NULL;
+    if (!with)
+        with = "";
+    len_with = strlen(with);
+
+    ins = (char *)orig;
+    for (count = 0; (tmp = strstr(ins, rep)); ++count) {
+        ins = tmp + len_rep;
+    }
+
+    tmp = result = malloc(strlen(orig) + (len_with - len_rep) * count + 1);
+
+    if (!result)
+        return NULL;
+
+    while (count--) {
+        ins = strstr(orig, rep);
+        len_front = ins - orig;
+        tmp = strncpy(tmp, orig, len_front) + len_front;
+        tmp = strcpy(tmp, with) + len_with;
+        orig += len_front + len_rep;
+    }
+    strcpy(tmp, orig);
+    return result;
+}
+
+/* Build translation instruction message from PROMPT_PREFIX */
+static char *build_instruction_message(const Config *config, const char *to_lang,
+                                       const char *format_note) {
+    const char *to_name = get_language_name(to_lang);
+    if (!to_name) to_name = to_lang;
+
+    /* Use PROMPT_PREFIX as the instruction message */
+    char *instruction = strdup(config->prompt_prefix);
+    if (!instruction) {
+        return NULL;
+    }
+
+    /* Replace [TARGET LANGUAGE] with actual target language name */
+    char *temp = str_replace(instruction, "[TARGET LANGUAGE]", to_name);
+    if (temp) {
+        free(instruction);
+        instruction = temp;
+    }
+
+    /* Also try replacing {{LANGUAGE_TO}} for backward compatibility */
+    temp = str_replace(instruction, "{{LANGUAGE_TO}}", to_name);
+    if (temp) {
+        free(instruction);
+        instruction = temp;
+    }
+
+    /* Multi-item requests describe the numbered output format */
+    if (format_note) {
+        size_t len = strlen(instruction) + strlen(format_note) + 3;
+        char *combined = malloc(len);
+        if (combined) {
+            snprintf(combined, len, "%s\n\n%s", instruction, format_note);
+        }
+        free(instruction);
+        instruction = combined;
+    }
+
+    return instruction;
+}
+
+/* Source message content around the placeholder for kind */
+static const char *placeholder_content(RequestTemplateKind kind) {
+    return kind == REQUEST_TEMPLATE_SINGLE ?
+           "<source>" SOURCE_PLACEHOLDER "</source>" : SOURCE_PLACEHOLDER;
+}
+
+/* Serialize a full request with the placeholder as source text.
+ * The stream flag is the last key so that the prefix does not depend on it. */
+static char *serialize_request(const Config *config, const char *from_lang,
+                               const char *to_lang, RequestTemplateKind kind,
+                               bool stream) {
+    char *instruction = build_instruction_message(config, to_lang,
+                                                  kind == REQUEST_TEMPLATE_MULTI ?
+                                                  MULTI_ITEM_FORMAT_NOTE : NULL);
+    if (!instruction) {
+        return NULL;
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        free(instruction);
+        return NULL;
+    }
+
+    cJSON_AddStringToObject(root, "model", config->openai_model);
+
+    /* Add reasoning object (always included) */
+    cJSON *reasoning = cJSON_CreateObject();
+    cJSON_AddStringToObject(reasoning, "effort", config->reasoning_effort);
+    cJSON_AddItemToObject(root, "reasoning", reasoning);
+
+    cJSON_AddNumberToObject(root, "temperature", config->temperature);
+    cJSON_AddNumberToObject(root, "top_p", config->top_p);
+    cJSON_AddNumberToObject(root, "seed", config->seed);
+    cJSON_AddNumberToObject(root, "frequency_penalty", config->frequency_penalty);
+    cJSON_AddNumberToObject(root, "presence_penalty", config->presence_penalty);
+
+    cJSON *messages = cJSON_CreateArray();
+
+    /* Message 1: System role */
+    cJSON *system_message = cJSON_CreateObject();
+    cJSON_AddStringToObject(system_message, "role", "system");
+    cJSON_AddStringToObject(system_message, "content", config->system_role);
+    cJSON_AddItemToArray(messages, system_message);
+
+    /* Message 2: Translation instructions with PROMPT_PREFIX */
+    cJSON *instruction_message = cJSON_CreateObject();
+    cJSON_AddStringToObject(instruction_message, "role", "user");
+    cJSON_AddStringToObject(instruction_message, "content", instruction);
+    cJSON_AddItemToArray(messages, instruction_message);
+
+    /* Message 3: Language direction */
+    const char *from_name = get_language_name(from_lang);
+    const char *to_name = get_language_name(to_lang);
+    char language_info[256];
+    snprintf(language_info, sizeof(language_info), "Translate FROM %s TO %s",
+             from_name ? from_name : from_lang, to_name ? to_name : to_lang);
+    cJSON *language_message = cJSON_CreateObject();
+    cJSON_AddStringToObject(language_message, "role", "user");
+    cJSON_AddStringToObject(language_message, "content", language_info);
+    cJSON_AddItemToArray(messages, language_message);
+
+    /* Message 4: Text to translate (placeholder, spliced per request) */
+    cJSON *text_message = cJSON_CreateObject();
+    cJSON_AddStringToObject(text_message, "role", "user");
+    cJSON_AddStringToObject(text_message, "content", placeholder_content(kind));
+    cJSON_AddItemToArray(messages, text_message);
+
+    cJSON_AddItemToObject(root, "messages", messages);
+    cJSON_AddBoolToObject(root, "stream", stream);
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    free(instruction);
+
+    return json;
+}
+
+/* Position of the placeholder in serialized JSON (last occurrence, as the
+ * source message comes after all configurable text) */
+static char *find_placeholder(char *json) {
+    char *found = NULL;
+
+    for (char *p = strstr(json, SOURCE_PLACEHOLDER_JSON); p;
+         p = strstr(p + 1, SOURCE_PLACEHOLDER_JSON)) {
+        found = p;
+    }
+
+    return found;
+}
+
+/* Create template set */
+RequestTemplates *request_templates_create(const Config *config) {
+    if (!config) {
+        return NULL;
+    }
+
+    RequestTemplates *templates = calloc(1, sizeof(RequestTemplates));
+    if (!templates) {
+        LOG_INFO("Error: Memory allocation failed for request templates");
+        return NULL;
+    }
+
+    templates->config = config;
+    pthread_rwlock_init(&templates->lock, NULL);
+    atomic_init(&templates->built, 0);
+
+    /* Suffixes only depend on kind and stream flag */
+    for (int kind = 0; kind < REQUEST_TEMPLATE_KIND_COUNT; kind++) {
+        for (int stream = 0; stream < 2; stream++) {
+            char *json = serialize_request(config, "eng", "eng", kind, stream);
+            char *placeholder = json ? find_placeholder(json) : NULL;
+
+            if (!placeholder) {
+                LOG_INFO("Error: Failed to serialize request template");
+                free(json);
+                request_templates_free(templates);
+                return NULL;
+            }
+
+            const char *tail = placeholder + strlen(SOURCE_PLACEHOLDER_JSON);
+            templates->suffix[kind][stream] = strdup(tail);
+            templates->suffix_len[kind][stream] = strlen(tail);
+            free(json);
+
+            if (!templates->suffix[kind][stream]) {
+                request_templates_free(templates);
+                return NULL;
+            }
+        }
+    }
+
+    return templates;
+}
+
+/* Bucket for a language pair */
+static size_t pair_index(const char *from_lang, const char *to_lang) {
+    unsigned int hash = 2166136261u;
+
+    for (const unsigned char *p = (const unsigned char *)from_lang; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    hash = (hash ^ '|') * 16777619u;
+    for (const unsigned char *p = (const unsigned char *)to_lang; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+
+    return hash % TEMPLATE_BUCKETS;
+}
+
+/* Find pair (caller holds lock) */
+static PairTemplate *find_pair(RequestTemplates *templates, size_t index,
+                               const char *from_lang, const char *to_lang) {
+    for (PairTemplate *pair = templates->buckets[index]; pair; pair = pair->next) {
+        if (strcmp(pair->from_lang, from_lang) == 0 && strcmp(pair->to_lang, to_lang) == 0) {
+            return pair;
+        }
+    }
+    return NULL;
+}
+
+/* Free pair */
+static void free_pair(PairTemplate *pair) {
+    for (int kind = 0; kind < REQUEST_TEMPLATE_KIND_COUNT; kind++) {
+        free(pair->prefix[kind]);
+    }
+    free(pair);
+}
+
+/* Serialize prefixes of a new pair */
+static PairTemplate *compile_pair(const Config *config, const char *from_lang,
+                                  const char *to_lang) {
+    PairTemplate *pair = calloc(1, sizeof(PairTemplate));
+    if (!pair) {
+        return NULL;
+    }
+
+    snprintf(pair->from_lang, sizeof(pair->from_lang), "%s", from_lang);
+    snprintf(pair->to_lang, sizeof(pair->to_lang), "%s", to_lang);
+
+    for (int kind = 0; kind < REQUEST_TEMPLATE_KIND_COUNT; kind++) {
+        char *json = serialize_request(config, from_lang, to_lang, kind, false);
+        char *placeholder = json ? find_placeholder(json) : NULL;
+
+        if (!placeholder) {
+            free(json);
+            free_pair(pair);
+            return NULL;
+        }
+
+        /* Keep everything before the placeholder */
+        *placeholder = '\0';
+        pair->prefix_len[kind] = (size_t)(placeholder - json);
+        pair->prefix[kind] = realloc(json, pair->prefix_len[kind] + 1);
+        if (!pair->prefix[kind]) {
+            free(json);
+            free_pair(pair);
+            return NULL;
+        }
+    }
+
+    return pair;
+}
+
+/* Cached pair, compiled on first use */
+static PairTemplate *get_pair(RequestTemplates *templates, const char *from_lang,
+                              const char *to_lang) {
+    size_t index = pair_index(from_lang, to_lang);
+
+    pthread_rwlock_rdlock(&templates->lock);
+    PairTemplate *pair = find_pair(templates, index, from_lang, to_lang);
+    pthread_rwlock_unlock(&templates->lock);
+
+    if (pair) {
+        return pair;
+    }
+
+    /* Serialize outside the lock; a concurrent first use may win the insert */
+    PairTemplate *compiled = compile_pair(templates->config, from_lang, to_lang);
+    if (!compiled) {
+        return NULL;
+    }
+
+    pthread_rwlock_wrlock(&templates->lock);
+    pair = find_pair(templates, index, from_lang, to_lang);
+    if (!pair) {
+        compiled->next = templates->buckets[index];
+        templates->buckets[index] = compiled;
+        templates->pairs++;
+        for (int kind = 0; kind < REQUEST_TEMPLATE_KIND_COUNT; kind++) {
+            templates->prefix_bytes += compiled->prefix_len[kind];
+        }
+        pair = compiled;
+        compiled = NULL;
+    }
+    pthread_rwlock_unlock(&templates->lock);
+
+    if (compiled) {
+        free_pair(compiled);
+    }
+
+    LOG_DEBUG("Request template ready for %s -> %s", from_lang, to_lang);
+    return pair;
+}
+
+/* Length of text as a JSON string body (without quotes) */
+static size_t json_escaped_length(const unsigned char *text) {
+    size_t len = 0;
+
+    for (const unsigned char *p = text; *p; p++) {
+        switch (*p) {
+            case '"': case '\\': case '\b': case '\f':
+            case '\n': case '\r': case '\t':
+                len += 2;
+                break;
+            default:
+                len += (*p < 0x20) ? 6 : 1;
+                break;
+        }
+    }
+
+    return len;
+}
+
+/* Write text as a JSON string body (same escaping as cJSON) */
+static char *json_escape_into(char *out, const unsigned char *text) {
+    for (const unsigned char *p = text; *p; p++) {
+        switch (*p) {
+            case '"': *out++ = '\\'; *out++ = '"'; break;
+            case '\\': *out++ = '\\'; *out++ = '\\'; break;
+            case '\b': *out++ = '\\'; *out++ = 'b'; break;
+            case '\f': *out++ = '\\'; *out++ = 'f'; break;
+            case '\n': *out++ = '\\'; *out++ = 'n'; break;
+            case '\r': *out++ = '\\'; *out++ = 'r'; break;
+            case '\t': *out++ = '\\'; *out++ = 't'; break;
+            default:
+                if (*p < 0x20) {
+                    out += sprintf(out, "\\u%04x", *p);
+                } else {
+                    *out++ = (char)*p;
+                }
+                break;
+        }
+    }
+
+    return out;
+}
+
+/* Assemble request body */
+char *request_templates_build(RequestTemplates *templates, RequestTemplateKind kind,
+                              const char *from_lang, const char *to_lang,
+                              const char *source, bool stream) {
+    if (!templates || !from_lang || !to_lang || !source ||
+        (int)kind < 0 || kind >= REQUEST_TEMPLATE_KIND_COUNT) {
+        return NULL;
+    }
+
+    PairTemplate *pair = get_pair(templates, from_lang, to_lang);
+    if (!pair) {
+        return NULL;
+    }
+
+    const char *suffix = templates->suffix[kind][stream ? 1 : 0];
+    size_t suffix_len = templates->suffix_len[kind][stream ? 1 : 0];
+    size_t source_len = json_escaped_length((const unsigned char *)source);
+
+    char *body = malloc(pair->prefix_len[kind] + source_len + suffix_len + 1);
+    if (!body) {
+        return NULL;
+    }
+
+    memcpy(body, pair->prefix[kind], pair->prefix_len[kind]);
+    char *out = json_escape_into(body + pair->prefix_len[kind], (const unsigned char *)source);
+    memcpy(out, suffix, suffix_len + 1);
+
+    atomic_fetch_add(&templates->built, 1);
+
+    return body;
+}
+
+/* Template metrics */
+cJSON *request_templates_stats(RequestTemplates *templates) {
+    if (!templates) {
+        return NULL;
+    }
+
+    pthread_rwlock_rdlock(&templates->lock);
+    size_t pairs = templates->pairs;
+    size_t prefix_bytes = templates->prefix_bytes;
+    pthread_rwlock_unlock(&templates->lock);
+    unsigned long long built = atomic_load(&templates->built);
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) {
+        return NULL;
+    }
+
+    cJSON_AddNumberToObject(stats, "pairs", (double)pairs);
+    cJSON_AddNumberToObject(stats, "prefix_bytes", (double)prefix_bytes);
+    cJSON_AddNumberToObject(stats, "bodies_built", (double)built);
+
+    return stats;
+}
+
+/* Free template set */
+void request_templates_free(RequestTemplates *templates) {
+    if (!templates) {
+        return;
+    }
+
+    for (size_t i = 0; i < TEMPLATE_BUCKETS; i++) {
+        PairTemplate *pair = templates->buckets[i];
+        while (pair) {
+            PairTemplate *next = pair->next;
+            free_pair(pair);
+            pair = next;
+        }
+    }
+
+    for (int kind = 0; kind < REQUEST_TEMPLATE_KIND_COUNT; kind++) {
+        for (int stream = 0; stream < 2; stream++) {
+            free(templates->suffix[kind][stream]);
+        }
+    }
+
+    pthread_rwlock_destroy(&templates->lock);
+    free(templates);
+}
@@ -0,0 +1,316 @@
+/**
+ * Singleflight module for transbasket.
+ * Coalesces identical in-flight translations so that concurrent requests
+ * for the same (from, to, text) share one upstream call.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "singleflight.h"
+#include "utils.h"
+
+#define SINGLEFLIGHT_BUCKETS 1024
+#define SINGLEFLIGHT_KEY_SIZE 65
+
+/* Waiter attached to a flight */
+typedef struct FlightWaiter {
+    TranslationCallback callback;
+    void *user_data;
+    long long joined_ms;            /* Monotonic join time (followers only) */
+    bool follower;
+    struct FlightWaiter *next;
+} FlightWaiter;
+
+/* One in-flight key */
+typedef struct Flight {
+    char key[SINGLEFLIGHT_KEY_SIZE];
+    FlightWaiter *waiters;          /* Leader first, followers after */
+    FlightWaiter *waiters_tail;
+    size_t waiter_count;
+    struct Flight *next;
+} Flight;
+
+struct SingleFlight {
+    Flight *buckets[SINGLEFLIGHT_BUCKETS];
+    pthread_mutex_t lock;
+
+    /* Statistics (under lock) */
+    size_t inflight;
+    size_t peak_inflight;
+    size_t max_waiters;
+    unsigned long long leaders;
+    unsigned long long followers;
+    unsigned long long errors_fanned_out;
+    unsigned long long followers_completed;
+    unsigned long long follower_wait_ms_total;
+    unsigned long long follower_wait_ms_max;
+};
+
+/* Monotonic clock in milliseconds */
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* FNV-1a over the key string */
+static size_t bucket_index(const char *key) {
+    unsigned int hash = 2166136261u;
+
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+
+    return hash % SINGLEFLIGHT_BUCKETS;
+}
+
+/* Create in-flight table */
+SingleFlight *singleflight_create(void) {
+    SingleFlight *sf = calloc(1, sizeof(SingleFlight));
+    if (!sf) {
+        LOG_INFO("Error: Memory allocation failed for singleflight table");
+        return NULL;
+    }
+
+    pthread_mutex_init(&sf->lock, NULL);
+    return sf;
+}
+
+/* Free flight and its waiters */
+static void free_flight(Flight *flight) {
+    FlightWaiter *waiter = flight->waiters;
+
+    while (waiter) {
+        FlightWaiter *next = waiter->next;
+        free(waiter);
+        waiter = next;
+    }
+
+    free(flight);
+}
+
+/* Free in-flight table */
+void singleflight_free(SingleFlight *sf) {
+    if (!sf) {
+        return;
+    }
+
+    for (size_t i = 0; i < SINGLEFLIGHT_BUCKETS; i++) {
+        Flight *flight = sf->buckets[i];
+
+        while (flight) {
+            Flight *next = flight->next;
+            free_flight(flight);
+            flight = next;
+        }
+    }
+
+    pthread_mutex_destroy(&sf->lock);
+    free(sf);
+}
+
+/* Join the flight for key, creating it if absent */
+SingleFlightRole singleflight_join(SingleFlight *sf, const char *key,
+                                   TranslationCallback callback, void *user_data) {
+    if (!sf || !key || !callback) {
+        return SINGLEFLIGHT_ERROR;
+    }
+
+    FlightWaiter *waiter = calloc(1, sizeof(FlightWaiter));
+    if (!waiter) {
+        return SINGLEFLIGHT_ERROR;
+    }
+
+    waiter->callback = callback;
+    waiter->user_data = user_data;
+
+    size_t index = bucket_index(key);
+
+    pthread_mutex_lock(&sf->lock);
+
+    Flight *flight = sf->buckets[index];
+    while (flight && strcmp(flight->key, key) != 0) {
+        flight = flight->next;
+    }
+
+    if (flight) {
+        /* Attach to running flight */
+        waiter->follower = true;
+        waiter->joined_ms = monotonic_ms();
+
+        flight->waiters_tail->next = waiter;
+        flight->waiters_tail = waiter;
+        flight->waiter_count++;
+
+        sf->followers++;
+        if (flight->waiter_count > sf->max_waiters) {
+            sf->max_waiters = flight->waiter_count;
+        }
+
+        pthread_mutex_unlock(&sf->lock);
+        return SINGLEFLIGHT_FOLLOWER;
+    }
+
+    flight = calloc(1, sizeof(Flight));
+    if (!flight) {
+        pthread_mutex_unlock(&sf->lock);
+        free(waiter);
+        return SINGLEFLIGHT_ERROR;
+    }
+
+    snprintf(flight->key, sizeof(flight->key), "%s", key);
+    flight->waiters = waiter;
+    flight->waiters_tail = waiter;
+    flight->waiter_count = 1;
+    flight->next = sf->buckets[index];
+    sf->buckets[index] = flight;
+
+    sf->leaders++;
+    sf->inflight++;
+    if (sf->inflight > sf->peak_inflight) {
+        sf->peak_inflight = sf->inflight;
+    }
+
+    pthread_mutex_unlock(&sf->lock);
+    return SINGLEFLIGHT_LEADER;
+}
+
+/* Complete flight and deliver result to all waiters */
+void singleflight_complete(SingleFlight *sf, const char *key,
+                           char *translated_text, TranslationError *error) {
+    if (!sf || !key) {
+        free(translated_text);
+        if (error) {
+            free(error->message);
+            error->message = NULL;
+        }
+        return;
+    }
+
+    size_t index = bucket_index(key);
+
+    pthread_mutex_lock(&sf->lock);
+
+    /* Unlink so new arrivals start a fresh flight (and see the updated cache) */
+    Flight **pos = &sf->buckets[index];
+    while (*pos && strcmp((*pos)->key, key) != 0) {
+        pos = &(*pos)->next;
+    }
+
+    Flight *flight = *pos;
+    if (flight) {
+        *pos = flight->next;
+        sf->inflight--;
+
+        long long now = monotonic_ms();
+        for (FlightWaiter *w = flight->waiters; w; w = w->next) {
+            if (w->follower) {
+                sf->followers_completed++;
+                unsigned long long waited = (unsigned long long)(now - w->joined_ms);
+                sf->follower_wait_ms_total += waited;
+                if (waited > sf->follower_wait_ms_max) {
+                    sf->follower_wait_ms_max = waited;
+                }
+            }
+        }
+
+        if (!translated_text && flight->waiter_count > 1) {
+            sf->errors_fanned_out += flight->waiter_count - 1;
+        }
+    }
+
+    pthread_mutex_unlock(&sf->lock);
+
+    if (!flight) {
+        LOG_INFO("Warning: singleflight completion for unknown key %s", key);
+        free(translated_text);
+        if (error) {
+            free(error->message);
+            error->message = NULL;
+        }
+        return;
+    }
+
+    /* Fan out outside the lock; the last waiter takes the original buffers */
+    for (FlightWaiter *w = flight->waiters; w; w = w->next) {
+        bool last = (w->next == NULL);
+
+        if (translated_text) {
+            char *copy = last ? translated_text : strdup(translated_text);
+            if (copy) {
+                w->callback(copy, NULL, w->user_data);
+                continue;
+            }
+
+            TranslationError oom = {
+                .message = strdup("Memory allocation failed"),
+                .retryable = true,
+                .status_code = 0
+            };
+            w->callback(NULL, &oom, w->user_data);
+            continue;
+        }
+
+        TranslationError waiter_error = {
+            .message = NULL,
+            .retryable = error ? error->retryable : true,
+            .status_code = error ? error->status_code : 0
+        };
+
+        if (error && error->message) {
+            waiter_error.message = last ? error->message : strdup(error->message);
+        }
+
+        w->callback(NULL, &waiter_error, w->user_data);
+    }
+
+    if (error && !translated_text) {
+        error->message = NULL;  /* Handed to the last waiter */
+    }
+
+    free_flight(flight);
+}
+
+/* Coalescing metrics */
+cJSON *singleflight_stats(SingleFlight *sf) {
+    if (!sf) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&sf->lock);
+    size_t inflight = sf->inflight;
+    size_t peak_inflight = sf->peak_inflight;
+    size_t max_waiters = sf->max_waiters;
+    unsigned long long leaders = sf->leaders;
+    unsigned long long followers = sf->followers;
+    unsigned long long errors_fanned_out = sf->errors_fanned_out;
+    unsigned long long followers_completed = sf->followers_completed;
+    unsigned long long wait_total = sf->follower_wait_ms_total;
+    unsigned long long wait_max = sf->follower_wait_ms_max;
+    pthread_mutex_unlock(&sf->lock);
+
+    unsigned long long joined = leaders + followers;
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) {
+        return NULL;
+    }
+
+    cJSON_AddNumberToObject(stats, "inflight", (double)inflight);
+    cJSON_AddNumberToObject(stats, "peak_inflight", (double)peak_inflight);
+    cJSON_AddNumberToObject(stats, "leaders", (double)leaders);
+    cJSON_AddNumberToObject(stats, "followers", (double)followers);
+    cJSON_AddNumberToObject(stats, "coalesce_rate",
+                            joined ? (double)followers / (double)joined : 0.0);
+    cJSON_AddNumberToObject(stats, "max_waiters", (double)max_waiters);
+    cJSON_AddNumberToObject(stats, "errors_fanned_out", (double)errors_fanned_out);
+    cJSON_AddNumberToObject(stats, "avg_follower_wait_ms",
+                            followers_completed ?
+                            (double)wait_total / (double)followers_completed : 0.0);
+    cJSON_AddNumberToObject(stats, "max_follower_wait_ms", (double)wait_max);
+
+    return stats;
+}
@@ -0,0 +1,521 @@
+/**
+ * SSE parser module for transbasket.
+ * Decodes chat completion streams ("data: {json}" events) incrementally,
+ * as bytes arrive from the upstream, into a growable output buffer.
+ * choices[0].delta.content is picked out of each event by a scanner that
+ * builds no JSON tree; cJSON only handles events it does not recognize.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <cjson/cJSON.h>
+#include "sse_parser.h"
+#include "utils.h"
+
+#define INITIAL_LINE_CAPACITY 1024
+#define INITIAL_OUTPUT_CAPACITY 256
+#define MAX_SKIP_DEPTH 64               /* Nesting the scanner skips over */
+
+struct SseParser {
+    SseDeltaCallback callback;
+    void *user_data;
+
+    /* Current (incomplete) line; only one line is ever buffered */
+    char *line;
+    size_t line_len;
+    size_t line_cap;
+    bool skip_lf;                   /* Last chunk ended in CR; drop a leading LF */
+
+    /* Accumulated delta content */
+    char *output;
+    size_t output_len;
+    size_t output_cap;
+
+    /* Decoded content of an event with escapes */
+    char *scratch;
+    size_t scratch_cap;
+
+    bool done;
+    bool failed;
+    size_t deltas;
+    long long first_delta_at;
+};
+
+/* Monotonic clock in milliseconds */
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Grow buffer to hold at least needed bytes */
+static int ensure_capacity(char **buffer, size_t *capacity, size_t needed, size_t initial) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+
+    size_t new_capacity = *capacity ? *capacity : initial;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    char *ptr = realloc(*buffer, new_capacity);
+    if (!ptr) {
+        return -1;
+    }
+
+    *buffer = ptr;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/* Create parser */
+SseParser *sse_parser_create(SseDeltaCallback callback, void *user_data) {
+    SseParser *parser = calloc(1, sizeof(SseParser));
+    if (!parser) {
+        LOG_DEBUG("Error: Memory allocation failed for SSE parser\n");
+        return NULL;
+    }
+
+    parser->callback = callback;
+    parser->user_data = user_data;
+    return parser;
+}
+
+/* Reset parser state, keeping allocated buffers */
+void sse_parser_reset(SseParser *parser) {
+    if (!parser) {
+        return;
+    }
+
+    parser->line_len = 0;
+    parser->skip_lf = false;
+    parser->output_len = 0;
+    if (parser->output) {
+        parser->output[0] = '\0';
+    }
+    parser->done = false;
+    parser->failed = false;
+    parser->deltas = 0;
+    parser->first_delta_at = 0;
+}
+
+/* Append content delta and report progress */
+static int append_delta(SseParser *parser, const char *delta, size_t len) {
+    if (ensure_capacity(&parser->output, &parser->output_cap,
+                        parser->output_len + len + 1, INITIAL_OUTPUT_CAPACITY) != 0) {
+        LOG_DEBUG("Error: Memory allocation failed for SSE output\n");
+        return -1;
+    }
+
+    memcpy(parser->output + parser->output_len, delta, len);
+    parser->output_len += len;
+    parser->output[parser->output_len] = '\0';
+
+    parser->deltas++;
+    if (parser->deltas == 1) {
+        parser->first_delta_at = monotonic_ms();
+    }
+
+    if (parser->callback &&
+        parser->callback(delta, len, parser->deltas, parser->user_data) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Skip JSON whitespace */
+static const char *skip_space(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+    return p;
+}
+
+/* Scan a JSON string from after its opening quote. Returns the position
+ * after the closing quote, or NULL if unterminated. */
+static const char *scan_string(const char *p, const char *end, bool *escaped) {
+    *escaped = false;
+    while (p < end) {
+        if (*p == '"') {
+            return p + 1;
+        }
+        if (*p == '\\') {
+            *escaped = true;
+            p += 2;
+        } else {
+            p++;
+        }
+    }
+    return NULL;
+}
+
+/* Skip the JSON value at p. Returns the position after it, or NULL. */
+static const char *skip_value(const char *p, const char *end) {
+    bool escaped;
+
+    if (p < end && *p == '"') {
+        return scan_string(p + 1, end, &escaped);
+    }
+    if (p < end && (*p == '{' || *p == '[')) {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                p = scan_string(p + 1, end, &escaped);
+                if (!p) {
+                    return NULL;
+                }
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                if (++depth > MAX_SKIP_DEPTH) {
+                    return NULL;
+                }
+            } else if ((*p == '}' || *p == ']') && --depth == 0) {
+                return p + 1;
+            }
+            p++;
+        }
+        return NULL;
+    }
+
+    /* Number or literal */
+    const char *start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+           *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+        p++;
+    }
+    return p > start ? p : NULL;
+}
+
+/* Value of member name in the object at p (at its '{'), or NULL if the
+ * object has none. Sets *malformed if the object could not be scanned up to
+ * the member (or to its end); keys with escapes count as malformed too. */
+static const char *member_value(const char *p, const char *end, const char *name,
+                                bool *malformed) {
+    size_t name_len = strlen(name);
+
+    *malformed = true;
+    p = skip_space(p + 1, end);
+    if (p < end && *p == '}') {
+        *malformed = false;
+        return NULL;
+    }
+
+    while (p < end && *p == '"') {
+        bool escaped;
+        const char *key = p + 1;
+        p = scan_string(key, end, &escaped);
+        if (!p || escaped) {
+            return NULL;
+        }
+        size_t key_len = (size_t)(p - 1 - key);
+
+        p = skip_space(p, end);
+        if (p == end || *p != ':') {
+            return NULL;
+        }
+        p = skip_space(p + 1, end);
+
+        if (key_len == name_len && memcmp(key, name, name_len) == 0) {
+            *malformed = p == end;
+            return *malformed ? NULL : p;
+        }
+
+        p = skip_value(p, end);
+        if (!p) {
+            return NULL;
+        }
+        p = skip_space(p, end);
+        if (p < end && *p == '}') {
+            *malformed = false;
+            return NULL;
+        }
+        if (p == end || *p != ',') {
+            return NULL;
+        }
+        p = skip_space(p + 1, end);
+    }
+
+    return NULL;
+}
+
+/* Find choices[0].delta.content in the event without parsing it whole.
+ * Returns 1 with the raw string body in *text / *len, 0 if the event has no
+ * content string, -1 if it is not a shape the scanner knows (the rest of
+ * the event after the content is not validated). */
+static int scan_content(const char *payload, size_t payload_len,
+                        const char **text, size_t *len, bool *escaped) {
+    const char *end = payload + payload_len;
+    const char *p = skip_space(payload, end);
+    bool malformed;
+
+    if (p == end || *p != '{') {
+        return -1;
+    }
+
+    const char *choices = member_value(p, end, "choices", &malformed);
+    if (!choices) {
+        return malformed ? -1 : 0;
+    }
+    if (*choices != '[') {
+        return 0;
+    }
+
+    const char *choice = skip_space(choices + 1, end);
+    if (choice == end || *choice != '{') {
+        return choice < end && *choice == ']' ? 0 : -1;
+    }
+
+    const char *delta = member_value(choice, end, "delta", &malformed);
+    if (!delta) {
+        return malformed ? -1 : 0;
+    }
+    if (*delta != '{') {
+        return 0;
+    }
+
+    const char *content = member_value(delta, end, "content", &malformed);
+    if (!content) {
+        return malformed ? -1 : 0;
+    }
+    if (*content != '"') {
+        return 0;           /* null on role-only and final events */
+    }
+
+    const char *close = scan_string(content + 1, end, escaped);
+    if (!close) {
+        return -1;
+    }
+
+    *text = content + 1;
+    *len = (size_t)(close - 1 - *text);
+    return 1;
+}
+
+/* Append the content of a scanned event, decoding escapes if it has any.
+ * Returns 0, 1 if the escapes are malformed, -1 on failure. */
+static int append_scanned(SseParser *parser, const char *text, size_t len, bool escaped) {
+    if (!escaped) {
+        return len > 0 ? append_delta(parser, text, len) : 0;
+    }
+
+    if (ensure_capacity(&parser->scratch, &parser->scratch_cap, len + 1,
+                        INITIAL_OUTPUT_CAPACITY) != 0) {
+        LOG_DEBUG("Error: Memory allocation failed for SSE output\n");
+        return -1;
+    }
+
+    long decoded = json_unescape(text, len, parser->scratch);
+    if (decoded < 0) {
+        return 1;
+    }
+
+    return decoded > 0 ? append_delta(parser, parser->scratch, (size_t)decoded) : 0;
+}
+
+/* Handle one "data:" payload (NUL-terminated) */
+static int process_data(SseParser *parser, const char *payload) {
+    if (strcmp(payload, "[DONE]") == 0) {
+        parser->done = true;
+        return 0;
+    }
+
+    const char *text;
+    size_t len;
+    bool escaped;
+    int found = scan_content(payload, strlen(payload), &text, &len, &escaped);
+    if (found == 0) {
+        return 0;
+    }
+    if (found > 0) {
+        int ret = append_scanned(parser, text, len, escaped);
+        if (ret <= 0) {
+            return ret;
+        }
+    }
+
+    /* Unusual event: let cJSON decide */
+    cJSON *json = cJSON_Parse(payload);
+    if (!json) {
+        LOG_DEBUG("Failed to parse SSE JSON chunk\n");
+        return 0;
+    }
+
+    int ret = 0;
+
+    /* Extract content from choices[0].delta.content */
+    cJSON *choices = cJSON_GetObjectItem(json, "choices");
+    if (cJSON_IsArray(choices) && cJSON_GetArraySize(choices) > 0) {
+        cJSON *first_choice = cJSON_GetArrayItem(choices, 0);
+        cJSON *delta = cJSON_GetObjectItem(first_choice, "delta");
+        cJSON *content = delta ? cJSON_GetObjectItem(delta, "content") : NULL;
+
+        /* Role-only and empty deltas carry no text */
+        if (cJSON_IsString(content) && content->valuestring && content->valuestring[0]) {
+            ret = append_delta(parser, content->valuestring, strlen(content->valuestring));
+        }
+    }
+
+    cJSON_Delete(json);
+    return ret;
+}
+
+/* Handle one complete line (NUL-terminated, without line terminator) */
+static int process_line(SseParser *parser, char *line) {
+    /* Empty line ends an event; comments start with ':' */
+    if (line[0] == '\0' || line[0] == ':') {
+        return 0;
+    }
+
+    /* event:, id: and retry: fields carry nothing we need */
+    if (strncmp(line, "data:", 5) != 0) {
+        return 0;
+    }
+
+    char *payload = line + 5;
+    if (*payload == ' ') {
+        payload++;
+    }
+
+    return process_data(parser, payload);
+}
+
+/* Consume bytes as they arrive */
+int sse_parser_feed(SseParser *parser, const char *data, size_t len) {
+    if (!parser || (!data && len > 0) || parser->failed) {
+        return -1;
+    }
+
+    size_t pos = 0;
+
+    if (parser->skip_lf && len > 0) {
+        parser->skip_lf = false;
+        if (data[0] == '\n') {
+            pos = 1;
+        }
+    }
+
+    while (pos < len && !parser->done) {
+        /* Find next line terminator in this chunk */
+        size_t end = pos;
+        while (end < len && data[end] != '\n' && data[end] != '\r') {
+            end++;
+        }
+
+        size_t piece = end - pos;
+        if (ensure_capacity(&parser->line, &parser->line_cap,
+                            parser->line_len + piece + 1, INITIAL_LINE_CAPACITY) != 0) {
+            LOG_DEBUG("Error: Memory allocation failed for SSE line buffer\n");
+            parser->failed = true;
+            return -1;
+        }
+
+        memcpy(parser->line + parser->line_len, data + pos, piece);
+        parser->line_len += piece;
+
+        if (end == len) {
+            /* Line continues in the next chunk */
+            break;
+        }
+
+        parser->line[parser->line_len] = '\0';
+        parser->line_len = 0;
+
+        /* CRLF: swallow the LF, possibly at the start of the next chunk */
+        pos = end + 1;
+        if (data[end] == '\r') {
+            if (pos < len) {
+                if (data[pos] == '\n') {
+                    pos++;
+                }
+            } else {
+                parser->skip_lf = true;
+            }
+        }
+
+        if (process_line(parser, parser->line) != 0) {
+            parser->failed = true;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Process trailing unterminated line */
+int sse_parser_finish(SseParser *parser) {
+    if (!parser || parser->failed) {
+        return -1;
+    }
+
+    if (parser->line_len == 0 || parser->done) {
+        return 0;
+    }
+
+    parser->line[parser->line_len] = '\0';
+    parser->line_len = 0;
+
+    if (process_line(parser, parser->line) != 0) {
+        parser->failed = true;
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Accumulated delta content */
+const char *sse_parser_output(const SseParser *parser, size_t *len) {
+    if (!parser) {
+        return NULL;
+    }
+
+    if (len) {
+        *len = parser->output_len;
+    }
+    return parser->output ? parser->output : "";
+}
+
+/* Detach accumulated content */
+char *sse_parser_take_output(SseParser *parser) {
+    if (!parser || parser->output_len == 0) {
+        return NULL;
+    }
+
+    char *output = parser->output;
+    parser->output = NULL;
+    parser->output_len = 0;
+    parser->output_cap = 0;
+
+    return output;
+}
+
+/* True once [DONE] has been seen */
+bool sse_parser_done(const SseParser *parser) {
+    return parser && parser->done;
+}
+
+/* Number of content deltas */
+size_t sse_parser_delta_count(const SseParser *parser) {
+    return parser ? parser->deltas : 0;
+}
+
+/* Time of first content delta */
+long long sse_parser_first_delta_at(const SseParser *parser) {
+    return parser ? parser->first_delta_at : 0;
+}
+
+/* Free parser */
+void sse_parser_free(SseParser *parser) {
+    if (!parser) {
+        return;
+    }
+
+    free(parser->line);
+    free(parser->output);
+    free(parser->scratch);
+    free(parser);
+}
@@ -11,14 +11,17 @@
 #include "trans_cache.h"
 #include "cache_backend_text.h"
 #include "cache_backend_sqlite.h"
+#include "cache_backend_redis.h"
+#include "cache_write_behind.h"
+#include "cache_hot_tier.h"
+#include "epoch.h"
 #include "utils.h"
 
-/* Calculate SHA256 hash for cache key (public utility) */
-void trans_cache_calculate_hash(const char *from_lang,
-                                const char *to_lang,
-                                const char *text,
-                                char *hash_out) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
+/* Calculate binary SHA256 digest for cache key (public utility) */
+void trans_cache_calculate_digest(const char *from_lang,
+                                  const char *to_lang,
+                                  const char *text,
+                                  unsigned char *digest_out) {
     SHA256_CTX sha256;
 
     SHA256_Init(&sha256);
@@ -27,39 +30,137 @@ void trans_cache_calculate_hash(const char *from_lang,
     SHA256_Update(&sha256, to_lang, strlen(to_lang));
     SHA256_Update(&sha256, "|", 1);
     SHA256_Update(&sha256, text, strlen(text));
-    SHA256_Final(hash, &sha256);
+    SHA256_Final(digest_out, &sha256);
+}
+
+/* Convert digest to lowercase hex string */
+void trans_cache_digest_to_hex(const unsigned char *digest, char *hash_out) {
+    static const char hex[] = "0123456789abcdef";
+
+    for (int i = 0; i < TRANS_CACHE_DIGEST_SIZE; i++) {
+        hash_out[i * 2] = hex[digest[i] >> 4];
+        hash_out[i * 2 + 1] = hex[digest[i] & 0x0F];
+    }
+    hash_out[TRANS_CACHE_DIGEST_SIZE * 2] = '\0';
+}
 
-    /* Convert to hex string */
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        sprintf(hash_out + (i * 2), "%02x", hash[i]);
+/* Value of a hex digit plus one (0: not a hex digit) */
+static const unsigned char hex_values[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+    ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16
+};
+
+/* Decode hex hash into digest */
+int trans_cache_hex_to_digest(const char *hash, unsigned char *digest_out) {
+    if (!hash) {
+        return -1;
     }
-    hash_out[64] = '\0';
+
+    const unsigned char *hex = (const unsigned char *)hash;
+    for (int i = 0; i < TRANS_CACHE_DIGEST_SIZE; i++) {
+        unsigned int high = hex_values[hex[i * 2]];
+        unsigned int low = high ? hex_values[hex[i * 2 + 1]] : 0;
+        if (!low) {
+            return -1;
+        }
+        digest_out[i] = (unsigned char)(((high - 1) << 4) | (low - 1));
+    }
+
+    return hash[TRANS_CACHE_DIGEST_SIZE * 2] == '\0' ? 0 : -1;
+}
+
+/* Calculate SHA256 hash for cache key (public utility) */
+void trans_cache_calculate_hash(const char *from_lang,
+                                const char *to_lang,
+                                const char *text,
+                                char *hash_out) {
+    unsigned char digest[TRANS_CACHE_DIGEST_SIZE];
+
+    trans_cache_calculate_digest(from_lang, to_lang, text, digest);
+    trans_cache_digest_to_hex(digest, hash_out);
+}
+
+/* Interned language codes; id 0 is reserved for "unknown". Codes are only
+ * appended, so reading an id that was handed out needs no lock. */
+#define MAX_LANG_IDS 256
+#define MAX_LANG_CODE_LENGTH 7
+
+static char lang_codes[MAX_LANG_IDS][MAX_LANG_CODE_LENGTH + 1];
+static int lang_code_count = 1;
+static pthread_mutex_t lang_codes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Intern language code */
+uint8_t trans_cache_lang_id(const char *lang_code) {
+    if (!lang_code || !lang_code[0] || strlen(lang_code) > MAX_LANG_CODE_LENGTH) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&lang_codes_lock);
+
+    uint8_t id = 0;
+    for (int i = 1; i < lang_code_count; i++) {
+        if (strcmp(lang_codes[i], lang_code) == 0) {
+            id = (uint8_t)i;
+            break;
+        }
+    }
+
+    if (id == 0 && lang_code_count < MAX_LANG_IDS) {
+        strcpy(lang_codes[lang_code_count], lang_code);
+        id = (uint8_t)lang_code_count++;
+    }
+
+    pthread_mutex_unlock(&lang_codes_lock);
+
+    if (id == 0) {
+        LOG_INFO("Warning: Language code table full, cannot intern '%s'\n", lang_code);
+    }
+    return id;
+}
+
+/* Language code for interned id */
+const char *trans_cache_lang_code(uint8_t lang_id) {
+    return lang_codes[lang_id];
+}
+
+/* Source language of entry */
+const char *trans_cache_entry_from_lang(const CacheEntry *entry) {
+    return trans_cache_lang_code(entry->from_id);
+}
+
+/* Target language of entry */
+const char *trans_cache_entry_to_lang(const CacheEntry *entry) {
+    return trans_cache_lang_code(entry->to_id);
+}
+
+/* Hex hash of entry */
+void trans_cache_entry_hash(const CacheEntry *entry, char *hash_out) {
+    trans_cache_digest_to_hex(entry->key, hash_out);
 }
 
 /* Initialize translation cache with specified backend */
 TransCache *trans_cache_init_with_backend(CacheBackendType type,
                                           const char *config_path,
                                           void *options) {
-    (void)options;  /* Not used yet */
-
     switch (type) {
         case CACHE_BACKEND_TEXT:
-            return text_backend_init(config_path);
+            return text_backend_init(config_path, (const TextBackendOptions *)options);
 
         case CACHE_BACKEND_SQLITE:
-            return sqlite_backend_init(config_path);
+            return sqlite_backend_init(config_path, (const SqliteBackendOptions *)options);
 
         case CACHE_BACKEND_MONGODB:
             LOG_INFO("MongoDB backend not yet implemented, using text backend\n");
-            return text_backend_init(config_path);
+            return text_backend_init(config_path, NULL);
 
         case CACHE_BACKEND_REDIS:
-            LOG_INFO("Redis backend not yet implemented, using text backend\n");
-            return text_backend_init(config_path);
+            return redis_backend_init(config_path, (const RedisBackendOptions *)options);
 
         default:
             LOG_INFO("Unknown backend type %d, using text backend\n", type);
-            return text_backend_init(config_path);
+            return text_backend_init(config_path, NULL);
     }
 }
 
@@ -68,19 +169,128 @@ TransCache *trans_cache_init(const char *file_path) {
     return trans_cache_init_with_backend(CACHE_BACKEND_TEXT, file_path, NULL);
 }
 
-/* Lookup cache entry */
+/* Create cache structure with one lock per shard */
+TransCache *trans_cache_create(CacheBackendType type, CacheBackendOps *ops,
+                               void *backend_ctx, void *const *slices,
+                               size_t shard_count) {
+    if (!ops || !slices || shard_count == 0 || shard_count > 256 ||
+        (shard_count & (shard_count - 1)) != 0) {
+        LOG_DEBUG("Error: Invalid cache shard count %zu\n", shard_count);
+        return NULL;
+    }
+
+    TransCache *cache = calloc(1, sizeof(TransCache));
+    TransCacheShard *shards = calloc(shard_count, sizeof(TransCacheShard));
+    if (!cache || !shards) {
+        LOG_DEBUG("Error: Memory allocation failed\n");
+        free(cache);
+        free(shards);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < shard_count; i++) {
+        if (pthread_rwlock_init(&shards[i].lock, NULL) != 0) {
+            LOG_DEBUG("Error: Failed to initialize rwlock\n");
+            while (i-- > 0) {
+                pthread_rwlock_destroy(&shards[i].lock);
+            }
+            free(shards);
+            free(cache);
+            return NULL;
+        }
+        shards[i].backend_ctx = slices[i];
+        atomic_init(&shards[i].read_locks, 0);
+        atomic_init(&shards[i].read_waits, 0);
+        atomic_init(&shards[i].write_locks, 0);
+        atomic_init(&shards[i].write_waits, 0);
+    }
+
+    cache->type = type;
+    cache->backend_ctx = backend_ctx;
+    cache->ops = ops;
+    cache->shards = shards;
+    cache->shard_count = shard_count;
+    atomic_init(&cache->hit_flushes, 0);
+    atomic_init(&cache->hits_folded, 0);
+    return cache;
+}
+
+/* Shard of key: last digest byte (the index tag uses the first bytes) */
+size_t trans_cache_shard_of(const unsigned char *key, size_t shard_count) {
+    return key[TRANS_CACHE_DIGEST_SIZE - 1] & (shard_count - 1);
+}
+
+/* Lock shard, counting acquisitions that had to wait */
+void trans_cache_lock_shard(TransCache *cache, size_t shard, bool write) {
+    TransCacheShard *s = &cache->shards[shard];
+
+    if (write) {
+        if (pthread_rwlock_trywrlock(&s->lock) != 0) {
+            atomic_fetch_add_explicit(&s->write_waits, 1, memory_order_relaxed);
+            pthread_rwlock_wrlock(&s->lock);
+        }
+        atomic_fetch_add_explicit(&s->write_locks, 1, memory_order_relaxed);
+    } else {
+        if (pthread_rwlock_tryrdlock(&s->lock) != 0) {
+            atomic_fetch_add_explicit(&s->read_waits, 1, memory_order_relaxed);
+            pthread_rwlock_rdlock(&s->lock);
+        }
+        atomic_fetch_add_explicit(&s->read_locks, 1, memory_order_relaxed);
+    }
+}
+
+/* Unlock shard */
+void trans_cache_unlock_shard(TransCache *cache, size_t shard) {
+    pthread_rwlock_unlock(&cache->shards[shard].lock);
+}
+
+/* Begin read section */
+void trans_cache_read_begin(TransCache *cache) {
+    (void)cache;
+    epoch_enter();
+}
+
+/* End read section */
+void trans_cache_read_end(TransCache *cache) {
+    (void)cache;
+    epoch_exit();
+}
+
+/* Lookup cache entry: hot tier first, then the backend (lock-free where
+ * it allows) */
 CacheEntry *trans_cache_lookup(TransCache *cache,
                                const char *from_lang,
                                const char *to_lang,
                                const char *text) {
-    if (!cache || !cache->ops || !cache->ops->lookup) {
+    if (!cache || !cache->ops || !cache->ops->lookup || !from_lang || !to_lang || !text) {
         return NULL;
     }
 
-    pthread_rwlock_rdlock(&cache->lock);
-    CacheEntry *result = cache->ops->lookup(cache->backend_ctx, from_lang, to_lang, text);
-    pthread_rwlock_unlock(&cache->lock);
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    trans_cache_calculate_digest(from_lang, to_lang, text, key);
+    size_t shard = trans_cache_shard_of(key, cache->shard_count);
+
+    unsigned int generation = 0;
+    if (cache->hot_tier) {
+        CacheEntry *hot = hot_tier_lookup(cache->hot_tier, key, &generation);
+        if (hot) {
+            return hot;
+        }
+    }
 
+    CacheEntry *result;
+    if (cache->ops->concurrent_lookup) {
+        result = cache->ops->lookup(cache->shards[shard].backend_ctx, key);
+    } else {
+        /* Backends with shared lookup state (statements) need exclusive access */
+        trans_cache_lock_shard(cache, shard, true);
+        result = cache->ops->lookup(cache->shards[shard].backend_ctx, key);
+        trans_cache_unlock_shard(cache, shard);
+    }
+
+    if (cache->hot_tier) {
+        result = hot_tier_fill(cache->hot_tier, key, result, generation);
+    }
     return result;
 }
 
@@ -90,27 +300,43 @@ int trans_cache_add(TransCache *cache,
                    const char *to_lang,
                    const char *source_text,
                    const char *translated_text) {
-    if (!cache || !cache->ops || !cache->ops->add) {
+    if (!cache || !cache->ops || !cache->ops->add ||
+        !from_lang || !to_lang || !source_text || !translated_text) {
         return -1;
     }
 
-    pthread_rwlock_wrlock(&cache->lock);
-    int result = cache->ops->add(cache->backend_ctx, from_lang, to_lang,
+    unsigned char key[TRANS_CACHE_DIGEST_SIZE];
+    trans_cache_calculate_digest(from_lang, to_lang, source_text, key);
+    if (cache->write_behind) {
+        return write_behind_enqueue(cache->write_behind, key, from_lang, to_lang,
+                                    source_text, translated_text);
+    }
+
+    size_t shard = trans_cache_shard_of(key, cache->shard_count);
+
+    trans_cache_lock_shard(cache, shard, true);
+    int result = cache->ops->add(cache->shards[shard].backend_ctx, key, from_lang, to_lang,
                                  source_text, translated_text);
-    pthread_rwlock_unlock(&cache->lock);
+    trans_cache_unlock_shard(cache, shard);
 
     return result;
 }
 
-/* Update cache entry count */
+/* Record a hit: lock-free where the backend allows it */
 int trans_cache_update_count(TransCache *cache, CacheEntry *entry) {
-    if (!cache || !cache->ops || !cache->ops->update_count) {
+    if (!cache || !cache->ops || !cache->ops->update_count || !entry) {
         return -1;
     }
 
-    pthread_rwlock_wrlock(&cache->lock);
-    int result = cache->ops->update_count(cache->backend_ctx, entry);
-    pthread_rwlock_unlock(&cache->lock);
+    size_t shard = trans_cache_shard_of(entry->key, cache->shard_count);
+
+    if (cache->ops->concurrent_update_count) {
+        return cache->ops->update_count(cache->shards[shard].backend_ctx, entry);
+    }
+
+    trans_cache_lock_shard(cache, shard, true);
+    int result = cache->ops->update_count(cache->shards[shard].backend_ctx, entry);
+    trans_cache_unlock_shard(cache, shard);
 
     return result;
 }
@@ -119,44 +345,120 @@ int trans_cache_update_count(TransCache *cache, CacheEntry *entry) {
 int trans_cache_update_translation(TransCache *cache,
                                    CacheEntry *entry,
                                    const char *new_translation) {
-    if (!cache || !cache->ops || !cache->ops->update_translation) {
+    if (!cache || !cache->ops || !cache->ops->update_translation || !entry) {
         return -1;
     }
 
-    pthread_rwlock_wrlock(&cache->lock);
-    int result = cache->ops->update_translation(cache->backend_ctx, entry, new_translation);
-    pthread_rwlock_unlock(&cache->lock);
+    if (cache->write_behind) {
+        if (!new_translation) {
+            return -1;
+        }
+        return write_behind_enqueue(cache->write_behind, entry->key,
+                                    trans_cache_lang_code(entry->from_id),
+                                    trans_cache_lang_code(entry->to_id),
+                                    entry->source_text, new_translation);
+    }
+
+    size_t shard = trans_cache_shard_of(entry->key, cache->shard_count);
+
+    trans_cache_lock_shard(cache, shard, true);
+    int result = cache->ops->update_translation(cache->shards[shard].backend_ctx, entry,
+                                                new_translation);
+    trans_cache_unlock_shard(cache, shard);
+
+    /* The backend has the new translation: the next lookup copies it */
+    hot_tier_invalidate(cache->hot_tier, entry->key);
 
     return result;
 }
 
-/* Save cache to storage */
+/* Fold deferred hits of one shard (caller holds its write lock) */
+static int flush_shard_hits(TransCache *cache, size_t shard) {
+    if (!cache->ops->flush_hits) {
+        return 0;
+    }
+
+    int folded = cache->ops->flush_hits(cache->shards[shard].backend_ctx);
+    if (folded > 0) {
+        atomic_fetch_add_explicit(&cache->hits_folded, (unsigned long long)folded,
+                                  memory_order_relaxed);
+    }
+    return folded;
+}
+
+/* Fold deferred hits into storage */
+int trans_cache_flush_hits(TransCache *cache) {
+    if (!cache || !cache->ops) {
+        return -1;
+    }
+    if (!cache->ops->flush_hits) {
+        return 0;
+    }
+
+    int result = 0;
+    bool failed = false;
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        trans_cache_lock_shard(cache, i, true);
+        int folded = flush_shard_hits(cache, i);
+        trans_cache_unlock_shard(cache, i);
+
+        if (folded < 0) {
+            failed = true;
+        } else {
+            result += folded;
+        }
+    }
+
+    atomic_fetch_add_explicit(&cache->hit_flushes, 1, memory_order_relaxed);
+    return failed ? -1 : result;
+}
+
+/* Save cache to storage (backend locks the shards it reads). Queued
+ * writes are applied and deferred hits folded in first. As saves run
+ * periodically, this also frees retired memory whose readers are gone. */
 int trans_cache_save(TransCache *cache) {
     if (!cache || !cache->ops || !cache->ops->save) {
         return -1;
     }
 
-    pthread_rwlock_rdlock(&cache->lock);
-    int result = cache->ops->save(cache->backend_ctx);
-    pthread_rwlock_unlock(&cache->lock);
+    write_behind_flush(cache->write_behind);
 
-    return result;
+    int flushed = trans_cache_flush_hits(cache);
+    if (flushed < 0) {
+        LOG_INFO("Warning: Failed to write deferred cache hits, retrying on next save\n");
+    }
+
+    int result = cache->ops->save(cache);
+    epoch_reclaim();
+
+    return flushed < 0 ? -1 : result;
 }
 
-/* Cleanup old cache entries */
+/* Cleanup old cache entries, one shard at a time */
 int trans_cache_cleanup(TransCache *cache, int days_threshold) {
     if (!cache || !cache->ops || !cache->ops->cleanup) {
         return 0;
     }
 
-    pthread_rwlock_wrlock(&cache->lock);
-    int result = cache->ops->cleanup(cache->backend_ctx, days_threshold);
-    pthread_rwlock_unlock(&cache->lock);
+    int result = 0;
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        trans_cache_lock_shard(cache, i, true);
+        /* Deferred hits may make entries recent again */
+        flush_shard_hits(cache, i);
+        result += cache->ops->cleanup(cache->shards[i].backend_ctx, days_threshold);
+        trans_cache_unlock_shard(cache, i);
+    }
+
+    /* Removed entries must not be served from copies */
+    if (result > 0) {
+        hot_tier_clear(cache->hot_tier);
+    }
 
     return result;
 }
 
-/* Get cache statistics */
+/* Get cache statistics (sum over shards, deferred hits folded in first) */
 void trans_cache_stats(TransCache *cache,
                       size_t *total_entries,
                       size_t *active_entries,
@@ -167,10 +469,144 @@ void trans_cache_stats(TransCache *cache,
         return;
     }
 
-    pthread_rwlock_rdlock(&cache->lock);
-    cache->ops->stats(cache->backend_ctx, total_entries, active_entries,
-                     expired_entries, cache_threshold, days_threshold);
-    pthread_rwlock_unlock(&cache->lock);
+    trans_cache_flush_hits(cache);
+
+    size_t total = 0, active = 0, expired = 0;
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        size_t shard_total = 0, shard_active = 0, shard_expired = 0;
+
+        trans_cache_lock_shard(cache, i, false);
+        cache->ops->stats(cache->shards[i].backend_ctx, &shard_total, &shard_active,
+                          &shard_expired, cache_threshold, days_threshold);
+        trans_cache_unlock_shard(cache, i);
+
+        total += shard_total;
+        active += shard_active;
+        expired += shard_expired;
+    }
+
+    if (total_entries) *total_entries = total;
+    if (active_entries) *active_entries = active;
+    if (expired_entries) *expired_entries = expired;
+}
+
+/* Backend type name for metrics */
+static const char *backend_name(CacheBackendType type) {
+    switch (type) {
+        case CACHE_BACKEND_TEXT: return "text";
+        case CACHE_BACKEND_SQLITE: return "sqlite";
+        case CACHE_BACKEND_MONGODB: return "mongodb";
+        case CACHE_BACKEND_REDIS: return "redis";
+        default: return "unknown";
+    }
+}
+
+/* Cache metrics as JSON */
+cJSON *trans_cache_metrics(TransCache *cache) {
+    if (!cache) {
+        return NULL;
+    }
+
+    cJSON *metrics = cJSON_CreateObject();
+    cJSON *locks = cJSON_CreateObject();
+    cJSON *per_shard = cJSON_CreateArray();
+    cJSON *reclaim = cJSON_CreateObject();
+    cJSON *hits = cJSON_CreateObject();
+    if (!metrics || !locks || !per_shard || !reclaim || !hits) {
+        cJSON_Delete(metrics);
+        cJSON_Delete(locks);
+        cJSON_Delete(per_shard);
+        cJSON_Delete(reclaim);
+        cJSON_Delete(hits);
+        return NULL;
+    }
+
+    unsigned long long read_locks = 0, read_waits = 0;
+    unsigned long long write_locks = 0, write_waits = 0;
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        TransCacheShard *s = &cache->shards[i];
+        unsigned long long r = atomic_load_explicit(&s->read_locks, memory_order_relaxed);
+        unsigned long long rw = atomic_load_explicit(&s->read_waits, memory_order_relaxed);
+        unsigned long long w = atomic_load_explicit(&s->write_locks, memory_order_relaxed);
+        unsigned long long ww = atomic_load_explicit(&s->write_waits, memory_order_relaxed);
+
+        read_locks += r;
+        read_waits += rw;
+        write_locks += w;
+        write_waits += ww;
+
+        cJSON *shard = cJSON_CreateObject();
+        if (shard) {
+            cJSON_AddNumberToObject(shard, "read_locks", (double)r);
+            cJSON_AddNumberToObject(shard, "read_waits", (double)rw);
+            cJSON_AddNumberToObject(shard, "write_locks", (double)w);
+            cJSON_AddNumberToObject(shard, "write_waits", (double)ww);
+            cJSON_AddItemToArray(per_shard, shard);
+        }
+    }
+
+    unsigned long long acquisitions = read_locks + write_locks;
+
+    cJSON_AddNumberToObject(locks, "read_locks", (double)read_locks);
+    cJSON_AddNumberToObject(locks, "read_waits", (double)read_waits);
+    cJSON_AddNumberToObject(locks, "write_locks", (double)write_locks);
+    cJSON_AddNumberToObject(locks, "write_waits", (double)write_waits);
+    cJSON_AddNumberToObject(locks, "contention_rate",
+                            acquisitions ?
+                            (double)(read_waits + write_waits) / (double)acquisitions : 0.0);
+    cJSON_AddItemToObject(locks, "per_shard", per_shard);
+
+    cJSON_AddStringToObject(metrics, "backend", backend_name(cache->type));
+    cJSON_AddNumberToObject(metrics, "shards", (double)cache->shard_count);
+    cJSON_AddItemToObject(metrics, "locks", locks);
+
+    /* Deferred frees of replaced and removed entries */
+    unsigned long long epoch = 0, reclaimed = 0;
+    size_t pending = 0;
+    epoch_stats(&epoch, &pending, &reclaimed);
+    cJSON_AddBoolToObject(metrics, "lockfree_lookup", cache->ops->concurrent_lookup);
+    cJSON_AddNumberToObject(reclaim, "epoch", (double)epoch);
+    cJSON_AddNumberToObject(reclaim, "pending", (double)pending);
+    cJSON_AddNumberToObject(reclaim, "reclaimed", (double)reclaimed);
+    cJSON_AddItemToObject(metrics, "reclaim", reclaim);
+
+    /* Hits recorded without the shard lock and written in batches */
+    cJSON_AddBoolToObject(hits, "lockfree", cache->ops->concurrent_update_count);
+    cJSON_AddNumberToObject(hits, "flushes",
+                            (double)atomic_load_explicit(&cache->hit_flushes,
+                                                         memory_order_relaxed));
+    cJSON_AddNumberToObject(hits, "folded",
+                            (double)atomic_load_explicit(&cache->hits_folded,
+                                                         memory_order_relaxed));
+    cJSON_AddItemToObject(metrics, "hits", hits);
+
+    /* Backend storage (e.g. SQLite WAL and checkpoints) */
+    if (cache->ops->metrics) {
+        cJSON *storage = cache->ops->metrics(cache);
+        if (storage) {
+            cJSON_AddItemToObject(metrics, "storage", storage);
+        }
+    }
+
+    /* In-process tier in front of the backend */
+    if (cache->hot_tier) {
+        cJSON *hot_tier = hot_tier_stats(cache->hot_tier);
+        if (hot_tier) {
+            cJSON_AddItemToObject(metrics, "hot_tier", hot_tier);
+        }
+    }
+
+    /* Queued inserts and translation updates */
+    if (cache->write_behind) {
+        cJSON *write_behind = write_behind_stats(cache->write_behind);
+        if (write_behind) {
+            cJSON_AddItemToObject(metrics, "write_behind", write_behind);
+        }
+    }
+
+    return metrics;
 }
 
 /* Free translation cache */
@@ -179,12 +615,29 @@ void trans_cache_free(TransCache *cache) {
         return;
     }
 
+    /* Apply queued writes while the backend is still there */
+    write_behind_free(cache->write_behind);
+    cache->write_behind = NULL;
+
+    /* Stop the backend's invalidations before the tier goes */
+    if (cache->hot_tier && cache->ops && cache->ops->attach_hot_tier) {
+        cache->ops->attach_hot_tier(cache->backend_ctx, NULL);
+    }
+    hot_tier_free(cache->hot_tier);
+    cache->hot_tier = NULL;
+
+    /* Readers are gone: release everything still waiting for a grace period */
+    epoch_barrier();
+
     /* Free backend resources */
     if (cache->ops && cache->ops->free_backend && cache->backend_ctx) {
         cache->ops->free_backend(cache->backend_ctx);
     }
 
-    /* Destroy lock and free cache structure */
-    pthread_rwlock_destroy(&cache->lock);
+    /* Destroy locks and free cache structure */
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        pthread_rwlock_destroy(&cache->shards[i].lock);
+    }
+    free(cache->shards);
     free(cache);
 }
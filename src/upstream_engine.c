@@ -0,0 +1,726 @@
+/**
+ * Upstream I/O engine for transbasket.
+ * Runs upstream HTTP transfers on curl_multi event loops so that many
+ * requests share a few threads. Each loop keeps its own pool of keep-alive
+ * connections; the DNS cache and TLS sessions are shared by all loops.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "upstream_engine.h"
+#include "utils.h"
+
+#define DEFAULT_EVENT_THREADS 1
+#define DEFAULT_MAX_INFLIGHT 1024
+#define DEFAULT_TIMEOUT 60
+#define MAX_EVENT_THREADS 64
+#define IDLE_POLL_MS 1000
+
+/* How a response body is handled */
+#define BODY_MODE_UNDECIDED 0
+#define BODY_MODE_BUFFER 1
+#define BODY_MODE_STREAM 2
+
+/* Queued or running upstream request */
+typedef struct UpstreamRequest {
+    char *url;
+    struct curl_slist *headers;
+    char *body;
+    UpstreamCallback callback;
+    UpstreamDataCallback data_callback;
+    void *user_data;
+    long long due_ms;               /* Monotonic time the request may start */
+    long long started_ms;
+
+    CURL *easy;                     /* Set while the transfer is running */
+    char *response;
+    size_t response_size;
+    int body_mode;                  /* BODY_MODE_* decided on the first chunk */
+
+    struct UpstreamRequest *next;
+} UpstreamRequest;
+
+/* One curl_multi event loop and its request queues */
+typedef struct {
+    UpstreamEngine *engine;
+    int index;
+    pthread_t thread;
+    bool thread_started;
+    CURLM *multi;
+
+    pthread_mutex_t lock;           /* Protects incoming queue, flag and stats */
+    UpstreamRequest *incoming_head; /* Submitted, not yet seen by loop thread */
+    UpstreamRequest *incoming_tail;
+    bool shutting_down;
+
+    /* Owned by the loop thread */
+    UpstreamRequest *ready_head;    /* Waiting for an in-flight slot */
+    UpstreamRequest *ready_tail;
+    UpstreamRequest *delayed;       /* Sorted by due_ms */
+    int max_running;
+
+    /* Statistics (under lock) */
+    size_t queued;                  /* incoming + ready */
+    size_t delayed_count;
+    size_t running;
+    size_t peak_running;
+    unsigned long long submitted;
+    unsigned long long completed;
+    unsigned long long transfer_errors;
+    unsigned long long cancelled;
+    unsigned long long new_connections;
+    unsigned long long reused_connections;
+    unsigned long long total_time_us;
+} UpstreamLoop;
+
+struct UpstreamEngine {
+    UpstreamLoop *loops;
+    int loop_count;
+    int timeout;
+    atomic_uint next_loop;          /* Round-robin submit cursor */
+    bool stopped;
+
+    CURLSH *share;                  /* Shared DNS / TLS session caches */
+    pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+};
+
+/* Monotonic clock in milliseconds */
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* CURLSH lock callbacks - share data is used from every loop thread */
+static void share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
+    (void)handle;
+    (void)access;
+    UpstreamEngine *engine = (UpstreamEngine *)userptr;
+    pthread_mutex_lock(&engine->share_locks[data]);
+}
+
+static void share_unlock(CURL *handle, curl_lock_data data, void *userptr) {
+    (void)handle;
+    UpstreamEngine *engine = (UpstreamEngine *)userptr;
+    pthread_mutex_unlock(&engine->share_locks[data]);
+}
+
+/* Curl write callback */
+static size_t upstream_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    UpstreamRequest *req = (UpstreamRequest *)userp;
+
+    /* Stream successful bodies to the data callback; status is known by now */
+    if (req->body_mode == BODY_MODE_UNDECIDED) {
+        long http_code = 0;
+        curl_easy_getinfo(req->easy, CURLINFO_RESPONSE_CODE, &http_code);
+        req->body_mode = (req->data_callback && http_code >= 200 && http_code < 300) ?
+                         BODY_MODE_STREAM : BODY_MODE_BUFFER;
+    }
+
+    if (req->body_mode == BODY_MODE_STREAM) {
+        if (req->data_callback((const char *)contents, realsize, req->user_data) != 0) {
+            return 0;  /* Aborts the transfer with CURLE_WRITE_ERROR */
+        }
+        return realsize;
+    }
+
+    char *ptr = realloc(req->response, req->response_size + realsize + 1);
+    if (!ptr) {
+        LOG_DEBUG("Error: Memory allocation failed in upstream write callback");
+        return 0;
+    }
+
+    req->response = ptr;
+    memcpy(req->response + req->response_size, contents, realsize);
+    req->response_size += realsize;
+    req->response[req->response_size] = '\0';
+
+    return realsize;
+}
+
+/* Free request */
+static void free_upstream_request(UpstreamRequest *req) {
+    if (!req) {
+        return;
+    }
+
+    if (req->easy) {
+        curl_easy_cleanup(req->easy);
+    }
+    curl_slist_free_all(req->headers);
+    free(req->url);
+    free(req->body);
+    free(req->response);
+    free(req);
+}
+
+/* Deliver result to the submitter and free the request */
+static void complete_request(UpstreamRequest *req, const UpstreamResult *result) {
+    req->callback(result, req->user_data);
+    free_upstream_request(req);
+}
+
+/* Cancel a request that never started */
+static void cancel_request(UpstreamLoop *loop, UpstreamRequest *req) {
+    UpstreamResult result = {
+        .curl_code = CURLE_ABORTED_BY_CALLBACK,
+        .http_code = 0,
+        .body = "",
+        .body_size = 0,
+        .cancelled = true,
+        .streamed = false,
+        .started_ms = 0
+    };
+
+    pthread_mutex_lock(&loop->lock);
+    loop->cancelled++;
+    pthread_mutex_unlock(&loop->lock);
+
+    complete_request(req, &result);
+}
+
+/* Insert into delayed list keeping it sorted by due time */
+static void insert_delayed(UpstreamLoop *loop, UpstreamRequest *req) {
+    UpstreamRequest **pos = &loop->delayed;
+
+    while (*pos && (*pos)->due_ms <= req->due_ms) {
+        pos = &(*pos)->next;
+    }
+
+    req->next = *pos;
+    *pos = req;
+}
+
+/* Append to ready queue */
+static void append_ready(UpstreamLoop *loop, UpstreamRequest *req) {
+    req->next = NULL;
+
+    if (loop->ready_tail) {
+        loop->ready_tail->next = req;
+    } else {
+        loop->ready_head = req;
+    }
+    loop->ready_tail = req;
+}
+
+/* Create easy handle and add the request to the multi handle */
+static int start_transfer(UpstreamLoop *loop, UpstreamRequest *req) {
+    UpstreamEngine *engine = loop->engine;
+
+    CURL *easy = curl_easy_init();
+    if (!easy) {
+        return -1;
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, req->url);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, req->headers);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, req->body);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)strlen(req->body));
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, upstream_write_callback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, req);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, req);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, (long)engine->timeout);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_SHARE, engine->share);
+
+    if (curl_multi_add_handle(loop->multi, easy) != CURLM_OK) {
+        curl_easy_cleanup(easy);
+        return -1;
+    }
+
+    req->easy = easy;
+    req->started_ms = monotonic_ms();
+    return 0;
+}
+
+/* Take newly submitted requests from the shared queue */
+static bool drain_incoming(UpstreamLoop *loop, long long now) {
+    pthread_mutex_lock(&loop->lock);
+    UpstreamRequest *req = loop->incoming_head;
+    loop->incoming_head = NULL;
+    loop->incoming_tail = NULL;
+    bool stopping = loop->shutting_down;
+    pthread_mutex_unlock(&loop->lock);
+
+    while (req) {
+        UpstreamRequest *next = req->next;
+
+        if (req->due_ms > now) {
+            pthread_mutex_lock(&loop->lock);
+            loop->queued--;
+            loop->delayed_count++;
+            pthread_mutex_unlock(&loop->lock);
+            insert_delayed(loop, req);
+        } else {
+            append_ready(loop, req);
+        }
+
+        req = next;
+    }
+
+    return stopping;
+}
+
+/* Cancel everything that has not started yet */
+static void cancel_pending(UpstreamLoop *loop) {
+    while (loop->ready_head) {
+        UpstreamRequest *req = loop->ready_head;
+        loop->ready_head = req->next;
+
+        pthread_mutex_lock(&loop->lock);
+        loop->queued--;
+        pthread_mutex_unlock(&loop->lock);
+
+        cancel_request(loop, req);
+    }
+    loop->ready_tail = NULL;
+
+    while (loop->delayed) {
+        UpstreamRequest *req = loop->delayed;
+        loop->delayed = req->next;
+
+        pthread_mutex_lock(&loop->lock);
+        loop->delayed_count--;
+        pthread_mutex_unlock(&loop->lock);
+
+        cancel_request(loop, req);
+    }
+}
+
+/* Move due delayed requests to the ready queue */
+static void promote_delayed(UpstreamLoop *loop, long long now) {
+    while (loop->delayed && loop->delayed->due_ms <= now) {
+        UpstreamRequest *req = loop->delayed;
+        loop->delayed = req->next;
+
+        pthread_mutex_lock(&loop->lock);
+        loop->delayed_count--;
+        loop->queued++;
+        pthread_mutex_unlock(&loop->lock);
+
+        append_ready(loop, req);
+    }
+}
+
+/* Start ready requests while in-flight slots are free */
+static void start_ready(UpstreamLoop *loop) {
+    while (loop->ready_head) {
+        pthread_mutex_lock(&loop->lock);
+        bool slot_free = loop->running < (size_t)loop->max_running;
+        pthread_mutex_unlock(&loop->lock);
+
+        if (!slot_free) {
+            break;
+        }
+
+        UpstreamRequest *req = loop->ready_head;
+        loop->ready_head = req->next;
+        if (!loop->ready_head) {
+            loop->ready_tail = NULL;
+        }
+        req->next = NULL;
+
+        if (start_transfer(loop, req) != 0) {
+            UpstreamResult result = {
+                .curl_code = CURLE_FAILED_INIT,
+                .http_code = 0,
+                .body = "",
+                .body_size = 0,
+                .cancelled = false,
+                .streamed = false,
+                .started_ms = 0
+            };
+
+            pthread_mutex_lock(&loop->lock);
+            loop->queued--;
+            loop->transfer_errors++;
+            pthread_mutex_unlock(&loop->lock);
+
+            complete_request(req, &result);
+            continue;
+        }
+
+        pthread_mutex_lock(&loop->lock);
+        loop->queued--;
+        loop->running++;
+        if (loop->running > loop->peak_running) {
+            loop->peak_running = loop->running;
+        }
+        pthread_mutex_unlock(&loop->lock);
+    }
+}
+
+/* Collect finished transfers and run their callbacks */
+static void finish_transfers(UpstreamLoop *loop) {
+    CURLMsg *msg;
+    int msgs_left;
+
+    while ((msg = curl_multi_info_read(loop->multi, &msgs_left))) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL *easy = msg->easy_handle;
+        CURLcode code = msg->data.result;
+        UpstreamRequest *req = NULL;
+        long http_code = 0;
+        long new_connects = 0;
+        curl_off_t total_time_us = 0;
+
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&req);
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_code);
+        curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &new_connects);
+        curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total_time_us);
+
+        curl_multi_remove_handle(loop->multi, easy);
+
+        pthread_mutex_lock(&loop->lock);
+        loop->running--;
+        loop->completed++;
+        if (code != CURLE_OK) {
+            loop->transfer_errors++;
+        }
+        if (new_connects > 0) {
+            loop->new_connections += (unsigned long long)new_connects;
+        } else if (code == CURLE_OK) {
+            loop->reused_connections++;
+        }
+        loop->total_time_us += (unsigned long long)total_time_us;
+        pthread_mutex_unlock(&loop->lock);
+
+        UpstreamResult result = {
+            .curl_code = code,
+            .http_code = http_code,
+            .body = req->response ? req->response : "",
+            .body_size = req->response_size,
+            .cancelled = false,
+            .streamed = req->body_mode == BODY_MODE_STREAM,
+            .started_ms = req->started_ms
+        };
+
+        complete_request(req, &result);
+    }
+}
+
+/* Event loop thread */
+static void *upstream_loop_thread(void *arg) {
+    UpstreamLoop *loop = (UpstreamLoop *)arg;
+
+    LOG_DEBUG("Upstream event loop %d started (max in-flight %d)", loop->index, loop->max_running);
+
+    while (1) {
+        long long now = monotonic_ms();
+        bool stopping = drain_incoming(loop, now);
+
+        if (stopping) {
+            cancel_pending(loop);
+        } else {
+            promote_delayed(loop, now);
+            start_ready(loop);
+        }
+
+        int still_running = 0;
+        curl_multi_perform(loop->multi, &still_running);
+        finish_transfers(loop);
+
+        if (stopping) {
+            pthread_mutex_lock(&loop->lock);
+            bool idle = loop->running == 0 && !loop->incoming_head;
+            pthread_mutex_unlock(&loop->lock);
+
+            if (idle) {
+                break;
+            }
+        }
+
+        /* Sleep until socket activity, a curl timer, the next delayed
+         * request, or a wakeup from submit/shutdown */
+        int wait_ms = IDLE_POLL_MS;
+        if (loop->delayed) {
+            long long until_due = loop->delayed->due_ms - monotonic_ms();
+            if (until_due < wait_ms) {
+                wait_ms = until_due > 0 ? (int)until_due : 0;
+            }
+        }
+
+        curl_multi_poll(loop->multi, NULL, 0, wait_ms, NULL);
+    }
+
+    LOG_DEBUG("Upstream event loop %d stopped", loop->index);
+    return NULL;
+}
+
+/* Create upstream engine */
+UpstreamEngine *upstream_engine_create(int event_threads, int max_inflight, int timeout) {
+    UpstreamEngine *engine = calloc(1, sizeof(UpstreamEngine));
+    if (!engine) {
+        LOG_INFO("Error: Memory allocation failed for upstream engine");
+        return NULL;
+    }
+
+    if (event_threads < 1) event_threads = DEFAULT_EVENT_THREADS;
+    if (event_threads > MAX_EVENT_THREADS) event_threads = MAX_EVENT_THREADS;
+    if (max_inflight < 1) max_inflight = DEFAULT_MAX_INFLIGHT;
+    if (event_threads > max_inflight) event_threads = max_inflight;
+
+    engine->timeout = timeout > 0 ? timeout : DEFAULT_TIMEOUT;
+    atomic_init(&engine->next_loop, 0);
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&engine->share_locks[i], NULL);
+    }
+
+    /* Share DNS cache and TLS sessions across all loops. Connections stay
+     * with the multi handle of their loop: libcurl does not support one
+     * connection cache used by multi handles on different threads */
+    engine->share = curl_share_init();
+    if (!engine->share) {
+        LOG_INFO("Error: Failed to initialize curl share handle");
+        upstream_engine_free(engine);
+        return NULL;
+    }
+
+    curl_share_setopt(engine->share, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(engine->share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(engine->share, CURLSHOPT_USERDATA, engine);
+    curl_share_setopt(engine->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(engine->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    engine->loops = calloc(event_threads, sizeof(UpstreamLoop));
+    if (!engine->loops) {
+        LOG_INFO("Error: Memory allocation failed for upstream event loops");
+        upstream_engine_free(engine);
+        return NULL;
+    }
+
+    /* Split in-flight budget across loops */
+    for (int i = 0; i < event_threads; i++) {
+        UpstreamLoop *loop = &engine->loops[i];
+
+        loop->engine = engine;
+        loop->index = i;
+        loop->max_running = max_inflight / event_threads +
+                            (i < max_inflight % event_threads ? 1 : 0);
+        pthread_mutex_init(&loop->lock, NULL);
+        engine->loop_count++;
+
+        loop->multi = curl_multi_init();
+        if (!loop->multi) {
+            LOG_INFO("Error: Failed to initialize curl multi handle");
+            upstream_engine_free(engine);
+            return NULL;
+        }
+
+        /* Connection pool of this loop, sized to its share of in-flight */
+        curl_multi_setopt(loop->multi, CURLMOPT_MAXCONNECTS, (long)loop->max_running);
+        curl_multi_setopt(loop->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)loop->max_running);
+        curl_multi_setopt(loop->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)loop->max_running);
+        curl_multi_setopt(loop->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+
+    for (int i = 0; i < engine->loop_count; i++) {
+        UpstreamLoop *loop = &engine->loops[i];
+
+        if (pthread_create(&loop->thread, NULL, upstream_loop_thread, loop) != 0) {
+            LOG_INFO("Error: Failed to start upstream event loop %d", i);
+            upstream_engine_free(engine);
+            return NULL;
+        }
+        loop->thread_started = true;
+    }
+
+    LOG_INFO("Upstream engine started: %d event loop(s), max in-flight %d",
+            engine->loop_count, max_inflight);
+
+    return engine;
+}
+
+/* Submit request to the next event loop */
+int upstream_engine_submit(UpstreamEngine *engine, const char *url,
+                           struct curl_slist *headers, char *body, long delay_ms,
+                           UpstreamCallback callback, void *user_data) {
+    return upstream_engine_submit_stream(engine, url, headers, body, delay_ms,
+                                         NULL, callback, user_data);
+}
+
+/* Submit request whose successful body is streamed to data_callback */
+int upstream_engine_submit_stream(UpstreamEngine *engine, const char *url,
+                                  struct curl_slist *headers, char *body, long delay_ms,
+                                  UpstreamDataCallback data_callback,
+                                  UpstreamCallback callback, void *user_data) {
+    if (!engine || !url || !body || !callback) {
+        curl_slist_free_all(headers);
+        free(body);
+        return -1;
+    }
+
+    UpstreamRequest *req = calloc(1, sizeof(UpstreamRequest));
+    if (!req) {
+        curl_slist_free_all(headers);
+        free(body);
+        return -1;
+    }
+
+    req->headers = headers;
+    req->body = body;
+    req->url = strdup(url);
+    req->callback = callback;
+    req->data_callback = data_callback;
+    req->user_data = user_data;
+    req->due_ms = monotonic_ms() + (delay_ms > 0 ? delay_ms : 0);
+
+    if (!req->url) {
+        free_upstream_request(req);
+        return -1;
+    }
+
+    unsigned int index = atomic_fetch_add(&engine->next_loop, 1) % (unsigned int)engine->loop_count;
+    UpstreamLoop *loop = &engine->loops[index];
+
+    pthread_mutex_lock(&loop->lock);
+
+    if (loop->shutting_down) {
+        pthread_mutex_unlock(&loop->lock);
+        free_upstream_request(req);
+        return -1;
+    }
+
+    if (loop->incoming_tail) {
+        loop->incoming_tail->next = req;
+    } else {
+        loop->incoming_head = req;
+    }
+    loop->incoming_tail = req;
+    loop->queued++;
+    loop->submitted++;
+
+    pthread_mutex_unlock(&loop->lock);
+
+    curl_multi_wakeup(loop->multi);
+
+    return 0;
+}
+
+/* Stop event loops after running transfers complete */
+void upstream_engine_shutdown(UpstreamEngine *engine) {
+    if (!engine || engine->stopped) {
+        return;
+    }
+
+    engine->stopped = true;
+
+    for (int i = 0; i < engine->loop_count; i++) {
+        UpstreamLoop *loop = &engine->loops[i];
+
+        pthread_mutex_lock(&loop->lock);
+        loop->shutting_down = true;
+        pthread_mutex_unlock(&loop->lock);
+
+        if (loop->multi) {
+            curl_multi_wakeup(loop->multi);
+        }
+    }
+
+    for (int i = 0; i < engine->loop_count; i++) {
+        UpstreamLoop *loop = &engine->loops[i];
+
+        if (loop->thread_started) {
+            pthread_join(loop->thread, NULL);
+            loop->thread_started = false;
+        }
+    }
+}
+
+/* Free upstream engine */
+void upstream_engine_free(UpstreamEngine *engine) {
+    if (!engine) {
+        return;
+    }
+
+    upstream_engine_shutdown(engine);
+
+    for (int i = 0; i < engine->loop_count; i++) {
+        UpstreamLoop *loop = &engine->loops[i];
+
+        if (loop->multi) {
+            curl_multi_cleanup(loop->multi);
+        }
+        pthread_mutex_destroy(&loop->lock);
+    }
+    free(engine->loops);
+
+    if (engine->share) {
+        curl_share_cleanup(engine->share);
+    }
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&engine->share_locks[i]);
+    }
+
+    free(engine);
+}
+
+/* Aggregate engine metrics */
+cJSON *upstream_engine_stats(UpstreamEngine *engine) {
+    if (!engine) {
+        return NULL;
+    }
+
+    size_t queued = 0, delayed = 0, running = 0, peak_running = 0;
+    unsigned long long submitted = 0, completed = 0, transfer_errors = 0, cancelled = 0;
+    unsigned long long new_connections = 0, reused_connections = 0, total_time_us = 0;
+    int max_inflight = 0;
+
+    for (int i = 0; i < engine->loop_count; i++) {
+        UpstreamLoop *loop = &engine->loops[i];
+
+        pthread_mutex_lock(&loop->lock);
+        queued += loop->queued;
+        delayed += loop->delayed_count;
+        running += loop->running;
+        peak_running += loop->peak_running;
+        submitted += loop->submitted;
+        completed += loop->completed;
+        transfer_errors += loop->transfer_errors;
+        cancelled += loop->cancelled;
+        new_connections += loop->new_connections;
+        reused_connections += loop->reused_connections;
+        total_time_us += loop->total_time_us;
+        pthread_mutex_unlock(&loop->lock);
+
+        max_inflight += loop->max_running;
+    }
+
+    unsigned long long connected = new_connections + reused_connections;
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) {
+        return NULL;
+    }
+
+    cJSON_AddNumberToObject(stats, "event_loops", engine->loop_count);
+    cJSON_AddNumberToObject(stats, "max_inflight", max_inflight);
+    cJSON_AddNumberToObject(stats, "inflight", (double)running);
+    cJSON_AddNumberToObject(stats, "peak_inflight", (double)peak_running);
+    cJSON_AddNumberToObject(stats, "queued", (double)queued);
+    cJSON_AddNumberToObject(stats, "delayed", (double)delayed);
+    cJSON_AddNumberToObject(stats, "submitted", (double)submitted);
+    cJSON_AddNumberToObject(stats, "completed", (double)completed);
+    cJSON_AddNumberToObject(stats, "transfer_errors", (double)transfer_errors);
+    cJSON_AddNumberToObject(stats, "cancelled", (double)cancelled);
+    cJSON_AddNumberToObject(stats, "connections_created", (double)new_connections);
+    cJSON_AddNumberToObject(stats, "connections_reused", (double)reused_connections);
+    cJSON_AddNumberToObject(stats, "connection_reuse_rate",
+                            connected ? (double)reused_connections / (double)connected : 0.0);
+    cJSON_AddNumberToObject(stats, "avg_transfer_ms",
+                            completed ? (double)total_time_us / (double)completed / 1000.0 : 0.0);
+
+    return stats;
+}
@@ -275,6 +275,22 @@ int get_current_timestamp(char *timestamp_buf, size_t buf_size) {
 /* Forward declaration for UTF-8 decoding helper */
 static int utf8_decode(const unsigned char *s, unsigned int *cp);
 
+/* Count UTF-8 characters (continuation bytes are not counted) */
+size_t utf8_strlen(const char *text) {
+    if (!text) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if ((*p & 0xC0) != 0x80) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
 /* Truncate text with suffix (UTF-8 aware) */
 int truncate_text(const char *text, char *output, size_t max_length, const char *suffix) {
     if (!text || !output || max_length == 0) {
@@ -357,6 +373,8 @@ static int utf8_decode(const unsigned char *s, unsigned int *cp) {
         *cp = ((s[0] & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F);
         return 4;
     }
+    /* Stray continuation or invalid lead byte: treat as a single byte */
+    *cp = s[0];
     return 1;
 }
 
@@ -495,6 +513,402 @@ int unescape_string(const char *input, char *output, size_t output_size) {
     return 0;
 }
 
+/* Value of 4 hex digits, or -1 */
+static long hex4(const char *p) {
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        int nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else {
+            return -1;
+        }
+        value = (value << 4) | nibble;
+    }
+    return value;
+}
+
+/* Decode JSON string escapes */
+long json_unescape(const char *s, size_t len, char *out) {
+    const char *end = s + len;
+    char *o = out;
+
+    while (s < end) {
+        if (*s != '\\') {
+            *o++ = *s++;
+            continue;
+        }
+        if (end - s < 2) {
+            return -1;
+        }
+        char c = s[1];
+        s += 2;
+        switch (c) {
+            case '"': *o++ = '"'; break;
+            case '\\': *o++ = '\\'; break;
+            case '/': *o++ = '/'; break;
+            case 'b': *o++ = '\b'; break;
+            case 'f': *o++ = '\f'; break;
+            case 'n': *o++ = '\n'; break;
+            case 'r': *o++ = '\r'; break;
+            case 't': *o++ = '\t'; break;
+            case 'u': {
+                long code = end - s >= 4 ? hex4(s) : -1;
+                if (code <= 0 || (code >= 0xDC00 && code <= 0xDFFF)) {
+                    return -1;
+                }
+                s += 4;
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    long low = end - s >= 6 && s[0] == '\\' && s[1] == 'u' ? hex4(s + 2) : -1;
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return -1;
+                    }
+                    s += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (code < 0x80) {
+                    *o++ = (char)code;
+                } else if (code < 0x800) {
+                    *o++ = (char)(0xC0 | (code >> 6));
+                    *o++ = (char)(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    *o++ = (char)(0xE0 | (code >> 12));
+                    *o++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *o++ = (char)(0x80 | (code & 0x3F));
+                } else {
+                    *o++ = (char)(0xF0 | (code >> 18));
+                    *o++ = (char)(0x80 | ((code >> 12) & 0x3F));
+                    *o++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *o++ = (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+
+    return (long)(o - out);
+}
+
+/* Reset incremental cleaner */
+void text_cleaner_init(TextCleaner *cleaner) {
+    if (cleaner) {
+        memset(cleaner, 0, sizeof(*cleaner));
+    }
+}
+
+/* Emoji/shortcode stage for one complete UTF-8 character */
+static size_t text_cleaner_put_char(TextCleaner *cleaner, const unsigned char *ch,
+                                    int char_len, char *output) {
+    size_t out = 0;
+    unsigned int codepoint = 0;
+
+    if (char_len > 1) {
+        utf8_decode(ch, &codepoint);
+    } else {
+        codepoint = ch[0];
+    }
+
+    /* Shortcode start */
+    if (ch[0] == ':' && !cleaner->in_shortcode) {
+        cleaner->in_shortcode = true;
+        return 0;
+    }
+
+    /* Shortcode body or end */
+    if (cleaner->in_shortcode) {
+        if (ch[0] == ':') {
+            cleaner->in_shortcode = false;
+            return 0;
+        }
+        if (isalnum(ch[0]) || ch[0] == '_' || ch[0] == '+' || ch[0] == '-' || ch[0] == '&') {
+            return 0;
+        }
+        cleaner->in_shortcode = false;
+    }
+
+    if (is_emoji_codepoint(codepoint)) {
+        return 0;
+    }
+
+    if (char_len == 1 && isspace(ch[0])) {
+        if (ch[0] == '\n') {
+            if (cleaner->pending_space) {
+                output[out++] = ' ';
+                cleaner->pending_space = false;
+            }
+            output[out++] = '\n';
+            cleaner->has_output = true;
+            cleaner->last_was_space = false;
+            return out;
+        }
+
+        /* Hold the space back: it is dropped if it turns out to be trailing */
+        if (!cleaner->last_was_space && cleaner->has_output) {
+            cleaner->pending_space = true;
+            cleaner->last_was_space = true;
+        }
+        return 0;
+    }
+
+    if (cleaner->pending_space) {
+        output[out++] = ' ';
+        cleaner->pending_space = false;
+    }
+
+    cleaner->last_was_space = false;
+    cleaner->has_output = true;
+    memcpy(output + out, ch, char_len);
+    out += char_len;
+
+    return out;
+}
+
+/* Collect bytes into UTF-8 characters */
+static size_t text_cleaner_put_byte(TextCleaner *cleaner, unsigned char byte, char *output) {
+    if (cleaner->utf8_len == 0) {
+        if ((byte & 0x80) == 0) {
+            cleaner->utf8_need = 1;
+        } else if ((byte & 0xE0) == 0xC0) {
+            cleaner->utf8_need = 2;
+        } else if ((byte & 0xF0) == 0xE0) {
+            cleaner->utf8_need = 3;
+        } else if ((byte & 0xF8) == 0xF0) {
+            cleaner->utf8_need = 4;
+        } else {
+            cleaner->utf8_need = 1;
+        }
+    }
+
+    cleaner->utf8_buf[cleaner->utf8_len++] = byte;
+    if (cleaner->utf8_len < cleaner->utf8_need) {
+        return 0;
+    }
+
+    int char_len = cleaner->utf8_len;
+    cleaner->utf8_len = 0;
+
+    return text_cleaner_put_char(cleaner, cleaner->utf8_buf, char_len, output);
+}
+
+/* Printable ASCII that passes both stages unchanged */
+static inline bool is_plain_byte(unsigned char ch) {
+    return ch > ' ' && ch < 0x7F && ch != '\\' && ch != ':';
+}
+
+/* Length of a complete multi-byte UTF-8 sequence at input, 0 if there is none */
+static int complete_utf8_length(const unsigned char *input, size_t len) {
+    int need;
+    if ((input[0] & 0xE0) == 0xC0) {
+        need = 2;
+    } else if ((input[0] & 0xF0) == 0xE0) {
+        need = 3;
+    } else if ((input[0] & 0xF8) == 0xF0) {
+        need = 4;
+    } else {
+        return 0;
+    }
+
+    if ((size_t)need > len) {
+        return 0;
+    }
+
+    /* A backslash here would be unescaped first; leave that to the slow path */
+    for (int i = 1; i < need; i++) {
+        if ((input[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return need;
+}
+
+/* Fast path while no escape, character or shortcode is in progress: plain
+ * ASCII runs, whitespace and complete UTF-8 characters are handled in place
+ * without the byte-wise state machine. Stops at a backslash, colon or
+ * anything else needing it. Returns number of input bytes consumed. */
+static size_t text_cleaner_fast_path(TextCleaner *cleaner, const unsigned char *input,
+                                     size_t len, char *output, size_t *out_len) {
+    size_t i = 0;
+    size_t out = *out_len;
+
+    while (i < len) {
+        unsigned char ch = input[i];
+
+        if (is_plain_byte(ch)) {
+            size_t run = i + 1;
+            while (run < len && is_plain_byte(input[run])) {
+                run++;
+            }
+
+            if (cleaner->pending_space) {
+                output[out++] = ' ';
+                cleaner->pending_space = false;
+            }
+            memcpy(output + out, input + i, run - i);
+            out += run - i;
+            i = run;
+            cleaner->last_was_space = false;
+            cleaner->has_output = true;
+            continue;
+        }
+
+        if (ch == ' ' || (ch >= '\t' && ch <= '\r')) {
+            if (ch == '\n') {
+                if (cleaner->pending_space) {
+                    output[out++] = ' ';
+                    cleaner->pending_space = false;
+                }
+                output[out++] = '\n';
+                cleaner->has_output = true;
+                cleaner->last_was_space = false;
+            } else if (!cleaner->last_was_space && cleaner->has_output) {
+                cleaner->pending_space = true;
+                cleaner->last_was_space = true;
+            }
+            i++;
+            continue;
+        }
+
+        int char_len = complete_utf8_length(input + i, len - i);
+        if (char_len == 0) {
+            break;
+        }
+
+        unsigned int codepoint;
+        utf8_decode(input + i, &codepoint);
+        if (!is_emoji_codepoint(codepoint)) {
+            if (cleaner->pending_space) {
+                output[out++] = ' ';
+                cleaner->pending_space = false;
+            }
+            memcpy(output + out, input + i, char_len);
+            out += char_len;
+            cleaner->last_was_space = false;
+            cleaner->has_output = true;
+        }
+        i += char_len;
+    }
+
+    *out_len = out;
+    return i;
+}
+
+/* Clean streamed input: unescape stage feeding the emoji/shortcode stage */
+size_t text_cleaner_feed(TextCleaner *cleaner, const char *input, size_t len, char *output) {
+    size_t out = 0;
+
+    if (!cleaner || !output) {
+        return 0;
+    }
+
+    const unsigned char *in = (const unsigned char *)input;
+    size_t i = 0;
+
+    while (in && i < len) {
+        if (!cleaner->pending_backslash && cleaner->utf8_len == 0 && !cleaner->in_shortcode) {
+            i += text_cleaner_fast_path(cleaner, in + i, len - i, output, &out);
+            if (i == len) {
+                break;
+            }
+        }
+
+        unsigned char ch = in[i++];
+
+        if (cleaner->pending_backslash) {
+            cleaner->pending_backslash = false;
+
+            char mapped = 0;
+            switch (ch) {
+                case 'n': mapped = '\n'; break;
+                case 't': mapped = '\t'; break;
+                case 'r': mapped = '\r'; break;
+                case '\\': mapped = '\\'; break;
+                case '"': mapped = '"'; break;
+                case '\'': mapped = '\''; break;
+                default: break;
+            }
+
+            if (mapped) {
+                out += text_cleaner_put_byte(cleaner, (unsigned char)mapped, output + out);
+                continue;
+            }
+
+            /* Not an escape sequence: keep the backslash, then handle ch normally */
+            out += text_cleaner_put_byte(cleaner, '\\', output + out);
+        }
+
+        if (ch == '\\') {
+            cleaner->pending_backslash = true;
+            continue;
+        }
+
+        out += text_cleaner_put_byte(cleaner, ch, output + out);
+    }
+
+    output[out] = '\0';
+    return out;
+}
+
+/* Clean a complete text in one pass into a buffer sized from the input */
+char *clean_text(const char *input, size_t len, size_t *out_len) {
+    if (!input) {
+        return NULL;
+    }
+
+    /* Output never exceeds the input; slack covers the flush and NUL */
+    char *output = malloc(len + TEXT_CLEANER_SLACK);
+    if (!output) {
+        return NULL;
+    }
+
+    TextCleaner cleaner;
+    text_cleaner_init(&cleaner);
+
+    size_t out = text_cleaner_feed(&cleaner, input, len, output);
+    out += text_cleaner_finish(&cleaner, output + out);
+
+    if (out_len) {
+        *out_len = out;
+    }
+    return output;
+}
+
+/* Flush held-back bytes; a trailing space is dropped */
+size_t text_cleaner_finish(TextCleaner *cleaner, char *output) {
+    size_t out = 0;
+
+    if (!cleaner || !output) {
+        return 0;
+    }
+
+    if (cleaner->pending_backslash) {
+        cleaner->pending_backslash = false;
+        out += text_cleaner_put_byte(cleaner, '\\', output + out);
+    }
+
+    /* Incomplete UTF-8 sequence at end of text is copied as-is */
+    if (cleaner->utf8_len > 0) {
+        if (cleaner->pending_space) {
+            output[out++] = ' ';
+            cleaner->pending_space = false;
+        }
+        memcpy(output + out, cleaner->utf8_buf, cleaner->utf8_len);
+        out += cleaner->utf8_len;
+        cleaner->utf8_len = 0;
+        cleaner->in_shortcode = false;
+    }
+
+    cleaner->pending_space = false;
+    output[out] = '\0';
+    return out;
+}
+
 /* Strip ANSI escape codes and control characters from text */
 int strip_ansi_codes(const char *input, char *output, size_t output_size) {
     if (!input || !output || output_size == 0) {
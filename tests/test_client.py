@@ -27,6 +27,18 @@ class TranslationClient:
             print(f"Health check failed: {e}\n")
             return False
 
+    def stats(self):
+        """Fetch runtime statistics."""
+        try:
+            response = requests.get(f"{self.base_url}/stats", timeout=5)
+            print(f"Stats: {response.status_code}")
+            print(json.dumps(response.json(), indent=2, ensure_ascii=False))
+            print()
+            return response.json() if response.status_code == 200 else None
+        except Exception as e:
+            print(f"Stats request failed: {e}\n")
+            return None
+
     def translate(self, text, from_lang="kor", to_lang="eng",
                   test_uuid=None, test_timestamp=None):
         """
@@ -237,6 +249,105 @@ def test_concurrent_requests():
 
     print(f"Completed {len(results)} requests in {elapsed_time:.2f} seconds")
     print(f"Success: {success_count}/{len(results)}")
+    print()
+
+    # Upstream connection reuse after the burst
+    client.stats()
+    print("="*60 + "\n")
+
+
+def test_batch_requests():
+    """Test batch translation endpoint."""
+    print("\n" + "="*60)
+    print("Testing Batch Requests")
+    print("="*60 + "\n")
+
+    client = TranslationClient()
+    timestamp = datetime.now(timezone.utc).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z"
+
+    def item(text, from_lang, to_lang):
+        return {
+            "timestamp": timestamp,
+            "uuid": str(uuid.uuid4()),
+            "from": from_lang,
+            "to": to_lang,
+            "text": text
+        }
+
+    items = [
+        item("안녕하세요", "kor", "eng"),
+        item("감사합니다", "kor", "eng"),
+        item("안녕하세요", "kor", "eng"),   # Duplicate of first item
+        {"uuid": "invalid", "from": "kor", "to": "eng", "text": "x"},  # Invalid item
+        item("Thank you", "eng", "jpn"),
+    ]
+
+    start_time = time.time()
+    response = requests.post(f"{client.base_url}/translate/batch",
+                             json={"items": items}, timeout=120)
+    elapsed_time = time.time() - start_time
+
+    print(f"Status Code: {response.status_code} ({elapsed_time:.2f} seconds)")
+    body = response.json()
+    print(json.dumps(body, indent=2, ensure_ascii=False))
+
+    if response.status_code == 200:
+        results = body.get("results", [])
+        ordered = all(r.get("uuid") == i["uuid"] for r, i in zip(results, items) if r.get("status") == 200)
+        print(f"Results: {len(results)}/{len(items)}, order preserved: {ordered}")
+        print(f"Invalid item rejected: {results[3].get('status') == 422}")
+
+    print("\n" + "="*60 + "\n")
+
+
+def test_stream_requests():
+    """Test streaming (server-sent events) translation responses."""
+    print("\n" + "="*60)
+    print("Testing Stream Requests")
+    print("="*60 + "\n")
+
+    client = TranslationClient()
+    payload = {
+        "timestamp": datetime.now(timezone.utc).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z",
+        "uuid": str(uuid.uuid4()),
+        "from": "kor",
+        "to": "eng",
+        "text": "오늘은 날씨가 좋아서 공원에 산책을 다녀왔습니다. 저녁에는 친구들과 함께 식사를 했습니다."
+    }
+
+    start_time = time.time()
+    first_delta_time = None
+    streamed = ""
+    final = None
+
+    response = requests.post(f"{client.base_url}/translate?stream=1", json=payload,
+                             headers={"Accept": "text/event-stream"}, stream=True, timeout=120)
+    print(f"Status Code: {response.status_code}")
+    print(f"Content-Type: {response.headers.get('Content-Type')}")
+
+    event = None
+    for line in response.iter_lines(decode_unicode=True):
+        if line.startswith("event: "):
+            event = line[len("event: "):]
+        elif line.startswith("data: "):
+            data = json.loads(line[len("data: "):])
+            if event == "delta":
+                if first_delta_time is None:
+                    first_delta_time = time.time() - start_time
+                streamed += data["text"]
+                print(data["text"], end="", flush=True)
+            elif event == "reset":
+                streamed = ""
+            elif event in ("done", "error"):
+                final = data
+                print(f"\n\n{event}: {json.dumps(data, ensure_ascii=False)}")
+
+    elapsed_time = time.time() - start_time
+    if first_delta_time is not None:
+        print(f"First fragment after {first_delta_time:.2f} seconds, total {elapsed_time:.2f} seconds")
+    if final and "translatedText" in final:
+        print(f"Fragments match final text: {streamed == final['translatedText']}")
+
     print("\n" + "="*60 + "\n")
 
 
@@ -270,14 +381,22 @@ def main():
             test_uuid_preservation()
         elif test_type == "concurrent":
             test_concurrent_requests()
+        elif test_type == "batch":
+            test_batch_requests()
+        elif test_type == "stream":
+            test_stream_requests()
+        elif test_type == "stats":
+            client.stats()
         elif test_type == "all":
             test_valid_requests()
             test_invalid_requests()
             test_uuid_preservation()
             test_concurrent_requests()
+            test_batch_requests()
+            test_stream_requests()
         else:
             print(f"Unknown test type: {test_type}")
-            print("Usage: python test_client.py [valid|invalid|uuid|concurrent|all]")
+            print("Usage: python test_client.py [valid|invalid|uuid|concurrent|batch|stream|stats|all]")
             sys.exit(1)
     else:
         # Default: run all tests
@@ -285,6 +404,8 @@ def main():
         test_invalid_requests()
         test_uuid_preservation()
         test_concurrent_requests()
+        test_batch_requests()
+        test_stream_requests()
 
     print("All tests completed!")
 